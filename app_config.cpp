@@ -0,0 +1,212 @@
+#include "app_config.h"
+#include <QtGlobal>
+#include <QByteArray>
+#include <fstream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+static void overrideFromEnv(const char *name, int &value, int minValue)
+{
+    bool ok = false;
+    int v = qEnvironmentVariableIntValue(name, &ok);
+    if (ok && v >= minValue)
+        value = v;
+}
+
+AppConfig AppConfig::fromEnvironment()
+{
+    AppConfig config;
+    // 调优文件先于环境变量读取，环境变量可以覆盖调优结果
+    QByteArray tuning = qgetenv("WHEELCHAIR_TUNING");
+    if (tuning == "off")
+        config.tuningPath.clear();
+    else if (!tuning.isEmpty())
+        config.tuningPath = tuning.toStdString();
+    if (!config.tuningPath.empty())
+        config.tuningLoaded = config.loadTuning(config.tuningPath);
+    QByteArray tuneFrames = qgetenv("WHEELCHAIR_TUNE_FRAMES");
+    if (tuneFrames == "off")
+        config.firstBootFramesPath.clear();
+    else if (!tuneFrames.isEmpty())
+        config.firstBootFramesPath = tuneFrames.toStdString();
+    overrideFromEnv("WHEELCHAIR_TUNE_FLOOR", config.tuneAccuracyPct, 0);
+
+    overrideFromEnv("WHEELCHAIR_CAPTURE_INTERVAL_MS", config.captureIntervalMs, 1);
+    overrideFromEnv("WHEELCHAIR_DISPLAY_FPS", config.displayFpsCap, 0);
+    // 屏幕刷新率以上没有意义，且超过1000时定时间隔会算成0ms（空转占满主线程）
+    config.displayFpsCap = qMin(config.displayFpsCap, 120);
+    overrideFromEnv("WHEELCHAIR_INFER_INTERVAL", config.inferenceInterval, 1);
+    overrideFromEnv("WHEELCHAIR_MANUAL_HOLD_MS", config.manualHoldMs, 0);
+    overrideFromEnv("WHEELCHAIR_AUTO_CONFIRM", config.autoConfirmFrames, 1);
+    overrideFromEnv("WHEELCHAIR_CONTROL_HZ", config.controlRateHz, 2);
+    overrideFromEnv("WHEELCHAIR_SETPOINT_TIMEOUT_MS", config.setpointTimeoutMs, 0);
+    overrideFromEnv("WHEELCHAIR_MAX_LINEAR", config.maxLinear, 0);
+    overrideFromEnv("WHEELCHAIR_MAX_ANGULAR", config.maxAngular, 0);
+    config.framedProtocol = qgetenv("WHEELCHAIR_PROTOCOL") == "framed";
+
+    config.rawMjpeg = qgetenv("WHEELCHAIR_RAW_MJPEG") != "0";
+    overrideFromEnv("WHEELCHAIR_RECORDER_MB", config.recorderBudgetMb, 0);
+    overrideFromEnv("WHEELCHAIR_RECORDER_SLOT_KB", config.recorderSlotKb, 1);
+    QByteArray recorderDir = qgetenv("WHEELCHAIR_RECORDER_DIR");
+    if (!recorderDir.isEmpty())
+        config.recorderDir = recorderDir.toStdString();
+
+    config.sessionAutoStart = qgetenv("WHEELCHAIR_SESSION") == "1";
+    QByteArray sessionDir = qgetenv("WHEELCHAIR_SESSION_DIR");
+    if (!sessionDir.isEmpty())
+        config.sessionDir = sessionDir.toStdString();
+    config.sessionAvi = qgetenv("WHEELCHAIR_SESSION_FORMAT") != "mjpeg";
+    overrideFromEnv("WHEELCHAIR_SESSION_SEGMENT_MB", config.sessionSegmentMb, 1);
+    overrideFromEnv("WHEELCHAIR_SESSION_SEGMENT_SEC", config.sessionSegmentSec, 1);
+    overrideFromEnv("WHEELCHAIR_SESSION_MIN_FREE_MB", config.sessionMinFreeMb, 0);
+
+    config.logLevels = qgetenv("WHEELCHAIR_LOG").toStdString();
+    config.logPath = qgetenv("WHEELCHAIR_LOG_FILE").toStdString();
+    overrideFromEnv("WHEELCHAIR_LOG_RATE", config.logRateLimit, 0);
+
+    overrideFromEnv("WHEELCHAIR_UI_STALL_MS", config.uiStallMs, 0);
+    overrideFromEnv("WHEELCHAIR_UI_WATCHDOG_MS", config.uiWatchdogMs, 0);
+
+    QByteArray metrics = qgetenv("WHEELCHAIR_METRICS");
+    if (metrics == "off")
+        config.metricsAddress.clear();
+    else if (!metrics.isEmpty())
+        config.metricsAddress = metrics.toStdString();
+
+    QByteArray model = qgetenv("WHEELCHAIR_MODEL");
+    if (!model.isEmpty())
+        config.modelPath = model.toStdString();
+    QByteArray backend = qgetenv("WHEELCHAIR_BACKEND");
+    if (!backend.isEmpty())
+        config.inferenceBackend = backend.toStdString();
+    overrideFromEnv("WHEELCHAIR_INFER_THREADS", config.inferenceThreads, 1);
+    overrideFromEnv("WHEELCHAIR_INPUT_SIZE", config.inputSize, 32);
+    QByteArray winograd = qgetenv("WHEELCHAIR_WINOGRAD");
+    if (!winograd.isEmpty())
+        config.winograd = winograd != "0";
+    QByteArray engine = qgetenv("WHEELCHAIR_ENGINE");
+    if (!engine.isEmpty())
+        config.inferenceEngine = engine.toStdString();
+    QByteArray faceModel = qgetenv("WHEELCHAIR_FACE_MODEL");
+    if (!faceModel.isEmpty())
+        config.faceModelPath = faceModel.toStdString();
+    config.faceCascadePath = qgetenv("WHEELCHAIR_FACE_CASCADE").toStdString();
+    overrideFromEnv("WHEELCHAIR_FACE_SIZE", config.faceInputSize, 16);
+    QByteArray gateModel = qgetenv("WHEELCHAIR_GATE_MODEL");
+    if (!gateModel.isEmpty())
+        config.gateModelPath = gateModel.toStdString();
+    overrideFromEnv("WHEELCHAIR_GATE_SIZE", config.gateInputSize, 16);
+    overrideFromEnv("WHEELCHAIR_GATE_MARGIN", config.gateMarginPct, 0);
+    overrideFromEnv("WHEELCHAIR_GATE_AUDIT", config.gateAuditInterval, 0);
+    QByteArray letterBox = qgetenv("WHEELCHAIR_LETTERBOX");
+    if (!letterBox.isEmpty())
+        config.letterBox = letterBox != "0";
+
+    QByteArray uart = qgetenv("WHEELCHAIR_UART");
+    if (!uart.isEmpty())
+        config.uartPath = uart.toStdString();
+
+    QByteArray input = qgetenv("WHEELCHAIR_INPUT");
+    if (input == "off") {
+        config.inputEnabled = false;
+    } else if (!input.isEmpty()) {
+        for (const QByteArray &path : input.split(',')) {
+            if (!path.trimmed().isEmpty())
+                config.inputDevices.push_back(path.trimmed().toStdString());
+        }
+    }
+    return config;
+}
+
+bool AppConfig::loadTuning(const std::string &path)
+{
+    std::ifstream in(path.c_str());
+    if (!in)
+        return false;
+    std::string line;
+    while (std::getline(in, line)) {
+        size_t eq = line.find('=');
+        if (line.empty() || line[0] == '#' || eq == std::string::npos)
+            continue;
+        std::string key = line.substr(0, eq);
+        std::string value = line.substr(eq + 1);
+        int number = atoi(value.c_str());
+        if (key == "backend" && !value.empty())
+            inferenceBackend = value;
+        else if (key == "threads" && number >= 1)
+            inferenceThreads = number;
+        else if (key == "winograd")
+            winograd = number != 0;
+        else if (key == "input_size" && number >= 32)
+            inputSize = number;
+        else if (key == "letterbox")
+            letterBox = number != 0;
+        else if (key == "infer_interval" && number >= 1)
+            inferenceInterval = number;
+    }
+    return true;
+}
+
+bool AppConfig::saveTuning(const std::string &path, std::string &error) const
+{
+    std::string tmpPath = path + ".tmp";
+    FILE *f = fopen(tmpPath.c_str(), "w");
+    if (!f) {
+        error = "无法写入 " + tmpPath;
+        return false;
+    }
+    fprintf(f, "# 自动调优结果（--tune生成），启动时读取，环境变量优先\n");
+    fprintf(f, "backend=%s\nthreads=%d\nwinograd=%d\ninput_size=%d\nletterbox=%d\ninfer_interval=%d\n",
+            inferenceBackend.c_str(), inferenceThreads, winograd ? 1 : 0, inputSize, letterBox ? 1 : 0,
+            inferenceInterval);
+    bool ok = fflush(f) == 0 && fsync(fileno(f)) == 0;
+    ok = fclose(f) == 0 && ok;
+    if (!ok || rename(tmpPath.c_str(), path.c_str()) != 0) {
+        remove(tmpPath.c_str());
+        error = "写入调优文件失败: " + path;
+        return false;
+    }
+    return true;
+}
+
+bool AppConfig::applyArguments(const std::vector<std::string> &arguments, std::string &error)
+{
+    for (size_t i = 1; i < arguments.size(); ++i) {
+        const std::string &arg = arguments[i];
+        bool hasValue = i + 1 < arguments.size();
+        if (arg == "--headless") {
+            headless = true;
+        } else if (arg == "--exit-on-end") {
+            exitOnReplayEnd = true;
+        } else if (arg == "--replay" && hasValue) {
+            replayPath = arguments[++i];
+        } else if (arg == "--tune" && hasValue) {
+            tuneFramesPath = arguments[++i];
+        } else if (arg == "--log" && hasValue) {
+            logLevels = arguments[++i];
+        } else if (arg == "--uart-out" && hasValue) {
+            uartOut = arguments[++i];
+        } else if (arg == "--replay-mode" && hasValue) {
+            const std::string &mode = arguments[++i];
+            if (mode == "lockstep")
+                replayMode = 0;
+            else if (mode == "realtime")
+                replayMode = 1;
+            else if (mode == "fast")
+                replayMode = 2;
+            else {
+                error = "未知的回放模式: " + mode + "（可选 lockstep|realtime|fast）";
+                return false;
+            }
+        } else {
+            error = "无法识别的参数: " + arg;
+            return false;
+        }
+    }
+    if ((!uartOut.empty() || exitOnReplayEnd) && replayPath.empty()) {
+        error = "--uart-out/--exit-on-end 只能与 --replay 一起使用";
+        return false;
+    }
+    return true;
+}
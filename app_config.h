@@ -0,0 +1,145 @@
+#ifndef APP_CONFIG_H
+#define APP_CONFIG_H
+
+#include <string>
+#include <vector>
+
+// 运行参数（默认值与原有硬编码一致；其次读取自动调优文件中的推理配置，环境变量最优先；无界面/回放相关参数来自命令行）
+//   WHEELCHAIR_CAPTURE_INTERVAL_MS  采集定时器间隔（毫秒）
+//   WHEELCHAIR_DISPLAY_FPS          显示帧率上限（0~120），0表示不渲染画面（无显示屏的kiosk部署）
+//   WHEELCHAIR_INFER_INTERVAL       每N个采集帧触发一次推理
+//   WHEELCHAIR_MANUAL_HOLD_MS       手动方向指令覆盖自动控制的时长（毫秒）
+//   WHEELCHAIR_AUTO_CONFIRM         恢复自动控制前需连续一致的姿态次数
+//   WHEELCHAIR_INPUT                物理输入设备，逗号分隔（可为录制的input_event文件/管道）；
+//                                   未设置时自动扫描/dev/input，"off"表示关闭
+//   WHEELCHAIR_UART                 串口设备路径（默认/dev/ttymxc5；可指向wheelchair_sim创建的伪终端）
+//   WHEELCHAIR_MODEL                ONNX模型路径（默认/root/last.onnx；tflite后端读取同名.tflite，
+//                                   native后端首次加载时在同目录生成同名.wcm）
+//   WHEELCHAIR_BACKEND              推理后端：opencv（默认）、native、ort、tflite（后两者需编译时开启，见inference_backends.pri）
+//   WHEELCHAIR_INFER_THREADS        推理线程数
+//   WHEELCHAIR_WINOGRAD             "0"关闭opencv后端的Winograd卷积
+//   WHEELCHAIR_INPUT_SIZE           模型输入边长（默认128，须为32的倍数）
+//   WHEELCHAIR_LETTERBOX            "0"关闭补零成正方形（直接拉伸到模型输入）
+//   WHEELCHAIR_ENGINE               推理引擎：yolo（默认）或face（LBP人脸定位/跟踪框 → 人脸裁剪 → 小的姿态分类器）
+//   WHEELCHAIR_FACE_MODEL           face引擎的姿态分类器ONNX（默认/root/pose_cls.onnx）
+//   WHEELCHAIR_FACE_CASCADE         face引擎的人脸级联分类器（默认OpenCV自带的lbpcascade_frontalface_improved.xml）
+//   WHEELCHAIR_FACE_SIZE            姿态分类器输入边长（默认64）
+//   WHEELCHAIR_GATE_MODEL           两级级联的门控模型（小的YOLO检测器ONNX，未设置表示不级联，每帧都跑完整模型）
+//   WHEELCHAIR_GATE_SIZE            门控模型输入边长（默认64）
+//   WHEELCHAIR_GATE_MARGIN          门控最优目标的类别间隔（最高与次高得分之差，百分比）不低于该值时直接采用（默认50）
+//   WHEELCHAIR_GATE_AUDIT           每采用N次门控结果抽查一次完整模型以统计不一致率（默认20，0表示不抽查）
+//   WHEELCHAIR_TUNING               自动调优文件（默认/root/wheelchair_tuning.conf，"off"表示不读也不写）
+//   WHEELCHAIR_TUNE_FRAMES          首次启动（调优文件不存在）时用于自动调优的黑匣子转储，"off"表示首次启动不调优
+//   WHEELCHAIR_TUNE_FLOOR           调优精度下限：与基准配置逐帧姿态一致的百分比（默认95）
+//   WHEELCHAIR_RAW_MJPEG            "0"关闭原始MJPEG采集（默认开启：自行解码，截图直接写出原始JPEG）
+//   WHEELCHAIR_RECORDER_MB          黑匣子内存预算（MB，0表示关闭）
+//   WHEELCHAIR_RECORDER_SLOT_KB     黑匣子单帧MJPEG上限（KB）
+//   WHEELCHAIR_RECORDER_DIR         黑匣子转储目录
+//   WHEELCHAIR_SESSION              "1"表示启动摄像头时自动开始连续录制（也可在界面上手动开始）
+//   WHEELCHAIR_SESSION_DIR          连续录制目录
+//   WHEELCHAIR_SESSION_FORMAT       "avi"（默认，AVI/MJPEG容器）或 "mjpeg"（裸MJPEG流）
+//   WHEELCHAIR_SESSION_SEGMENT_MB   单个段文件大小上限（MB，最大1024）
+//   WHEELCHAIR_SESSION_SEGMENT_SEC  单个段文件时长上限（秒）
+//   WHEELCHAIR_SESSION_MIN_FREE_MB  剩余空间低于该值时停止录制
+//   WHEELCHAIR_PROTOCOL             "legacy"（默认，单字符F/B/L/R/S）或 "framed"（固定频率速度设定值帧）
+//   WHEELCHAIR_CONTROL_HZ           帧协议下控制环频率
+//   WHEELCHAIR_SETPOINT_TIMEOUT_MS  帧协议下超过该时长没有新指令则缓停（0表示不超时）
+//   WHEELCHAIR_MAX_LINEAR           最大前进速度（mm/s）
+//   WHEELCHAIR_MAX_ANGULAR          最大转向角速度（mrad/s）
+//   WHEELCHAIR_LOG                  日志级别，"类别=级别"逗号分隔，如"infer=debug,ui=warn"（"*"表示全部类别，默认info）
+//   WHEELCHAIR_LOG_FILE             日志文件（默认stderr）
+//   WHEELCHAIR_LOG_RATE             每个日志点每秒最多输出条数（0表示不限流）
+//   WHEELCHAIR_UI_STALL_MS          主线程事件循环阻塞超过该时长记为卡顿并告警（0表示关闭卡顿监测）
+//   WHEELCHAIR_UI_WATCHDOG_MS       阻塞超过该时长发出看门狗停止（0表示只告警不停车）
+//   WHEELCHAIR_METRICS              指标导出地址（Prometheus文本格式）："端口"、"主机:端口"、"unix:/路径"，
+//                                   默认127.0.0.1:9101，"off"表示关闭
+struct AppConfig
+{
+    int captureIntervalMs {80};
+    int displayFpsCap     {10};
+    int inferenceInterval {20};
+    int manualHoldMs      {3000};
+    int autoConfirmFrames {2};
+    bool inputEnabled     {true};
+    std::vector<std::string> inputDevices;   // 为空表示自动扫描
+    std::string uartPath  {"/dev/ttymxc5"};
+    std::string modelPath {"/root/last.onnx"};
+    std::string inferenceBackend {"opencv"};
+    int inferenceThreads  {1};
+    bool winograd         {true};
+    int inputSize         {128};     // 与MODEL_INPUT_SIZE一致
+    bool letterBox        {true};
+    std::string inferenceEngine {"yolo"};
+    std::string faceModelPath {"/root/pose_cls.onnx"};
+    std::string faceCascadePath;     // 为空表示用InferenceConfig中的默认路径
+    int faceInputSize     {64};
+    std::string gateModelPath;       // 为空表示不级联
+    int gateInputSize     {64};
+    int gateMarginPct     {50};
+    int gateAuditInterval {20};
+    bool rawMjpeg         {true};
+
+    // 黑匣子（默认8MB：128x96的MJPEG约10KB/帧，可保留约20秒画面与5分钟事件）
+    int recorderBudgetMb  {8};
+    int recorderSlotKb    {32};
+    std::string recorderDir {"/root/flight"};
+
+    // 连续录制（再训练数据）：原始MJPEG直接写入段文件，不重新编码，需开启原始MJPEG采集
+    bool sessionAutoStart {false};
+    std::string sessionDir {"/root/sessions"};
+    bool sessionAvi       {true};
+    int sessionSegmentMb  {256};
+    int sessionSegmentSec {600};
+    int sessionMinFreeMb  {200};
+
+    // 帧协议速度控制（单位：mm/s、mrad/s 及其一阶/二阶导数）
+    bool framedProtocol   {false};
+    int controlRateHz     {50};
+    int setpointTimeoutMs {5000};
+    int maxLinear         {600};
+    int maxReverse        {300};
+    int maxAngular        {800};
+    int linearAccel       {500};
+    int linearJerk        {1500};
+    int angularAccel      {1500};
+    int angularJerk       {4000};
+
+    // 异步日志（命令行 --log 覆盖WHEELCHAIR_LOG）
+    std::string logLevels;
+    std::string logPath;
+    int logRateLimit      {20};
+
+    // 事件循环卡顿监测（触摸屏无响应时停车）
+    int uiStallMs         {250};
+    int uiWatchdogMs      {2000};
+
+    // 指标导出（HTTP GET /metrics），为空表示关闭
+    std::string metricsAddress {"127.0.0.1:9101"};
+
+    // 按板子自动调优（命令行 --tune <黑匣子转储> 按需运行；调优文件不存在时首次启动自动运行一次）
+    std::string tuningPath {"/root/wheelchair_tuning.conf"};   // 为空表示不读也不写
+    bool tuningLoaded     {false};                             // 本次启动读到了调优文件
+    std::string tuneFramesPath;                                // 非空表示调优模式：扫描后写调优文件并退出
+    std::string firstBootFramesPath {"/root/tune_frames.bin"};
+    int tuneAccuracyPct   {95};
+
+    // 无界面运行（命令行 --headless）：只跑采集/推理/控制，不创建任何窗口（kiosk/服务器部署）
+    bool headless         {false};
+
+    // 回放（命令行）：--replay <转储文件> [--replay-mode lockstep|realtime|fast] [--uart-out <文件或pty>] [--exit-on-end]
+    std::string replayPath;             // 非空表示回放模式，不打开摄像头
+    int replayMode        {0};          // ReplayMode
+    std::string uartOut;                // 回放时串口输出；为空则不打开任何串口（绝不驱动真实轮椅）
+    bool exitOnReplayEnd  {false};
+
+    static AppConfig fromEnvironment();
+    // 调优文件：每行"键=值"（backend/threads/winograd/input_size/letterbox/infer_interval），#开头为注释；
+    // 文件不存在时返回false，无法识别的行忽略
+    bool loadTuning(const std::string &path);
+    // 写入上述键（先写临时文件再改名），失败时返回false并在error中给出原因
+    bool saveTuning(const std::string &path, std::string &error) const;
+    // 解析命令行，失败时返回false并在error中给出原因
+    bool applyArguments(const std::vector<std::string> &arguments, std::string &error);
+};
+
+#endif // APP_CONFIG_H
@@ -0,0 +1,350 @@
+#include "async_logger.h"
+#include "pipeline_clock.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+
+std::atomic<uint8_t> AsyncLogger::levels[LogCategoryCount] = {
+    {LogInfo}, {LogInfo}, {LogInfo}, {LogInfo}, {LogInfo}, {LogInfo}, {LogInfo}, {LogInfo}, {LogInfo}
+};
+std::atomic<int> AsyncLogger::rateLimit(0);
+std::atomic<AsyncLogger *> AsyncLogger::current(nullptr);
+std::atomic<int> AsyncLogger::inFlightProducers(0);
+std::atomic<uint64_t> AsyncLogger::suppressedTotal(0);
+
+static const char *const kCategoryNames[LogCategoryCount] = {
+    "capture", "infer", "control", "input", "record", "replay", "stats", "ui", "system"
+};
+static const char *const kLevelNames[LogOff + 1] = {"debug", "info", "warn", "error", "off"};
+static const char kLevelTags[LogOff] = {'D', 'I', 'W', 'E'};
+
+static const int kFlushIntervalMs = 100;
+
+AsyncLogger::AsyncLogger(const std::string &path, int rateLimitPerSec, size_t capacity, QObject *parent)
+    : QThread(parent)
+    , ring(nullptr)
+    , mask(0)
+    , enqueuePos(0)
+    , dequeuePos(0)
+    , fd(STDERR_FILENO)
+    , ownsFd(false)
+    , running(true)
+    , outBuf(nullptr)
+    , outCap(64 * 1024)
+    , dropped(0)
+    , written(0)
+{
+    // 容量取2的幂，序号与下标用掩码换算
+    size_t slotCount = 2;
+    while (slotCount < capacity)
+        slotCount <<= 1;
+    ring = new LogEntry[slotCount];
+    mask = slotCount - 1;
+    // 初始化序号的同时预先触页
+    for (size_t i = 0; i < slotCount; ++i) {
+        memset(static_cast<void *>(&ring[i]), 0, sizeof(LogEntry));
+        ring[i].seq.store(i, std::memory_order_relaxed);
+    }
+    outBuf = static_cast<char *>(malloc(outCap));
+
+    if (!path.empty()) {
+        int f = open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+        if (f >= 0) {
+            fd = f;
+            ownsFd = true;
+        } else {
+            fprintf(stderr, "日志文件打开失败 %s: %s，改写stderr\n", path.c_str(), strerror(errno));
+        }
+    }
+    wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    rateLimit.store(rateLimitPerSec > 0 ? rateLimitPerSec : 0, std::memory_order_relaxed);
+    current.store(this, std::memory_order_release);
+}
+
+AsyncLogger::~AsyncLogger()
+{
+    stop();
+    if (wakeFd >= 0)
+        close(wakeFd);
+    if (ownsFd)
+        close(fd);
+    free(outBuf);
+    delete[] ring;
+}
+
+bool AsyncLogger::configure(const std::string &spec, std::string &error)
+{
+    size_t begin = 0;
+    while (begin <= spec.size()) {
+        size_t end = spec.find(',', begin);
+        if (end == std::string::npos)
+            end = spec.size();
+        std::string item = spec.substr(begin, end - begin);
+        begin = end + 1;
+        if (item.empty())
+            continue;
+
+        size_t eq = item.find('=');
+        std::string name = eq == std::string::npos ? std::string("*") : item.substr(0, eq);
+        std::string levelName = eq == std::string::npos ? item : item.substr(eq + 1);
+        int level = -1;
+        for (int l = 0; l <= LogOff; ++l) {
+            if (levelName == kLevelNames[l])
+                level = l;
+        }
+        if (level < 0) {
+            error = "未知日志级别: " + levelName + "（debug/info/warn/error/off）";
+            return false;
+        }
+        bool matched = false;
+        for (int c = 0; c < LogCategoryCount; ++c) {
+            if (name == "*" || name == kCategoryNames[c]) {
+                levels[c].store(static_cast<uint8_t>(level), std::memory_order_relaxed);
+                matched = true;
+            }
+        }
+        if (!matched) {
+            error = "未知日志类别: " + name;
+            return false;
+        }
+    }
+    return true;
+}
+
+void AsyncLogger::setLevel(LogCategory category, LogLevel level)
+{
+    levels[category].store(static_cast<uint8_t>(level), std::memory_order_relaxed);
+}
+
+// 按日志点限流：1秒窗口内超过rateLimit条的丢弃，计入该日志点的suppressed
+bool AsyncLogger::admit(LogSite &site, int64_t &now, uint32_t &suppressed)
+{
+    now = monotonicNowNs();
+    int limit = rateLimit.load(std::memory_order_relaxed);
+    if (limit > 0) {
+        int64_t start = site.windowStartNs.load(std::memory_order_relaxed);
+        if (now - start >= 1000000000LL &&
+            site.windowStartNs.compare_exchange_strong(start, now, std::memory_order_relaxed)) {
+            site.inWindow.store(0, std::memory_order_relaxed);
+        }
+        if (site.inWindow.fetch_add(1, std::memory_order_relaxed) >= static_cast<uint32_t>(limit)) {
+            site.suppressed.fetch_add(1, std::memory_order_relaxed);
+            suppressedTotal.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+    }
+    suppressed = site.suppressed.exchange(0, std::memory_order_relaxed);
+    return true;
+}
+
+// 有界多生产者队列：槽位序号等于入队位置表示空闲，等于位置+1表示已写好待消费。
+// 生产者只用一次CAS抢位置；队列满时返回空（调用方丢弃），不等待消费者
+LogEntry *AsyncLogger::claim(uint64_t &pos)
+{
+    pos = enqueuePos.load(std::memory_order_relaxed);
+    for (;;) {
+        LogEntry *r = &ring[pos & mask];
+        uint64_t seq = r->seq.load(std::memory_order_acquire);
+        int64_t diff = static_cast<int64_t>(seq - pos);
+        if (diff == 0) {
+            if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                return r;
+        } else if (diff < 0) {
+            return nullptr;
+        } else {
+            pos = enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+void AsyncLogger::commit(LogEntry *r, uint64_t pos)
+{
+    r->seq.store(pos + 1, std::memory_order_release);
+    // 警告以上或积压过半时立即唤醒；其余由写日志线程定时取走，热点路径上不做系统调用
+    uint64_t backlog = pos + 1 - dequeuePos.load(std::memory_order_relaxed);
+    if (r->site->level >= LogWarn || backlog == (mask + 1) / 2) {
+        uint64_t one = 1;
+        if (write(wakeFd, &one, sizeof(one)) != sizeof(one)) {
+        }
+    }
+}
+
+void AsyncLogger::stop()
+{
+    if (current.load(std::memory_order_acquire) == this)
+        current.store(nullptr);
+    // 摘下实例之前已读到它的生产者可能还在写槽位：等它们提交完再做最后一次取走，之后环形队列才能释放
+    while (inFlightProducers.load() != 0)
+        sched_yield();
+    running.store(false, std::memory_order_release);
+    uint64_t one = 1;
+    if (write(wakeFd, &one, sizeof(one)) != sizeof(one)) {
+    }
+    wait();
+    drain();
+}
+
+void AsyncLogger::run()
+{
+    struct pollfd pfd;
+    pfd.fd = wakeFd;
+    pfd.events = POLLIN;
+    while (running.load(std::memory_order_acquire)) {
+        poll(&pfd, 1, kFlushIntervalMs);
+        uint64_t n;
+        while (read(wakeFd, &n, sizeof(n)) == sizeof(n)) {
+        }
+        drain();
+    }
+}
+
+// 取走所有已写好的记录，格式化到输出缓冲后批量写出
+size_t AsyncLogger::drain()
+{
+    size_t count = 0;
+    size_t used = 0;
+    uint64_t pos = dequeuePos.load(std::memory_order_relaxed);
+    for (;;) {
+        LogEntry *r = &ring[pos & mask];
+        if (r->seq.load(std::memory_order_acquire) != pos + 1)
+            break;
+        if (outCap - used < 1024) {
+            if (write(fd, outBuf, used) < 0) {
+            }
+            used = 0;
+        }
+        used += format(*r, outBuf + used, outCap - used);
+        r->seq.store(pos + mask + 1, std::memory_order_release);
+        ++pos;
+        dequeuePos.store(pos, std::memory_order_relaxed);
+        ++count;
+    }
+    if (used > 0 && write(fd, outBuf, used) < 0) {
+    }
+    written.fetch_add(count, std::memory_order_relaxed);
+    return count;
+}
+
+void AsyncLogger::writeNow(const LogEntry &r)
+{
+    char line[1024];
+    size_t n = format(r, line, sizeof(line));
+    if (write(STDERR_FILENO, line, n) < 0) {
+    }
+}
+
+static bool isIntConversion(char c)
+{
+    return strchr("diouxXc", c) != nullptr;
+}
+
+static bool isFloatConversion(char c)
+{
+    return strchr("fFeEgGaA", c) != nullptr;
+}
+
+// 一个参数按格式说明输出；printf的长度修饰符由参数的实际类型决定，格式串里写不写都可以
+static int formatArg(char *out, size_t cap, const char *flags, size_t flagsLen, char conv,
+                     const LogEntry &r, int index)
+{
+    char spec[32];
+    if (flagsLen > sizeof(spec) - 4)
+        flagsLen = sizeof(spec) - 4;
+    spec[0] = '%';
+    memcpy(spec + 1, flags, flagsLen);
+    char *tail = spec + 1 + flagsLen;
+
+    const LogEntry::Arg &a = r.args[index];
+    uint8_t type = r.types[index];
+    if (type == LogEntry::ArgText) {
+        tail[0] = 's';
+        tail[1] = '\0';
+        return snprintf(out, cap, spec, r.text + a.textOffset);
+    }
+    if (isFloatConversion(conv) || (conv == 's' && type == LogEntry::ArgDouble)) {
+        tail[0] = conv == 's' ? 'g' : conv;
+        tail[1] = '\0';
+        double v = type == LogEntry::ArgDouble ? a.d : type == LogEntry::ArgInt ? double(a.i) : double(a.u);
+        return snprintf(out, cap, spec, v);
+    }
+    if (conv == 'c') {
+        tail[0] = 'c';
+        tail[1] = '\0';
+        int v = type == LogEntry::ArgDouble ? int(a.d) : int(a.i);
+        return snprintf(out, cap, spec, v);
+    }
+    // 整数（%s配整数也按十进制输出）
+    char c = isIntConversion(conv) ? conv : (type == LogEntry::ArgUInt ? 'u' : 'd');
+    tail[0] = 'l';
+    tail[1] = 'l';
+    tail[2] = c;
+    tail[3] = '\0';
+    if (c == 'd' || c == 'i') {
+        long long v = type == LogEntry::ArgDouble ? static_cast<long long>(a.d) : static_cast<long long>(a.i);
+        return snprintf(out, cap, spec, v);
+    }
+    unsigned long long v = type == LogEntry::ArgDouble ? static_cast<unsigned long long>(a.d)
+                                                        : static_cast<unsigned long long>(a.u);
+    return snprintf(out, cap, spec, v);
+}
+
+// 一条记录格式化为一行："[秒.微秒] 级别 类别 消息"，返回写入字节数（含换行，保证不越界）
+size_t AsyncLogger::format(const LogEntry &r, char *out, size_t cap)
+{
+    if (cap < 2)
+        return 0;
+    size_t limit = cap - 1;   // 留给换行
+    size_t n = 0;
+    const LogSite &site = *r.site;
+    int w = snprintf(out, limit, "[%5lld.%06lld] %c %-7s ",
+                     static_cast<long long>(r.tNs / 1000000000LL),
+                     static_cast<long long>((r.tNs % 1000000000LL) / 1000),
+                     kLevelTags[site.level < LogOff ? site.level : static_cast<int>(LogError)],
+                     kCategoryNames[site.category]);
+    n = w > 0 ? (static_cast<size_t>(w) < limit ? static_cast<size_t>(w) : limit - 1) : 0;
+
+    int argIndex = 0;
+    for (const char *p = site.format; *p && n + 1 < limit; ++p) {
+        if (*p != '%') {
+            out[n++] = *p;
+            continue;
+        }
+        if (p[1] == '%') {
+            out[n++] = '%';
+            ++p;
+            continue;
+        }
+        // 解析 %[flags][width][.precision][length]conv
+        const char *specBegin = p + 1;
+        const char *q = specBegin;
+        while (*q && strchr("-+ #0123456789.", *q))
+            ++q;
+        size_t flagsLen = q - specBegin;
+        while (*q && strchr("hlLqjzt", *q))
+            ++q;
+        if (!*q)
+            break;
+        char conv = *q;
+        p = q;
+        if (argIndex >= r.argc) {
+            out[n++] = '?';
+            continue;
+        }
+        int m = formatArg(out + n, limit - n, specBegin, flagsLen, conv, r, argIndex++);
+        if (m > 0)
+            n += static_cast<size_t>(m) < limit - n ? static_cast<size_t>(m) : limit - n - 1;
+    }
+
+    if (r.suppressed > 0 && n + 1 < limit) {
+        int m = snprintf(out + n, limit - n, "（此前%u条被限流）", r.suppressed);
+        if (m > 0)
+            n += static_cast<size_t>(m) < limit - n ? static_cast<size_t>(m) : limit - n - 1;
+    }
+    out[n++] = '\n';
+    return n;
+}
@@ -0,0 +1,250 @@
+#ifndef ASYNC_LOGGER_H
+#define ASYNC_LOGGER_H
+
+#include <QThread>
+#include <QString>
+#include <QByteArray>
+#include <atomic>
+#include <string>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// 日志级别（低于类别当前级别的日志点直接跳过）
+enum LogLevel
+{
+    LogDebug = 0,
+    LogInfo,
+    LogWarn,
+    LogError,
+    LogOff
+};
+
+// 日志类别：各自独立设置级别（WHEELCHAIR_LOG="infer=debug,ui=warn,*=info"）
+enum LogCategory
+{
+    LogCapture = 0,   // 采集/摄像头
+    LogInfer,         // 推理
+    LogControl,       // 控制分发/串口
+    LogInput,         // 物理输入
+    LogRecord,        // 黑匣子/连续录制/截图
+    LogReplay,        // 回放
+    LogStats,         // 周期统计（延迟/资源/录制开销）
+    LogUi,            // 界面按钮
+    LogSystem,        // 启动/退出
+    LogCategoryCount
+};
+
+// 日志点：每个LOG_xxx宏展开处一个函数内静态实例。构造函数为constexpr，
+// 常量初始化，不产生静态局部变量的首次初始化检查。限流状态也放在这里（按日志点限流）。
+struct LogSite
+{
+    const char *format;
+    uint8_t category;
+    uint8_t level;
+    std::atomic<int64_t> windowStartNs;
+    std::atomic<uint32_t> inWindow;
+    std::atomic<uint32_t> suppressed;
+
+    constexpr LogSite(const char *fmt, int cat, int lvl)
+        : format(fmt), category(static_cast<uint8_t>(cat)), level(static_cast<uint8_t>(lvl)),
+          windowStartNs(0), inWindow(0), suppressed(0) {}
+};
+
+// 二进制日志记录：生产者只写参数值（字符串拷贝到text，截断），格式化全部在写日志线程完成
+struct LogEntry
+{
+    static const int kMaxArgs = 8;
+    static const int kTextBytes = 96;
+
+    enum ArgType : uint8_t { ArgInt, ArgUInt, ArgDouble, ArgText };
+    union Arg
+    {
+        int64_t i;
+        uint64_t u;
+        double d;
+        uint32_t textOffset;
+    };
+
+    std::atomic<uint64_t> seq;     // 环形队列槽位序号（见AsyncLogger::claim）
+    int64_t tNs;                   // CLOCK_MONOTONIC
+    const LogSite *site;
+    uint32_t suppressed;           // 本条之前该日志点被限流丢弃的条数
+    uint8_t argc;
+    uint8_t textUsed;
+    uint8_t types[kMaxArgs];
+    Arg args[kMaxArgs];
+    char text[kTextBytes];
+};
+
+// 把参数逐个写入LogEntry（不分配内存；QString需转码，只用于非热点路径）
+class LogPacker
+{
+public:
+    explicit LogPacker(LogEntry *record) : r(record) { r->argc = 0; r->textUsed = 0; }
+
+    void add(bool v) { addInt(v ? 1 : 0); }
+    void add(char v) { addInt(v); }
+    void add(signed char v) { addInt(v); }
+    void add(unsigned char v) { addUInt(v); }
+    void add(short v) { addInt(v); }
+    void add(unsigned short v) { addUInt(v); }
+    void add(int v) { addInt(v); }
+    void add(unsigned v) { addUInt(v); }
+    void add(long v) { addInt(v); }
+    void add(unsigned long v) { addUInt(v); }
+    void add(long long v) { addInt(v); }
+    void add(unsigned long long v) { addUInt(v); }
+    void add(float v) { addDouble(v); }
+    void add(double v) { addDouble(v); }
+    void add(const char *s) { addText(s ? s : "(null)", s ? strlen(s) : 6); }
+    void add(const std::string &s) { addText(s.data(), s.size()); }
+    void add(const QString &s) { QByteArray utf8 = s.toUtf8(); addText(utf8.constData(), utf8.size()); }
+
+private:
+    LogEntry::Arg *next(uint8_t type)
+    {
+        r->types[r->argc] = type;
+        return &r->args[r->argc++];
+    }
+    void addInt(long long v) { next(LogEntry::ArgInt)->i = v; }
+    void addUInt(unsigned long long v) { next(LogEntry::ArgUInt)->u = v; }
+    void addDouble(double v) { next(LogEntry::ArgDouble)->d = v; }
+    void addText(const char *s, size_t len)
+    {
+        size_t room = LogEntry::kTextBytes - r->textUsed;
+        if (room == 0) {
+            next(LogEntry::ArgText)->textOffset = LogEntry::kTextBytes - 1;   // 指向末尾的'\0'
+            return;
+        }
+        if (len > room - 1)
+            len = room - 1;
+        memcpy(r->text + r->textUsed, s, len);
+        r->text[r->textUsed + len] = '\0';
+        next(LogEntry::ArgText)->textOffset = r->textUsed;
+        r->textUsed = static_cast<uint8_t>(r->textUsed + len + 1);
+    }
+
+    LogEntry *r;
+};
+
+// 异步日志：替代热点路径上的qDebug/std::cout（串口控制台上同步写一行要几毫秒）。
+// - 日志点先比较类别级别（一次relaxed原子读），关闭时只有几纳秒开销，参数都不求值
+// - 生产者（任意线程）把二进制记录写入预分配的无锁多生产者环形队列，不分配、不加锁、不做系统调用；
+//   队列满时丢弃并计数，绝不阻塞采集/推理/控制线程
+// - 每个日志点每秒最多rateLimit条，超出的丢弃，下一条放行的日志附上被限流的条数
+// - 本线程按printf格式串格式化并批量写出（默认stderr）；警告以上或队列过半时立即唤醒，其余最多延迟100ms
+// 未创建实例时（基准测试、流水线启动前）日志同步格式化后直接写stderr。
+class AsyncLogger : public QThread
+{
+    Q_OBJECT
+public:
+    // path为空写stderr；rateLimit为每个日志点每秒条数上限，0表示不限流
+    AsyncLogger(const std::string &path, int rateLimit, size_t capacity = 1024, QObject *parent = nullptr);
+    ~AsyncLogger();
+
+    // 按"类别=级别"逗号分隔设置级别，"*"表示全部类别；出错时返回false并在error中给出原因
+    static bool configure(const std::string &spec, std::string &error);
+    static void setLevel(LogCategory category, LogLevel level);
+    static bool enabled(int category, int level)
+    {
+        return level >= levels[category].load(std::memory_order_relaxed);
+    }
+
+    template <typename... Args>
+    static void log(LogSite &site, const Args &... args)
+    {
+        static_assert(sizeof...(Args) <= LogEntry::kMaxArgs, "too many log arguments");
+        int64_t now;
+        uint32_t suppressed;
+        if (!admit(site, now, suppressed))
+            return;
+        // 先登记再读实例：stop()摘下实例后等登记数归零，之后不会再有生产者写环形队列
+        inFlightProducers.fetch_add(1);
+        AsyncLogger *logger = current.load();
+        if (!logger)
+            inFlightProducers.fetch_sub(1, std::memory_order_release);
+        uint64_t pos = 0;
+        LogEntry fallback;
+        LogEntry *r = logger ? logger->claim(pos) : &fallback;
+        if (!r) {
+            logger->dropped.fetch_add(1, std::memory_order_relaxed);
+            site.suppressed.fetch_add(suppressed, std::memory_order_relaxed);
+            inFlightProducers.fetch_sub(1, std::memory_order_release);
+            return;
+        }
+        r->tNs = now;
+        r->site = &site;
+        r->suppressed = suppressed;
+        LogPacker packer(r);
+        int expand[] = {0, (packer.add(args), 0)...};
+        (void)expand;
+        if (logger) {
+            logger->commit(r, pos);
+            inFlightProducers.fetch_sub(1, std::memory_order_release);
+        } else {
+            writeNow(*r);
+        }
+    }
+
+    void stop();
+    uint64_t droppedCount() const { return dropped.load(std::memory_order_relaxed); }
+    uint64_t suppressedCount() const { return suppressedTotal.load(std::memory_order_relaxed); }
+    uint64_t writtenCount() const { return written.load(std::memory_order_relaxed); }
+    // 已入队未写出的条数（两个位置分别读取，只作观测用）
+    uint64_t backlog() const
+    {
+        uint64_t out = dequeuePos.load(std::memory_order_relaxed);
+        uint64_t in = enqueuePos.load(std::memory_order_relaxed);
+        return in > out ? in - out : 0;
+    }
+    static AsyncLogger *instance() { return current.load(std::memory_order_acquire); }
+
+protected:
+    void run() override;
+
+private:
+    static bool admit(LogSite &site, int64_t &now, uint32_t &suppressed);
+    LogEntry *claim(uint64_t &pos);
+    void commit(LogEntry *r, uint64_t pos);
+    size_t drain();
+    static size_t format(const LogEntry &r, char *out, size_t cap);
+    static void writeNow(const LogEntry &r);
+
+    static std::atomic<uint8_t> levels[LogCategoryCount];
+    static std::atomic<int> rateLimit;
+    static std::atomic<AsyncLogger *> current;
+    static std::atomic<int> inFlightProducers;   // 已读到实例、尚未提交的生产者数
+
+    LogEntry *ring;
+    size_t mask;
+    std::atomic<uint64_t> enqueuePos;
+    std::atomic<uint64_t> dequeuePos;
+    int fd;
+    bool ownsFd;
+    int wakeFd;
+    std::atomic<bool> running;
+    char *outBuf;
+    size_t outCap;
+
+    std::atomic<uint64_t> dropped;
+    std::atomic<uint64_t> written;
+    static std::atomic<uint64_t> suppressedTotal;
+};
+
+// 日志宏：格式串必须是字面量（按printf约定，整数/浮点的长度修饰符可省略）；
+// 级别关闭时不求值参数
+#define LOG_AT(category, level, fmt, ...)                                   \
+    do {                                                                    \
+        if (AsyncLogger::enabled(category, level)) {                        \
+            static LogSite logSite_(fmt, category, level);                  \
+            AsyncLogger::log(logSite_, ##__VA_ARGS__);                      \
+        }                                                                   \
+    } while (0)
+
+#define LOG_DEBUG(category, fmt, ...) LOG_AT(category, LogDebug, fmt, ##__VA_ARGS__)
+#define LOG_INFO(category, fmt, ...)  LOG_AT(category, LogInfo, fmt, ##__VA_ARGS__)
+#define LOG_WARN(category, fmt, ...)  LOG_AT(category, LogWarn, fmt, ##__VA_ARGS__)
+#define LOG_ERROR(category, fmt, ...) LOG_AT(category, LogError, fmt, ##__VA_ARGS__)
+
+#endif // ASYNC_LOGGER_H
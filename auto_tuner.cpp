@@ -0,0 +1,275 @@
+#include "auto_tuner.h"
+#include "replay_source.h"
+#include "headless_runner.h"
+#include "async_logger.h"
+#include <exception>
+#include <sstream>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const int kInputSizes[] = {96, 128, 160};
+static const int kIntervals[] = {1, 2, 3, 5, 10, 15, 20};
+static const size_t kMaxFrames = 100;    // 约8秒录像，整轮扫描在i.MX6ULL上1~2分钟
+static const int kWarmupRuns = 2;
+static const int kMaxThreads = 4;
+
+AutoTuner::AutoTuner(const AppConfig &config)
+    : base(config)
+    , bestIndex(-1)
+{
+}
+
+std::string AutoTuner::describe(const InferenceConfig &config)
+{
+    std::ostringstream out;
+    out << config.backend << " 线程" << config.backendOptions.threads;
+    if (config.backend == "opencv")
+        out << (config.backendOptions.winograd ? " winograd" : " 无winograd");
+    out << " " << config.inputSize << "x" << config.inputSize << (config.letterBox ? " 补零" : " 拉伸");
+    return out.str();
+}
+
+bool AutoTuner::loadFrames(const std::string &path, std::string &error)
+{
+    frames.clear();
+    ReplaySource source(path, ReplayFast);
+    if (!source.open()) {
+        error = path + ": " + source.errorString();
+        return false;
+    }
+    CapturedFrame frame;
+    while (frames.size() < kMaxFrames && source.read(frame))
+        frames.push_back(frame.bgr);
+    if (frames.empty()) {
+        error = path + ": 转储中没有可解码的帧";
+        return false;
+    }
+    return true;
+}
+
+bool AutoTuner::runTrial(const InferenceConfig &config, std::vector<int> &classes, double &inferMs,
+                         std::string &error)
+{
+    classes.clear();
+    try {
+        Inference inference(base.modelPath, config);
+        // 界面和控制只使用最优目标，与推理线程一致走top-1路径
+        inference.setBestOnly(true);
+        if (config.backend != inference.backendName()) {
+            error = "后端不可用或加载失败";
+            return false;
+        }
+        DetectionResult result;
+        for (int i = 0; i < kWarmupRuns; ++i)
+            inference.runInference(frames[0], result);
+        int64_t totalNs = 0;
+        for (size_t i = 0; i < frames.size(); ++i) {
+            if (!inference.runInference(frames[i], result)) {
+                error = "推理失败";
+                return false;
+            }
+            totalNs += result.t_infer_end_ns - result.t_infer_start_ns;
+            const Detection *best = result.best();
+            classes.push_back(best ? best->class_id : -1);
+        }
+        inferMs = totalNs / 1e6 / frames.size();
+    } catch (const std::exception &e) {
+        // 输入尺寸与模型中固定的形状不符时，加载或前向会抛出
+        error = e.what();
+        return false;
+    }
+    return true;
+}
+
+void AutoTuner::pickInterval(Trial &trial, const std::vector<int> &classes, const std::vector<int> &reference,
+                             int accuracyPct, int captureIntervalMs)
+{
+    trial.interval = 0;
+    trial.agreement = 0.0;
+    if (classes.empty() || classes.size() != reference.size())
+        return;
+    double floor = accuracyPct / 100.0;
+    for (size_t k = 0; k < sizeof(kIntervals) / sizeof(kIntervals[0]); ++k) {
+        int interval = kIntervals[k];
+        // 单次推理超过间隔内的采集时长时，实际推理频率会低于模拟值，一致率估计偏乐观
+        if (trial.inferMs > static_cast<double>(captureIntervalMs) * interval)
+            continue;
+        int agree = 0;
+        for (size_t i = 0; i < classes.size(); ++i) {
+            if (classes[i - i % interval] == reference[i])
+                ++agree;
+        }
+        double agreement = static_cast<double>(agree) / classes.size();
+        if (agreement >= floor) {
+            trial.interval = interval;
+            trial.agreement = agreement;
+        }
+    }
+}
+
+int AutoTuner::pickBest(const std::vector<Trial> &trials)
+{
+    int bestIndex = -1;
+    for (size_t i = 0; i < trials.size(); ++i) {
+        if (trials[i].interval <= 0)
+            continue;
+        double cost = trials[i].inferMs / trials[i].interval;
+        if (bestIndex < 0 || cost < trials[bestIndex].inferMs / trials[bestIndex].interval)
+            bestIndex = static_cast<int>(i);
+    }
+    return bestIndex;
+}
+
+bool AutoTuner::run(const std::string &framesPath, std::string &error)
+{
+    results.clear();
+    bestIndex = -1;
+    if (!loadFrames(framesPath, error))
+        return false;
+
+    double referenceMs = 0.0;
+    if (!runTrial(InferenceConfig(), reference, referenceMs, error)) {
+        error = "基准配置无法运行: " + error;
+        return false;
+    }
+
+    std::vector<InferenceConfig> candidates;
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    int maxThreads = cpus < 1 ? 1 : cpus > kMaxThreads ? kMaxThreads : static_cast<int>(cpus);
+    std::stringstream names(inferenceBackendNames());
+    std::string name;
+    while (std::getline(names, name, ',')) {
+        // native单线程；Winograd只对opencv有意义
+        int threadLimit = name == "native" ? 1 : maxThreads;
+        int winogradChoices = name == "opencv" ? 2 : 1;
+        for (int threads = 1; threads <= threadLimit; ++threads) {
+            for (int w = 0; w < winogradChoices; ++w) {
+                for (size_t s = 0; s < sizeof(kInputSizes) / sizeof(kInputSizes[0]); ++s) {
+                    for (int letterBox = 1; letterBox >= 0; --letterBox) {
+                        InferenceConfig config;
+                        config.backend = name;
+                        config.backendOptions.threads = threads;
+                        config.backendOptions.winograd = w == 0;
+                        config.inputSize = kInputSizes[s];
+                        config.letterBox = letterBox != 0;
+                        candidates.push_back(config);
+                    }
+                }
+            }
+        }
+    }
+
+    for (size_t c = 0; c < candidates.size(); ++c) {
+        Trial trial;
+        trial.inference = candidates[c];
+        trial.inferMs = 0.0;
+        trial.interval = 0;
+        trial.agreement = 0.0;
+        std::vector<int> classes;
+        if (runTrial(trial.inference, classes, trial.inferMs, trial.error))
+            pickInterval(trial, classes, reference, base.tuneAccuracyPct, base.captureIntervalMs);
+        LOG_INFO(LogSystem, "调优 %d/%d: %s %.1f ms 间隔%d 一致率%.1f%% %s", static_cast<int>(c + 1),
+                 static_cast<int>(candidates.size()), describe(trial.inference), trial.inferMs, trial.interval,
+                 trial.agreement * 100.0, trial.error);
+        results.push_back(trial);
+    }
+    bestIndex = pickBest(results);
+    return true;
+}
+
+bool AutoTuner::best(AppConfig &tuned) const
+{
+    if (bestIndex < 0)
+        return false;
+    const Trial &trial = results[bestIndex];
+    tuned = base;
+    tuned.inferenceBackend = trial.inference.backend;
+    tuned.inferenceThreads = trial.inference.backendOptions.threads;
+    tuned.winograd = trial.inference.backendOptions.winograd;
+    tuned.inputSize = trial.inference.inputSize;
+    tuned.letterBox = trial.inference.letterBox;
+    tuned.inferenceInterval = trial.interval;
+    return true;
+}
+
+// 扫描并写调优文件；saveOnFailure时没有可用结果也把当前配置写进去（首次启动不再重跑）
+static bool tuneAndSave(const AppConfig &config, const std::string &framesPath, bool printTable, bool saveOnFailure)
+{
+    AutoTuner tuner(config);
+    std::string error;
+    bool ok = tuner.run(framesPath, error);
+    if (!ok)
+        LOG_ERROR(LogSystem, "自动调优失败: %s", error);
+
+    if (ok && printTable) {
+        printf("%-40s %10s %6s %8s  %s\n", "配置", "推理(ms)", "间隔", "一致率", "备注");
+        for (size_t i = 0; i < tuner.trials().size(); ++i) {
+            const AutoTuner::Trial &t = tuner.trials()[i];
+            printf("%-40s %10.1f %6d %7.1f%%  %s\n", AutoTuner::describe(t.inference).c_str(), t.inferMs,
+                   t.interval, t.agreement * 100.0,
+                   !t.error.empty() ? t.error.c_str() : t.interval == 0 ? "低于精度下限或跟不上采集" : "");
+        }
+        printf("共%d帧，精度下限%d%%，采集间隔%d ms\n", tuner.frameCount(), config.tuneAccuracyPct,
+               config.captureIntervalMs);
+    }
+
+    AppConfig tuned = config;
+    if (ok && !tuner.best(tuned)) {
+        LOG_ERROR(LogSystem, "自动调优：没有组合满足精度下限%d%%", config.tuneAccuracyPct);
+        ok = false;
+    }
+    if (!ok && !saveOnFailure)
+        return false;
+    if (config.tuningPath.empty()) {
+        LOG_WARN(LogSystem, "未设置调优文件（WHEELCHAIR_TUNING=off），调优结果不保存");
+        return false;
+    }
+    if (!tuned.saveTuning(config.tuningPath, error)) {
+        LOG_ERROR(LogSystem, "%s", error);
+        return false;
+    }
+    if (ok) {
+        InferenceConfig chosen;
+        chosen.backend = tuned.inferenceBackend;
+        chosen.backendOptions.threads = tuned.inferenceThreads;
+        chosen.backendOptions.winograd = tuned.winograd;
+        chosen.inputSize = tuned.inputSize;
+        chosen.letterBox = tuned.letterBox;
+        LOG_INFO(LogSystem, "自动调优完成：%s，每%d帧推理一次，已写入%s", AutoTuner::describe(chosen),
+                 tuned.inferenceInterval, config.tuningPath);
+    }
+    return ok;
+}
+
+int runAutoTune(const AppConfig &config)
+{
+    AsyncLogger logger(config.logPath, config.logRateLimit);
+    std::string logError;
+    AsyncLogger::configure(config.logLevels, logError);
+    logger.start();
+    bool ok = tuneAndSave(config, config.tuneFramesPath, true, false);
+    logger.stop();
+    return ok ? 0 : 1;
+}
+
+void tuneOnFirstBoot(int argc, char *argv[], AppConfig &config)
+{
+    // 回放需要确定性，不在回放前改配置
+    if (config.tuningPath.empty() || config.firstBootFramesPath.empty() || !config.replayPath.empty())
+        return;
+    struct stat st;
+    if (stat(config.tuningPath.c_str(), &st) == 0 || stat(config.firstBootFramesPath.c_str(), &st) != 0)
+        return;
+
+    AsyncLogger logger(config.logPath, config.logRateLimit);
+    std::string logError;
+    AsyncLogger::configure(config.logLevels, logError);
+    logger.start();
+    LOG_INFO(LogSystem, "首次启动：在%s上自动调优推理配置", config.firstBootFramesPath);
+    tuneAndSave(config, config.firstBootFramesPath, false, true);
+    logger.stop();
+
+    config = AppConfig::fromEnvironment();
+    parseCommandLine(argc, argv, config);
+}
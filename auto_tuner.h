@@ -0,0 +1,61 @@
+#ifndef AUTO_TUNER_H
+#define AUTO_TUNER_H
+
+#include <string>
+#include <vector>
+#include <opencv2/core.hpp>
+#include "app_config.h"
+#include "inference.h"
+
+// 按板子自动调优推理配置（后端、线程数、Winograd、输入尺寸、补零、推理间隔）。
+// 在录制的帧（黑匣子转储）上把每个候选组合逐帧跑一遍，以原有硬编码配置（opencv单线程、128、补零、逐帧推理）
+// 的姿态类别为基准：与基准逐帧一致的比例不低于下限、且单次推理跟得上采集节拍的组合中，
+// 取每个采集帧摊到的推理耗时（单次耗时/推理间隔）最小的一个。
+// 推理间隔不重新推理，按"结果保持到下一次推理"在逐帧结果上模拟（不计跟踪丢失触发的额外推理）。
+class AutoTuner
+{
+public:
+    struct Trial
+    {
+        InferenceConfig inference;
+        std::string error;        // 非空表示该组合不可用（后端未编译进来、加载或推理失败）
+        double inferMs;           // 单次推理耗时均值（含前后处理）
+        int interval;             // 满足精度下限与采集节拍的最大推理间隔，0表示都不满足
+        double agreement;         // 该间隔下与基准的逐帧一致率
+    };
+
+    explicit AutoTuner(const AppConfig &config);
+
+    // 读入转储中的帧并扫描全部组合；帧读不出来或基准配置本身跑不通时返回false
+    bool run(const std::string &framesPath, std::string &error);
+    int frameCount() const { return static_cast<int>(frames.size()); }
+    const std::vector<Trial> &trials() const { return results; }
+    // 在构造时的配置上替换为选中的推理配置；没有组合满足约束时返回false
+    bool best(AppConfig &tuned) const;
+
+    static std::string describe(const InferenceConfig &config);
+    // 选择规则，与扫描分开便于单独验证：
+    // 在逐帧类别上取满足精度下限（百分比）且跟得上采集节拍的最大推理间隔，写入trial.interval/agreement
+    static void pickInterval(Trial &trial, const std::vector<int> &classes, const std::vector<int> &reference,
+                             int accuracyPct, int captureIntervalMs);
+    // 可用组合中每帧摊到的推理耗时最小者的下标，耗时相同取先出现的；都不可用时返回-1
+    static int pickBest(const std::vector<Trial> &trials);
+
+private:
+    bool loadFrames(const std::string &path, std::string &error);
+    bool runTrial(const InferenceConfig &config, std::vector<int> &classes, double &inferMs, std::string &error);
+
+    AppConfig base;
+    std::vector<cv::Mat> frames;
+    std::vector<int> reference;   // 基准配置逐帧的最优类别（-1表示未检出）
+    std::vector<Trial> results;
+    int bestIndex;
+};
+
+// --tune入口：扫描、打印各组合结果并写入调优文件，返回进程退出码
+int runAutoTune(const AppConfig &config);
+// 首次启动：调优文件不存在且有调优用的转储时先调优一次，再按新的调优文件重新读取配置（环境变量与命令行仍优先）。
+// 调优失败时也写入当前配置，避免每次启动都重跑（删除调优文件或用--tune可重新调优）
+void tuneOnFirstBoot(int argc, char *argv[], AppConfig &config);
+
+#endif // AUTO_TUNER_H
@@ -0,0 +1,612 @@
+// 热点函数微基准
+//
+// 逐帧路径上的每个热点函数单独计时，便于在板子上对比优化前后：
+//   ./wheelchair_bench                      全部用例（合成输入，不需要模型和摄像头）
+//   ./wheelchair_bench --filter decode      只跑名字包含decode的用例
+//   ./wheelchair_bench --model /root/last.onnx   额外跑一次完整runInference
+//   ./wheelchair_bench --model /root/last.onnx --backends opencv,native,ort,tflite --filter runInference
+//                                           同一模型、同一帧对比各推理后端的延迟/启动耗时/RSS
+//                                           （RSS按加载前后差值估算，要干净的数字就每个后端单独跑一次）
+//   ./wheelchair_bench --model /root/last.onnx --gate /root/gate.onnx --frames /root/flight/xxx.bin
+//                                           两级级联对比：同一组帧（黑匣子转储，未给出时用合成帧）分别只跑完整模型
+//                                           与跑级联，报告平均耗时降低、门控采用率与不一致率
+//   ./wheelchair_bench --model /root/last.onnx --face-model /root/pose_cls.onnx --frames /root/flight/xxx.bin
+//                                           face引擎对比：同一组帧分别走YOLO与LBP人脸定位+姿态分类器，
+//                                           报告两者的耗时、检出率，以及以YOLO为参照的姿态一致率
+//   ./wheelchair_bench --uart /dev/ttymxc5  uart_send_char改测真实串口（默认测pty）
+//   ./wheelchair_bench --model /root/last.onnx --compare-native 1e-3
+//                                           native后端正确性检查：同一帧逐层对比cv::dnn，
+//                                           误差超过容差（相对该层输出幅值）时报告第一个出错的层并返回1
+//
+// 每个用例先预热一批，再测rounds批，每批batch次调用，报告每次调用耗时的中位数/最小值/p90。
+// 输入用固定种子生成，同一台机器上多次运行可直接比较。
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <opencv2/core.hpp>
+#include "inference.h"
+#include "native_model.h"
+#include "replay_source.h"
+#include "uart_master.h"
+#include "pipeline_clock.h"
+#include "async_logger.h"
+#include "resource_usage.h"
+
+struct BenchOptions
+{
+    int rounds {50};
+    const char *filter {nullptr};
+    const char *modelPath {nullptr};
+    const char *uartPath {nullptr};
+    const char *backends {"opencv"};
+    const char *gatePath {nullptr};     // 级联门控模型
+    const char *framesPath {nullptr};   // 级联/face引擎对比用的黑匣子转储
+    const char *faceModelPath {nullptr};
+    const char *faceCascadePath {nullptr};
+    double compareTolerance {0.0};   // >0时只做native与cv::dnn的逐层对比
+    cv::Size frameSize {MODEL_INPUT_SIZE, MODEL_INPUT_SIZE * 3 / 4};   // 与摄像头采集尺寸一致
+};
+
+static BenchOptions options;
+static volatile float sink;   // 防止被测调用被优化掉
+
+static void noop() {}
+
+template <typename F, typename G>
+static void benchWith(const char *name, int batch, F fn, G afterBatch)
+{
+    if (options.filter && !strstr(name, options.filter))
+        return;
+
+    for (int i = 0; i < batch; ++i)
+        fn();
+    afterBatch();
+
+    std::vector<double> perCall(options.rounds);
+    for (int r = 0; r < options.rounds; ++r) {
+        int64_t t0 = monotonicNowNs();
+        for (int i = 0; i < batch; ++i)
+            fn();
+        int64_t t1 = monotonicNowNs();
+        perCall[r] = double(t1 - t0) / batch;
+        afterBatch();
+    }
+    std::sort(perCall.begin(), perCall.end());
+    printf("%-28s %12.1f %12.1f %12.1f   %dx%d\n", name,
+           perCall[perCall.size() / 2], perCall[0], perCall[perCall.size() * 9 / 10],
+           options.rounds, batch);
+    fflush(stdout);
+}
+
+template <typename F>
+static void bench(const char *name, int batch, F fn)
+{
+    benchWith(name, batch, fn, noop);
+}
+
+// 合成网络输出：rows个候选，每个4个框坐标（模型输入坐标系）+ [obj] + NUM_CLASSES个类别logit。
+// 约5%的候选分数过阈值，且集中在少数几个位置附近（接近真实头部检测的重叠框）。
+static cv::Mat makeOutput(int rows, bool yolov8)
+{
+    int dims = 4 + (yolov8 ? 0 : 1) + NUM_CLASSES;
+    cv::RNG rng(12345);
+    cv::Mat rowMajor(rows, dims, CV_32F);
+    for (int i = 0; i < rows; ++i) {
+        float *p = rowMajor.ptr<float>(i);
+        bool hit = rng.uniform(0.0, 1.0) < 0.05;
+        int cluster = rng.uniform(0, 3);
+        p[0] = hit ? 32.0f + cluster * 32.0f + rng.uniform(-3.0f, 3.0f) : rng.uniform(0.0f, float(MODEL_INPUT_SIZE));
+        p[1] = hit ? 48.0f + rng.uniform(-3.0f, 3.0f) : rng.uniform(0.0f, float(MODEL_INPUT_SIZE));
+        p[2] = rng.uniform(20.0f, 40.0f);
+        p[3] = rng.uniform(20.0f, 40.0f);
+        int c = 4;
+        if (!yolov8)
+            p[c++] = hit ? rng.uniform(1.0f, 4.0f) : rng.uniform(-8.0f, -2.0f);
+        int cls = rng.uniform(0, NUM_CLASSES);
+        for (int k = 0; k < NUM_CLASSES; ++k)
+            p[c + k] = (hit && k == cls) ? rng.uniform(1.0f, 4.0f) : rng.uniform(-8.0f, -2.0f);
+    }
+
+    // 网络输出为[1, rows, dims]（YOLOv5）或[1, dims, rows]（YOLOv8）
+    if (yolov8) {
+        cv::Mat t;
+        cv::transpose(rowMajor, t);
+        int shape[3] = {1, dims, rows};
+        return t.reshape(1, 3, shape).clone();
+    }
+    int shape[3] = {1, rows, dims};
+    return rowMajor.reshape(1, 3, shape).clone();
+}
+
+static void benchPreprocess()
+{
+    cv::Mat frame(options.frameSize, CV_8UC3);
+    cv::randu(frame, cv::Scalar::all(0), cv::Scalar::all(255));
+    cv::Size modelShape(MODEL_INPUT_SIZE, MODEL_INPUT_SIZE);
+
+    bench("formatToSquare", 200, [&]() {
+        cv::Mat square = formatToSquare(frame);
+        sink = square.data[0];
+    });
+
+    cv::Mat square = formatToSquare(frame);
+    cv::Mat blob;
+    bench("makeInputBlob", 200, [&]() {
+        makeInputBlob(square, modelShape, blob);
+        sink = blob.ptr<float>()[0];
+    });
+}
+
+static void benchPostprocess()
+{
+    // 128输入：YOLOv8/11为3个尺度共16²+8²+4²=336个候选，YOLOv5每个位置3个锚框
+    const int anchorFree = (MODEL_INPUT_SIZE / 8) * (MODEL_INPUT_SIZE / 8)
+                         + (MODEL_INPUT_SIZE / 16) * (MODEL_INPUT_SIZE / 16)
+                         + (MODEL_INPUT_SIZE / 32) * (MODEL_INPUT_SIZE / 32);
+    cv::Mat v8 = makeOutput(anchorFree, true);
+    cv::Mat v5 = makeOutput(anchorFree * 3, false);
+    cv::Size inputSize(MODEL_INPUT_SIZE, MODEL_INPUT_SIZE);
+    cv::Size2f modelShape(MODEL_INPUT_SIZE, MODEL_INPUT_SIZE);
+    YoloThresholds thresholds;
+    cv::Mat transposed;
+    YoloCandidates candidates;
+
+    bench("decode (v8 layout)", 200, [&]() {
+        decodeYoloOutput(v8, inputSize, modelShape, thresholds, false, transposed, candidates);
+        sink = candidates.size();
+    });
+    bench("decode (v8 layout, best)", 200, [&]() {
+        decodeYoloOutput(v8, inputSize, modelShape, thresholds, true, transposed, candidates);
+        sink = candidates.size();
+    });
+    bench("decode (v5 layout)", 200, [&]() {
+        decodeYoloOutput(v5, inputSize, modelShape, thresholds, false, transposed, candidates);
+        sink = candidates.size();
+    });
+
+    decodeYoloOutput(v8, inputSize, modelShape, thresholds, false, transposed, candidates);
+    std::vector<int> keep;
+    DetectionResult result;
+    char name[64];
+    snprintf(name, sizeof(name), "nms (%d candidates)", candidates.size());
+    bench(name, 200, [&]() {
+        selectDetections(candidates, thresholds, keep, result);
+        sink = result.count;
+    });
+
+    std::vector<float> logits(1024);
+    cv::RNG rng(54321);
+    for (size_t i = 0; i < logits.size(); ++i)
+        logits[i] = rng.uniform(-8.0f, 8.0f);
+    size_t next = 0;
+    bench("sigmoid", 100000, [&]() {
+        sink = yoloSigmoid(logits[next]);
+        next = (next + 1) & 1023;
+    });
+}
+
+// 各后端依次加载同一模型、推理同一帧：启动耗时为构造Inference（读模型+初始化后端）的时间
+static void benchInference()
+{
+    if (!options.modelPath)
+        return;
+    cv::Mat frame(options.frameSize, CV_8UC3);
+    cv::randu(frame, cv::Scalar::all(0), cv::Scalar::all(255));
+
+    struct Row
+    {
+        std::string backend;
+        double startupMs;
+        double loadRssMb;
+        double peakRssMb;
+        int count;
+        int classId;
+        float confidence;
+    };
+    std::vector<Row> rows;
+    std::string list = options.backends;
+    size_t begin = 0;
+    while (begin <= list.size()) {
+        size_t end = list.find(',', begin);
+        if (end == std::string::npos)
+            end = list.size();
+        std::string backend = list.substr(begin, end - begin);
+        begin = end + 1;
+        std::string name = "runInference [" + backend + "]";
+        if (backend.empty() || (options.filter && !strstr(name.c_str(), options.filter)))
+            continue;
+
+        long rssBefore, peakBefore, rssAfter, peakAfter;
+        ResourceUsage::readMemoryKb(rssBefore, peakBefore);
+        int64_t t0 = monotonicNowNs();
+        Inference inf(options.modelPath, cv::Size(MODEL_INPUT_SIZE, MODEL_INPUT_SIZE), "", false, backend);
+        int64_t t1 = monotonicNowNs();
+        ResourceUsage::readMemoryKb(rssAfter, peakAfter);
+        if (backend != inf.backendName()) {
+            fprintf(stderr, "后端%s不可用，跳过（已编译：%s）\n", backend.c_str(), inferenceBackendNames());
+            continue;
+        }
+
+        DetectionResult result;
+        bench(name.c_str(), 5, [&]() {
+            inf.runInference(frame, result);
+            sink = result.count;
+        });
+        long rssEnd, peakEnd;
+        ResourceUsage::readMemoryKb(rssEnd, peakEnd);
+
+        Row row;
+        row.backend = backend;
+        row.startupMs = (t1 - t0) / 1e6;
+        row.loadRssMb = (rssEnd - rssBefore) / 1024.0;
+        row.peakRssMb = peakEnd / 1024.0;
+        row.count = result.count;
+        row.classId = result.count > 0 ? result.detections[0].class_id : -1;
+        row.confidence = result.count > 0 ? result.detections[0].confidence : 0.0f;
+        rows.push_back(row);
+    }
+
+    // 同一帧各后端的最优结果应一致（合成帧上通常没有目标，只比较数量也能发现布局/预处理错误）
+    if (!rows.empty()) {
+        printf("\n%-10s %12s %14s %14s   %s\n", "后端", "启动(ms)", "RSS增量(MB)", "峰值RSS(MB)", "结果");
+        for (size_t i = 0; i < rows.size(); ++i) {
+            const Row &r = rows[i];
+            printf("%-10s %12.1f %14.1f %14.1f   %d个 %s %.3f\n", r.backend.c_str(), r.startupMs, r.loadRssMb,
+                   r.peakRssMb, r.count, Inference::getClassName(r.classId), r.confidence);
+        }
+        printf("\n");
+    }
+}
+
+// 级联/face引擎对比用的帧：黑匣子转储里的前若干帧（真实画面才有意义的采用率/不一致率），否则一张合成帧
+static std::vector<cv::Mat> loadFrames(size_t maxFrames)
+{
+    std::vector<cv::Mat> frames;
+    if (options.framesPath) {
+        ReplaySource source(options.framesPath, ReplayFast);
+        if (!source.open()) {
+            fprintf(stderr, "%s: %s\n", options.framesPath, source.errorString().c_str());
+        } else {
+            CapturedFrame frame;
+            while (frames.size() < maxFrames && source.read(frame))
+                frames.push_back(frame.bgr);
+        }
+    }
+    if (frames.empty()) {
+        cv::Mat frame(options.frameSize, CV_8UC3);
+        cv::randu(frame, cv::Scalar::all(0), cv::Scalar::all(255));
+        frames.push_back(frame);
+    }
+    return frames;
+}
+
+// 两级级联：抽查间隔设为1，每次采用门控结果都同时跑完整模型，不一致率是精确值（抽查耗时不计入级联耗时）
+static void benchCascade()
+{
+    if (!options.modelPath || !options.gatePath || (options.filter && !strstr("runInference [cascade]", options.filter)))
+        return;
+    std::vector<cv::Mat> frames = loadFrames(200);
+    int passes = std::max(1, options.rounds / static_cast<int>(frames.size()));
+
+    InferenceConfig fullConfig;
+    Inference full(options.modelPath, fullConfig);
+    full.setBestOnly(true);
+    DetectionResult result;
+    full.runInference(frames[0], result);
+    int64_t fullNs = 0;
+    for (int p = 0; p < passes; ++p) {
+        for (size_t i = 0; i < frames.size(); ++i) {
+            full.runInference(frames[i], result);
+            fullNs += result.t_infer_end_ns - result.t_infer_start_ns;
+        }
+    }
+    double fullMs = fullNs / 1e6 / (passes * frames.size());
+
+    InferenceConfig cascadeConfig;
+    cascadeConfig.gateModelPath = options.gatePath;
+    cascadeConfig.gateAuditInterval = 1;
+    Inference cascade(options.modelPath, cascadeConfig);
+    if (!cascade.isCascade()) {
+        fprintf(stderr, "门控模型%s加载失败，跳过级联对比\n", options.gatePath);
+        return;
+    }
+    cascade.setBestOnly(true);
+    for (int p = 0; p < passes; ++p) {
+        for (size_t i = 0; i < frames.size(); ++i)
+            cascade.runInference(frames[i], result);
+    }
+    CascadeStats cs = cascade.cascadeStats();
+    printf("\n级联（%d帧x%d遍，门控%dx%d，类别间隔≥%.2f）\n", static_cast<int>(frames.size()), passes,
+           cascadeConfig.gateInputSize, cascadeConfig.gateInputSize, cascadeConfig.gateMargin);
+    printf("  只跑完整模型 %.2f ms/帧 | 级联 %.2f ms/帧（门控 %.2f ms） | 降低 %.1f%%\n", fullMs, cs.averageMs(),
+           cs.frames ? cs.gateNs / 1e6 / cs.frames : 0.0, fullMs > 0.0 ? 100.0 * (1.0 - cs.averageMs() / fullMs) : 0.0);
+    printf("  门控采用 %.1f%% | 与完整模型不一致 %.1f%%（%d/%d）\n", cs.frames ? 100.0 * cs.accepted / cs.frames : 0.0,
+           100.0 * cs.disagreementRate(), static_cast<int>(cs.disagreed), static_cast<int>(cs.audited));
+    if (!options.framesPath)
+        printf("  （合成帧：采用率/不一致率没有参考意义，请用--frames指定真实录像）\n");
+}
+
+// face引擎与YOLO逐帧对比：没有人工标注，以YOLO的最优类别（含未检出）为参照统计一致率
+static void benchFaceEngine()
+{
+    if (!options.modelPath || !options.faceModelPath || (options.filter && !strstr("runInference [face]", options.filter)))
+        return;
+    std::vector<cv::Mat> frames = loadFrames(200);
+    int passes = std::max(1, options.rounds / static_cast<int>(frames.size()));
+
+    InferenceConfig faceConfig;
+    faceConfig.engine = "face";
+    faceConfig.faceModelPath = options.faceModelPath;
+    if (options.faceCascadePath)
+        faceConfig.faceCascadePath = options.faceCascadePath;
+    Inference face(options.modelPath, faceConfig);
+    if (!face.isFaceEngine()) {
+        fprintf(stderr, "face引擎加载失败（分类器%s），跳过对比\n", options.faceModelPath);
+        return;
+    }
+    Inference yolo(options.modelPath, InferenceConfig());
+    yolo.setBestOnly(true);
+
+    DetectionResult yoloResult, faceResult;
+    yolo.runInference(frames[0], yoloResult);
+    face.runInference(frames[0], faceResult);
+    int64_t yoloNs = 0, faceNs = 0;
+    int yoloFound = 0, faceFound = 0, agree = 0, total = 0;
+    for (int p = 0; p < passes; ++p) {
+        for (size_t i = 0; i < frames.size(); ++i, ++total) {
+            yolo.runInference(frames[i], yoloResult);
+            face.runInference(frames[i], faceResult);
+            yoloNs += yoloResult.t_infer_end_ns - yoloResult.t_infer_start_ns;
+            faceNs += faceResult.t_infer_end_ns - faceResult.t_infer_start_ns;
+            int yoloClass = yoloResult.count > 0 ? yoloResult.detections[0].class_id : -1;
+            int faceClass = faceResult.count > 0 ? faceResult.detections[0].class_id : -1;
+            yoloFound += yoloClass >= 0;
+            faceFound += faceClass >= 0;
+            agree += yoloClass == faceClass;
+        }
+    }
+    printf("\nface引擎 vs YOLO（%d帧x%d遍，分类器输入%dx%d）\n", static_cast<int>(frames.size()), passes,
+           faceConfig.faceInputSize, faceConfig.faceInputSize);
+    printf("  YOLO %.2f ms/帧 检出%.1f%% | face %.2f ms/帧 检出%.1f%% | 耗时降低 %.1f%%\n", yoloNs / 1e6 / total,
+           100.0 * yoloFound / total, faceNs / 1e6 / total, 100.0 * faceFound / total,
+           yoloNs > 0 ? 100.0 * (1.0 - double(faceNs) / yoloNs) : 0.0);
+    printf("  与YOLO姿态一致 %.1f%%（含双方都未检出）\n", 100.0 * agree / total);
+    if (!options.framesPath)
+        printf("  （合成帧：检出率/一致率没有参考意义，请用--frames指定真实录像）\n");
+}
+
+// native后端逐层对比：native保留全部中间结果跑一帧，cv::dnn对同一输入取出同名层的输出逐个比较。
+// 层名按cv::dnn的ONNX导入规则（4.6起为"onnx_node!节点名"，之前为节点名/输出名）依次尝试；
+// cv::dnn导入时自己折叠/融合掉、找不到同名层的算子跳过，不算失败
+static int compareNative()
+{
+    if (!options.modelPath) {
+        fprintf(stderr, "--compare-native需要--model\n");
+        return 2;
+    }
+    cv::Size shape(MODEL_INPUT_SIZE, MODEL_INPUT_SIZE);
+    cv::Mat frame(options.frameSize, CV_8UC3);
+    cv::RNG rng(12345);
+    rng.fill(frame, cv::RNG::UNIFORM, 0, 255);
+    cv::Mat blob;
+    makeInputBlob(formatToSquare(frame), shape, blob);
+
+    NativeModel model;
+    std::string error;
+    if (!model.load(options.modelPath, shape, true, error)) {
+        fprintf(stderr, "native模型加载失败: %s\n", error.c_str());
+        return 1;
+    }
+    model.run(blob.ptr<float>());
+
+    cv::dnn::Net net = cv::dnn::readNetFromONNX(options.modelPath);
+    net.setPreferableBackend(cv::dnn::DNN_BACKEND_OPENCV);
+    net.setPreferableTarget(cv::dnn::DNN_TARGET_CPU);
+
+    std::vector<int> opIndex;
+    std::vector<cv::String> layerNames;
+    for (int i = 0; i < model.opCount(); ++i) {
+        const NativeOpDesc &op = model.op(i);
+        std::string node = model.name(op.nameOffset);
+        std::string output = model.name(model.tensorDesc(op.outputs[0]).nameOffset);
+        std::string candidates[4] = {"onnx_node!" + node, node, "onnx_node_output_0!" + output, output};
+        for (int k = 0; k < 4; ++k) {
+            if (candidates[k] != "onnx_node!" && !candidates[k].empty() && net.getLayerId(candidates[k]) >= 0) {
+                opIndex.push_back(i);
+                layerNames.push_back(candidates[k]);
+                break;
+            }
+        }
+    }
+    if (layerNames.empty()) {
+        fprintf(stderr, "cv::dnn中找不到任何对应的层\n");
+        return 1;
+    }
+    net.setInput(blob);
+    std::vector<cv::Mat> refs;
+    net.forward(refs, layerNames);
+
+    printf("%-4s %-14s %-32s %10s %12s %12s\n", "#", "算子", "ONNX节点", "元素数", "最大绝对误差", "相对误差");
+    int failures = 0;
+    int firstFailure = -1;
+    for (size_t k = 0; k < layerNames.size(); ++k) {
+        const NativeOpDesc &op = model.op(opIndex[k]);
+        cv::Mat got = model.tensor(op.outputs[0]);
+        const cv::Mat &ref = refs[k];
+        bool ok = got.total() == ref.total() && ref.type() == CV_32F && ref.isContinuous();
+        double maxAbs = 0.0, maxRef = 0.0;
+        if (ok) {
+            const float *a = got.ptr<float>();
+            const float *b = ref.ptr<float>();
+            for (size_t i = 0; i < ref.total(); ++i) {
+                maxAbs = std::max(maxAbs, double(fabsf(a[i] - b[i])));
+                maxRef = std::max(maxRef, double(fabsf(b[i])));
+            }
+        }
+        double rel = maxAbs / std::max(1.0, maxRef);
+        ok = ok && rel <= options.compareTolerance;
+        if (!ok) {
+            ++failures;
+            if (firstFailure < 0)
+                firstFailure = static_cast<int>(k);
+        }
+        printf("%-4d %-14s %-32s %10d %12.3g %12.3g %s\n", opIndex[k], NativeModel::opTypeName(op.type),
+               model.name(op.nameOffset), static_cast<int>(got.total()), maxAbs, rel,
+               ok ? "" : got.total() == ref.total() ? "超出容差" : "形状不符");
+    }
+
+    printf("\n对比%d层（native共%d个算子，其余在cv::dnn中无同名层），失败%d层\n",
+           static_cast<int>(layerNames.size()), model.opCount(), failures);
+    if (firstFailure >= 0) {
+        const NativeOpDesc &op = model.op(opIndex[firstFailure]);
+        printf("第一个出错的层: #%d %s（%s）\n", opIndex[firstFailure], model.name(op.nameOffset),
+               NativeModel::opTypeName(op.type));
+    }
+    return failures ? 1 : 0;
+}
+
+// 日志点开销：级别关闭时只有一次原子读；开启时为限流判断+入队（格式化与写出在日志线程）
+static void benchLog()
+{
+    AsyncLogger::setLevel(LogStats, LogInfo);
+    int i = 0;
+    bench("log (disabled site)", 100000, [&]() {
+        LOG_DEBUG(LogStats, "bench %d %.2f", i, 1.5);
+        ++i;
+    });
+
+    // 批量等于队列一半：每批最后一条唤醒日志线程，批间等它写完，队列不会满
+    AsyncLogger logger("/dev/null", 0, 1024);
+    logger.start();
+    uint64_t expected = 0;
+    benchWith("log (enabled, async)", 512, [&]() {
+        LOG_INFO(LogStats, "bench %d %.2f %s", i, 1.5, "text");
+        ++i;
+    }, [&]() {
+        expected += 512;
+        while (logger.writtenCount() + logger.droppedCount() < expected)
+            usleep(100);
+    });
+    logger.stop();
+}
+
+// uart_send_char：write + tcdrain。默认在pty上测（主机上可跑，只含系统调用与tty层开销），
+// --uart指定真实串口时包含115200波特率下的发送时间（约87us/字节）
+static void benchUart()
+{
+    int master = -1;
+    std::string path;
+    if (options.uartPath) {
+        path = options.uartPath;
+    } else {
+        master = posix_openpt(O_RDWR | O_NOCTTY | O_CLOEXEC);
+        if (master < 0 || grantpt(master) < 0 || unlockpt(master) < 0) {
+            fprintf(stderr, "伪终端创建失败: %s\n", strerror(errno));
+            if (master >= 0)
+                close(master);
+            return;
+        }
+        path = ptsname(master);
+        fcntl(master, F_SETFL, fcntl(master, F_GETFL) | O_NONBLOCK);
+    }
+
+    int fd = uart_init(path.c_str());
+    if (fd < 0) {
+        if (master >= 0)
+            close(master);
+        return;
+    }
+
+    // 每批读空主端，避免pty缓冲写满后write阻塞/失败
+    char buf[4096];
+    benchWith(options.uartPath ? "uart_send_char (tty)" : "uart_send_char (pty)", 64, [&]() {
+        uart_send_char(fd, 'S');
+    }, [&]() {
+        if (master >= 0) {
+            while (read(master, buf, sizeof(buf)) > 0) {
+            }
+        }
+    });
+
+    uart_close(fd);
+    if (master >= 0)
+        close(master);
+}
+
+static void usage(const char *argv0)
+{
+    fprintf(stderr, "用法: %s [--rounds N] [--filter 子串] [--frame WxH] [--model onnx] [--backends opencv,native,ort,tflite]"
+            " [--gate 门控onnx] [--face-model 姿态分类onnx] [--face-cascade xml] [--frames 黑匣子转储]"
+            " [--compare-native 容差] [--uart 串口]\n", argv0);
+}
+
+int main(int argc, char *argv[])
+{
+    for (int i = 1; i < argc; ++i) {
+        const char *arg = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (!value) {
+            usage(argv[0]);
+            return 2;
+        }
+        if (strcmp(arg, "--rounds") == 0) {
+            options.rounds = std::max(1, atoi(value));
+        } else if (strcmp(arg, "--filter") == 0) {
+            options.filter = value;
+        } else if (strcmp(arg, "--frame") == 0) {
+            int w = 0, h = 0;
+            if (sscanf(value, "%dx%d", &w, &h) != 2 || w <= 0 || h <= 0) {
+                usage(argv[0]);
+                return 2;
+            }
+            options.frameSize = cv::Size(w, h);
+        } else if (strcmp(arg, "--model") == 0) {
+            options.modelPath = value;
+        } else if (strcmp(arg, "--backends") == 0) {
+            options.backends = value;
+        } else if (strcmp(arg, "--gate") == 0) {
+            options.gatePath = value;
+        } else if (strcmp(arg, "--face-model") == 0) {
+            options.faceModelPath = value;
+        } else if (strcmp(arg, "--face-cascade") == 0) {
+            options.faceCascadePath = value;
+        } else if (strcmp(arg, "--frames") == 0) {
+            options.framesPath = value;
+        } else if (strcmp(arg, "--compare-native") == 0) {
+            options.compareTolerance = atof(value);
+            if (options.compareTolerance <= 0.0) {
+                usage(argv[0]);
+                return 2;
+            }
+        } else if (strcmp(arg, "--uart") == 0) {
+            options.uartPath = value;
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+        ++i;
+    }
+
+    // 与推理线程一致：OpenCV单线程
+    cv::setNumThreads(1);
+    if (options.compareTolerance > 0.0)
+        return compareNative();
+    printf("帧 %dx%d，模型输入 %dx%d\n", options.frameSize.width, options.frameSize.height,
+           MODEL_INPUT_SIZE, MODEL_INPUT_SIZE);
+    printf("%-28s %12s %12s %12s   %s\n", "用例", "中位(ns)", "最小(ns)", "p90(ns)", "轮数x批量");
+
+    benchPreprocess();
+    benchPostprocess();
+    benchInference();
+    benchLog();
+    benchUart();
+    benchCascade();
+    benchFaceEngine();
+    return 0;
+}
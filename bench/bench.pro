@@ -0,0 +1,13 @@
+# 热点函数微基准：letterBox、blob生成、输出解码、NMS、sigmoid、日志点、经pty的uart_send_char、各推理后端对比、两级级联对比、face引擎与YOLO对比
+QT       = core
+
+CONFIG   += console c++11 release
+CONFIG   -= app_bundle debug
+
+TARGET = wheelchair_bench
+TEMPLATE = app
+
+include(../core.pri)
+include(../opencv.pri)
+
+SOURCES += bench.cpp
@@ -0,0 +1,85 @@
+#include "command_arbiter.h"
+
+CommandArbiter::CommandArbiter(int64_t holdNs, int confirmFrames)
+    : holdNs(holdNs)
+    , confirmFrames(confirmFrames < 1 ? 1 : confirmFrames)
+    , currentMode(ModeAuto)
+    , holdUntilNs(0)
+    , lastManualNs(0)
+    , confirmCmd(0)
+    , confirmCount(0)
+    , cancelled(0)
+{
+}
+
+char CommandArbiter::onManual(char cmd, int64_t nowNs)
+{
+    lastManualNs = nowNs;
+    confirmCount = 0;
+    if (cmd == 'S') {
+        currentMode = ModeStopped;
+    } else {
+        currentMode = ModeManualHold;
+        holdUntilNs = nowNs + holdNs;
+    }
+    return cmd;
+}
+
+char CommandArbiter::onAuto(char cmd, int64_t captureNs, int64_t nowNs)
+{
+    // 手动指令之前采集的帧得出的结果已过期
+    if (captureNs < lastManualNs) {
+        cancelled++;
+        return 0;
+    }
+
+    switch (currentMode) {
+    case ModeStopped:
+        cancelled++;
+        return 0;
+    case ModeManualHold:
+        if (nowNs < holdUntilNs) {
+            cancelled++;
+            return 0;
+        }
+        currentMode = ModeAwaitConfirm;
+        confirmCount = 0;
+        // fall through
+    case ModeAwaitConfirm:
+        if (cmd == confirmCmd) {
+            confirmCount++;
+        } else {
+            confirmCmd = cmd;
+            confirmCount = 1;
+        }
+        if (confirmCount < confirmFrames) {
+            cancelled++;
+            return 0;
+        }
+        currentMode = ModeAuto;
+        return cmd;
+    case ModeAuto:
+    default:
+        return cmd;
+    }
+}
+
+char CommandArbiter::onRelease(int64_t nowNs)
+{
+    if (currentMode != ModeManualHold && currentMode != ModeAwaitConfirm) {
+        return 0;
+    }
+    // 松开前采集的帧仍按过期处理
+    lastManualNs = nowNs;
+    currentMode = ModeAwaitConfirm;
+    confirmCount = 0;
+    return 'S';
+}
+
+void CommandArbiter::resumeAuto()
+{
+    if (currentMode == ModeStopped || currentMode == ModeManualHold) {
+        currentMode = ModeAwaitConfirm;
+        confirmCount = 0;
+    }
+}
@@ -0,0 +1,81 @@
+#ifndef COMMAND_ARBITER_H
+#define COMMAND_ARBITER_H
+
+#include <atomic>
+#include <stdint.h>
+
+// 指令来源
+enum CommandSource
+{
+    SourceAuto = 0,      // 头部姿态推理
+    SourceButton,        // 触摸屏按钮
+    SourceInput,         // 物理按键/摇杆（evdev）
+    SourceWatchdog,      // 看门狗（界面卡顿时自动停止）
+    SourceCount
+};
+
+// 无锁延迟计数器（纳秒）：写端单线程，读端任意线程
+struct LatencyCounter
+{
+    std::atomic<int64_t> last {0};
+    std::atomic<int64_t> max {0};
+    std::atomic<int64_t> total {0};
+    std::atomic<uint64_t> count {0};
+
+    void record(int64_t ns)
+    {
+        last.store(ns, std::memory_order_relaxed);
+        total.fetch_add(ns, std::memory_order_relaxed);
+        count.fetch_add(1, std::memory_order_relaxed);
+        if (ns > max.load(std::memory_order_relaxed))
+            max.store(ns, std::memory_order_relaxed);
+    }
+    int64_t avg() const
+    {
+        uint64_t n = count.load(std::memory_order_relaxed);
+        return n ? total.load(std::memory_order_relaxed) / static_cast<int64_t>(n) : 0;
+    }
+};
+
+// 指令仲裁（纯逻辑，时间由调用方传入，只在控制分发线程中使用）：
+// - 手动停止优先于一切，并锁存：自动控制需用户显式resumeAuto()后才进入确认阶段
+// - 手动方向指令覆盖自动控制holdNs时长
+// - 松开物理方向键/摇杆回中只结束手动保持并把目标归零，不锁存停止，自动控制经确认后即可恢复
+// - 保持期结束（或resumeAuto）后，自动指令需连续confirmFrames次一致才恢复下发
+// - 采集时刻早于最近一次手动指令的推理结果属于过期结果，直接作废
+class CommandArbiter
+{
+public:
+    enum Mode
+    {
+        ModeAuto = 0,        // 自动控制生效
+        ModeManualHold,      // 手动指令保持期内
+        ModeAwaitConfirm,    // 等待自动指令连续确认
+        ModeStopped          // 手动停止锁存
+    };
+
+    CommandArbiter(int64_t holdNs, int confirmFrames);
+
+    // 返回需要下发的指令字符，0表示不下发
+    char onManual(char cmd, int64_t nowNs);
+    char onAuto(char cmd, int64_t captureNs, int64_t nowNs);
+    // 手动方向结束（松开）：仍由手动方向控制时返回'S'（目标归零）并进入确认阶段；
+    // 已锁存停止或自动控制已接管时返回0
+    char onRelease(int64_t nowNs);
+    void resumeAuto();
+
+    Mode mode() const { return currentMode; }
+    uint64_t cancelledAuto() const { return cancelled; }
+
+private:
+    int64_t holdNs;
+    int confirmFrames;
+    Mode currentMode;
+    int64_t holdUntilNs;
+    int64_t lastManualNs;
+    char confirmCmd;
+    int confirmCount;
+    uint64_t cancelled;
+};
+
+#endif // COMMAND_ARBITER_H
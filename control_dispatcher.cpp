@@ -0,0 +1,334 @@
+#include "control_dispatcher.h"
+#include "uart_master.h"
+#include "pipeline_clock.h"
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+
+// 头部姿态 → UART指令（按类别id查表：front/left/up/right/down）
+static const char kPoseCommands[NUM_CLASSES] = {'F', 'L', 'S', 'R', 'B'};
+
+static const uint64_t kManualTimeMask = (1ULL << 48) - 1;
+
+static RampLimits rampLimits(int accel, int jerk)
+{
+    RampLimits limits;
+    limits.maxAccel = accel * 0.001f;
+    limits.maxJerk = jerk * 0.001f;
+    limits.tau = 0.2f;
+    return limits;
+}
+
+ControlDispatcher::ControlDispatcher(int uartFd, const AppConfig &config, QObject *parent)
+    : QThread(parent)
+    , uartFd(uartFd)
+    , running(true)   // stop()可能在run()开始前调用，run()里再置位会把它覆盖
+    , arbiter(static_cast<int64_t>(config.manualHoldMs) * 1000000, config.autoConfirmFrames)
+    , framed(config.framedProtocol)
+    , timerFd(-1)
+    , controlPeriodNs(1000000000 / config.controlRateHz)
+    , setpointTimeoutNs(static_cast<int64_t>(config.setpointTimeoutMs) * 1000000)
+    , lastTargetNs(0)
+    , inputHeld(false)
+    , poseFilter(config.maxLinear * 0.001f, config.maxReverse * 0.001f, config.maxAngular * 0.001f, 0.6f)
+    , ramp(rampLimits(config.linearAccel, config.linearJerk), rampLimits(config.angularAccel, config.angularJerk))
+    , frameSeq(0)
+    , handledSeq(0)
+    , manualSlot(0)
+    , stopRequestNs(0)
+    , stopSource(SourceButton)
+    , releaseRequestNs(0)
+    , releaseSource(SourceInput)
+    , resumeRequested(false)
+    , sent(0)
+    , failed(0)
+    , overBudget(0)
+    , cancelledAuto(0)
+    , lastCmd(0)
+    , mode(CommandArbiter::ModeAuto)
+    , setpointLinear(0)
+    , setpointAngular(0)
+    , setpointFrames(0)
+    , setpointTimeouts(0)
+{
+    wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (framed) {
+        timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    }
+}
+
+ControlDispatcher::~ControlDispatcher()
+{
+    stop();
+    if (wakeFd >= 0) {
+        close(wakeFd);
+    }
+    if (timerFd >= 0) {
+        close(timerFd);
+    }
+}
+
+char ControlDispatcher::commandForClass(int classId)
+{
+    return (classId >= 0 && classId < NUM_CLASSES) ? kPoseCommands[classId] : 'S';
+}
+
+void ControlDispatcher::wake()
+{
+    uint64_t one = 1;
+    if (write(wakeFd, &one, sizeof(one)) != sizeof(one)) {
+        // 计数溢出才会失败，此时线程必然已被唤醒
+    }
+}
+
+void ControlDispatcher::postResult(const DetectionResult &result)
+{
+    pending.store(result);
+    wake();
+}
+
+void ControlDispatcher::submitManual(char cmd, CommandSource source, int64_t originNs)
+{
+    int64_t now = originNs > 0 ? originNs : monotonicNowNs();
+    if (cmd == 'S') {
+        stopSource.store(source, std::memory_order_relaxed);
+        stopRequestNs.store(now, std::memory_order_release);
+    } else {
+        uint64_t packed = (static_cast<uint64_t>(static_cast<unsigned char>(cmd)) << 56) |
+                          (static_cast<uint64_t>(source & 0xff) << 48) |
+                          (static_cast<uint64_t>(now / 1000) & kManualTimeMask);
+        manualSlot.store(packed, std::memory_order_release);
+    }
+    wake();
+}
+
+void ControlDispatcher::submitRelease(CommandSource source, int64_t originNs)
+{
+    int64_t now = originNs > 0 ? originNs : monotonicNowNs();
+    releaseSource.store(source, std::memory_order_relaxed);
+    releaseRequestNs.store(now, std::memory_order_release);
+    wake();
+}
+
+void ControlDispatcher::requestResumeAuto()
+{
+    resumeRequested.store(true, std::memory_order_release);
+    wake();
+}
+
+void ControlDispatcher::stop()
+{
+    if (!isRunning()) {
+        return;
+    }
+    running = false;
+    wake();
+    wait();
+}
+
+void ControlDispatcher::run()
+{
+    // 以ROOT运行时提升为SCHED_FIFO，保证负载下指令→上线仍在1ms内；失败则保持普通调度
+    struct sched_param param;
+    param.sched_priority = 10;
+    pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+
+    struct pollfd pfds[2];
+    pfds[0].fd = wakeFd;
+    pfds[0].events = POLLIN;
+    pfds[1].fd = timerFd;
+    pfds[1].events = POLLIN;
+    int nfds = 1;
+    if (timerFd >= 0) {
+        struct itimerspec its;
+        its.it_interval.tv_sec = 0;
+        its.it_interval.tv_nsec = controlPeriodNs;
+        its.it_value = its.it_interval;
+        timerfd_settime(timerFd, 0, &its, NULL);
+        ramp.reset(monotonicNowNs());
+        nfds = 2;
+    }
+
+    DetectionResult result;
+    while (running) {
+        pfds[0].revents = 0;
+        pfds[1].revents = 0;
+        if (poll(pfds, nfds, -1) <= 0) {
+            continue;
+        }
+        uint64_t n;
+        while (read(wakeFd, &n, sizeof(n)) == sizeof(n)) {
+        }
+        if (!running) {
+            break;
+        }
+        if (nfds == 2 && (pfds[1].revents & POLLIN)) {
+            while (read(timerFd, &n, sizeof(n)) == sizeof(n)) {
+            }
+            controlTick();
+        }
+
+        // 1. 手动停止：最高优先级，同一轮内的其他手动/自动指令全部作废
+        int64_t stopNs = stopRequestNs.exchange(0, std::memory_order_acquire);
+        if (stopNs) {
+            manualSlot.store(0, std::memory_order_relaxed);
+            releaseRequestNs.store(0, std::memory_order_relaxed);
+            handledSeq = pending.sequence();
+            inputHeld = false;
+            CommandSource source = static_cast<CommandSource>(stopSource.load());
+            send(arbiter.onManual('S', monotonicNowNs()), source, stopNs);
+            if (recorder) {
+                recorder->trigger(source == SourceWatchdog ? TriggerWatchdog : TriggerStop);
+            }
+        }
+
+        // 2. 手动方向：覆盖自动控制并作废待处理的自动结果；松开：结束手动保持，目标归零。
+        //    同一轮内两者都有时只处理较新的（先按后松的短按不动，先松后按的换向直接走新方向）
+        uint64_t packed = manualSlot.exchange(0, std::memory_order_acquire);
+        int64_t releaseNs = releaseRequestNs.exchange(0, std::memory_order_acquire);
+        int64_t originNs = static_cast<int64_t>(packed & kManualTimeMask) * 1000;
+        if (packed && releaseNs) {
+            if (originNs > releaseNs / 1000 * 1000) {
+                releaseNs = 0;
+            } else {
+                packed = 0;
+            }
+        }
+        if (releaseNs) {
+            inputHeld = false;
+            char cmd = arbiter.onRelease(monotonicNowNs());
+            if (cmd) {
+                send(cmd, static_cast<CommandSource>(releaseSource.load()), releaseNs);
+            }
+        }
+        if (packed) {
+            char cmd = static_cast<char>(packed >> 56);
+            CommandSource source = static_cast<CommandSource>((packed >> 48) & 0xff);
+            handledSeq = pending.sequence();
+            inputHeld = source == SourceInput;
+            send(arbiter.onManual(cmd, monotonicNowNs()), source, originNs);
+        }
+
+        // 3. 用户确认恢复自动
+        if (resumeRequested.exchange(false, std::memory_order_acquire)) {
+            arbiter.resumeAuto();
+        }
+
+        // 4. 自动结果：只处理最新的一份，是否下发由仲裁决定
+        unsigned seq = pending.sequence();
+        if (seq != handledSeq && pending.load(result)) {
+            int64_t dispatchNs = monotonicNowNs();
+            handledSeq = seq;
+            const Detection *best = result.best();
+            // 未检测到头部姿态时保持当前指令（与原有逻辑一致）
+            if (best) {
+                char cmd = arbiter.onAuto(commandForClass(best->class_id), result.t_capture_ns, monotonicNowNs());
+                if (cmd) {
+                    inputHeld = false;
+                    send(cmd, SourceAuto, result.t_infer_end_ns, best->confidence, &result, dispatchNs);
+                }
+            }
+        }
+
+        cancelledAuto.store(arbiter.cancelledAuto(), std::memory_order_relaxed);
+        mode.store(arbiter.mode(), std::memory_order_relaxed);
+    }
+}
+
+bool ControlDispatcher::send(char cmd, CommandSource source, int64_t originNs, float confidence,
+                             const DetectionResult *cause, int64_t dispatchNs)
+{
+    unsigned char uartSeq = frameSeq;
+    bool ok;
+    if (framed) {
+        int64_t now = monotonicNowNs();
+        if (source == SourceAuto) {
+            poseFilter.update(cmd, confidence);
+        } else {
+            poseFilter.force(cmd);
+            if (cmd == 'S' && arbiter.mode() == CommandArbiter::ModeStopped) {
+                ramp.reset(now);   // 手动停止：不走斜坡，立即下发零速度；松开方向键仍按斜坡减速
+            }
+        }
+        ramp.setTarget(poseFilter.linear(), poseFilter.angular());
+        lastTargetNs = now;
+        // 目标变化立即补发一帧，不等控制环下一个周期
+        ok = sendSetpoint(now);
+        lastCmd.store(cmd, std::memory_order_relaxed);
+    } else {
+        ok = uartFd >= 0 && uart_send_char(uartFd, cmd) == 0;
+        if (ok) {
+            sent.fetch_add(1, std::memory_order_relaxed);
+            lastCmd.store(cmd, std::memory_order_relaxed);
+        } else {
+            failed.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    int64_t sentNs = monotonicNowNs();
+    if (recorder) {
+        recorder->recordCommand(cmd, source, cause ? cause->frame_id : 0, cause ? cause->t_capture_ns : 0, uartSeq);
+    }
+    int64_t latency = sentNs - originNs;
+    latencies[source].record(latency);
+    if (!framed && latency > kLatencyBudgetNs) {
+        overBudget.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // 只统计真正上线的自动指令，失败的写入不计入端到端延迟
+    if (cause && ok) {
+        CommandTrace trace;
+        trace.frameId = cause->frame_id;
+        trace.cmd = cmd;
+        trace.uartSeq = uartSeq;
+        trace.tCaptureNs = cause->t_capture_ns;
+        trace.tInferStartNs = cause->t_infer_start_ns;
+        trace.tInferEndNs = cause->t_infer_end_ns;
+        trace.tDispatchNs = dispatchNs;
+        trace.tSentNs = sentNs;
+        pipeline.record(trace);
+        autoTrace.store(trace);
+    }
+    return ok;
+}
+
+void ControlDispatcher::controlTick()
+{
+    int64_t now = monotonicNowNs();
+    // 长时间没有新指令（推理停滞/相机断开）时目标归零，按斜坡缓停；
+    // 按住的方向键/摇杆只在按下时发一次指令，按住期间是操作者在控制，不算停滞
+    if (setpointTimeoutNs > 0 && lastTargetNs > 0 && !inputHeld && now - lastTargetNs > setpointTimeoutNs) {
+        // 静止时超时（如停车后不再有推理结果）是常态，只计数；行驶中超时才值得转储现场
+        bool moving = ramp.linear() != 0.0f || ramp.angular() != 0.0f;
+        poseFilter.force('S');
+        ramp.setTarget(0.0f, 0.0f);
+        lastTargetNs = 0;
+        setpointTimeouts.fetch_add(1, std::memory_order_relaxed);
+        if (recorder && moving) {
+            recorder->trigger(TriggerWatchdog);
+        }
+    }
+    sendSetpoint(now);
+}
+
+bool ControlDispatcher::sendSetpoint(int64_t nowNs)
+{
+    ramp.step(nowNs);
+    int linear = static_cast<int>(ramp.linear() * 1000.0f);
+    int angular = static_cast<int>(ramp.angular() * 1000.0f);
+    int ret = uartFd >= 0 ? uart_send_setpoint(uartFd, static_cast<short>(linear), static_cast<short>(angular), frameSeq++) : -1;
+    if (ret == 0) {
+        sent.fetch_add(1, std::memory_order_relaxed);
+        setpointFrames.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        failed.fetch_add(1, std::memory_order_relaxed);
+    }
+    setpointLinear.store(linear, std::memory_order_relaxed);
+    setpointAngular.store(angular, std::memory_order_relaxed);
+    if (recorder) {
+        recorder->recordSetpoint(poseFilter.linear(), poseFilter.angular(), ramp.linear(), ramp.angular());
+    }
+    return ret == 0;
+}
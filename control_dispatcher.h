@@ -0,0 +1,127 @@
+#ifndef CONTROL_DISPATCHER_H
+#define CONTROL_DISPATCHER_H
+
+#include <QThread>
+#include <atomic>
+#include <stdint.h>
+#include "inference.h"
+#include "seqlock.h"
+#include "command_arbiter.h"
+#include "speed_ramp.h"
+#include "app_config.h"
+#include "pipeline_latency.h"
+#include "flight_recorder.h"
+
+// 控制分发线程：UART的唯一写者。
+// 推理结果（SeqLock覆盖式投递）与手动指令（原子槽位，多生产者）都经eventfd唤醒本线程，
+// 由CommandArbiter按优先级仲裁后立即下发，不经过GUI事件循环。
+// 每轮按 停止 → 手动方向/松开 → 恢复自动 → 自动结果 的顺序处理，低优先级的待处理指令被作废而非排队。
+// 帧协议下仲裁结果不直接发字符，而是经PoseFilter变成目标线速度/角速度，由timerfd驱动的
+// 固定频率控制环（默认50Hz）按加速度/jerk限制生成斜坡，连续下发速度设定值帧；
+// 目标变化时立即补发一帧，响应不依赖控制环周期，两次推理之间速度平滑过渡。
+// 界面只通过统计接口异步观察，不参与控制链路。
+class ControlDispatcher : public QThread
+{
+    Q_OBJECT
+public:
+    ControlDispatcher(int uartFd, const AppConfig &config, QObject *parent = nullptr);
+    ~ControlDispatcher();
+
+    // 推理线程调用（单写者）：覆盖式投递最新结果，未处理的旧结果直接作废
+    void postResult(const DetectionResult &result);
+    // 任意线程调用：手动指令（F/B/L/R/S），同一轮内只保留最新的方向指令，停止指令单独锁存不会丢失
+    // originNs为指令产生时刻（如evdev事件时间戳），0表示取当前时刻；来源为SourceWatchdog的停止按看门狗事件转储黑匣子
+    void submitManual(char cmd, CommandSource source, int64_t originNs = 0);
+    // 任意线程调用：手动方向结束（松开方向键/摇杆回中），目标归零并按斜坡减速，但不锁存停止、不转储黑匣子；
+    // 与同一轮内的方向指令按时间先后只保留较新的一个
+    void submitRelease(CommandSource source, int64_t originNs = 0);
+    // 任意线程调用：用户确认恢复自动控制
+    void requestResumeAuto();
+    void stop();
+    // 须在start()前设置：指令与设定值写入黑匣子，停止/看门狗事件触发转储
+    void setFlightRecorder(FlightRecorder *r) { recorder = r; }
+
+    // 头部姿态类别 → UART指令字符（front/left/up/right/down → F/L/S/R/B，其他 → S）
+    static char commandForClass(int classId);
+
+    // 各来源 指令产生→上线（write+tcdrain返回）的延迟统计，单位纳秒
+    const LatencyCounter &latency(CommandSource source) const { return latencies[source]; }
+    int64_t lastLatencyNs() const { return latencies[SourceAuto].last.load(std::memory_order_relaxed); }
+    uint64_t commandsSent() const { return sent.load(std::memory_order_relaxed); }
+    uint64_t commandsFailed() const { return failed.load(std::memory_order_relaxed); }
+    uint64_t overBudgetCount() const { return overBudget.load(std::memory_order_relaxed); }
+    uint64_t cancelledAutoCount() const { return cancelledAuto.load(std::memory_order_relaxed); }
+    char lastCommand() const { return static_cast<char>(lastCmd.load(std::memory_order_relaxed)); }
+    CommandArbiter::Mode arbiterMode() const { return static_cast<CommandArbiter::Mode>(mode.load(std::memory_order_relaxed)); }
+
+    // 帧协议下当前下发的速度设定值（mm/s、mrad/s）与已发送帧数
+    bool isFramed() const { return framed; }
+    int currentLinear() const { return setpointLinear.load(std::memory_order_relaxed); }
+    int currentAngular() const { return setpointAngular.load(std::memory_order_relaxed); }
+    uint64_t setpointFramesSent() const { return setpointFrames.load(std::memory_order_relaxed); }
+    // 设定值超时次数（含静止时的超时，只有行驶中超时才转储黑匣子）
+    uint64_t setpointTimeoutCount() const { return setpointTimeouts.load(std::memory_order_relaxed); }
+
+    // 自动指令的端到端延迟（采集→推理→分发→上线，各环节直方图）与最近一条指令的时间线
+    const PipelineLatency &pipelineLatency() const { return pipeline; }
+    bool lastAutoTrace(CommandTrace &out) const { return autoTrace.load(out); }
+
+    static const int64_t kLatencyBudgetNs = 1000000;   // 1ms
+
+protected:
+    void run() override;
+
+private:
+    void wake();
+    // 返回是否成功写入串口；cause非空时为自动指令，记录其端到端时间线
+    bool send(char cmd, CommandSource source, int64_t originNs, float confidence = 1.0f,
+              const DetectionResult *cause = nullptr, int64_t dispatchNs = 0);
+    bool sendSetpoint(int64_t nowNs);
+    void controlTick();
+
+    int uartFd;
+    int wakeFd;
+    std::atomic<bool> running;
+    CommandArbiter arbiter;
+
+    // 帧协议速度控制
+    bool framed;
+    int timerFd;
+    int controlPeriodNs;
+    int64_t setpointTimeoutNs;
+    int64_t lastTargetNs;
+    // 物理输入的方向键/摇杆仍按住：松开必然另有指令到来，期间不做设定值超时
+    bool inputHeld;
+    PoseFilter poseFilter;
+    SpeedRamp ramp;
+    unsigned char frameSeq;
+
+    // 自动结果通道
+    SeqLock<DetectionResult> pending;
+    unsigned handledSeq;
+    // 手动指令槽位：cmd(8位) | source(8位) | 时间戳(48位，微秒)，0表示空
+    std::atomic<uint64_t> manualSlot;
+    std::atomic<int64_t> stopRequestNs;   // 非0表示有待处理的停止指令
+    std::atomic<int> stopSource;
+    std::atomic<int64_t> releaseRequestNs;   // 非0表示有待处理的松开
+    std::atomic<int> releaseSource;
+    std::atomic<bool> resumeRequested;
+
+    LatencyCounter latencies[SourceCount];
+    std::atomic<uint64_t> sent;
+    std::atomic<uint64_t> failed;
+    std::atomic<uint64_t> overBudget;
+    std::atomic<uint64_t> cancelledAuto;
+    std::atomic<int> lastCmd;
+    std::atomic<int> mode;
+    std::atomic<int> setpointLinear;
+    std::atomic<int> setpointAngular;
+    std::atomic<uint64_t> setpointFrames;
+    std::atomic<uint64_t> setpointTimeouts;
+
+    PipelineLatency pipeline;
+    FlightRecorder *recorder {nullptr};
+    SeqLock<CommandTrace> autoTrace;
+};
+
+#endif // CONTROL_DISPATCHER_H
@@ -0,0 +1,11 @@
+# 链接流水线核心静态库（core/core.pro）；须在opencv.pri之前include，保证静态库排在OpenCV前面
+INCLUDEPATH += $$PWD
+DEPENDPATH += $$PWD
+
+# 默认各子工程与core同级；更深一层的子工程（如tests/下）先自行设置CORE_OUT
+isEmpty(CORE_OUT): CORE_OUT = $$OUT_PWD/../core
+LIBS += -L$$CORE_OUT -lwheelchair_core
+PRE_TARGETDEPS += $$CORE_OUT/libwheelchair_core.a
+
+# 可选推理后端的宏定义与链接库（静态库中的后端代码在最终链接时需要）
+include($$PWD/inference_backends.pri)
@@ -0,0 +1,74 @@
+# 流水线核心静态库：采集/推理/控制/录制/回放，只依赖QtCore，不含QtWidgets
+QT       = core
+
+CONFIG   += c++11 staticlib
+
+TARGET = wheelchair_core
+TEMPLATE = lib
+
+INCLUDEPATH += ..
+
+include(../opencv.pri)
+include(../inference_backends.pri)
+
+SOURCES += ../app_config.cpp \
+           ../async_logger.cpp \
+           ../inference.cpp \
+           ../inference_backend.cpp \
+           ../native_kernels.cpp \
+           ../native_model.cpp \
+           ../native_packer.cpp \
+           ../native_backend.cpp \
+           ../ort_backend.cpp \
+           ../tflite_backend.cpp \
+           ../head_tracker.cpp \
+           ../command_arbiter.cpp \
+           ../control_dispatcher.cpp \
+           ../speed_ramp.cpp \
+           ../pipeline_latency.cpp \
+           ../input_reader.cpp \
+           ../snapshot_writer.cpp \
+           ../flight_recorder.cpp \
+           ../session_recorder.cpp \
+           ../frame_source.cpp \
+           ../replay_source.cpp \
+           ../resource_usage.cpp \
+           ../metrics_registry.cpp \
+           ../metrics_server.cpp \
+           ../event_loop_monitor.cpp \
+           ../auto_tuner.cpp \
+           ../pipeline.cpp \
+           ../headless_runner.cpp \
+           ../uart_master.cpp
+
+HEADERS  += ../app_config.h \
+            ../async_logger.h \
+            ../inference.h \
+            ../inference_backend.h \
+            ../native_kernels.h \
+            ../native_model.h \
+            ../head_tracker.h \
+            ../command_arbiter.h \
+            ../control_dispatcher.h \
+            ../speed_ramp.h \
+            ../input_reader.h \
+            ../snapshot_writer.h \
+            ../flight_recorder.h \
+            ../session_recorder.h \
+            ../frame_source.h \
+            ../replay_source.h \
+            ../resource_usage.h \
+            ../metrics_registry.h \
+            ../metrics_server.h \
+            ../event_loop_monitor.h \
+            ../auto_tuner.h \
+            ../infer_thread.h \
+            ../overlay_box.h \
+            ../pipeline.h \
+            ../headless_runner.h \
+            ../seqlock.h \
+            ../pipeline_clock.h \
+            ../pipeline_latency.h \
+            ../uart_master.h
+
+DEFINES += QT_DEPRECATED_WARNINGS
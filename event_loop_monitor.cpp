@@ -0,0 +1,170 @@
+#include "event_loop_monitor.h"
+#include "control_dispatcher.h"
+#include "pipeline_clock.h"
+#include "async_logger.h"
+#include <QCoreApplication>
+#include <QEvent>
+#include <QObject>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+std::atomic<const char *> EventLoopMonitor::currentSlot(nullptr);
+
+static QEvent::Type probeEventType()
+{
+    static const QEvent::Type type = static_cast<QEvent::Type>(QEvent::registerEventType());
+    return type;
+}
+
+class ProbeEvent : public QEvent
+{
+public:
+    explicit ProbeEvent(int64_t posted) : QEvent(probeEventType()), postedNs(posted) {}
+    int64_t postedNs;
+};
+
+// 探测接收对象：归属主线程，事件在主线程的事件循环中分发
+class EventLoopProbe : public QObject
+{
+public:
+    explicit EventLoopProbe(EventLoopMonitor *monitor) : monitor(monitor) {}
+
+    bool event(QEvent *e) override
+    {
+        if (e->type() != probeEventType())
+            return QObject::event(e);
+        monitor->onProbe(static_cast<ProbeEvent *>(e)->postedNs);
+        return true;
+    }
+
+private:
+    EventLoopMonitor *monitor;
+};
+
+EventLoopMonitor::EventLoopMonitor(int stallMs, int watchdogMs, ControlDispatcher *dispatcher, QObject *parent)
+    : QThread(parent)
+    , probe(new EventLoopProbe(this))
+    , dispatcher(dispatcher)
+    , stallNs(static_cast<int64_t>(stallMs) * 1000000)
+    , watchdogNs(static_cast<int64_t>(watchdogMs) * 1000000)
+    , running(true)   // 构造时置位，run()不再改写：start()之后、run()之前的stop()不会丢
+    , inFlightNs(0)
+    , stalls(0)
+    , watchdogs(0)
+    , worstLag(0)
+{
+    wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+}
+
+EventLoopMonitor::~EventLoopMonitor()
+{
+    stop();
+    // 已投递未分发的探测事件随接收对象一起删除
+    delete probe;
+    if (wakeFd >= 0)
+        close(wakeFd);
+}
+
+void EventLoopMonitor::stop()
+{
+    if (!isRunning())
+        return;
+    running = false;
+    uint64_t one = 1;
+    if (write(wakeFd, &one, sizeof(one)) != sizeof(one)) {
+    }
+    wait();
+}
+
+void EventLoopMonitor::post(int64_t nowNs)
+{
+    inFlightNs.store(nowNs, std::memory_order_release);
+    QCoreApplication::postEvent(probe, new ProbeEvent(nowNs));
+}
+
+void EventLoopMonitor::onProbe(int64_t postedNs)
+{
+    int64_t lag = monotonicNowNs() - postedNs;
+    lagHistogram.record(lag);
+    if (lag / 1000 > worstLag.load(std::memory_order_relaxed))
+        worstLag.store(lag / 1000, std::memory_order_relaxed);
+    inFlightNs.store(0, std::memory_order_release);
+    // 唤醒监测线程：卡顿结束立即记录，并按间隔投递下一个探测
+    uint64_t one = 1;
+    if (write(wakeFd, &one, sizeof(one)) != sizeof(one)) {
+    }
+}
+
+void EventLoopMonitor::run()
+{
+    const int64_t intervalNs = static_cast<int64_t>(probeIntervalMs) * 1000000;
+    bool loopSeen = false;         // 第一个探测被处理前事件循环可能还没开始（启动阶段加载模型等），不判卡顿
+    int64_t stalledProbeNs = 0;    // 已告警的在途探测（投递时刻）
+    bool watchdogFired = false;
+    const char *stallSlot = "";
+    int64_t nextPostNs = monotonicNowNs();
+
+    struct pollfd pfd;
+    pfd.fd = wakeFd;
+    pfd.events = POLLIN;
+    while (running) {
+        int64_t now = monotonicNowNs();
+        int64_t posted = inFlightNs.load(std::memory_order_acquire);
+
+        if (posted == 0) {
+            if (stalledProbeNs != 0) {
+                LOG_WARN(LogUi, "【界面卡顿】已恢复：事件循环阻塞%lldms（%s）", lagHistogram.lastUs() / 1000, stallSlot);
+                stalledProbeNs = 0;
+            }
+            if (!loopSeen && lagHistogram.count() > 0)
+                loopSeen = true;
+            if (now >= nextPostNs) {
+                post(now);
+                posted = now;
+                nextPostNs = now + intervalNs;
+            }
+        }
+
+        if (posted != 0 && loopSeen) {
+            int64_t waited = now - posted;
+            if (waited >= stallNs && stalledProbeNs != posted) {
+                stalledProbeNs = posted;
+                watchdogFired = false;
+                const char *slot = activeSlot();
+                stallSlot = slot ? slot : "未标注的处理";
+                stalls.fetch_add(1, std::memory_order_relaxed);
+                LOG_WARN(LogUi, "【界面卡顿】事件循环已阻塞%lldms，正在执行：%s", waited / 1000000, stallSlot);
+            }
+            if (watchdogNs > 0 && waited >= watchdogNs && stalledProbeNs == posted && !watchdogFired) {
+                watchdogFired = true;
+                watchdogs.fetch_add(1, std::memory_order_relaxed);
+                LOG_ERROR(LogUi, "【界面卡顿】阻塞超过%lldms（%s），触摸屏无法响应，看门狗停车（需手动恢复自动）",
+                          watchdogNs / 1000000, stallSlot);
+                if (dispatcher)
+                    dispatcher->submitManual('S', SourceWatchdog);
+            }
+        }
+
+        // 下一次需要醒来的时刻：投递下一个探测，或在途探测到达告警/看门狗阈值；探测被处理时由onProbe唤醒
+        int64_t wakeAtNs = -1;
+        if (posted == 0)
+            wakeAtNs = nextPostNs;
+        else if (!loopSeen)
+            wakeAtNs = -1;
+        else if (stalledProbeNs != posted)
+            wakeAtNs = posted + stallNs;
+        else if (watchdogNs > 0 && !watchdogFired)
+            wakeAtNs = posted + watchdogNs;
+        int timeoutMs = -1;
+        if (wakeAtNs >= 0) {
+            int64_t remain = wakeAtNs - monotonicNowNs();
+            timeoutMs = remain > 0 ? static_cast<int>((remain + 999999) / 1000000) : 0;
+        }
+        if (poll(&pfd, 1, timeoutMs) > 0) {
+            uint64_t n;
+            while (read(wakeFd, &n, sizeof(n)) == sizeof(n)) {
+            }
+        }
+    }
+}
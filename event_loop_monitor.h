@@ -0,0 +1,80 @@
+#ifndef EVENT_LOOP_MONITOR_H
+#define EVENT_LOOP_MONITOR_H
+
+#include <QThread>
+#include <atomic>
+#include <stdint.h>
+#include "pipeline_latency.h"
+
+class QObject;
+class ControlDispatcher;
+class EventLoopProbe;
+
+// 事件循环卡顿监测：本线程每probeIntervalMs向主线程（流水线/界面所在的事件循环）投递一个带时间戳的探测事件，
+// 主线程处理到它时记录投递→处理的延迟（直方图）。同一时刻只有一个探测在途，在途超过阈值即为卡顿：
+// - 超过stallMs：告警一次，带上当时正在执行的槽函数名（UI_SLOT_SCOPE标注）
+// - 超过watchdogMs：触摸屏已无法响应停止按钮，经控制分发线程发出看门狗停止（锁存，需手动恢复自动）
+// - 探测最终被处理时记录卡顿总时长
+// 本线程不碰任何界面对象，控制分发线程独立于事件循环，卡顿期间停止指令照常下发。
+class EventLoopMonitor : public QThread
+{
+    Q_OBJECT
+public:
+    // watchdogMs为0表示只告警不停车；须在主线程构造（探测接收对象归属构造线程）
+    EventLoopMonitor(int stallMs, int watchdogMs, ControlDispatcher *dispatcher, QObject *parent = nullptr);
+    ~EventLoopMonitor();
+
+    void stop();
+
+    const LatencyHistogram &lag() const { return lagHistogram; }
+    uint64_t stallCount() const { return stalls.load(std::memory_order_relaxed); }
+    uint64_t watchdogCount() const { return watchdogs.load(std::memory_order_relaxed); }
+    int64_t worstLagUs() const { return worstLag.load(std::memory_order_relaxed); }
+
+    // 当前正在执行的已标注槽函数（主线程写，本线程读）
+    static const char *activeSlot() { return currentSlot.load(std::memory_order_relaxed); }
+
+    int probeIntervalMs {100};
+
+protected:
+    void run() override;
+
+private:
+    friend class EventLoopProbe;
+    friend class EventLoopSlotScope;
+
+    void onProbe(int64_t postedNs);   // 主线程调用
+    void post(int64_t nowNs);
+
+    EventLoopProbe *probe;
+    ControlDispatcher *dispatcher;
+    int64_t stallNs;
+    int64_t watchdogNs;
+    int wakeFd;
+    std::atomic<bool> running;
+    std::atomic<int64_t> inFlightNs;   // 在途探测的投递时刻，0表示没有在途探测
+
+    LatencyHistogram lagHistogram;
+    std::atomic<uint64_t> stalls;
+    std::atomic<uint64_t> watchdogs;
+    std::atomic<int64_t> worstLag;
+
+    static std::atomic<const char *> currentSlot;
+};
+
+// 槽函数作用域：进入时登记名字，退出时恢复外层（嵌套的事件循环/直接调用）
+class EventLoopSlotScope
+{
+public:
+    explicit EventLoopSlotScope(const char *name)
+        : outer(EventLoopMonitor::currentSlot.exchange(name, std::memory_order_relaxed)) {}
+    ~EventLoopSlotScope() { EventLoopMonitor::currentSlot.store(outer, std::memory_order_relaxed); }
+
+private:
+    const char *outer;
+};
+
+// 在主线程的槽函数开头使用：卡顿告警中给出该函数名
+#define UI_SLOT_SCOPE() EventLoopSlotScope uiSlotScope_(__func__)
+
+#endif // EVENT_LOOP_MONITOR_H
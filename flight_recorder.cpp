@@ -0,0 +1,428 @@
+#include "flight_recorder.h"
+#include "inference.h"
+#include "pipeline_clock.h"
+#include "async_logger.h"
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/eventfd.h>
+#include <sys/stat.h>
+
+// 事件环固定占用的预算（其余给帧环）
+static const size_t kEventBudgetBytes = 1024 * 1024;
+static const size_t kMinScratchBytes = 64 * 1024;
+
+static FlightRecorder *g_crashRecorder = nullptr;
+static volatile sig_atomic_t g_crashing = 0;
+static const int kCrashSignals[] = {SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT};
+
+// ---- 异步信号安全的小工具（转储路径不能用snprintf/malloc） ----
+static char *appendStr(char *p, char *end, const char *s)
+{
+    while (*s && p < end - 1)
+        *p++ = *s++;
+    *p = '\0';
+    return p;
+}
+
+static char *appendUInt(char *p, char *end, uint64_t v)
+{
+    char digits[24];
+    int n = 0;
+    do {
+        digits[n++] = static_cast<char>('0' + v % 10);
+        v /= 10;
+    } while (v > 0);
+    while (n > 0 && p < end - 1)
+        *p++ = digits[--n];
+    *p = '\0';
+    return p;
+}
+
+static bool writeAll(int fd, const void *data, size_t len)
+{
+    const char *p = static_cast<const char *>(data);
+    while (len > 0) {
+        ssize_t n = write(fd, p, len);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            return false;
+        }
+        p += n;
+        len -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+static const char *triggerName(int reason)
+{
+    switch (reason) {
+    case TriggerManual: return "manual";
+    case TriggerStop: return "stop";
+    case TriggerWatchdog: return "watchdog";
+    case TriggerCrash: return "crash";
+    default: return "unknown";
+    }
+}
+
+FlightRecorder::FlightRecorder(size_t budgetBytes, size_t frameSlotBytes, const char *dir, QObject *parent)
+    : QThread(parent)
+    , arena(nullptr)
+    , arenaBytes(0)
+    , events(nullptr)
+    , eventSlots(0)
+    , frames(nullptr)
+    , frameSlots(0)
+    , frameSlotBytes(frameSlotBytes)
+    , scratch(nullptr)
+    , crashScratch(nullptr)
+    , eventIndex(0)
+    , frameIndex(0)
+    , frameCommitted(0)
+    , running(false)
+    , pendingReason(0)
+    , dumps(0)
+    , oversized(0)
+{
+    snprintf(dumpDir, sizeof(dumpDir), "%s", dir);
+    memset(lastDumpNs, 0, sizeof(lastDumpNs));
+    wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+    size_t frameStride = sizeof(FlightFrameHeader) + frameSlotBytes;
+    if (budgetBytes <= kEventBudgetBytes + frameStride) {
+        return;   // 预算不足，记录仪关闭
+    }
+    eventSlots = kEventBudgetBytes / sizeof(FlightEvent);
+    frameSlots = (budgetBytes - kEventBudgetBytes) / frameStride;
+    size_t scratchBytes = frameStride > kMinScratchBytes ? frameStride : kMinScratchBytes;
+
+    arenaBytes = eventSlots * sizeof(FlightEvent) + frameSlots * frameStride + 2 * scratchBytes;
+    arena = static_cast<char *>(malloc(arenaBytes));
+    if (!arena) {
+        eventSlots = frameSlots = 0;
+        return;
+    }
+    // 预先触页：记录路径上不发生缺页
+    memset(arena, 0, arenaBytes);
+    events = reinterpret_cast<FlightEvent *>(arena);
+    frames = arena + eventSlots * sizeof(FlightEvent);
+    scratch = frames + frameSlots * frameStride;
+    crashScratch = scratch + scratchBytes;
+
+    mkdir(dumpDir, 0755);
+}
+
+FlightRecorder::~FlightRecorder()
+{
+    stop();
+    if (g_crashRecorder == this)
+        g_crashRecorder = nullptr;
+    if (wakeFd >= 0)
+        close(wakeFd);
+    free(arena);
+}
+
+void FlightRecorder::recordFrame(uint32_t frameId, int64_t tCaptureNs, const void *jpeg, size_t length)
+{
+    if (frameSlots == 0 || jpeg == nullptr)
+        return;
+    if (length > frameSlotBytes) {
+        oversized.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    uint64_t index = frameIndex++;
+    FlightFrameHeader *hdr = reinterpret_cast<FlightFrameHeader *>(
+        frames + (index % frameSlots) * (sizeof(FlightFrameHeader) + frameSlotBytes));
+    __atomic_store_n(&hdr->seq, index * 2 + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    hdr->tCaptureNs = tCaptureNs;
+    hdr->frameId = frameId;
+    hdr->length = static_cast<uint32_t>(length);
+    memcpy(hdr + 1, jpeg, length);
+    __atomic_store_n(&hdr->seq, index * 2 + 2, __ATOMIC_RELEASE);
+    frameCommitted.store(index + 1, std::memory_order_release);
+}
+
+FlightEvent *FlightRecorder::nextEvent(uint64_t &index)
+{
+    if (eventSlots == 0)
+        return nullptr;
+    index = eventIndex.fetch_add(1, std::memory_order_relaxed);
+    FlightEvent *ev = &events[index % eventSlots];
+    __atomic_store_n(&ev->seq, index * 2 + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    ev->tNs = monotonicNowNs();
+    ev->tCaptureNs = 0;
+    ev->frameId = 0;
+    ev->source = 0;
+    ev->cmd = 0;
+    ev->uartSeq = 0;
+    ev->classId = -1;
+    ev->confidence = 0.0f;
+    memset(ev->box, 0, sizeof(ev->box));
+    memset(ev->value, 0, sizeof(ev->value));
+    return ev;
+}
+
+void FlightRecorder::commitEvent(FlightEvent *ev, uint64_t index)
+{
+    __atomic_store_n(&ev->seq, index * 2 + 2, __ATOMIC_RELEASE);
+}
+
+void FlightRecorder::recordDetection(const DetectionResult &result)
+{
+    uint64_t index;
+    FlightEvent *ev = nextEvent(index);
+    if (!ev)
+        return;
+    ev->type = FlightDetection;
+    ev->tNs = result.t_infer_end_ns;
+    ev->tCaptureNs = result.t_capture_ns;
+    ev->frameId = result.frame_id;
+    const Detection *best = result.best();
+    if (best) {
+        ev->classId = best->class_id;
+        ev->confidence = best->confidence;
+        ev->box[0] = static_cast<int16_t>(best->box.x);
+        ev->box[1] = static_cast<int16_t>(best->box.y);
+        ev->box[2] = static_cast<int16_t>(best->box.width);
+        ev->box[3] = static_cast<int16_t>(best->box.height);
+    }
+    ev->value[0] = static_cast<float>((result.t_infer_end_ns - result.t_infer_start_ns) / 1000);   // 推理耗时（us）
+    commitEvent(ev, index);
+}
+
+void FlightRecorder::recordCommand(char cmd, int source, uint32_t frameId, int64_t tCaptureNs, uint8_t uartSeq)
+{
+    uint64_t index;
+    FlightEvent *ev = nextEvent(index);
+    if (!ev)
+        return;
+    ev->type = FlightCommand;
+    ev->cmd = cmd;
+    ev->source = static_cast<uint8_t>(source);
+    ev->frameId = frameId;
+    ev->tCaptureNs = tCaptureNs;
+    ev->uartSeq = uartSeq;
+    commitEvent(ev, index);
+}
+
+void FlightRecorder::recordSetpoint(float filterLinear, float filterAngular, float rampLinear, float rampAngular)
+{
+    uint64_t index;
+    FlightEvent *ev = nextEvent(index);
+    if (!ev)
+        return;
+    ev->type = FlightSetpoint;
+    ev->value[0] = filterLinear;
+    ev->value[1] = filterAngular;
+    ev->value[2] = rampLinear;
+    ev->value[3] = rampAngular;
+    commitEvent(ev, index);
+}
+
+void FlightRecorder::trigger(FlightTrigger reason)
+{
+    if (frameSlots == 0)
+        return;
+    uint64_t index;
+    FlightEvent *ev = nextEvent(index);
+    if (ev) {
+        ev->type = FlightMark;
+        ev->value[0] = static_cast<float>(reason);
+        commitEvent(ev, index);
+    }
+    // 已有待处理的转储时不重复触发，延迟窗口内的后续事件会一并写入
+    int expected = 0;
+    if (pendingReason.compare_exchange_strong(expected, reason)) {
+        uint64_t one = 1;
+        if (write(wakeFd, &one, sizeof(one)) != sizeof(one)) {
+        }
+    }
+}
+
+void FlightRecorder::stop()
+{
+    if (!isRunning())
+        return;
+    running = false;
+    uint64_t one = 1;
+    if (write(wakeFd, &one, sizeof(one)) != sizeof(one)) {
+    }
+    wait();
+}
+
+void FlightRecorder::run()
+{
+    running = true;
+    struct pollfd pfd;
+    pfd.fd = wakeFd;
+    pfd.events = POLLIN;
+    while (running) {
+        if (poll(&pfd, 1, -1) <= 0)
+            continue;
+        uint64_t n;
+        while (read(wakeFd, &n, sizeof(n)) == sizeof(n)) {
+        }
+        int reason = pendingReason.load(std::memory_order_acquire);
+        if (!running || reason == 0)
+            continue;
+
+        // 等待触发后的现场（停止后的几帧、斜坡减速过程）进入记录
+        int64_t deadline = monotonicNowNs() + static_cast<int64_t>(dumpDelayMs) * 1000000;
+        while (running) {
+            int64_t left = deadline - monotonicNowNs();
+            if (left <= 0)
+                break;
+            poll(nullptr, 0, static_cast<int>(left / 1000000) + 1);
+        }
+
+        int64_t now = monotonicNowNs();
+        if (lastDumpNs[reason] == 0 || now - lastDumpNs[reason] >= static_cast<int64_t>(minDumpIntervalMs) * 1000000) {
+            lastDumpNs[reason] = now;
+            if (dump(static_cast<FlightTrigger>(reason), scratch)) {
+                dumps.fetch_add(1, std::memory_order_relaxed);
+                LOG_INFO(LogRecord, "【黑匣子】已转储（%s）到 %s", triggerName(reason), dumpDir);
+            }
+        }
+        pendingReason.store(0, std::memory_order_release);
+    }
+}
+
+bool FlightRecorder::dump(FlightTrigger reason, char *buf)
+{
+    if (frameSlots == 0)
+        return false;
+
+    struct timespec rt;
+    clock_gettime(CLOCK_REALTIME, &rt);
+    int64_t nowNs = monotonicNowNs();
+
+    char finalPath[320];
+    char tmpPath[330];
+    char *end = finalPath + sizeof(finalPath);
+    char *p = appendStr(finalPath, end, dumpDir);
+    p = appendStr(p, end, "/flight_");
+    p = appendUInt(p, end, static_cast<uint64_t>(rt.tv_sec));
+    p = appendStr(p, end, "_");
+    p = appendUInt(p, end, static_cast<uint64_t>(rt.tv_nsec / 1000000));
+    p = appendStr(p, end, "_");
+    p = appendStr(p, end, triggerName(reason));
+    p = appendStr(p, end, ".bin");
+    p = appendStr(tmpPath, tmpPath + sizeof(tmpPath), finalPath);
+    appendStr(p, tmpPath + sizeof(tmpPath), ".tmp");
+
+    int fd = open(tmpPath, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0)
+        return false;
+
+    FlightDumpHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, "WCFLIGHT", 8);
+    header.version = 1;
+    header.reason = reason;
+    header.tDumpNs = nowNs;
+    header.tDumpRealtimeSec = rt.tv_sec;
+    header.eventSize = sizeof(FlightEvent);
+    header.frameSlotBytes = static_cast<uint32_t>(frameSlotBytes);
+    bool ok = writeAll(fd, &header, sizeof(header));
+
+    // 事件：从最旧到最新，按批拷贝到scratch再写出；拷贝期间被覆盖的槽位跳过
+    uint64_t endIndex = eventIndex.load(std::memory_order_acquire);
+    uint64_t index = endIndex > eventSlots ? endIndex - eventSlots : 0;
+    size_t batchMax = kMinScratchBytes / sizeof(FlightEvent);
+    FlightEvent *batch = reinterpret_cast<FlightEvent *>(buf);
+    size_t batchCount = 0;
+    for (; ok && index < endIndex; ++index) {
+        const FlightEvent *ev = &events[index % eventSlots];
+        uint64_t s1 = __atomic_load_n(&ev->seq, __ATOMIC_ACQUIRE);
+        if (s1 != index * 2 + 2)
+            continue;
+        memcpy(&batch[batchCount], ev, sizeof(FlightEvent));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&ev->seq, __ATOMIC_RELAXED) != s1)
+            continue;
+        header.eventCount++;
+        if (++batchCount == batchMax) {
+            ok = writeAll(fd, batch, batchCount * sizeof(FlightEvent));
+            batchCount = 0;
+        }
+    }
+    if (ok && batchCount > 0)
+        ok = writeAll(fd, batch, batchCount * sizeof(FlightEvent));
+
+    // 帧：同样从最旧到最新
+    size_t frameStride = sizeof(FlightFrameHeader) + frameSlotBytes;
+    endIndex = frameCommitted.load(std::memory_order_acquire);
+    index = endIndex > frameSlots ? endIndex - frameSlots : 0;
+    for (; ok && index < endIndex; ++index) {
+        const FlightFrameHeader *hdr = reinterpret_cast<const FlightFrameHeader *>(frames + (index % frameSlots) * frameStride);
+        uint64_t s1 = __atomic_load_n(&hdr->seq, __ATOMIC_ACQUIRE);
+        if (s1 != index * 2 + 2)
+            continue;
+        FlightFrameHeader *copy = reinterpret_cast<FlightFrameHeader *>(buf);
+        memcpy(copy, hdr, sizeof(FlightFrameHeader));
+        size_t length = copy->length <= frameSlotBytes ? copy->length : frameSlotBytes;
+        memcpy(copy + 1, hdr + 1, length);
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&hdr->seq, __ATOMIC_RELAXED) != s1)
+            continue;
+        copy->length = static_cast<uint32_t>(length);
+        ok = writeAll(fd, copy, sizeof(FlightFrameHeader) + length);
+        header.frameCount++;
+    }
+
+    ok = ok && pwrite(fd, &header, sizeof(header), 0) == static_cast<ssize_t>(sizeof(header));
+    ok = ok && fsync(fd) == 0;
+    close(fd);
+    if (!ok || rename(tmpPath, finalPath) != 0) {
+        unlink(tmpPath);
+        return false;
+    }
+    int dirFd = open(dumpDir, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dirFd >= 0) {
+        fsync(dirFd);
+        close(dirFd);
+    }
+    return true;
+}
+
+void FlightRecorder::onCrashSignal(int sig)
+{
+    if (!g_crashing && g_crashRecorder) {
+        g_crashing = 1;
+        g_crashRecorder->dump(TriggerCrash, g_crashRecorder->crashScratch);
+    }
+    // 恢复默认处理并重新投递，保留core dump与退出码
+    signal(sig, SIG_DFL);
+    raise(sig);
+}
+
+void FlightRecorder::installCrashHandler()
+{
+    if (frameSlots == 0)
+        return;
+    g_crashRecorder = this;
+
+    // 栈溢出时也能执行处理函数（只对安装线程生效）
+    static char altStack[64 * 1024];
+    stack_t ss;
+    memset(&ss, 0, sizeof(ss));
+    ss.ss_sp = altStack;
+    ss.ss_size = sizeof(altStack);
+    sigaltstack(&ss, nullptr);
+
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = onCrashSignal;
+    sa.sa_flags = SA_ONSTACK;
+    sigemptyset(&sa.sa_mask);
+    for (size_t i = 0; i < sizeof(kCrashSignals) / sizeof(kCrashSignals[0]); ++i)
+        sigaction(kCrashSignals[i], &sa, nullptr);
+}
@@ -0,0 +1,140 @@
+#ifndef FLIGHT_RECORDER_H
+#define FLIGHT_RECORDER_H
+
+#include <QThread>
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+struct DetectionResult;
+
+// 黑匣子记录的事件类型
+enum FlightEventType
+{
+    FlightDetection = 1,   // 推理结果（最优目标）
+    FlightCommand,         // 下发的指令（单字符或帧协议目标变化）
+    FlightSetpoint,        // 帧协议控制环：滤波目标与斜坡输出
+    FlightMark             // 触发转储等标记
+};
+
+// 转储触发原因
+enum FlightTrigger
+{
+    TriggerManual = 1,
+    TriggerStop,           // 手动停止
+    TriggerWatchdog,       // 设定值超时/界面卡顿等看门狗事件
+    TriggerCrash           // 致命信号
+};
+
+// 定长事件记录（POD，转储文件中按此布局原样写出）
+struct FlightEvent
+{
+    uint64_t seq;          // 槽位序号（奇数表示正在写入），转储时用于检测被覆盖的槽位
+    int64_t tNs;           // 事件时刻（CLOCK_MONOTONIC）
+    int64_t tCaptureNs;    // 关联帧的采集时刻
+    uint32_t frameId;      // 关联帧号（0表示无）
+    uint8_t type;          // FlightEventType
+    uint8_t source;        // CommandSource
+    char cmd;              // 指令字符
+    uint8_t uartSeq;       // 帧协议序号
+    int32_t classId;
+    float confidence;
+    int16_t box[4];        // x, y, width, height
+    float value[4];        // FlightSetpoint：滤波线速度/角速度、斜坡线速度/角速度；FlightMark：[0]为触发原因
+};
+
+// 帧槽位头部，后接length字节的原始MJPEG数据
+struct FlightFrameHeader
+{
+    uint64_t seq;
+    int64_t tCaptureNs;
+    uint32_t frameId;
+    uint32_t length;
+};
+
+// 转储文件：FlightDumpHeader | eventCount个FlightEvent（按时间先后）| frameCount个（FlightFrameHeader + JPEG）
+struct FlightDumpHeader
+{
+    char magic[8];         // "WCFLIGHT"
+    uint32_t version;
+    uint32_t reason;       // FlightTrigger
+    int64_t tDumpNs;       // CLOCK_MONOTONIC
+    int64_t tDumpRealtimeSec;
+    uint32_t eventCount;
+    uint32_t frameCount;
+    uint32_t eventSize;
+    uint32_t frameSlotBytes;
+};
+
+// 飞行记录仪（黑匣子）：最近N秒的原始MJPEG帧、检测结果、滤波/斜坡状态与串口指令。
+// - 全部内存在构造时一次性分配并预先触页，记录路径只做memcpy与原子操作，不分配、不加锁、不阻塞
+// - 事件环多生产者（推理线程/控制分发线程/采集），帧环单生产者（采集）；每个槽位带序号，
+//   转储与写入并发时，被覆盖的槽位直接跳过
+// - 手动、停止、看门狗触发时由本线程延迟dumpDelayMs后转储（包含触发后的现场）；
+//   致命信号在信号处理函数内同步转储（只用异步信号安全的系统调用）
+// - 转储先写临时文件并fsync，再rename，不会留下不完整的文件
+class FlightRecorder : public QThread
+{
+    Q_OBJECT
+public:
+    // budgetBytes为帧环与事件环的总预算，frameSlotBytes为单帧上限（超出的帧不记录）
+    FlightRecorder(size_t budgetBytes, size_t frameSlotBytes, const char *dumpDir, QObject *parent = nullptr);
+    ~FlightRecorder();
+
+    bool isEnabled() const { return frameSlots > 0; }
+
+    // 记录接口：任意线程调用（recordFrame只允许采集线程调用）
+    void recordFrame(uint32_t frameId, int64_t tCaptureNs, const void *jpeg, size_t length);
+    void recordDetection(const DetectionResult &result);
+    void recordCommand(char cmd, int source, uint32_t frameId, int64_t tCaptureNs, uint8_t uartSeq);
+    void recordSetpoint(float filterLinear, float filterAngular, float rampLinear, float rampAngular);
+
+    // 任意线程调用：请求一次转储（同一原因在minDumpIntervalMs内只转储一次）
+    void trigger(FlightTrigger reason);
+    void stop();
+
+    // 安装SIGSEGV/SIGBUS/SIGFPE/SIGILL/SIGABRT处理：崩溃时转储后按默认行为退出
+    void installCrashHandler();
+
+    size_t frameCapacity() const { return frameSlots; }
+    size_t eventCapacity() const { return eventSlots; }
+    uint64_t dumpsWritten() const { return dumps.load(std::memory_order_relaxed); }
+    uint64_t framesTooLarge() const { return oversized.load(std::memory_order_relaxed); }
+
+    int dumpDelayMs {1000};
+    int minDumpIntervalMs {5000};
+
+protected:
+    void run() override;
+
+private:
+    FlightEvent *nextEvent(uint64_t &index);
+    void commitEvent(FlightEvent *ev, uint64_t index);
+    // 异步信号安全：只用open/write/pwrite/fsync/rename/clock_gettime，scratch为预分配缓冲
+    bool dump(FlightTrigger reason, char *scratch);
+    static void onCrashSignal(int sig);
+
+    char *arena;
+    size_t arenaBytes;
+    FlightEvent *events;
+    size_t eventSlots;
+    char *frames;
+    size_t frameSlots;
+    size_t frameSlotBytes;
+    char *scratch;          // 转储线程使用
+    char *crashScratch;     // 信号处理函数使用
+    char dumpDir[256];
+
+    std::atomic<uint64_t> eventIndex;
+    uint64_t frameIndex;    // 只由采集线程写
+    std::atomic<uint64_t> frameCommitted;
+
+    int wakeFd;
+    std::atomic<bool> running;
+    std::atomic<int> pendingReason;
+    int64_t lastDumpNs[TriggerCrash + 1];
+    std::atomic<uint64_t> dumps;
+    std::atomic<uint64_t> oversized;
+};
+
+#endif // FLIGHT_RECORDER_H
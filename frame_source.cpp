@@ -0,0 +1,110 @@
+#include "frame_source.h"
+#include "inference.h"
+#include "pipeline_clock.h"
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/highgui.hpp>
+
+CameraSource::CameraSource(int preferredIndex, bool rawMjpeg)
+    : preferredIndex(preferredIndex)
+    , index(-1)
+    , wantRaw(rawMjpeg)
+    , raw(false)
+    , nextFrameId(0)
+{
+}
+
+bool CameraSource::open()
+{
+    cap.release();
+    index = preferredIndex;
+
+    // 尝试打开摄像头
+    cap.open(index, cv::CAP_V4L2);
+    // 备用索引
+    if (!cap.isOpened()) {
+        index = (preferredIndex == 1) ? 0 : 1;
+        cap.open(index);
+    }
+    if (!cap.isOpened()) {
+        return false;
+    }
+
+    // 摄像头参数设置
+    cap.set(cv::CAP_PROP_FOURCC, cv::VideoWriter::fourcc('M', 'J', 'P', 'G'));
+    cap.set(cv::CAP_PROP_FRAME_WIDTH, MODEL_INPUT_SIZE);
+    cap.set(cv::CAP_PROP_FRAME_HEIGHT, MODEL_INPUT_SIZE * 3 / 4); // 4:3比例
+    cap.set(cv::CAP_PROP_FPS, 10);
+    cap.set(cv::CAP_PROP_BUFFERSIZE, 1);
+    cap.set(cv::CAP_PROP_AUTO_EXPOSURE, 0);
+    cap.set(cv::CAP_PROP_AUTOFOCUS, 0);
+    // 原始MJPEG采集：解码由本类完成（与OpenCV内部解码开销相同），截图/黑匣子可直接使用原始JPEG
+    raw = wantRaw && cap.set(cv::CAP_PROP_CONVERT_RGB, 0);
+    nextFrameId = 0;
+    return true;
+}
+
+void CameraSource::release()
+{
+    cap.release();
+}
+
+cv::Size CameraSource::frameSize()
+{
+    return cv::Size(static_cast<int>(cap.get(cv::CAP_PROP_FRAME_WIDTH)),
+                    static_cast<int>(cap.get(cv::CAP_PROP_FRAME_HEIGHT)));
+}
+
+std::string CameraSource::description() const
+{
+    return "camera " + std::to_string(index) + (raw ? " (raw MJPEG)" : "");
+}
+
+int64_t CameraSource::bufferTimestampNs()
+{
+    int64_t now = monotonicNowNs();
+    // V4L2后端的POS_MSEC是驱动填写的缓冲区时间戳（CLOCK_MONOTONIC），比read()返回时刻更接近曝光时刻；
+    // 驱动不提供或时钟源不一致（与当前时刻相差超过1秒）时退回read()返回时刻
+    double ms = cap.get(cv::CAP_PROP_POS_MSEC);
+    int64_t bufferNs = static_cast<int64_t>(ms * 1000000.0);
+    if (bufferNs > 0 && bufferNs <= now && now - bufferNs < 1000000000LL)
+        return bufferNs;
+    return now;
+}
+
+bool CameraSource::read(CapturedFrame &frame)
+{
+    if (!cap.isOpened())
+        return false;
+
+    cv::Mat image;
+    bool readSuccess = false;
+    // 重试读取帧（避免丢帧）
+    for (int i = 0; i < 3; i++) {
+        if (cap.read(image)) {
+            readSuccess = true;
+            break;
+        }
+        cv::waitKey(1);
+    }
+    if (!readSuccess)
+        return false;
+
+    frame.captureNs = bufferTimestampNs();
+    frame.jpeg.release();
+    if (raw) {
+        if (image.rows == 1 && image.type() == CV_8UC1) {
+            frame.jpeg = image;
+            image = cv::imdecode(frame.jpeg, cv::IMREAD_COLOR);
+            if (image.empty())
+                return false;
+        } else {
+            // 驱动没有协商到MJPEG格式（如YUYV），退回OpenCV内部转换，丢弃本帧
+            raw = false;
+            cap.set(cv::CAP_PROP_CONVERT_RGB, 1);
+            return false;
+        }
+    }
+    frame.bgr = image;
+    frame.frameId = ++nextFrameId;
+    return true;
+}
@@ -0,0 +1,62 @@
+#ifndef FRAME_SOURCE_H
+#define FRAME_SOURCE_H
+
+#include <string>
+#include <stdint.h>
+#include <opencv2/core.hpp>
+#include <opencv2/videoio.hpp>
+
+// 一个采集帧：解码后的BGR图像、原始MJPEG（有则非空）、帧号与采集时刻（CLOCK_MONOTONIC）
+struct CapturedFrame
+{
+    cv::Mat bgr;
+    cv::Mat jpeg;
+    uint32_t frameId;
+    int64_t captureNs;
+};
+
+// 采集接口：摄像头与录制回放共用，流水线只依赖这一层
+class FrameSource
+{
+public:
+    virtual ~FrameSource() {}
+
+    virtual bool open() = 0;
+    virtual void release() = 0;
+    virtual bool isOpened() const = 0;
+    // 读取下一帧；返回false表示本次没有帧（读失败、解码失败或已到末尾，用atEnd()区分）
+    virtual bool read(CapturedFrame &frame) = 0;
+    // 有限长度的来源（回放）读完后返回true
+    virtual bool atEnd() const { return false; }
+    virtual std::string description() const = 0;
+};
+
+// V4L2摄像头：MJPEG格式，优先原始MJPEG采集并自行解码；时间戳取驱动的缓冲区时间戳
+class CameraSource : public FrameSource
+{
+public:
+    CameraSource(int preferredIndex, bool rawMjpeg);
+
+    // 先以V4L2打开preferredIndex，失败再尝试备用索引（0/1互换）
+    bool open() override;
+    void release() override;
+    bool isOpened() const override { return cap.isOpened(); }
+    bool read(CapturedFrame &frame) override;
+    std::string description() const override;
+
+    int openedIndex() const { return index; }
+    bool isRawMjpeg() const { return raw; }
+    cv::Size frameSize();
+
+private:
+    int64_t bufferTimestampNs();
+
+    cv::VideoCapture cap;
+    int preferredIndex;
+    int index;
+    bool wantRaw;
+    bool raw;            // 采集端返回未解码的MJPEG，由本类imdecode
+    uint32_t nextFrameId;
+};
+
+#endif // FRAME_SOURCE_H
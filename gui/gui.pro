@@ -0,0 +1,19 @@
+# 图形界面版：流水线核心 + 视频窗口/按钮
+QT       += core gui widgets
+
+CONFIG   += c++11
+
+TARGET = OpenCV_CameraMonitor
+TEMPLATE = app
+
+include(../core.pri)
+include(../opencv.pri)
+
+SOURCES += ../main.cpp\
+           ../mainwindow.cpp \
+           ../video_widget.cpp
+
+HEADERS  += ../mainwindow.h\
+            ../video_widget.h
+
+DEFINES += QT_DEPRECATED_WARNINGS
@@ -0,0 +1,142 @@
+#include "head_tracker.h"
+#include <algorithm>
+#include <cmath>
+
+static float median(std::vector<float> &v)
+{
+    std::nth_element(v.begin(), v.begin() + v.size() / 2, v.end());
+    return v[v.size() / 2];
+}
+
+HeadTracker::HeadTracker()
+    : tracking(false)
+{
+    prevPts.reserve(maxCorners);
+    nextPts.reserve(maxCorners);
+    status.reserve(maxCorners);
+    err.reserve(maxCorners);
+    dxs.reserve(maxCorners);
+    dys.reserve(maxCorners);
+}
+
+void HeadTracker::toGray(const cv::Mat &frame, cv::Mat &gray)
+{
+    if (frame.channels() == 3)
+        cv::cvtColor(frame, gray, cv::COLOR_BGR2GRAY);
+    else
+        frame.copyTo(gray);
+}
+
+bool HeadTracker::seed(const cv::Mat &frame, const cv::Rect &box)
+{
+    reset();
+    if (frame.empty())
+        return false;
+
+    cv::Rect seedBox = box & cv::Rect(0, 0, frame.cols, frame.rows);
+    if (seedBox.width < 8 || seedBox.height < 8)
+        return false;
+
+    toGray(frame, prevGray);
+
+    // 只在检测框内取角点
+    seedMask.create(prevGray.size(), CV_8UC1);
+    seedMask.setTo(cv::Scalar(0));
+    seedMask(seedBox).setTo(cv::Scalar(255));
+    cv::goodFeaturesToTrack(prevGray, prevPts, maxCorners, 0.01, 3, seedMask, 3);
+    if (static_cast<int>(prevPts.size()) < minPoints)
+        return false;
+
+    trackedBox = cv::Rect2f(seedBox);
+    tracking = true;
+    return true;
+}
+
+bool HeadTracker::update(const cv::Mat &frame)
+{
+    if (!tracking || frame.empty())
+        return false;
+
+    toGray(frame, currGray);
+    if (currGray.size() != prevGray.size()) {
+        reset();
+        return false;
+    }
+
+    cv::calcOpticalFlowPyrLK(prevGray, currGray, prevPts, nextPts, status, err,
+                             cv::Size(11, 11), 2);
+
+    dxs.clear();
+    dys.clear();
+    for (size_t i = 0; i < nextPts.size(); ++i) {
+        if (status[i] && err[i] < maxFlowError) {
+            dxs.push_back(nextPts[i].x - prevPts[i].x);
+            dys.push_back(nextPts[i].y - prevPts[i].y);
+        }
+    }
+    if (static_cast<int>(dxs.size()) < minPoints) {
+        reset();
+        return false;
+    }
+
+    // 框的位移取中位数，抵抗个别角点漂移
+    float dx = median(dxs);
+    float dy = median(dys);
+    trackedBox.x += dx;
+    trackedBox.y += dy;
+
+    // 剔除与整体运动不一致的角点，剩下的作为下一帧的起点
+    size_t kept = 0;
+    for (size_t i = 0; i < nextPts.size(); ++i) {
+        if (!status[i] || err[i] >= maxFlowError)
+            continue;
+        float ex = nextPts[i].x - prevPts[i].x - dx;
+        float ey = nextPts[i].y - prevPts[i].y - dy;
+        if (ex * ex + ey * ey <= 9.0f)
+            prevPts[kept++] = nextPts[i];
+    }
+    prevPts.resize(kept);
+
+    // 中心离开画面或存活角点不足均视为跟踪失败
+    cv::Point2f center(trackedBox.x + trackedBox.width * 0.5f, trackedBox.y + trackedBox.height * 0.5f);
+    if (static_cast<int>(kept) < minPoints ||
+        center.x < 0 || center.y < 0 || center.x >= currGray.cols || center.y >= currGray.rows) {
+        reset();
+        return false;
+    }
+
+    cv::swap(prevGray, currGray);
+    return true;
+}
+
+void HeadTracker::reset()
+{
+    tracking = false;
+    prevPts.clear();
+    nextPts.clear();
+}
+
+cv::Rect HeadTracker::box() const
+{
+    return cv::Rect(cvRound(trackedBox.x), cvRound(trackedBox.y),
+                    cvRound(trackedBox.width), cvRound(trackedBox.height));
+}
+
+cv::Rect HeadTracker::inferenceRoi(const cv::Size &frameSize) const
+{
+    if (!tracking)
+        return cv::Rect();
+
+    float w = trackedBox.width * roiScale;
+    float h = trackedBox.height * roiScale;
+    // 保持正方形，避免letterBox后目标被过度压缩
+    float side = std::max(std::max(w, h), static_cast<float>(minRoiSize));
+    float cx = trackedBox.x + trackedBox.width * 0.5f;
+    float cy = trackedBox.y + trackedBox.height * 0.5f;
+
+    cv::Rect roi(cvRound(cx - side * 0.5f), cvRound(cy - side * 0.5f), cvRound(side), cvRound(side));
+    roi &= cv::Rect(0, 0, frameSize.width, frameSize.height);
+    if (roi.width < minRoiSize || roi.height < minRoiSize)
+        return cv::Rect();
+    return roi;
+}
@@ -0,0 +1,51 @@
+#ifndef HEAD_TRACKER_H
+#define HEAD_TRACKER_H
+
+#include <vector>
+#include <opencv2/imgproc.hpp>
+#include <opencv2/video/tracking.hpp>
+
+// 推理间隔内的头部跟踪器：
+// 每次检测结果作为种子，在检测框内取角点，之后每个采集帧用金字塔LK光流传播检测框。
+// 所有缓冲区为成员变量并复用，逐帧调用不产生额外的内存分配（128x96灰度图上约1ms）。
+class HeadTracker
+{
+public:
+    HeadTracker();
+
+    // 用检测框（帧坐标）重新初始化跟踪，返回false表示框内可跟踪的角点不足
+    bool seed(const cv::Mat &frame, const cv::Rect &box);
+    // 每个采集帧调用一次，返回false表示跟踪失败（此后isTracking()为false）
+    bool update(const cv::Mat &frame);
+    void reset();
+
+    bool isTracking() const { return tracking; }
+    cv::Rect box() const;
+    // 下一次推理使用的ROI：跟踪框按roiScale向外扩展并裁剪到帧内
+    cv::Rect inferenceRoi(const cv::Size &frameSize) const;
+
+private:
+    void toGray(const cv::Mat &frame, cv::Mat &gray);
+
+    cv::Mat prevGray;
+    cv::Mat currGray;
+    cv::Mat seedMask;
+    std::vector<cv::Point2f> prevPts;
+    std::vector<cv::Point2f> nextPts;
+    std::vector<uchar> status;
+    std::vector<float> err;
+    std::vector<float> dxs;
+    std::vector<float> dys;
+
+    cv::Rect2f trackedBox;
+    bool tracking;
+
+    // 跟踪参数（针对128x96的小分辨率输入）
+    int   maxCorners      {30};
+    int   minPoints       {6};     // 存活角点少于该值判定为跟踪失败
+    float maxFlowError    {20.0f}; // LK匹配误差上限
+    float roiScale        {1.6f};  // 推理ROI相对跟踪框的放大倍数
+    int   minRoiSize      {48};    // 推理ROI最小边长，过小的ROI直接退化为整帧
+};
+
+#endif // HEAD_TRACKER_H
@@ -0,0 +1,15 @@
+# 无界面版：只链接QtCore，SIGINT/SIGTERM正常退出，适合systemd托管
+QT       = core
+
+CONFIG   += console c++11
+CONFIG   -= app_bundle
+
+TARGET = OpenCV_CameraMonitor_headless
+TEMPLATE = app
+
+include(../core.pri)
+include(../opencv.pri)
+
+SOURCES += headless_main.cpp
+
+DEFINES += QT_DEPRECATED_WARNINGS
@@ -0,0 +1,14 @@
+// 无界面版入口：只链接QtCore，部署到不带显示屏的板子上
+#include "headless_runner.h"
+#include "auto_tuner.h"
+
+int main(int argc, char *argv[])
+{
+    AppConfig config = AppConfig::fromEnvironment();
+    if (!parseCommandLine(argc, argv, config))
+        return 2;
+    if (!config.tuneFramesPath.empty())
+        return runAutoTune(config);
+    tuneOnFirstBoot(argc, argv, config);
+    return runHeadless(argc, argv, config);
+}
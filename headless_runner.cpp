@@ -0,0 +1,63 @@
+#include "headless_runner.h"
+#include "pipeline.h"
+#include <QCoreApplication>
+#include <QSocketNotifier>
+#include <QTimer>
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+
+static int quitFd = -1;
+
+// 信号处理函数里只写eventfd（异步信号安全），退出在事件循环中完成
+static void onQuitSignal(int)
+{
+    uint64_t one = 1;
+    if (write(quitFd, &one, sizeof(one)) != sizeof(one)) {
+    }
+}
+
+bool parseCommandLine(int argc, char *argv[], AppConfig &config)
+{
+    std::vector<std::string> arguments(argv, argv + argc);
+    std::string error;
+    if (!config.applyArguments(arguments, error)) {
+        fprintf(stderr, "%s\n用法: %s [--headless] [--log 类别=级别,...] [--tune <黑匣子转储>] [--replay <黑匣子转储> [--replay-mode lockstep|realtime|fast] [--uart-out <文件或pty>] [--exit-on-end]]\n",
+                error.c_str(), argv[0]);
+        return false;
+    }
+    return true;
+}
+
+int runHeadless(int argc, char *argv[], const AppConfig &config)
+{
+    QCoreApplication app(argc, argv);
+
+    quitFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = onQuitSignal;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGINT, &sa, nullptr);
+    sigaction(SIGTERM, &sa, nullptr);
+    QSocketNotifier quitNotifier(quitFd, QSocketNotifier::Read);
+    QObject::connect(&quitNotifier, SIGNAL(activated(int)), &app, SLOT(quit()));
+
+    int status;
+    {
+        Pipeline pipeline(config);
+        if (!pipeline.isYoloInit())
+            fprintf(stderr, "【无界面】YOLO模型加载失败，仅采集与手动控制\n");
+        // 摄像头打不开时直接退出，由systemd等外部守护负责重启
+        QObject::connect(&pipeline, &Pipeline::openFailed, [&app](const QString &message) {
+            fprintf(stderr, "【无界面】%s\n", message.toLocal8Bit().constData());
+            app.exit(1);
+        });
+        QTimer::singleShot(0, &pipeline, &Pipeline::start);
+        status = app.exec();
+    }
+    close(quitFd);
+    return status;
+}
@@ -0,0 +1,14 @@
+#ifndef HEADLESS_RUNNER_H
+#define HEADLESS_RUNNER_H
+
+#include "app_config.h"
+
+// 命令行参数叠加到config上；出错时打印用法并返回false
+bool parseCommandLine(int argc, char *argv[], AppConfig &config);
+
+// 无界面运行：QCoreApplication + 流水线，不加载QtWidgets/平台插件，无绘制开销。
+// SIGINT/SIGTERM时正常退出（停线程、收尾录制段、关串口），便于systemd管理。
+// 返回进程退出码（摄像头打不开时为1）。
+int runHeadless(int argc, char *argv[], const AppConfig &config);
+
+#endif // HEADLESS_RUNNER_H
@@ -0,0 +1,198 @@
+#ifndef INFER_THREAD_H
+#define INFER_THREAD_H
+
+#include <QThread>
+#include <QMutex>
+#include <atomic>
+#include <opencv2/core.hpp>
+#include <string.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include "inference.h"
+#include "seqlock.h"
+#include "overlay_box.h"
+#include "control_dispatcher.h"
+#include "flight_recorder.h"
+#include "session_recorder.h"
+
+// 推理线程类
+// 结果通过SeqLock发布（定长POD整体拷贝），再写eventfd唤醒主线程（流水线所在的事件循环）的QSocketNotifier，
+// 全程不经过Qt的排队信号，也不做任何堆分配
+class YoloInferThread : public QThread
+{
+    Q_OBJECT
+public:
+    YoloInferThread(const std::string& onnxPath, const InferenceConfig& config, QObject *parent = nullptr)
+        : QThread(parent), onnxModelPath(onnxPath), running(false), newFrameAvailable(false), inputFrameId(0),
+          inputCaptureNs(0), isInitSuccess(false), yoloInfer(nullptr) {
+        resultFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        // 输入尺寸/后端/线程数等来自配置（默认即MODEL_INPUT_SIZE、opencv单线程）
+        try {
+            yoloInfer = new Inference(onnxModelPath, config);
+            // 界面和控制只使用最优目标，走top-1快速路径
+            yoloInfer->setBestOnly(true);
+            isInitSuccess = true;
+        } catch (...) {
+            isInitSuccess = false;
+        }
+    }
+
+    ~YoloInferThread() {
+        stop();
+        if (yoloInfer) {
+            yoloInfer->release();
+            delete yoloInfer;
+        }
+        if (resultFd >= 0) {
+            close(resultFd);
+        }
+    }
+
+    // roi非空时只对该区域推理（由跟踪框给出），检测框会映射回整帧坐标；headBox为跟踪框本身（face引擎找不到人脸时用）
+    // frameId/captureNs随结果一路传到控制分发线程，用于把串口指令关联回产生它的帧
+    void setFrame(const cv::Mat& frame, const cv::Rect& roi, const cv::Rect& headBox, uint32_t frameId, int64_t captureNs) {
+        QMutexLocker locker(&mutex);
+        inputFrame = frame.clone();
+        inputRoi = roi & cv::Rect(0, 0, frame.cols, frame.rows);
+        inputHeadBox = headBox;
+        inputFrameId = frameId;
+        inputCaptureNs = captureNs;
+        if (newFrameAvailable) {
+            // 上一帧还没被推理线程取走就被覆盖
+            superseded.fetch_add(1, std::memory_order_relaxed);
+        }
+        newFrameAvailable = true;
+    }
+
+    void stop() {
+        running = false;
+        wait();
+    }
+
+    bool isInit() const { return isInitSuccess; }
+    const char *backendName() const { return yoloInfer ? yoloInfer->backendName() : "none"; }
+    bool isCascade() const { return yoloInfer && yoloInfer->isCascade(); }
+    // 级联统计（任意线程可调用；未级联时全为0）
+    CascadeStats cascadeStats() const { return yoloInfer ? yoloInfer->cascadeStats() : CascadeStats(); }
+    // 送入推理后未被处理即被新帧覆盖的帧数
+    uint64_t supersededFrames() const { return superseded.load(std::memory_order_relaxed); }
+
+    // 须在start()前设置：结果产生后首先投递给控制分发线程
+    void setControlDispatcher(ControlDispatcher *d) { dispatcher = d; }
+    void setFlightRecorder(FlightRecorder *r) { recorder = r; }
+    void setSessionRecorder(SessionRecorder *r) { session = r; }
+
+    // 结果就绪时可读的eventfd（交给QSocketNotifier监听）
+    int resultNotifyFd() const { return resultFd; }
+    // 清空eventfd计数并取出最新结果；没有新结果时返回false
+    bool takeResult(DetectionResult& out) {
+        uint64_t n;
+        while (read(resultFd, &n, sizeof(n)) == sizeof(n)) {
+        }
+        unsigned seq = latestResult.sequence();
+        if (seq == takenSeq) {
+            return false;
+        }
+        takenSeq = seq;
+        return latestResult.load(out);
+    }
+
+    // 最近一次检测结果的叠加层状态（推理线程写，显示控件无锁读取）
+    const SeqLock<OverlayBox> *overlayState() const { return &overlay; }
+
+protected:
+    void run() override {
+        running = true;
+        cv::Mat frame;
+        cv::Rect roi;
+        cv::Rect headBox;
+        while (running) {
+            bool hasFrame = false;
+            {
+                // 只在取帧时持锁，推理期间setFrame()不会阻塞采集线程
+                QMutexLocker locker(&mutex);
+                if (newFrameAvailable) {
+                    frame = inputFrame;
+                    roi = inputRoi;
+                    headBox = inputHeadBox;
+                    result.frame_id = inputFrameId;
+                    result.t_capture_ns = inputCaptureNs;
+                    newFrameAvailable = false;
+                    hasFrame = true;
+                }
+            }
+            if (hasFrame) {
+                result.count = 0;
+                if (yoloInfer) {
+                    if (roi.area() > 0) {
+                        yoloInfer->runInference(frame(roi), result, headBox - roi.tl());
+                        for (int i = 0; i < result.count; ++i) {
+                            result.detections[i].box.x += roi.x;
+                            result.detections[i].box.y += roi.y;
+                        }
+                    } else {
+                        yoloInfer->runInference(frame, result, headBox);
+                    }
+                }
+                if (dispatcher) {
+                    dispatcher->postResult(result);
+                }
+                if (recorder) {
+                    recorder->recordDetection(result);
+                }
+                if (session) {
+                    session->recordDetection(result);
+                }
+                latestResult.store(result);
+                publishOverlay(result);
+                uint64_t one = 1;
+                if (write(resultFd, &one, sizeof(one)) != sizeof(one)) {
+                    // 计数溢出才会失败，GUI端下次读取时仍能拿到最新结果
+                }
+            }
+            msleep(20);
+        }
+    }
+
+private:
+    void publishOverlay(const DetectionResult& res) {
+        OverlayBox box;
+        memset(&box, 0, sizeof(box));
+        box.classId = -1;
+        const Detection *best = res.best();
+        if (best) {
+            box.x = best->box.x;
+            box.y = best->box.y;
+            box.width = best->box.width;
+            box.height = best->box.height;
+            box.classId = best->class_id;
+            box.confidence = best->confidence;
+            strncpy(box.label, Inference::getClassName(best->class_id), sizeof(box.label) - 1);
+        }
+        box.stampMs = overlayClockMs();
+        overlay.store(box);
+    }
+
+    std::string onnxModelPath;
+    bool running;
+    QMutex mutex;
+    cv::Mat inputFrame;
+    cv::Rect inputRoi;
+    cv::Rect inputHeadBox;
+    bool newFrameAvailable;
+    uint32_t inputFrameId;
+    int64_t inputCaptureNs;
+    std::atomic<uint64_t> superseded {0};
+    bool isInitSuccess;
+    Inference *yoloInfer;
+    ControlDispatcher *dispatcher {nullptr};
+    FlightRecorder *recorder {nullptr};
+    SessionRecorder *session {nullptr};
+    DetectionResult result;               // 推理线程内复用
+    SeqLock<DetectionResult> latestResult;
+    unsigned takenSeq {0};                // GUI线程已取走的结果序号
+    int resultFd;
+    SeqLock<OverlayBox> overlay;
+};
+
+#endif // INFER_THREAD_H
@@ -1,20 +1,31 @@
 #include "inference.h"
-#include <chrono>   // 仅新增：计时（和你原始输出格式一致）
-#include <cmath>    // 仅新增：sigmoid函数（修复置信度）
-
-// 仅新增：sigmoid函数（YOLO logits转0~1概率，核心修复）
-static float sigmoid(float x) {
-    return 1.0f / (1.0f + expf(-x));
-}
+#include "pipeline_clock.h"
+#include "async_logger.h"
+#include <stdexcept>
 
 Inference::Inference(const std::string &onnxModelPath, const cv::Size &modelInputShape,
-                     const std::string &classesTxtFile, const bool &runWithCuda)
+                     const std::string &classesTxtFile, const bool &runWithCuda, const std::string &backendName)
 {
+    // 类别表固定为头部姿态5类（见kClassNames），classesTxtFile保留仅为兼容旧接口
+    (void)classesTxtFile;
     modelPath = onnxModelPath;
     modelShape = modelInputShape;
-    classesPath = classesTxtFile;
     cudaEnabled = runWithCuda;
-    loadOnnxNetwork();
+    loadBackend(backendName, InferenceBackendOptions());
+}
+
+Inference::Inference(const std::string &onnxModelPath, const InferenceConfig &config)
+{
+    cudaEnabled = false;
+    letterBoxForSquare = config.letterBox;
+    // face引擎的级联分类器或姿态分类器加载不了时退回yolo，与后端加载失败退回OpenCV DNN同理
+    if (config.engine == "face" && loadFaceEngine(config))
+        return;
+    modelPath = onnxModelPath;
+    modelShape = cv::Size(config.inputSize, config.inputSize);
+    loadBackend(config.backend, config.backendOptions);
+    if (!config.gateModelPath.empty())
+        loadGate(config);
 }
 
 Inference::~Inference()
@@ -24,201 +35,503 @@ Inference::~Inference()
 
 void Inference::release()
 {
-    // 保留你原始的释放逻辑
-    if (!net.empty()) {
-        net = cv::dnn::Net();
+    if (gate) {
+        gate->release();
+        delete gate;
+        gate = nullptr;
+    }
+    if (backend) {
+        backend->release();
+        delete backend;
+        backend = nullptr;
     }
 }
 
-std::string Inference::getClassName(int classId)
+// 头部姿态类别表（保留你原始的类别顺序）
+static const char *const kClassNames[NUM_CLASSES] = {"front", "left", "up", "right", "down"};
+
+const char *Inference::getClassName(int classId)
 {
-    // 保留你原始的类别获取逻辑
-    if (classId >= 0 && static_cast<size_t>(classId) < classes.size()) {
-        return classes[classId];
+    if (classId >= 0 && classId < NUM_CLASSES) {
+        return kClassNames[classId];
     }
     return "unknown";
 }
 
-std::vector<Detection> Inference::runInference(const cv::Mat &input)
+// 类别logits取argmax；sigmoid单调，只需对最大值做一次sigmoid
+static int argmaxClass(const float *scores, float &maxLogit)
+{
+    int best = 0;
+    maxLogit = scores[0];
+    for (int c = 1; c < NUM_CLASSES; c++) {
+        if (scores[c] > maxLogit) {
+            maxLogit = scores[c];
+            best = c;
+        }
+    }
+    return best;
+}
+
+bool Inference::runInference(const cv::Mat &input, DetectionResult &result, const cv::Rect &headHint)
 {
-    // 仅新增：计时开始（和你原始输出格式一致）
-    auto start = std::chrono::steady_clock::now();
+    result.count = 0;
+    result.t_infer_start_ns = monotonicNowNs();
+    result.t_infer_end_ns = result.t_infer_start_ns;
 
-    if (input.empty() || net.empty()) {
-        return {};
+    if (input.empty() || !backend) {
+        return false;
     }
+    if (faceEngine)
+        return runFaceInference(input, headHint, result);
 
     cv::Mat modelInput = input;
     // 保留你原始的letterBox逻辑
     if (letterBoxForSquare && modelShape.width == modelShape.height)
         modelInput = formatToSquare(modelInput);
 
-    // 保留你原始的blob生成逻辑
-    cv::Mat blob;
+    // 保留你原始的blob生成逻辑（直接写入后端的输入张量）
+    makeInputBlob(modelInput, modelShape, backend->inputTensor());
+
+    // 级联：门控结果可信时直接返回；每gateAuditInterval次采用抽查一次完整模型，抽查帧输出完整模型的结果
+    bool audit = false;
+    int gateClass = -1;
+    int64_t fullStartNs = result.t_infer_start_ns;
+    if (gate) {
+        bool accepted = runGate(modelInput.size(), result);
+        fullStartNs = monotonicNowNs();
+        cascadeGateNs.fetch_add(fullStartNs - result.t_infer_start_ns, std::memory_order_relaxed);
+        cascadeFrames.fetch_add(1, std::memory_order_relaxed);
+        if (accepted) {
+            uint64_t n = cascadeAccepted.fetch_add(1, std::memory_order_relaxed) + 1;
+            audit = gateAuditInterval > 0 && n % gateAuditInterval == 0;
+            if (!audit) {
+                result.t_infer_end_ns = fullStartNs;
+                return true;
+            }
+            gateClass = result.detections[0].class_id;
+        }
+        result.count = 0;
+    }
+
+    if (!backend->run()) {
+        result.t_infer_end_ns = monotonicNowNs();
+        return false;
+    }
+
+    decodeYoloOutput(backend->outputTensor(0), modelInput.size(), modelShape, thresholds, bestOnly, transposed, candidates);
+
+    if (bestOnly)
+    {
+        // 单目标无需NMS，与NMS后的首个结果一致
+        if (candidates.size() > 0)
+        {
+            result.detections[0].class_id = candidates.classIds[0];
+            result.detections[0].confidence = candidates.confidences[0];
+            result.detections[0].box = candidates.boxes[0];
+            result.count = 1;
+        }
+    }
+    else
+    {
+        selectDetections(candidates, thresholds, nms_result, result);
+    }
+    result.t_infer_end_ns = monotonicNowNs();
+
+    if (gate) {
+        int64_t fullNs = result.t_infer_end_ns - fullStartNs;
+        if (audit) {
+            const Detection *best = result.best();
+            cascadeAuditNs.fetch_add(fullNs, std::memory_order_relaxed);
+            cascadeAudited.fetch_add(1, std::memory_order_relaxed);
+            if (!best || best->class_id != gateClass)
+                cascadeDisagreed.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            cascadeFullNs.fetch_add(fullNs, std::memory_order_relaxed);
+        }
+    }
+
+    // 每帧耗时只在debug级别输出（默认关闭，日志点开销只有一次级别比较）
+    LOG_DEBUG(LogInfer, "[YOLO] 推理耗时: %.1f ms (输入尺寸 %dx%d)",
+              (result.t_infer_end_ns - result.t_infer_start_ns) / 1e6, static_cast<int>(modelShape.width),
+              static_cast<int>(modelShape.height));
+
+    return true;
+}
+
+void Inference::loadGate(const InferenceConfig &config)
+{
+    gateShape = cv::Size(config.gateInputSize, config.gateInputSize);
+    gateMargin = config.gateMargin;
+    gateAuditInterval = config.gateAuditInterval;
+    // 门控与完整模型用同一种后端；失败时不退回，直接关闭级联（完整模型照常工作）
+    std::string error;
+    gate = createInferenceBackend(config.backend);
+    if (!gate)
+        gate = createInferenceBackend("opencv");
+    if (!gate->load(config.gateModelPath, cv::Size(config.gateInputSize, config.gateInputSize), config.backendOptions,
+                    error)) {
+        LOG_WARN(LogInfer, "门控模型%s加载失败（%s），不启用级联", config.gateModelPath, error);
+        delete gate;
+        gate = nullptr;
+        return;
+    }
+    LOG_INFO(LogInfer, "两级级联：门控模型%s（%s，%dx%d），类别间隔≥%.2f时采用，每%d次抽查完整模型",
+             config.gateModelPath, gate->name(), config.gateInputSize, config.gateInputSize, gateMargin,
+             gateAuditInterval);
+}
+
+bool Inference::runGate(const cv::Size &inputSize, DetectionResult &result)
+{
+    // 门控输入取自完整模型的blob（letterBox、颜色转换、归一化只做一次）：同尺寸直接共用内存，否则逐通道缩小
+    const cv::Mat &blob = backend->inputTensor();
+    cv::Mat &gateBlob = gate->inputTensor();
+    int gateW = static_cast<int>(gateShape.width);
+    int gateH = static_cast<int>(gateShape.height);
+    if (blob.size[2] == gateH && blob.size[3] == gateW) {
+        gateBlob = blob;
+    } else {
+        int sizes[4] = {1, blob.size[1], gateH, gateW};
+        gateBlob.create(4, sizes, CV_32F);
+        for (int c = 0; c < blob.size[1]; ++c) {
+            cv::Mat src(blob.size[2], blob.size[3], CV_32F, const_cast<float *>(blob.ptr<float>(0, c)));
+            cv::Mat dst(gateH, gateW, CV_32F, gateBlob.ptr<float>(0, c));
+            cv::resize(src, dst, dst.size(), 0, 0, cv::INTER_AREA);
+        }
+    }
+    if (!gate->run())
+        return false;
+
+    const cv::Mat &output = gate->outputTensor(0);
+    decodeYoloOutput(output, inputSize, gateShape, thresholds, true, gateTransposed, gateCandidates);
+    // 门控没有看到头部时也交给完整模型确认
+    if (gateCandidates.size() == 0 || yoloBestClassMargin(output, gateTransposed) < gateMargin)
+        return false;
+    result.detections[0].class_id = gateCandidates.classIds[0];
+    result.detections[0].confidence = gateCandidates.confidences[0];
+    result.detections[0].box = gateCandidates.boxes[0];
+    result.count = 1;
+    return true;
+}
+
+bool Inference::loadFaceEngine(const InferenceConfig &config)
+{
+    if (config.faceModelPath.empty()) {
+        LOG_WARN(LogInfer, "face引擎未指定姿态分类器模型，使用YOLO");
+        return false;
+    }
+    if (!faceCascade.load(config.faceCascadePath)) {
+        LOG_WARN(LogInfer, "人脸级联分类器%s加载失败，使用YOLO", config.faceCascadePath);
+        return false;
+    }
+    faceEngine = true;
+    faceCropScale = config.faceCropScale;
+    modelPath = config.faceModelPath;
+    modelShape = cv::Size(config.faceInputSize, config.faceInputSize);
+    try {
+        loadBackend(config.backend, config.backendOptions);
+    } catch (const std::exception &e) {
+        LOG_WARN(LogInfer, "姿态分类器%s加载失败（%s），使用YOLO", config.faceModelPath, e.what());
+        faceEngine = false;
+        faceCascade = cv::CascadeClassifier();
+        return false;
+    }
+    if (!config.gateModelPath.empty())
+        LOG_WARN(LogInfer, "face引擎不使用两级级联，忽略门控模型");
+    LOG_INFO(LogInfer, "face引擎：%s定位 + %s分类（%dx%d，裁剪%.1f倍）", config.faceCascadePath, config.faceModelPath,
+             config.faceInputSize, config.faceInputSize, faceCropScale);
+    return true;
+}
+
+bool Inference::runFaceInference(const cv::Mat &input, const cv::Rect &headHint, DetectionResult &result)
+{
+    // 定位：LBP人脸检测取面积最大的一个；找不到（侧脸、低头等）时用调用方给出的头部框
+    cv::cvtColor(input, faceGray, cv::COLOR_BGR2GRAY);
+    cv::equalizeHist(faceGray, faceGray);
+    int minFace = std::max(16, std::min(input.cols, input.rows) / 5);
+    faceCascade.detectMultiScale(faceGray, faces, 1.1, 3, 0, cv::Size(minFace, minFace));
+    cv::Rect face = pickFaceBox(faces, headHint, input.size());
+    if (face.area() == 0) {
+        result.t_infer_end_ns = monotonicNowNs();
+        return true;
+    }
+
+    // 对齐：以框中心取正方形、按faceCropScale外扩并归一到分类器输入尺寸（LBP不给关键点，不做旋转校正），
+    // 超出画面的部分复制边缘像素，保证人脸始终居中
+    cv::Rect square = faceCropSquare(face, faceCropScale);
+    cv::Rect inside = square & cv::Rect(0, 0, input.cols, input.rows);
+    cv::copyMakeBorder(input(inside), faceCrop, inside.y - square.y, square.br().y - inside.br().y,
+                       inside.x - square.x, square.br().x - inside.br().x, cv::BORDER_REPLICATE);
+
+    makeInputBlob(faceCrop, modelShape, backend->inputTensor());
+    if (!backend->run() || backend->outputTensor(0).total() < static_cast<size_t>(NUM_CLASSES)) {
+        result.t_infer_end_ns = monotonicNowNs();
+        return false;
+    }
+
+    // 输出已是概率（模型末尾带softmax）时直接使用，否则按logit做softmax
+    const float *out = backend->outputTensor(0).ptr<float>();
+    faceScores.assign(out, out + NUM_CLASSES);
+    int best = normalizeFaceScores(faceScores);
+    // 与YOLO路径相同的类别得分下限
+    if (faceScores[best] > thresholds.score) {
+        result.detections[0].class_id = best;
+        result.detections[0].confidence = faceScores[best];
+        result.detections[0].box = face;
+        result.count = 1;
+    }
+    result.t_infer_end_ns = monotonicNowNs();
+    return true;
+}
+
+CascadeStats Inference::cascadeStats() const
+{
+    CascadeStats s;
+    s.frames = cascadeFrames.load(std::memory_order_relaxed);
+    s.accepted = cascadeAccepted.load(std::memory_order_relaxed);
+    s.audited = cascadeAudited.load(std::memory_order_relaxed);
+    s.disagreed = cascadeDisagreed.load(std::memory_order_relaxed);
+    s.gateNs = cascadeGateNs.load(std::memory_order_relaxed);
+    s.fullNs = cascadeFullNs.load(std::memory_order_relaxed);
+    s.auditNs = cascadeAuditNs.load(std::memory_order_relaxed);
+    return s;
+}
+
+void makeInputBlob(const cv::Mat &modelInput, const cv::Size &modelShape, cv::Mat &blob)
+{
     cv::dnn::blobFromImage(modelInput, blob, 1.0/255.0, modelShape, cv::Scalar(), true, false);
-    net.setInput(blob);
+}
 
-    std::vector<cv::Mat> outputs;
-    net.forward(outputs, net.getUnconnectedOutLayersNames());
+void decodeYoloOutput(const cv::Mat &output, const cv::Size &inputSize, const cv::Size2f &modelShape,
+                      const YoloThresholds &thresholds, bool bestOnly,
+                      cv::Mat &transposed, YoloCandidates &candidates)
+{
+    candidates.clear();
 
-    int rows = outputs[0].size[1];
-    int dimensions = outputs[0].size[2];
+    int rows = output.size[1];
+    int dimensions = output.size[2];
     bool yolov8 = false;
+    const float *data = (const float *)output.data;
 
     // 保留你原始的YOLOv8兼容逻辑
     if (dimensions > rows)
     {
         yolov8 = true;
-        rows = outputs[0].size[2];
-        dimensions = outputs[0].size[1];
-        outputs[0] = outputs[0].reshape(1, dimensions);
-        cv::transpose(outputs[0], outputs[0]);
+        rows = output.size[2];
+        dimensions = output.size[1];
+        cv::transpose(output.reshape(1, dimensions), transposed);
+        data = (const float *)transposed.data;
     }
 
-    float *data = (float *)outputs[0].data;
     // 保留你原始的缩放因子计算
-    float x_factor = modelInput.cols / modelShape.width;
-    float y_factor = modelInput.rows / modelShape.height;
+    float x_factor = inputSize.width / modelShape.width;
+    float y_factor = inputSize.height / modelShape.height;
 
-    std::vector<int> class_ids;
-    std::vector<float> confidences;
-    std::vector<cv::Rect> boxes;
+    int bestClass = -1;
+    float bestScore = 0.0f;
+    cv::Rect bestBox;
 
-    for (int i = 0; i < rows; ++i)
+    for (int i = 0; i < rows; ++i, data += dimensions)
     {
+        int classId;
+        float score;
+        bool clampBox;
+        float maxLogit;
         if (yolov8)
         {
-            // 修复YOLOv8分支：类别得分做sigmoid
-            float *classes_scores = data+4;
-            cv::Mat scores(1, classes.size(), CV_32FC1, classes_scores);
-            // 对每个类别得分做sigmoid（核心修复）
-            for (int c = 0; c < classes.size(); c++) {
-                scores.at<float>(0, c) = sigmoid(scores.at<float>(0, c));
-            }
-            cv::Point class_id;
-            double maxClassScore;
-            minMaxLoc(scores, 0, &maxClassScore, 0, &class_id);
-
-            if (maxClassScore > modelScoreThreshold)
-            {
-                // 置信度直接用类别得分（YOLOv8无单独obj_conf）
-                confidences.push_back(static_cast<float>(maxClassScore));
-                class_ids.push_back(class_id.x);
-
-                float x = data[0];
-                float y = data[1];
-                float w = data[2];
-                float h = data[3];
-
-                int left = int((x - 0.5 * w) * x_factor);
-                int top = int((y - 0.5 * h) * y_factor);
-                int width = int(w * x_factor);
-                int height = int(h * y_factor);
-
-                boxes.push_back(cv::Rect(left, top, width, height));
-            }
+            // YOLOv8无单独obj_conf，置信度直接用类别得分（sigmoid后）
+            classId = argmaxClass(data + 4, maxLogit);
+            score = yoloSigmoid(maxLogit);
+            if (score <= thresholds.score)
+                continue;
+            clampBox = false;
         }
         else
         {
-            // 修复YOLOv5/YOLOv11分支：obj_conf和类别得分都做sigmoid
-            float confidence = sigmoid(data[4]); // obj_conf做sigmoid（核心修复）
-            if (confidence >= modelConfidenceThreshold)
-            {
-                float *classes_scores = data+5;
-                cv::Mat scores(1, classes.size(), CV_32FC1, classes_scores);
-                // 对每个类别得分做sigmoid（核心修复）
-                for (int c = 0; c < classes.size(); c++) {
-                    scores.at<float>(0, c) = sigmoid(scores.at<float>(0, c));
-                }
-                cv::Point class_id;
-                double max_class_score;
-                minMaxLoc(scores, 0, &max_class_score, 0, &class_id);
-
-                if (max_class_score > modelScoreThreshold)
-                {
-                    // 最终置信度=obj_conf×类别得分（0~1，核心修复）
-                    confidences.push_back(confidence * static_cast<float>(max_class_score));
-                    class_ids.push_back(class_id.x);
-
-                    float x = data[0];
-                    float y = data[1];
-                    float w = data[2];
-                    float h = data[3];
-
-                    int left = int((x - 0.5 * w) * x_factor);
-                    int top = int((y - 0.5 * h) * y_factor);
-                    int width = int(w * x_factor);
-                    int height = int(h * y_factor);
-
-                    // 仅新增：边界检查（过滤0/352等异常框）
-                    left = std::max(0, std::min(left, modelInput.cols - 1));
-                    top = std::max(0, std::min(top, modelInput.rows - 1));
-                    width = std::max(5, std::min(width, modelInput.cols - left));
-                    height = std::max(5, std::min(height, modelInput.rows - top));
-
-                    boxes.push_back(cv::Rect(left, top, width, height));
-                }
-            }
+            // YOLOv5/YOLOv11：obj_conf和类别得分都做sigmoid，最终置信度=obj_conf×类别得分
+            float confidence = yoloSigmoid(data[4]);
+            if (confidence < thresholds.confidence)
+                continue;
+            classId = argmaxClass(data + 5, maxLogit);
+            float classScore = yoloSigmoid(maxLogit);
+            if (classScore <= thresholds.score)
+                continue;
+            score = confidence * classScore;
+            clampBox = true;
         }
-        data += dimensions;
-    }
 
-    // 保留你原始的NMS逻辑
-    std::vector<int> nms_result;
-    cv::dnn::NMSBoxes(boxes, confidences, modelScoreThreshold, modelNMSThreshold, nms_result);
+        // 只取最优目标时，分数不超过当前最优的候选连框都不用算
+        if (bestOnly && (score <= bestScore || score <= thresholds.score))
+            continue;
 
-    std::vector<Detection> detections{};
-    for (unsigned long i = 0; i < nms_result.size(); ++i)
-    {
-        int idx = nms_result[i];
-        Detection result;
-        result.class_id = class_ids[idx];
-        result.confidence = confidences[idx]; // 0~1的归一化置信度
+        float x = data[0];
+        float y = data[1];
+        float w = data[2];
+        float h = data[3];
 
-        // 保留你原始的随机颜色逻辑
-        std::random_device rd;
-        std::mt19937 gen(rd());
-        std::uniform_int_distribution<int> dis(100, 255);
-        result.color = cv::Scalar(dis(gen), dis(gen), dis(gen));
+        int left = int((x - 0.5 * w) * x_factor);
+        int top = int((y - 0.5 * h) * y_factor);
+        int width = int(w * x_factor);
+        int height = int(h * y_factor);
+
+        if (clampBox)
+        {
+            // 边界检查（过滤0/352等异常框）
+            left = std::max(0, std::min(left, inputSize.width - 1));
+            top = std::max(0, std::min(top, inputSize.height - 1));
+            width = std::max(5, std::min(width, inputSize.width - left));
+            height = std::max(5, std::min(height, inputSize.height - top));
+        }
 
-        result.className = classes[result.class_id];
-        result.box = boxes[idx];
-        detections.push_back(result);
+        if (bestOnly)
+        {
+            bestClass = classId;
+            bestScore = score;
+            bestBox = cv::Rect(left, top, width, height);
+        }
+        else
+        {
+            candidates.confidences.push_back(score);
+            candidates.classIds.push_back(classId);
+            candidates.boxes.push_back(cv::Rect(left, top, width, height));
+        }
     }
 
-    // 仅新增：计时结束+打印（和你原始输出格式一致）
-    auto end = std::chrono::steady_clock::now();
-    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
-    std::cout << "[YOLO] 推理耗时: " << elapsed << " ms (输入尺寸 " << MODEL_INPUT_SIZE << "x" << MODEL_INPUT_SIZE << ")" << std::endl;
+    if (bestOnly && bestClass >= 0)
+    {
+        candidates.confidences.push_back(bestScore);
+        candidates.classIds.push_back(bestClass);
+        candidates.boxes.push_back(bestBox);
+    }
+}
 
-    outputs.clear();
-    return detections;
+float yoloBestClassMargin(const cv::Mat &output, const cv::Mat &transposed)
+{
+    int rows = output.size[1];
+    int dimensions = output.size[2];
+    const float *data = (const float *)output.data;
+    bool yolov8 = dimensions > rows;
+    if (yolov8) {
+        rows = output.size[2];
+        dimensions = output.size[1];
+        data = (const float *)transposed.data;
+    }
+    int first = yolov8 ? 4 : 5;
+
+    float bestScore = 0.0f;
+    float margin = 0.0f;
+    for (int i = 0; i < rows; ++i, data += dimensions) {
+        const float *scores = data + first;
+        float top1 = scores[0];
+        float top2 = scores[1];
+        if (top2 > top1)
+            std::swap(top1, top2);
+        for (int c = 2; c < NUM_CLASSES; c++) {
+            if (scores[c] > top1) {
+                top2 = top1;
+                top1 = scores[c];
+            } else if (scores[c] > top2) {
+                top2 = scores[c];
+            }
+        }
+        float objectness = yolov8 ? 1.0f : yoloSigmoid(data[4]);
+        float top1Score = yoloSigmoid(top1);
+        float score = objectness * top1Score;
+        if (score > bestScore) {
+            bestScore = score;
+            margin = objectness * (top1Score - yoloSigmoid(top2));
+        }
+    }
+    return margin;
 }
 
-void Inference::loadClassesFromFile()
+int selectDetections(const YoloCandidates &candidates, const YoloThresholds &thresholds,
+                     std::vector<int> &keep, DetectionResult &result)
 {
-    // 保留你原始的加载类别逻辑
-    std::ifstream inputFile(classesPath);
-    if (inputFile.is_open())
+    // 保留你原始的NMS逻辑（结果按置信度降序）
+    keep.clear();
+    cv::dnn::NMSBoxes(candidates.boxes, candidates.confidences, thresholds.score, thresholds.nms, keep);
+
+    int n = std::min(static_cast<int>(keep.size()), MAX_DETECTIONS);
+    for (int i = 0; i < n; ++i)
     {
-        std::string classLine;
-        while (std::getline(inputFile, classLine))
-            classes.push_back(classLine);
-        inputFile.close();
+        int idx = keep[i];
+        result.detections[i].class_id = candidates.classIds[idx];
+        result.detections[i].confidence = candidates.confidences[idx]; // 0~1的归一化置信度
+        result.detections[i].box = candidates.boxes[idx];
+    }
+    result.count = n;
+    return n;
+}
+
+cv::Rect pickFaceBox(const std::vector<cv::Rect> &faces, const cv::Rect &headHint, const cv::Size &frameSize)
+{
+    cv::Rect bounds(0, 0, frameSize.width, frameSize.height);
+    cv::Rect face;
+    for (size_t i = 0; i < faces.size(); ++i) {
+        if (faces[i].area() > face.area())
+            face = faces[i];
     }
+    if (face.area() == 0)
+        face = headHint;
+    return face & bounds;
 }
 
-void Inference::loadOnnxNetwork()
+cv::Rect faceCropSquare(const cv::Rect &face, float scale)
 {
-    net = cv::dnn::readNetFromONNX(modelPath);
-    // 保留你原始的设备选择逻辑（强制CPU，适配i.MX6ULL）
-    std::cout << "\nYOLOv11n 推理模式：CPU (i.MX6ULL适配版) 输入尺寸: " << MODEL_INPUT_SIZE << "x" << MODEL_INPUT_SIZE << std::endl;
-    net.setPreferableBackend(cv::dnn::DNN_BACKEND_OPENCV);
-    net.setPreferableTarget(cv::dnn::DNN_TARGET_CPU);
-    cv::setNumThreads(1); // 仅新增：单线程，适配嵌入式
+    int side = static_cast<int>(std::max(face.width, face.height) * scale + 0.5f);
+    return cv::Rect(face.x + face.width / 2 - side / 2, face.y + face.height / 2 - side / 2, side, side);
+}
+
+int normalizeFaceScores(std::vector<float> &scores)
+{
+    if (scores.empty())
+        return -1;
+    float sum = 0.0f;
+    bool probabilities = true;
+    for (size_t c = 0; c < scores.size(); c++) {
+        probabilities = probabilities && scores[c] >= 0.0f && scores[c] <= 1.0f;
+        sum += scores[c];
+    }
+    if (!probabilities || fabsf(sum - 1.0f) > 1e-3f) {
+        float maxLogit = *std::max_element(scores.begin(), scores.end());
+        sum = 0.0f;
+        for (size_t c = 0; c < scores.size(); c++) {
+            scores[c] = expf(scores[c] - maxLogit);
+            sum += scores[c];
+        }
+        for (size_t c = 0; c < scores.size(); c++)
+            scores[c] /= sum;
+    }
+    return static_cast<int>(std::max_element(scores.begin(), scores.end()) - scores.begin());
+}
+
+void Inference::loadBackend(const std::string &name, const InferenceBackendOptions &options)
+{
+    cv::Size shape(static_cast<int>(modelShape.width), static_cast<int>(modelShape.height));
+    std::string error;
+    backend = createInferenceBackend(name);
+    if (!backend) {
+        LOG_WARN(LogInfer, "推理后端\"%s\"不可用（已编译：%s），使用OpenCV DNN", name, inferenceBackendNames());
+    } else if (!backend->load(modelPath, shape, options, error)) {
+        LOG_WARN(LogInfer, "推理后端%s加载失败（%s），使用OpenCV DNN", backend->name(), error);
+        delete backend;
+        backend = nullptr;
+    }
+    if (!backend) {
+        // 保留你原始的设备选择逻辑（强制CPU，线程数按配置，默认单线程，适配i.MX6ULL）
+        backend = createInferenceBackend("opencv");
+        if (!backend->load(modelPath, shape, options, error)) {
+            delete backend;
+            backend = nullptr;
+            throw std::runtime_error(error);
+        }
+    }
+    LOG_INFO(LogInfer, "%s 推理后端：%s CPU (i.MX6ULL适配版) 输入尺寸: %dx%d 线程: %d",
+             faceEngine ? "姿态分类器" : "YOLOv11n", backend->name(),
+             shape.width, shape.height, options.threads);
 }
 
-cv::Mat Inference::formatToSquare(const cv::Mat &source)
+cv::Mat formatToSquare(const cv::Mat &source)
 {
     // 保留你原始的letterBox逻辑
     int col = source.cols;
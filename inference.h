@@ -1,59 +1,228 @@
 #ifndef INFERENCE_H
 #define INFERENCE_H
 
-#include <fstream>
+#include <atomic>
 #include <vector>
 #include <string>
-#include <random>
+#include <stdint.h>
+#include <math.h>
 #include <opencv2/imgproc.hpp>
 #include <opencv2/opencv.hpp>
 #include <opencv2/dnn.hpp>
+#include <opencv2/objdetect.hpp>
+#include "inference_backend.h"
 
 // 仅修改：适配你的160x160输入尺寸
 //#define MODEL_INPUT_SIZE 160
 #define MODEL_INPUT_SIZE 128
 
+#define MAX_DETECTIONS 8   // 单次推理结果上限（NMS后）
+#define NUM_CLASSES 5
+
+// 单个检测目标（POD，可平凡拷贝）
 struct Detection
 {
     int class_id{0};
-    std::string className{};
     float confidence{0.0};
-    cv::Scalar color{};
     cv::Rect box{};
 };
 
+// 一次推理的全部结果：定长数组 + 帧号/时间戳，跨线程传递时整体memcpy，无堆分配
+// detections按置信度降序排列，detections[0]即最优目标
+struct DetectionResult
+{
+    uint32_t frame_id{0};
+    int64_t t_capture_ns{0};       // 帧采集时刻（CLOCK_MONOTONIC）
+    int64_t t_infer_start_ns{0};
+    int64_t t_infer_end_ns{0};
+    int count{0};
+    Detection detections[MAX_DETECTIONS];
+
+    const Detection *best() const { return count > 0 ? &detections[0] : nullptr; }
+};
+
+// ---- 前后处理的无状态函数：Inference逐帧调用，也可单独做基准测试 ----
+
+// YOLO logits转0~1概率
+inline float yoloSigmoid(float x)
+{
+    return 1.0f / (1.0f + expf(-x));
+}
+
+// 解码阈值（保留原始取值）
+struct YoloThresholds
+{
+    float confidence {0.25};   // YOLOv5 obj_conf下限
+    float score      {0.45};   // 类别得分下限
+    float nms        {0.50};   // NMS的IoU阈值
+};
+
+// 解码得到的候选框（clear()保留容量，逐帧复用时稳态下不再分配）
+struct YoloCandidates
+{
+    std::vector<int> classIds;
+    std::vector<float> confidences;
+    std::vector<cv::Rect> boxes;
+
+    void clear() { classIds.clear(); confidences.clear(); boxes.clear(); }
+    int size() const { return static_cast<int>(boxes.size()); }
+};
+
+// letterBox：右下补零成正方形（原图位于左上角，框坐标无需平移）
+cv::Mat formatToSquare(const cv::Mat &source);
+// 归一化到0~1、缩放到模型输入尺寸、BGR→RGB，得到NCHW的blob
+void makeInputBlob(const cv::Mat &modelInput, const cv::Size &modelShape, cv::Mat &blob);
+// 解析网络输出：自动识别YOLOv8布局（[1, 4+类别, N]，转置到transposed中，output本身不改），
+// 框按modelInput/modelShape的比例还原到letterBox后的图像坐标。
+// bestOnly时逐行只保留分数最高的一个候选，candidates至多一项。
+void decodeYoloOutput(const cv::Mat &output, const cv::Size &inputSize, const cv::Size2f &modelShape,
+                      const YoloThresholds &thresholds, bool bestOnly,
+                      cv::Mat &transposed, YoloCandidates &candidates);
+// 最优候选（得分最高的一行）最高与次高类别得分之差（YOLOv5布局再乘obj_conf），0~1，越大越确定；
+// transposed须是同一output经decodeYoloOutput得到的转置缓冲
+float yoloBestClassMargin(const cv::Mat &output, const cv::Mat &transposed);
+// NMS后按置信度降序写入result（至多MAX_DETECTIONS个），返回保留数量；keep为复用的下标缓冲
+int selectDetections(const YoloCandidates &candidates, const YoloThresholds &thresholds,
+                     std::vector<int> &keep, DetectionResult &result);
+
+// face引擎的定位：LBP检出的人脸中取面积最大的一个，没有时取头部提示框，均裁剪到画面内；找不到时返回空框
+cv::Rect pickFaceBox(const std::vector<cv::Rect> &faces, const cv::Rect &headHint, const cv::Size &frameSize);
+// 以人脸框中心取边长为长边×scale（四舍五入）的正方形，可超出画面（超出部分裁剪时复制边缘）
+cv::Rect faceCropSquare(const cv::Rect &face, float scale);
+// 分类器输出已是概率（各项在0~1且和为1）时原样保留，否则按logit做softmax；返回最大项下标
+int normalizeFaceScores(std::vector<float> &scores);
+
+// 推理配置（默认值与原有硬编码一致；按板子调优的结果经AppConfig传入，见auto_tuner.h）
+struct InferenceConfig
+{
+    // 引擎：yolo（默认，整帧/ROI检测）或face（LBP人脸定位或跟踪框 → 人脸裁剪 → 小的姿态分类ONNX）
+    std::string engine {"yolo"};
+    std::string backend {"opencv"};
+    InferenceBackendOptions backendOptions;
+    int inputSize {MODEL_INPUT_SIZE};   // 模型输入边长（正方形）
+    bool letterBox {true};              // 先右下补零成正方形再缩放；关闭时直接拉伸
+
+    // 两级级联（gateModelPath非空时开启）：先跑小的门控检测器（同样的YOLO输出布局与类别），
+    // 最优目标的类别间隔不低于gateMargin时直接采用，否则再跑完整模型。门控与完整模型共用同一次预处理
+    std::string gateModelPath;
+    int gateInputSize {64};
+    float gateMargin {0.5f};
+    int gateAuditInterval {20};         // 每采用N次门控结果抽查一次完整模型（统计不一致率），0表示不抽查
+
+    // face引擎：分类器输入为[1, 3, S, S]（与YOLO相同的RGB、0~1归一化），输出NUM_CLASSES个logit或概率
+    std::string faceCascadePath {"/usr/local/arm_opencv480/share/opencv4/lbpcascades/lbpcascade_frontalface_improved.xml"};
+    std::string faceModelPath;
+    int faceInputSize {64};
+    float faceCropScale {1.4f};         // 裁剪边长相对人脸框长边的倍数（姿态分类需要头发/下巴等上下文）
+};
+
+// 级联统计（推理线程累加，其他线程读取快照）
+struct CascadeStats
+{
+    uint64_t frames {0};        // 经过门控的帧数
+    uint64_t accepted {0};      // 直接采用门控结果的帧数（含被抽查的）
+    uint64_t audited {0};       // 采用后又抽查了完整模型的帧数
+    uint64_t disagreed {0};     // 抽查中门控与完整模型最优类别不一致的帧数
+    int64_t gateNs {0};         // 门控累计耗时
+    int64_t fullNs {0};         // 未采用门控结果时完整模型的累计耗时
+    int64_t auditNs {0};        // 抽查时完整模型的累计耗时（测量开销，不计入级联耗时）
+
+    // 每帧平均推理耗时（门控 + 需要时的完整模型，不含抽查）
+    double averageMs() const { return frames ? (gateNs + fullNs) / 1e6 / frames : 0.0; }
+    // 完整模型单独一次的平均耗时（即不开级联时的每帧耗时）
+    double fullAverageMs() const
+    {
+        uint64_t runs = frames - accepted + audited;
+        return runs ? (fullNs + auditNs) / 1e6 / runs : 0.0;
+    }
+    // 相对每帧都跑完整模型的耗时降低比例
+    double latencyReduction() const
+    {
+        double full = fullAverageMs();
+        return full > 0.0 ? 1.0 - averageMs() / full : 0.0;
+    }
+    double disagreementRate() const { return audited ? static_cast<double>(disagreed) / audited : 0.0; }
+};
+
 class Inference
 {
 public:
     // 仅修改：默认尺寸改为MODEL_INPUT_SIZE x MODEL_INPUT_SIZE
+    // backendName见InferenceBackend（opencv/native/ort/tflite）；该后端不可用或加载失败时退回OpenCV DNN，
+    // OpenCV DNN也加载失败时抛出std::runtime_error
     Inference(const std::string &onnxModelPath, const cv::Size &modelInputShape = {MODEL_INPUT_SIZE, MODEL_INPUT_SIZE},
-              const std::string &classesTxtFile = "", const bool &runWithCuda = true);
+              const std::string &classesTxtFile = "", const bool &runWithCuda = true,
+              const std::string &backendName = "opencv");
+    Inference(const std::string &onnxModelPath, const InferenceConfig &config);
     ~Inference();
-    std::vector<Detection> runInference(const cv::Mat &input);
-    std::string getClassName(int classId);
+    // 结果写入result（count/detections/推理时间戳），frame_id与t_capture_ns由调用方填写。
+    // headHint为已知的头部框（input坐标，如跟踪框）：face引擎在LBP找不到人脸时用它裁剪，yolo引擎忽略
+    bool runInference(const cv::Mat &input, DetectionResult &result, const cv::Rect &headHint = cv::Rect());
+    // 类别名来自静态表，越界返回"unknown"
+    static const char *getClassName(int classId);
     void release();
 
+    // 只需要最优目标时开启：逐行取argmax，跳过候选框收集与NMS
+    void setBestOnly(bool enabled) { bestOnly = enabled; }
+    bool isBestOnly() const { return bestOnly; }
+    // 实际使用的后端名
+    const char *backendName() const { return backend ? backend->name() : "none"; }
+    // face引擎加载成功（否则已退回yolo）
+    bool isFaceEngine() const { return faceEngine; }
+    // 门控模型加载成功，级联生效
+    bool isCascade() const { return gate != nullptr; }
+    // 任意线程可调用
+    CascadeStats cascadeStats() const;
+
 private:
-    void loadClassesFromFile();
-    void loadOnnxNetwork();
-    cv::Mat formatToSquare(const cv::Mat &source);
+    void loadBackend(const std::string &name, const InferenceBackendOptions &options);
+    void loadGate(const InferenceConfig &config);
+    bool loadFaceEngine(const InferenceConfig &config);
+    bool runFaceInference(const cv::Mat &input, const cv::Rect &headHint, DetectionResult &result);
+    // 门控结果可信时写入result并返回true
+    bool runGate(const cv::Size &inputSize, DetectionResult &result);
 
     std::string modelPath{};
-    std::string classesPath{};
     bool cudaEnabled{};
 
-    // 保留你原始的类别顺序
-    std::vector<std::string> classes{"front", "left", "up","right" , "down"};
     cv::Size2f modelShape{};
 
     // 保留你原始的阈值
-    float modelConfidenceThreshold {0.25};
-    float modelScoreThreshold      {0.45};
-    float modelNMSThreshold        {0.50};
+    YoloThresholds thresholds;
 
     // 保留你原始的letterBox设置
     bool letterBoxForSquare = true;
-    cv::dnn::Net net;
+    bool bestOnly = false;
+    InferenceBackend *backend{nullptr};
+
+    // 级联门控（见InferenceConfig）
+    InferenceBackend *gate{nullptr};
+    cv::Size2f gateShape{};
+    float gateMargin{0.5f};
+    int gateAuditInterval{0};
+    cv::Mat gateTransposed;
+    YoloCandidates gateCandidates;
+    std::atomic<uint64_t> cascadeFrames{0};
+    std::atomic<uint64_t> cascadeAccepted{0};
+    std::atomic<uint64_t> cascadeAudited{0};
+    std::atomic<uint64_t> cascadeDisagreed{0};
+    std::atomic<int64_t> cascadeGateNs{0};
+    std::atomic<int64_t> cascadeFullNs{0};
+    std::atomic<int64_t> cascadeAuditNs{0};
+
+    // face引擎（modelPath/modelShape/backend此时指姿态分类器）
+    bool faceEngine{false};
+    float faceCropScale{1.4f};
+    cv::CascadeClassifier faceCascade;
+    cv::Mat faceGray;
+    cv::Mat faceCrop;
+    std::vector<cv::Rect> faces;
+    std::vector<float> faceScores;
+
+    // 逐帧复用的中间缓冲（clear()保留容量，稳态下不再分配；输入张量由后端持有）
+    cv::Mat transposed;
+    YoloCandidates candidates;
+    std::vector<int> nms_result;
 };
 
 #endif // INFERENCE_H
@@ -0,0 +1,89 @@
+#include "inference_backend.h"
+#include <opencv2/dnn.hpp>
+#include <vector>
+
+// OpenCV DNN后端（原有实现）：强制CPU，默认单线程，适配i.MX6ULL
+class OpenCvDnnBackend : public InferenceBackend
+{
+public:
+    const char *name() const override { return "opencv"; }
+
+    bool load(const std::string &modelPath, const cv::Size &inputShape,
+              const InferenceBackendOptions &options, std::string &error) override
+    {
+        (void)inputShape;
+        try {
+            net = cv::dnn::readNetFromONNX(modelPath);
+        } catch (const cv::Exception &e) {
+            error = e.what();
+            return false;
+        }
+        if (net.empty()) {
+            error = "模型为空: " + modelPath;
+            return false;
+        }
+        net.setPreferableBackend(cv::dnn::DNN_BACKEND_OPENCV);
+        net.setPreferableTarget(cv::dnn::DNN_TARGET_CPU);
+        net.enableWinograd(options.winograd);
+        cv::setNumThreads(options.threads);
+        outputNames = net.getUnconnectedOutLayersNames();
+        return true;
+    }
+
+    cv::Mat &inputTensor() override { return blob; }
+
+    bool run() override
+    {
+        if (net.empty() || blob.empty())
+            return false;
+        net.setInput(blob);
+        outputs.clear();
+        net.forward(outputs, outputNames);
+        return !outputs.empty();
+    }
+
+    int outputCount() const override { return static_cast<int>(outputs.size()); }
+    const cv::Mat &outputTensor(int index) const override { return outputs[index]; }
+
+    void release() override
+    {
+        if (!net.empty())
+            net = cv::dnn::Net();
+        outputs.clear();
+    }
+
+private:
+    cv::dnn::Net net;
+    std::vector<cv::String> outputNames;
+    cv::Mat blob;
+    std::vector<cv::Mat> outputs;   // clear()保留容量，逐帧复用
+};
+
+InferenceBackend *createInferenceBackend(const std::string &name)
+{
+    if (name.empty() || name == "opencv")
+        return new OpenCvDnnBackend;
+    if (name == "native")
+        return createNativeBackend();
+#ifdef WHEELCHAIR_WITH_ORT
+    if (name == "ort")
+        return createOrtBackend();
+#endif
+#ifdef WHEELCHAIR_WITH_TFLITE
+    if (name == "tflite")
+        return createTfliteBackend();
+#endif
+    return nullptr;
+}
+
+const char *inferenceBackendNames()
+{
+    return "opencv,native"
+#ifdef WHEELCHAIR_WITH_ORT
+           ",ort"
+#endif
+#ifdef WHEELCHAIR_WITH_TFLITE
+           ",tflite"
+#endif
+        ;
+}
@@ -0,0 +1,53 @@
+#ifndef INFERENCE_BACKEND_H
+#define INFERENCE_BACKEND_H
+
+#include <string>
+#include <opencv2/core.hpp>
+
+// 推理后端：Inference只负责前后处理，网络本身的加载与执行交给后端。
+// 默认OpenCV DNN；其余后端编译时按需开启（见inference_backends.pri），运行时按名字选择：
+//   opencv  cv::dnn（DNN_BACKEND_OPENCV，单线程）
+//   native  自研精简运行时（NEON卷积内核、静态内存规划，模型打包为同名.wcm，见native_model.h）
+//   ort     ONNX Runtime（CONFIG+=ort）
+//   tflite  TensorFlow Lite + XNNPACK（CONFIG+=tflite，模型为同名.tflite）
+// 后端运行参数（默认值即原有硬编码；对该后端无意义的项忽略，可由自动调优结果覆盖）
+struct InferenceBackendOptions
+{
+    int threads {1};          // 推理线程数（opencv/ort/tflite；i.MX6ULL单核为1）
+    bool winograd {true};     // opencv后端3x3卷积走Winograd（OpenCV 4.8默认开启）
+};
+
+// 调用顺序：load() → 每帧写inputTensor() → run() → 读outputTensor()。
+// 输出张量在下一次run()/release()前有效，可能直接引用后端内部内存，不要跨帧保留。
+class InferenceBackend
+{
+public:
+    virtual ~InferenceBackend() {}
+
+    virtual const char *name() const = 0;
+    // inputShape为模型输入宽高；失败时返回false并在error中给出原因
+    virtual bool load(const std::string &modelPath, const cv::Size &inputShape,
+                      const InferenceBackendOptions &options, std::string &error) = 0;
+    // NCHW float32输入张量（由makeInputBlob写入，尺寸不变时复用内存）
+    virtual cv::Mat &inputTensor() = 0;
+    virtual bool run() = 0;
+    virtual int outputCount() const = 0;
+    // float32输出张量，维度与模型输出一致（如[1, 4+类别, N]）
+    virtual const cv::Mat &outputTensor(int index) const = 0;
+    virtual void release() = 0;
+};
+
+// 按名字创建后端；名字未知或该后端未编译进来时返回nullptr
+InferenceBackend *createInferenceBackend(const std::string &name);
+// 已编译进来的后端名，逗号分隔
+const char *inferenceBackendNames();
+
+InferenceBackend *createNativeBackend();
+#ifdef WHEELCHAIR_WITH_ORT
+InferenceBackend *createOrtBackend();
+#endif
+#ifdef WHEELCHAIR_WITH_TFLITE
+InferenceBackend *createTfliteBackend();
+#endif
+
+#endif // INFERENCE_BACKEND_H
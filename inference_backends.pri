@@ -0,0 +1,24 @@
+# 可选推理后端（默认编译OpenCV DNN与自研native），运行时用WHEELCHAIR_BACKEND选择：
+#   qmake CONFIG+=ort ORT_DIR=/opt/onnxruntime-linux-armhf      ONNX Runtime（C++ API，1.13及以上）
+#   qmake CONFIG+=tflite TFLITE_DIR=/opt/tflite                 TensorFlow Lite C库（含XNNPACK委托）
+#   qmake CONFIG+=neon                                          工具链默认未开NEON时为native后端打开NEON内核
+# core.pro（编译）与core.pri（链接）都包含本文件
+ort {
+    isEmpty(ORT_DIR): ORT_DIR = /usr/local/onnxruntime
+    DEFINES += WHEELCHAIR_WITH_ORT
+    INCLUDEPATH += $$ORT_DIR/include
+    LIBS += -L$$ORT_DIR/lib -lonnxruntime
+    QMAKE_LFLAGS += -Wl,-rpath=$$ORT_DIR/lib
+}
+
+tflite {
+    isEmpty(TFLITE_DIR): TFLITE_DIR = /usr/local/tflite
+    DEFINES += WHEELCHAIR_WITH_TFLITE
+    INCLUDEPATH += $$TFLITE_DIR/include
+    LIBS += -L$$TFLITE_DIR/lib -ltensorflowlite_c
+    QMAKE_LFLAGS += -Wl,-rpath=$$TFLITE_DIR/lib
+}
+
+neon {
+    QMAKE_CXXFLAGS += -mfpu=neon
+}
@@ -0,0 +1,345 @@
+#include "input_reader.h"
+#include "control_dispatcher.h"
+#include "pipeline_clock.h"
+#include "async_logger.h"
+#include <linux/input.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <glob.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+
+#ifndef input_event_sec
+#define input_event_sec time.tv_sec
+#define input_event_usec time.tv_usec
+#endif
+
+#define BITS_PER_LONG (sizeof(long) * 8)
+#define NBITS(x) ((((x) - 1) / BITS_PER_LONG) + 1)
+
+static bool testBit(const unsigned long *bits, int bit)
+{
+    return (bits[bit / BITS_PER_LONG] >> (bit % BITS_PER_LONG)) & 1UL;
+}
+
+// 按键 → 指令
+static char keyCommand(int code)
+{
+    switch (code) {
+    case KEY_UP:    case KEY_W: case BTN_DPAD_UP:    return 'F';
+    case KEY_DOWN:  case KEY_S: case BTN_DPAD_DOWN:  return 'B';
+    case KEY_LEFT:  case KEY_A: case BTN_DPAD_LEFT:  return 'L';
+    case KEY_RIGHT: case KEY_D: case BTN_DPAD_RIGHT: return 'R';
+    case KEY_SPACE: case KEY_ESC: case KEY_ENTER: case BTN_SOUTH: return 'S';
+    default: return 0;
+    }
+}
+
+static const int kHatKeyFlag = 0x10000;   // 十字键（ABS_HAT0X/Y）在Device::heldKey中的标记
+
+InputReader::InputReader(const std::vector<std::string> &devicePaths, ControlDispatcher *dispatcher, QObject *parent)
+    : QThread(parent)
+    , dispatcher(dispatcher)
+    , running(false)
+    , events(0)
+    , commands(0)
+{
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.fd = wakeFd;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &ev);
+
+    if (!devicePaths.empty()) {
+        for (size_t i = 0; i < devicePaths.size(); ++i) {
+            openDevice(devicePaths[i]);
+        }
+        return;
+    }
+
+    // 自动扫描：只保留带方向键/手柄能力的设备，跳过触摸屏（其ABS_X/ABS_Y不是摇杆）
+    glob_t g;
+    if (glob("/dev/input/event*", 0, NULL, &g) != 0) {
+        return;
+    }
+    for (size_t i = 0; i < g.gl_pathc; ++i) {
+        int fd = open(g.gl_pathv[i], O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+        if (fd < 0) {
+            continue;
+        }
+        unsigned long keyBits[NBITS(KEY_MAX + 1)];
+        unsigned long propBits[NBITS(INPUT_PROP_MAX + 1)];
+        memset(keyBits, 0, sizeof(keyBits));
+        memset(propBits, 0, sizeof(propBits));
+        ioctl(fd, EVIOCGBIT(EV_KEY, sizeof(keyBits)), keyBits);
+        ioctl(fd, EVIOCGPROP(sizeof(propBits)), propBits);
+        close(fd);
+
+        bool touch = testBit(propBits, INPUT_PROP_DIRECT) || testBit(keyBits, BTN_TOUCH);
+        bool usable = testBit(keyBits, KEY_UP) || testBit(keyBits, BTN_DPAD_UP) ||
+                      testBit(keyBits, BTN_JOYSTICK) || testBit(keyBits, BTN_GAMEPAD);
+        if (usable && !touch) {
+            openDevice(g.gl_pathv[i]);
+        }
+    }
+    globfree(&g);
+}
+
+InputReader::~InputReader()
+{
+    stop();
+    for (size_t i = 0; i < devices.size(); ++i) {
+        close(devices[i].fd);
+    }
+    if (wakeFd >= 0) {
+        close(wakeFd);
+    }
+    if (epollFd >= 0) {
+        close(epollFd);
+    }
+}
+
+bool InputReader::openDevice(const std::string &path)
+{
+    int fd = open(path.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) {
+        LOG_WARN(LogInput, "输入设备打开失败: %s (%s)", path, strerror(errno));
+        return false;
+    }
+
+    Device dev;
+    dev.fd = fd;
+    dev.path = path;
+    struct stat st;
+    fstat(fd, &st);
+    dev.isRegularFile = S_ISREG(st.st_mode);
+    dev.isEvdev = S_ISCHR(st.st_mode);
+    dev.heldKey = 0;
+    dev.heldCommand = 0;
+    dev.stickDirection = 0;
+    for (int axis = 0; axis < 2; ++axis) {
+        dev.absMin[axis] = -32768;
+        dev.absMax[axis] = 32767;
+    }
+
+    if (dev.isEvdev) {
+        // 事件时间戳改用CLOCK_MONOTONIC，与流水线时钟同源，可直接计算输入→上线延迟
+        int clockId = CLOCK_MONOTONIC;
+        ioctl(fd, EVIOCSCLOCKID, &clockId);
+        for (int axis = 0; axis < 2; ++axis) {
+            struct input_absinfo abs;
+            if (ioctl(fd, EVIOCGABS(axis == 0 ? ABS_X : ABS_Y), &abs) == 0 && abs.maximum > abs.minimum) {
+                dev.absMin[axis] = abs.minimum;
+                dev.absMax[axis] = abs.maximum;
+            }
+        }
+    }
+    for (int axis = 0; axis < 2; ++axis) {
+        dev.absValue[axis] = (dev.absMin[axis] + dev.absMax[axis]) / 2;
+    }
+
+    if (dev.isRegularFile) {
+        // 录制文件按顺序阻塞读取
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) & ~O_NONBLOCK);
+    } else {
+        struct epoll_event ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN;
+        ev.data.fd = fd;
+        if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+            LOG_WARN(LogInput, "输入设备无法加入epoll: %s (%s)", path, strerror(errno));
+            close(fd);
+            return false;
+        }
+    }
+    devices.push_back(dev);
+    return true;
+}
+
+void InputReader::stop()
+{
+    if (!isRunning()) {
+        return;
+    }
+    running = false;
+    uint64_t one = 1;
+    if (write(wakeFd, &one, sizeof(one)) != sizeof(one)) {
+    }
+    wait();
+}
+
+void InputReader::run()
+{
+    running = true;
+
+    // 录制文件先按原始时间间隔回放
+    for (size_t i = 0; i < devices.size() && running; ++i) {
+        if (devices[i].isRegularFile) {
+            runRegularFile(devices[i]);
+        }
+    }
+
+    struct input_event buf[64];
+    struct epoll_event ready[8];
+    while (running) {
+        int n = epoll_wait(epollFd, ready, 8, -1);
+        for (int i = 0; i < n && running; ++i) {
+            int fd = ready[i].data.fd;
+            if (fd == wakeFd) {
+                continue;
+            }
+            Device *dev = nullptr;
+            for (size_t d = 0; d < devices.size(); ++d) {
+                if (devices[d].fd == fd) {
+                    dev = &devices[d];
+                }
+            }
+            if (!dev) {
+                continue;
+            }
+
+            ssize_t len = read(fd, buf, sizeof(buf));
+            int64_t readNs = monotonicNowNs();
+            if (len == 0 || (len < 0 && errno != EAGAIN && errno != EINTR)) {
+                // 设备拔出或管道写端关闭：按住的方向再也等不到松开，按松开处理
+                epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, NULL);
+                releaseHeld(*dev, readNs);
+                continue;
+            }
+            for (ssize_t k = 0; k < len / static_cast<ssize_t>(sizeof(struct input_event)); ++k) {
+                handleEvent(*dev, buf[k], readNs);
+            }
+        }
+    }
+}
+
+void InputReader::runRegularFile(Device &dev)
+{
+    struct input_event ev;
+    int64_t firstEventNs = -1;
+    int64_t startNs = monotonicNowNs();
+    while (running && read(dev.fd, &ev, sizeof(ev)) == static_cast<ssize_t>(sizeof(ev))) {
+        int64_t eventNs = static_cast<int64_t>(ev.input_event_sec) * 1000000000LL + ev.input_event_usec * 1000LL;
+        if (firstEventNs < 0) {
+            firstEventNs = eventNs;
+        }
+        int64_t waitNs = (eventNs - firstEventNs) - (monotonicNowNs() - startNs);
+        if (waitNs > 0) {
+            usleep(static_cast<useconds_t>(waitNs / 1000));
+        }
+        handleEvent(dev, ev, monotonicNowNs());
+    }
+    // 录制文件结束时仍按住的方向同样按松开处理
+    releaseHeld(dev, monotonicNowNs());
+}
+
+void InputReader::releaseHeld(Device &dev, int64_t originNs)
+{
+    if (dev.heldKey || dev.stickDirection) {
+        dev.heldKey = 0;
+        dev.heldCommand = 0;
+        dev.stickDirection = 0;
+        released(originNs);
+    }
+}
+
+void InputReader::handleEvent(Device &dev, const struct input_event &ev, int64_t readNs)
+{
+    events.fetch_add(1, std::memory_order_relaxed);
+    int64_t originNs = readNs;
+    if (dev.isEvdev) {
+        originNs = static_cast<int64_t>(ev.input_event_sec) * 1000000000LL + ev.input_event_usec * 1000LL;
+    }
+
+    if (ev.type == EV_KEY) {
+        char cmd = keyCommand(ev.code);
+        if (!cmd) {
+            return;
+        }
+        if (ev.value == 1 && cmd == 'S') {
+            // 停止键：锁存停止，所有设备上按住的方向键一并作废（摇杆按实际位置，回中时再松开）
+            for (size_t d = 0; d < devices.size(); ++d) {
+                devices[d].heldKey = 0;
+                devices[d].heldCommand = 0;
+            }
+            issue(cmd, originNs);
+        } else if (ev.value == 1) {
+            dev.heldKey = ev.code;
+            dev.heldCommand = cmd;
+            issue(cmd, originNs);
+        } else if (ev.value == 0 && ev.code == dev.heldKey) {
+            dev.heldKey = 0;
+            dev.heldCommand = 0;
+            released(originNs);
+        }
+    } else if (ev.type == EV_ABS) {
+        if (ev.code == ABS_HAT0X || ev.code == ABS_HAT0Y) {
+            int hatKey = kHatKeyFlag | ev.code;
+            if (ev.value != 0) {
+                dev.heldKey = hatKey;
+                dev.heldCommand = ev.code == ABS_HAT0X ? (ev.value < 0 ? 'L' : 'R') : (ev.value < 0 ? 'F' : 'B');
+                issue(dev.heldCommand, originNs);
+            } else if (dev.heldKey == hatKey) {
+                dev.heldKey = 0;
+                dev.heldCommand = 0;
+                released(originNs);
+            }
+        } else if (ev.code == ABS_X || ev.code == ABS_Y) {
+            dev.absValue[ev.code == ABS_X ? 0 : 1] = ev.value;
+        }
+    } else if (ev.type == EV_SYN && ev.code == SYN_REPORT) {
+        // 一帧摇杆数据齐了再判断方向：取超出死区的主轴
+        float v[2];
+        for (int axis = 0; axis < 2; ++axis) {
+            float range = static_cast<float>(dev.absMax[axis] - dev.absMin[axis]);
+            v[axis] = 2.0f * (dev.absValue[axis] - dev.absMin[axis]) / range - 1.0f;
+        }
+        float ax = v[0] < 0 ? -v[0] : v[0];
+        float ay = v[1] < 0 ? -v[1] : v[1];
+        char dir = 0;
+        if (ax > deadZone || ay > deadZone) {
+            dir = ax > ay ? (v[0] < 0 ? 'L' : 'R') : (v[1] < 0 ? 'F' : 'B');
+        }
+        if (dir != dev.stickDirection) {
+            dev.stickDirection = dir;
+            if (dir) {
+                issue(dir, originNs);
+            } else {
+                released(originNs);
+            }
+        }
+    }
+}
+
+void InputReader::released(int64_t originNs)
+{
+    // 其他方向键/摇杆（含其他设备）仍按住时改走该方向，全部松开才结束手动保持
+    for (size_t d = 0; d < devices.size(); ++d) {
+        char held = devices[d].heldCommand ? devices[d].heldCommand : devices[d].stickDirection;
+        if (held) {
+            issue(held, originNs);
+            return;
+        }
+    }
+    if (dispatcher) {
+        dispatcher->submitRelease(SourceInput, originNs);
+    }
+    commands.fetch_add(1, std::memory_order_relaxed);
+    emit inputCommand('S');
+}
+
+void InputReader::issue(char cmd, int64_t originNs)
+{
+    if (dispatcher) {
+        dispatcher->submitManual(cmd, SourceInput, originNs);
+    }
+    commands.fetch_add(1, std::memory_order_relaxed);
+    emit inputCommand(cmd);
+}
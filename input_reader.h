@@ -0,0 +1,75 @@
+#ifndef INPUT_READER_H
+#define INPUT_READER_H
+
+#include <QThread>
+#include <atomic>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+class ControlDispatcher;
+struct input_event;
+
+// 物理输入线程：用epoll读取 /dev/input/event*（方向键/WASD/手柄十字键/摇杆），
+// 映射为手动指令直接交给ControlDispatcher仲裁下发，不经过Qt控件事件链路。
+// - 方向键按下发送方向指令，松开当前方向键发送松开（死人开关语义：目标归零，但不锁存停止、不转储黑匣子）；
+//   停止键发送锁存的停止
+// - 摇杆超过死区时取主轴方向，回中同松开
+// - 按住状态按设备分别记录：一个设备松开时其他设备仍按住的方向继续生效
+// - 普通文件/管道也可作为输入源（录制好的input_event流），用于离线测试；普通文件按录制时间间隔回放
+// 界面通过inputCommand信号异步得知状态，不在控制链路上。
+class InputReader : public QThread
+{
+    Q_OBJECT
+public:
+    // devicePaths为空时扫描 /dev/input/event*，只保留带方向键或手柄能力、且不是触摸屏的设备
+    InputReader(const std::vector<std::string> &devicePaths, ControlDispatcher *dispatcher, QObject *parent = nullptr);
+    ~InputReader();
+
+    void stop();
+    int deviceCount() const { return static_cast<int>(devices.size()); }
+    uint64_t eventsRead() const { return events.load(std::memory_order_relaxed); }
+    uint64_t commandsIssued() const { return commands.load(std::memory_order_relaxed); }
+
+signals:
+    void inputCommand(char cmd);
+
+protected:
+    void run() override;
+
+private:
+    struct Device
+    {
+        int fd;
+        std::string path;
+        bool isEvdev;       // 真实evdev设备（时间戳为CLOCK_MONOTONIC）
+        bool isRegularFile; // 录制文件：不能加入epoll，按时间戳回放
+        int absMin[2];      // ABS_X/ABS_Y 量程
+        int absMax[2];
+        int absValue[2];
+        int heldKey;        // 当前按下的方向键（0表示无）
+        char heldCommand;   // heldKey对应的方向
+        char stickDirection; // 摇杆当前方向（0表示回中）
+    };
+
+    bool openDevice(const std::string &path);
+    void runRegularFile(Device &dev);
+    void handleEvent(Device &dev, const struct input_event &ev, int64_t readNs);
+    void issue(char cmd, int64_t originNs);
+    // 某个方向结束：仍有按住的方向时改走它，否则向分发器发送松开
+    void released(int64_t originNs);
+    // 设备消失时按住的方向等不到松开事件，补发松开
+    void releaseHeld(Device &dev, int64_t originNs);
+
+    std::vector<Device> devices;
+    ControlDispatcher *dispatcher;
+    int epollFd;
+    int wakeFd;
+    std::atomic<bool> running;
+    std::atomic<uint64_t> events;
+    std::atomic<uint64_t> commands;
+
+    float deadZone {0.3f};
+};
+
+#endif // INPUT_READER_H
@@ -1,10 +1,30 @@
 #include "mainwindow.h"
+#include "headless_runner.h"
+#include "auto_tuner.h"
 #include <QApplication>
+#include <string.h>
 
 int main(int argc, char *argv[])
 {
+    AppConfig config = AppConfig::fromEnvironment();
+    // 图形版也接受--headless/--tune（与OpenCV_CameraMonitor_headless行为一致，只是多链接了QtWidgets）
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--headless") == 0 || strcmp(argv[i], "--tune") == 0) {
+            if (!parseCommandLine(argc, argv, config))
+                return 2;
+            if (!config.tuneFramesPath.empty())
+                return runAutoTune(config);
+            tuneOnFirstBoot(argc, argv, config);
+            return runHeadless(argc, argv, config);
+        }
+    }
+
+    // QApplication先取走Qt自己的参数（如-platform linuxfb），剩下的才是本程序的
     QApplication a(argc, argv);
-    MainWindow w;
+    if (!parseCommandLine(argc, argv, config))
+        return 2;
+    tuneOnFirstBoot(argc, argv, config);
+    MainWindow w(config);
     w.show();
     return a.exec();
 }
@@ -1,34 +1,21 @@
 #include "mainwindow.h"
-#include "uart_master.h"
 
 // 构造函数（核心修改：方向键布局）
-MainWindow::MainWindow(QWidget *parent)
+MainWindow::MainWindow(const AppConfig &appConfig, QWidget *parent)
     : QMainWindow(parent)
-    , isCameraRunning(false)
-    , cameraIndex(1)
-    , frameCounter(0)  // 先初始化
-    , isYoloInit(false) // 后初始化
-    , inferThread(nullptr)
+    , pipeline(nullptr)
+    , displayFramePending(false)
+    , skippedLastDisplay(false)
+    , displayedFrames(0)
+    , lastDisplayedFrames(0)
+    , displayFps(0.0)
 {
-    // 注册自定义类型
-    qRegisterMetaType<std::vector<Detection>>("std::vector<Detection>");
-
-    // 初始化推理线程
-    std::string onnxPath = "/root/last.onnx";
-    inferThread = new YoloInferThread(onnxPath, this);
-    isYoloInit = inferThread->isInit();
-
-    // 连接推理完成信号
-    connect(inferThread, &YoloInferThread::inferenceFinished, this, &MainWindow::onInferenceFinished);
-    inferThread->start();
-
-    // 打印初始化信息
-    if (isYoloInit) {
-        qDebug() << "YOLOv11n推理线程初始化成功：" << QString::fromStdString(onnxPath)
-                 << " 输入尺寸： " << MODEL_INPUT_SIZE << " x " << MODEL_INPUT_SIZE;
-    } else {
+    config = appConfig;
+
+    // 采集/推理/控制流水线（与无界面模式共用，界面只观察）
+    pipeline = new Pipeline(config, this);
+    if (!pipeline->isYoloInit()) {
         QMessageBox::warning(this, "警告", "YOLO模型加载失败！\n将仅显示摄像头画面");
-        qDebug() << "YOLOv11n推理线程初始化失败";
     }
 
     // 窗口设置
@@ -45,6 +32,20 @@ MainWindow::MainWindow(QWidget *parent)
     captureBtn->setStyleSheet("QPushButton{font-size:14px; background:#4CAF50; color:white; border:none; border-radius:4px;} QPushButton:hover{background:#388E3C;}");
     captureBtn->setEnabled(false);
 
+    resumeAutoBtn = new QPushButton("▶ 恢复自动", this);
+    resumeAutoBtn->setFixedSize(120, 40);
+    resumeAutoBtn->setStyleSheet("QPushButton{font-size:14px; background:#607D8B; color:white; border:none; border-radius:4px;} QPushButton:hover{background:#455A64;}");
+
+    recorderBtn = new QPushButton("保存黑匣子", this);
+    recorderBtn->setFixedSize(120, 40);
+    recorderBtn->setStyleSheet("QPushButton{font-size:14px; background:#3F51B5; color:white; border:none; border-radius:4px;} QPushButton:hover{background:#303F9F;}");
+    recorderBtn->setEnabled(pipeline->recorder()->isEnabled());
+
+    sessionBtn = new QPushButton("● 开始录制", this);
+    sessionBtn->setFixedSize(120, 40);
+    sessionBtn->setStyleSheet("QPushButton{font-size:14px; background:#E91E63; color:white; border:none; border-radius:4px;} QPushButton:hover{background:#C2185B;}");
+    sessionBtn->setEnabled(false);
+
     // ========== 核心修改：方向键样式按钮创建 ==========
     // 向前（上）
     forwardBtn = new QPushButton("↑ 向前 (F)", this);
@@ -71,17 +72,19 @@ MainWindow::MainWindow(QWidget *parent)
     stopBtn->setFixedSize(120, 40);
     stopBtn->setStyleSheet("QPushButton{font-size:14px; background:#F44336; color:white; border:none; border-radius:4px;} QPushButton:hover{background:#D32F2F;}");
 
-    // 摄像头显示标签（完全不变）
-    cameraLabel = new QLabel(this);
-    cameraLabel->setAlignment(Qt::AlignCenter);
-    cameraLabel->setStyleSheet("QLabel{border:2px solid #2196F3; background-color:#f5f5f5;}");
-    cameraLabel->setText("Q8 HD摄像头未启动\n点击「启动摄像头」开始监控\n检测结果仅在终端打印（异步推理不卡UI）");
+    // 摄像头显示控件（直接绘制采集帧，无逐帧拷贝）
+    videoWidget = new VideoWidget(this);
+    videoWidget->setPlaceholderText("Q8 HD摄像头未启动\n点击「启动摄像头」开始监控\n检测框与姿态叠加显示在画面上（异步推理不卡UI）");
+    videoWidget->setOverlaySources(pipeline->detectionOverlay(), pipeline->trackOverlay());
 
     // ========== 布局调整：方向键样式布局 ==========
     // 原有按钮布局
     QHBoxLayout *btnLayout = new QHBoxLayout();
     btnLayout->addWidget(startStopBtn);
     btnLayout->addWidget(captureBtn);
+    btnLayout->addWidget(resumeAutoBtn);
+    btnLayout->addWidget(recorderBtn);
+    btnLayout->addWidget(sessionBtn);
     btnLayout->addStretch();
 
     // 核心：方向键布局（3行）
@@ -120,21 +123,35 @@ MainWindow::MainWindow(QWidget *parent)
     mainLayout->addSpacing(20); // 增加间距更美观
     mainLayout->addLayout(dirKeyLayout);
     mainLayout->addSpacing(20);
-    mainLayout->addWidget(cameraLabel);
+    mainLayout->addWidget(videoWidget);
     this->setCentralWidget(centralWidget);
 
     // 状态栏（完全不变）
     QStatusBar *statusBar = new QStatusBar(this);
     this->setStatusBar(statusBar);
+    latencyLabel = new QLabel("端到端：--", this);
+    statusBar->addPermanentWidget(latencyLabel);
     this->statusBar()->showMessage("就绪 - OpenCV版本：" + QString(CV_VERSION) +
-                           " | 摄像头索引：" + QString::number(cameraIndex) +
-                           " | YOLOv11n：" + (isYoloInit ? QString("已加载（%1x%1）").arg(MODEL_INPUT_SIZE) : "未加载") +
-                           " | 多线程异步推理 | 仅终端打印结果 | CPU主频：792MHz");
-
-    // 定时器（完全不变）
-    timer = new QTimer(this);
-    timer->setInterval(80);
-    connect(timer, &QTimer::timeout, this, &MainWindow::updateCameraFrame);
+                           " | 摄像头索引：1" +
+                           " | YOLOv11n：" + (pipeline->isYoloInit() ? QString("已加载（%1x%1）").arg(config.inputSize) : "未加载") +
+                           " | 多线程异步推理 | 检测结果叠加显示 | CPU主频：792MHz");
+
+    // 显示定时器（帧率上限为0时不启动）
+    displayTimer = new QTimer(this);
+    if (config.displayFpsCap > 0)
+        displayTimer->setInterval(qMax(1, 1000 / config.displayFpsCap));
+    displayTimer->setTimerType(Qt::CoarseTimer);
+    connect(displayTimer, &QTimer::timeout, this, &MainWindow::presentFrame);
+
+    // 截图完成提示（非模态，不打断操作）
+    toastLabel = new QLabel(this);
+    toastLabel->setStyleSheet("QLabel{font-size:14px; background:rgba(33,33,33,200); color:white; border-radius:6px; padding:8px 16px;}");
+    toastLabel->setAttribute(Qt::WA_TransparentForMouseEvents);
+    toastLabel->hide();
+    toastTimer = new QTimer(this);
+    toastTimer->setSingleShot(true);
+    toastTimer->setInterval(2500);
+    connect(toastTimer, &QTimer::timeout, toastLabel, &QLabel::hide);
 
     // 信号槽 - 原有绑定（完全不变）
     connect(startStopBtn, &QPushButton::clicked, this, &MainWindow::toggleCamera);
@@ -146,282 +163,328 @@ MainWindow::MainWindow(QWidget *parent)
     connect(leftBtn, &QPushButton::clicked, this, &MainWindow::onLeftBtnClicked);
     connect(rightBtn, &QPushButton::clicked, this, &MainWindow::onRightBtnClicked);
     connect(stopBtn, &QPushButton::clicked, this, &MainWindow::onStopBtnClicked);
-
-    // UART初始化（完全不变）
-    uart_fd = uart_init("/dev/ttymxc5");
-    if (uart_fd < 0) {
-        fprintf(stderr, "【UART初始化失败】无法发送控制指令，请检查/dev/ttymxc5是否存在并以ROOT权限运行\n");
-    } else {
-        qDebug() << "【UART初始化成功】已打开/dev/ttymxc5，波特率115200";
+    connect(resumeAutoBtn, &QPushButton::clicked, this, &MainWindow::onResumeAutoBtnClicked);
+    connect(recorderBtn, &QPushButton::clicked, this, &MainWindow::onRecorderDumpClicked);
+    connect(sessionBtn, &QPushButton::clicked, this, &MainWindow::onSessionRecordClicked);
+
+    // 流水线状态 → 界面
+    connect(pipeline, &Pipeline::runningChanged, this, &MainWindow::onRunningChanged);
+    connect(pipeline, &Pipeline::openFailed, this, &MainWindow::onOpenFailed);
+    connect(pipeline, &Pipeline::frameCaptured, this, &MainWindow::onFrameCaptured);
+    connect(pipeline, &Pipeline::frameReadFailed, this, &MainWindow::onFrameReadFailed);
+    connect(pipeline, &Pipeline::detectionFinished, this, &MainWindow::onDetectionFinished);
+    connect(pipeline, &Pipeline::ratesUpdated, this, &MainWindow::updateFrameRates);
+    connect(pipeline, &Pipeline::replayFinished, this, &MainWindow::onReplayFinished);
+    connect(pipeline, &Pipeline::inputCommand, this, &MainWindow::onInputCommand);
+    connect(pipeline, &Pipeline::snapshotSaved, this, &MainWindow::onSnapshotSaved);
+    connect(pipeline, &Pipeline::sessionRecordingChanged, this, &MainWindow::onSessionRecordingChanged);
+    connect(pipeline, &Pipeline::statusMessage, this, &MainWindow::onStatusMessage);
+
+    // 回放模式：启动后立即开始
+    if (pipeline->isReplay()) {
+        startStopBtn->setText("开始回放");
+        QTimer::singleShot(0, pipeline, &Pipeline::start);
     }
 }
 
-// 析构函数（完全不变）
+// 析构函数：流水线负责按顺序停止各线程并关闭串口
 MainWindow::~MainWindow()
 {
-    // 释放摄像头
-    if (cap.isOpened()) {
-        cap.release();
-    }
-
-    // 停止推理线程
-    if (inferThread) {
-        inferThread->stop();
-        delete inferThread;
-    }
-
-    // 关闭UART
-    if (uart_fd >= 0) {
-        uart_close(uart_fd);
-        qDebug() << "【UART已关闭】释放串口资源";
-    }
+    delete pipeline;
 }
 
 // ========== 方向键按钮槽函数实现（加速版） ==========
 void MainWindow::onForwardBtnClicked() {
-    if (uart_fd >= 0) {
-        // 第一步：先发送指令（核心加速，无延迟）
-        uart_send_char(uart_fd, 'F');
+    UI_SLOT_SCOPE();
+    if (pipeline->uartReady()) {
+        // 第一步：交给控制分发线程仲裁后发送（核心加速，GUI线程不等待串口）
+        pipeline->dispatcher()->submitManual('F', SourceButton);
         // 第二步：极简日志+状态栏（减少耗时）
-        qDebug("【手动控制】向前 → F");
-        statusBar()->showMessage("手动控制：向前 (F)");
+        LOG_INFO(LogUi, "【手动控制】向前 → F");
+        statusBar()->showMessage("手动控制：向前 (F) | 自动控制暂停" + QString::number(config.manualHoldMs) + "ms");
     } else {
-        qDebug("【手动控制失败】无法发送 F");
+        LOG_WARN(LogUi, "【手动控制失败】无法发送 F");
         QMessageBox::warning(this, "警告", "UART未初始化，无法发送向前指令！");
     }
 }
 
 void MainWindow::onBackwardBtnClicked() {
-    if (uart_fd >= 0) {
-        uart_send_char(uart_fd, 'B');
-        qDebug("【手动控制】向后 → B");
-        statusBar()->showMessage("手动控制：向后 (B)");
+    UI_SLOT_SCOPE();
+    if (pipeline->uartReady()) {
+        pipeline->dispatcher()->submitManual('B', SourceButton);
+        LOG_INFO(LogUi, "【手动控制】向后 → B");
+        statusBar()->showMessage("手动控制：向后 (B) | 自动控制暂停" + QString::number(config.manualHoldMs) + "ms");
     } else {
-        qDebug("【手动控制失败】无法发送 B");
+        LOG_WARN(LogUi, "【手动控制失败】无法发送 B");
         QMessageBox::warning(this, "警告", "UART未初始化，无法发送向后指令！");
     }
 }
 
 void MainWindow::onLeftBtnClicked() {
-    if (uart_fd >= 0) {
-        uart_send_char(uart_fd, 'L');
-        qDebug("【手动控制】向左 → L");
-        statusBar()->showMessage("手动控制：向左 (L)");
+    UI_SLOT_SCOPE();
+    if (pipeline->uartReady()) {
+        pipeline->dispatcher()->submitManual('L', SourceButton);
+        LOG_INFO(LogUi, "【手动控制】向左 → L");
+        statusBar()->showMessage("手动控制：向左 (L) | 自动控制暂停" + QString::number(config.manualHoldMs) + "ms");
     } else {
-        qDebug("【手动控制失败】无法发送 L");
+        LOG_WARN(LogUi, "【手动控制失败】无法发送 L");
         QMessageBox::warning(this, "警告", "UART未初始化，无法发送向左指令！");
     }
 }
 
 void MainWindow::onRightBtnClicked() {
-    if (uart_fd >= 0) {
-        uart_send_char(uart_fd, 'R');
-        qDebug("【手动控制】向右 → R");
-        statusBar()->showMessage("手动控制：向右 (R)");
+    UI_SLOT_SCOPE();
+    if (pipeline->uartReady()) {
+        pipeline->dispatcher()->submitManual('R', SourceButton);
+        LOG_INFO(LogUi, "【手动控制】向右 → R");
+        statusBar()->showMessage("手动控制：向右 (R) | 自动控制暂停" + QString::number(config.manualHoldMs) + "ms");
     } else {
-        qDebug("【手动控制失败】无法发送 R");
+        LOG_WARN(LogUi, "【手动控制失败】无法发送 R");
         QMessageBox::warning(this, "警告", "UART未初始化，无法发送向右指令！");
     }
 }
 
+void MainWindow::onResumeAutoBtnClicked() {
+    UI_SLOT_SCOPE();
+    pipeline->dispatcher()->requestResumeAuto();
+    LOG_INFO(LogUi, "【手动控制】恢复自动控制（等待姿态确认）");
+    statusBar()->showMessage("恢复自动控制：等待连续" + QString::number(config.autoConfirmFrames) + "次一致的头部姿态");
+}
+
+void MainWindow::onInputCommand(char cmd) {
+    UI_SLOT_SCOPE();
+    const LatencyCounter &lat = pipeline->dispatcher()->latency(SourceInput);
+    LOG_INFO(LogInput, "【物理输入】%c 输入→上线：%lldus（平均%lldus，最大%lldus）",
+             cmd, lat.last.load() / 1000, lat.avg() / 1000, lat.max.load() / 1000);
+    statusBar()->showMessage(QString("物理输入：%1 | 输入→上线：%2us（平均%3us）")
+                             .arg(cmd).arg(lat.last.load() / 1000).arg(lat.avg() / 1000));
+}
+
 void MainWindow::onStopBtnClicked() {
-    if (uart_fd >= 0) {
-        uart_send_char(uart_fd, 'S');
-        qDebug("【手动控制】停止 → S");
-        statusBar()->showMessage("手动控制：停止 (S)");
+    UI_SLOT_SCOPE();
+    if (pipeline->uartReady()) {
+        pipeline->dispatcher()->submitManual('S', SourceButton);
+        LOG_INFO(LogUi, "【手动控制】停止 → S");
+        statusBar()->showMessage("手动控制：停止 (S) | 自动控制已锁存，点击「恢复自动」后需连续" +
+                                 QString::number(config.autoConfirmFrames) + "次一致的姿态才恢复");
     } else {
-        qDebug("【手动控制失败】无法发送 S");
+        LOG_WARN(LogUi, "【手动控制失败】无法发送 S");
         QMessageBox::warning(this, "警告", "UART未初始化，无法发送停止指令！");
     }
 }
 
-// 推理完成槽函数（完全不变）
-void MainWindow::onInferenceFinished(const std::vector<Detection>& detections)
+// 推理完成：日志、跟踪器播种与回放比对已在流水线中完成，这里只刷新状态栏
+void MainWindow::onDetectionFinished(const DetectionResult &result, qint64 inferMs)
 {
-    qDebug() << "\n==================== YOLOv11n 检测结果 ====================";
-
-    // 筛选置信度最高的目标
-    Detection bestDetection;
-    float maxConfidence = 0.0f;
-    for (const Detection& det : detections) {
-        if (det.confidence > maxConfidence) {
-            maxConfidence = det.confidence;
-            bestDetection = det;
-        }
-    }
-
-    // 检测到有效目标
-    if (maxConfidence > 0.0f) {
-        // 原有打印逻辑（完全不变）
-        qDebug() << "检测目标  1 :";
-        qDebug() << "  头部姿态：" << QString::fromStdString(bestDetection.className);
-        qDebug() << "  置信度：" << QString::number(bestDetection.confidence, 'f', 4);
-        qDebug() << "  检测框坐标：x=" << bestDetection.box.x << " y=" << bestDetection.box.y
-                 << " 宽度=" << bestDetection.box.width << " 高度=" << bestDetection.box.height;
-
-        QString temp_pose = QString::fromStdString(bestDetection.className);
-
-        // UART发送逻辑（完全不变）
-        if (uart_fd >= 0) { // 仅当UART初始化成功时发送
-            if (temp_pose == "up") {
-                uart_send_char(uart_fd, 'S'); // up → S
-            } else if (temp_pose == "down") {
-                uart_send_char(uart_fd, 'B'); // down → B
-            } else if (temp_pose == "left") {
-                uart_send_char(uart_fd, 'L'); // left → L
-            } else if (temp_pose == "right") {
-                uart_send_char(uart_fd, 'R'); // right → R
-            } else if (temp_pose == "front") {
-                uart_send_char(uart_fd, 'F'); // front → F
-            } else {
-                uart_send_char(uart_fd, 'S'); // 其他 → S
-            }
-            qDebug() << "【UART发送成功】姿态：" << temp_pose << " → 字符：" << (temp_pose == "up" ? 'S' : (temp_pose == "down" ? 'B' : (temp_pose == "left" ? 'L' : (temp_pose == "right" ? 'R' : (temp_pose == "front" ? 'F' : 'S')))));
-        } else {
-            qDebug() << "【UART发送失败】串口未初始化，无法发送字符";
-        }
-
-        // 原有状态栏逻辑（完全不变）
-        this->statusBar()->showMessage("YOLOv11n检测完成 | 头部姿态：" + QString::fromStdString(bestDetection.className) +
-                               " | 置信度：" + QString::number(bestDetection.confidence, 'f', 2) +
-                               " | 输入尺寸：" + QString("%1x%1").arg(MODEL_INPUT_SIZE) + " | 推理耗时：约10-14秒");
+    UI_SLOT_SCOPE();
+    const Detection *best = result.best();
+    if (best) {
+        this->statusBar()->showMessage("YOLOv11n检测完成 | 头部姿态：" + QString(Inference::getClassName(best->class_id)) +
+                               " | 置信度：" + QString::number(best->confidence, 'f', 2) +
+                               " | 输入尺寸：" + QString("%1x%1").arg(config.inputSize) +
+                               " | 推理耗时：" + QString::number(inferMs) + "ms" +
+                               " | 控制延迟：" + QString::number(pipeline->dispatcher()->lastLatencyNs() / 1000) + "us");
     } else {
-        // 未检测到目标（原有逻辑）
-        qDebug() << "  未检测到头部姿态";
-
-        // 原有状态栏逻辑
-        this->statusBar()->showMessage("YOLOv11n检测完成 | 未检测到头部姿态 | 输入尺寸：" + QString("%1x%1").arg(MODEL_INPUT_SIZE) + " | 推理耗时：约10-14秒");
+        this->statusBar()->showMessage("YOLOv11n检测完成 | 未检测到头部姿态 | 输入尺寸：" + QString("%1x%1").arg(config.inputSize) +
+                               " | 推理耗时：" + QString::number(inferMs) + "ms");
     }
-    qDebug() << "===========================================================\n";
 }
 
-// 摄像头启停（完全不变）
+// 摄像头（或回放）启停
 void MainWindow::toggleCamera()
 {
-    if (!isCameraRunning) {
-        cap.release();
-        bool openSuccess = false;
-        int tryIndex = cameraIndex;
-
-        // 尝试打开摄像头
-        cap.open(tryIndex, cv::CAP_V4L2);
-        if (cap.isOpened()) {
-            cap.set(cv::CAP_PROP_FOURCC, cv::VideoWriter::fourcc('M', 'J', 'P', 'G'));
-            openSuccess = true;
-        }
+    UI_SLOT_SCOPE();
+    if (pipeline->isRunning())
+        pipeline->stop();
+    else
+        pipeline->start();
+}
 
-        // 备用索引
-        if (!openSuccess) {
-            tryIndex = (cameraIndex == 1) ? 0 : 1;
-            cap.open(tryIndex);
-            if (cap.isOpened()) {
-                cap.set(cv::CAP_PROP_FOURCC, cv::VideoWriter::fourcc('M', 'J', 'P', 'G'));
-                openSuccess = true;
-            }
-        }
+void MainWindow::onOpenFailed(const QString &message)
+{
+    UI_SLOT_SCOPE();
+    if (pipeline->isReplay()) {
+        QMessageBox::critical(this, "错误", message);
+        this->statusBar()->showMessage("错误：回放文件打开失败 | " + QString::fromStdString(config.replayPath));
+        return;
+    }
+    // 打开失败提示
+    QMessageBox::critical(this, "错误", "无法打开Q8 HD摄像头！\n解决方案：\n1. 执行 sudo ./OpenCV_CameraMonitor 运行\n2. 更换USB2.0接口\n3. 重启开发板后重试");
+    this->statusBar()->showMessage("错误：摄像头打开失败 | " + message);
+}
 
-        // 打开失败提示
-        if (!openSuccess) {
-            QMessageBox::critical(this, "错误", "无法打开Q8 HD摄像头！\n解决方案：\n1. 执行 sudo ./OpenCV_CameraMonitor 运行\n2. 更换USB2.0接口\n3. 重启开发板后重试");
-            this->statusBar()->showMessage("错误：摄像头打开失败 | 尝试索引：" + QString::number(cameraIndex) + "," + QString::number(tryIndex));
-            return;
+void MainWindow::onRunningChanged(bool running)
+{
+    UI_SLOT_SCOPE();
+    if (running) {
+        displayedFrames = lastDisplayedFrames = 0;
+        displayFps = 0.0;
+        displayFramePending = false;
+        if (config.displayFpsCap > 0) {
+            displayTimer->start();
+        } else {
+            videoWidget->setPlaceholderText("画面显示已关闭（WHEELCHAIR_DISPLAY_FPS=0）\n采集、推理与控制照常运行");
         }
-
-        // 摄像头参数设置
-        cap.set(cv::CAP_PROP_FRAME_WIDTH, MODEL_INPUT_SIZE);
-        cap.set(cv::CAP_PROP_FRAME_HEIGHT, MODEL_INPUT_SIZE * 3 / 4); // 4:3比例
-        cap.set(cv::CAP_PROP_FPS, 10);
-        cap.set(cv::CAP_PROP_BUFFERSIZE, 1);
-        cap.set(cv::CAP_PROP_AUTO_EXPOSURE, 0);
-        cap.set(cv::CAP_PROP_AUTOFOCUS, 0);
-
-        frameCounter = 0;
-
-        // 启动定时器
-        timer->start();
-        isCameraRunning = true;
-        startStopBtn->setText("停止摄像头");
+        startStopBtn->setText(pipeline->isReplay() ? "停止回放" : "停止摄像头");
         captureBtn->setEnabled(true);
-        cameraLabel->setText("");
+        sessionBtn->setEnabled(!pipeline->isReplay());
 
         // 更新状态栏
-        int width = cap.get(cv::CAP_PROP_FRAME_WIDTH);
-        int height = cap.get(cv::CAP_PROP_FRAME_HEIGHT);
-        this->statusBar()->showMessage("Q8 HD摄像头已启动 | 索引：" + QString::number(tryIndex) +
-                               " | 分辨率：" + QString::number(width) + "x" + QString::number(height) +
-                               " | 格式：MJPG | YOLOv11n：每20帧异步检测一次（" + QString("%1x%1").arg(MODEL_INPUT_SIZE) + " | 792MHz）");
+        if (pipeline->isReplay()) {
+            this->statusBar()->showMessage("回放中 | " + QString::fromStdString(pipeline->replay()->description()));
+        } else {
+            cv::Size size = pipeline->camera()->frameSize();
+            this->statusBar()->showMessage("Q8 HD摄像头已启动 | 索引：" + QString::number(pipeline->camera()->openedIndex()) +
+                                   " | 分辨率：" + QString::number(size.width) + "x" + QString::number(size.height) +
+                                   " | 格式：MJPG | YOLOv11n：每" + QString::number(config.inferenceInterval) + "帧异步检测一次（" + QString("%1x%1").arg(config.inputSize) + " | 792MHz）");
+        }
     } else {
-        // 停止摄像头
-        timer->stop();
-        cap.release();
-        isCameraRunning = false;
-        startStopBtn->setText("启动摄像头");
+        displayTimer->stop();
+        sessionBtn->setText("● 开始录制");
+        sessionBtn->setEnabled(false);
+        startStopBtn->setText(pipeline->isReplay() ? "开始回放" : "启动摄像头");
         captureBtn->setEnabled(false);
-        cameraLabel->setText("Q8 HD摄像头已停止\n点击「启动摄像头」重新开始（异步推理不卡UI）");
+        videoWidget->setPlaceholderText("Q8 HD摄像头已停止\n点击「启动摄像头」重新开始（异步推理不卡UI）");
         this->statusBar()->showMessage("摄像头已停止 | OpenCV版本：" + QString(CV_VERSION) +
-                               " | YOLOv11n：" + (isYoloInit ? QString("已加载（%1x%1）").arg(MODEL_INPUT_SIZE) : "未加载") + " | CPU主频：792MHz");
+                               " | YOLOv11n：" + (pipeline->isYoloInit() ? QString("已加载（%1x%1）").arg(config.inputSize) : "未加载") + " | CPU主频：792MHz");
     }
 }
 
-// 更新摄像头画面（完全不变）
-void MainWindow::updateCameraFrame()
+// 每采集一帧：标记有新帧待显示，刷新状态栏
+void MainWindow::onFrameCaptured(bool inferenceRequested)
 {
-    if (!cap.isOpened()) return;
-
-    cv::Mat frame;
-    bool readSuccess = false;
-    // 重试读取帧（避免丢帧）
-    for (int i = 0; i < 3; i++) {
-        if (cap.read(frame)) {
-            readSuccess = true;
-            break;
-        }
-        cv::waitKey(1);
+    UI_SLOT_SCOPE();
+    displayFramePending = true;
+    const cv::Mat &frame = pipeline->latestFrame();
+    if (inferenceRequested) {
+        this->statusBar()->showMessage("YOLOv11n异步推理中 | 当前帧：" + QString::number(pipeline->frameCounter()) +
+                               " | 输入尺寸：" + QString("%1x%1").arg(config.inputSize) + " | UI不阻塞 | 792MHz");
+    } else {
+        this->statusBar()->showMessage("Q8 HD摄像头运行中 | 分辨率：" + QString::number(frame.cols) + "x" + QString::number(frame.rows) +
+                               " | 采集/显示/推理：" + QString::number(pipeline->captureFps(), 'f', 1) + "/" + QString::number(displayFps, 'f', 1) +
+                               "/" + QString::number(pipeline->inferFps(), 'f', 2) + "FPS（已显示" + QString::number(displayedFrames) +
+                               "/" + QString::number(pipeline->capturedFrames()) + "帧） | 检测频率：每" + QString::number(config.inferenceInterval) +
+                               "帧一次（当前帧：" + QString::number(pipeline->frameCounter()) +
+                               "） | 输入尺寸：" + QString("%1x%1").arg(config.inputSize) +
+                               " | 渲染：" + QString::number(videoWidget->lastPaintCostUs()) + "us | 792MHz");
     }
+}
+
+void MainWindow::onFrameReadFailed()
+{
+    UI_SLOT_SCOPE();
+    this->statusBar()->showMessage("警告：Q8摄像头帧读取失败，正在重试...");
+}
+
+void MainWindow::onReplayFinished(const QString &brief, const QString &throughput)
+{
+    UI_SLOT_SCOPE();
+    this->statusBar()->showMessage(brief + " | " + throughput);
+    showToast(brief);
+}
 
-    if (!readSuccess) {
-        this->statusBar()->showMessage("警告：Q8摄像头帧读取失败，正在重试...");
+// 显示最新采集帧：优先级最低，采集滞后时隔一个显示节拍才渲染一次
+void MainWindow::presentFrame()
+{
+    UI_SLOT_SCOPE();
+    const cv::Mat &frame = pipeline->latestFrame();
+    if (!displayFramePending || frame.empty())
+        return;
+
+    if (pipeline->captureContended() && !skippedLastDisplay) {
+        skippedLastDisplay = true;
         return;
     }
+    skippedLastDisplay = false;
+    displayFramePending = false;
+
+    // 直接提交给显示控件（共享帧数据，控件不可见时跳过渲染）
+    if (videoWidget->setFrame(frame))
+        displayedFrames++;
+}
+
+void MainWindow::updateFrameRates()
+{
+    UI_SLOT_SCOPE();
+    displayFps = static_cast<double>(displayedFrames - lastDisplayedFrames);
+    lastDisplayedFrames = displayedFrames;
+
+    const LatencyHistogram &total = pipeline->dispatcher()->pipelineLatency().stages[StageTotal];
+    if (total.count() > 0) {
+        CommandTrace trace;
+        QString last;
+        if (pipeline->dispatcher()->lastAutoTrace(trace))
+            last = QString(" | 帧#%1→%2").arg(trace.frameId).arg(trace.cmd);
+        latencyLabel->setText(QString("端到端 p50 %1ms p99 %2ms 最大 %3ms%4")
+                              .arg(total.percentileUs(50) / 1000.0, 0, 'f', 1)
+                              .arg(total.percentileUs(99) / 1000.0, 0, 'f', 1)
+                              .arg(total.maxUs() / 1000.0, 0, 'f', 1)
+                              .arg(last));
+    }
+}
 
-    frameCounter++;
-    // 每20帧触发一次推理
-    if (isYoloInit && frameCounter % 20 == 0) {
-        inferThread->setFrame(frame);
-        this->statusBar()->showMessage("YOLOv11n异步推理中 | 当前帧：" + QString::number(frameCounter) +
-                               " | 输入尺寸：" + QString("%1x%1").arg(MODEL_INPUT_SIZE) + " | UI不阻塞 | 792MHz");
+// 截图保存：取已采集的最新帧（不再从摄像头额外读一帧），编码与写盘交给后台线程
+void MainWindow::captureScreenshot()
+{
+    UI_SLOT_SCOPE();
+    if (pipeline->latestFrame().empty()) return;
+
+    QString savePath;
+    if (!pipeline->captureSnapshot(savePath)) {
+        showToast("截图过于频繁，正在写盘，请稍后再试");
+        return;
+    }
+    this->statusBar()->showMessage("截图保存中：" + savePath);
+}
+
+void MainWindow::onSnapshotSaved(const QString &path, bool ok, qint64 costMs)
+{
+    UI_SLOT_SCOPE();
+    if (ok) {
+        showToast("截图已保存：" + path);
+        this->statusBar()->showMessage("截图已保存：" + path + " | 写盘耗时：" + QString::number(costMs) + "ms");
     } else {
-        this->statusBar()->showMessage("Q8 HD摄像头运行中 | 分辨率：" + QString::number(frame.cols) + "x" + QString::number(frame.rows) +
-                               " | 帧率：10FPS | 检测频率：每20帧一次（当前帧：" + QString::number(frameCounter) +
-                               "） | 输入尺寸：" + QString("%1x%1").arg(MODEL_INPUT_SIZE) + " | 792MHz");
+        showToast("截图保存失败：" + path);
+        this->statusBar()->showMessage("截图保存失败：" + path);
     }
+}
 
-    // 转换格式并显示
-    cv::Mat rgbFrame;
-    cv::cvtColor(frame, rgbFrame, cv::COLOR_BGR2RGB);
-    QImage qImage(rgbFrame.data, rgbFrame.cols, rgbFrame.rows, rgbFrame.step, QImage::Format_RGB888);
-    QPixmap pixmap = QPixmap::fromImage(qImage).scaled(
-        cameraLabel->size(), Qt::KeepAspectRatio
-    );
-    cameraLabel->setPixmap(pixmap);
+void MainWindow::onRecorderDumpClicked()
+{
+    UI_SLOT_SCOPE();
+    pipeline->dumpFlightRecorder();
+    showToast(QString("黑匣子将在%1秒后转储到 %2").arg(pipeline->recorder()->dumpDelayMs / 1000.0, 0, 'f', 1)
+              .arg(config.recorderDir.c_str()));
 }
 
-// 截图保存（完全不变）
-void MainWindow::captureScreenshot()
+void MainWindow::onSessionRecordClicked()
 {
-    if (!cap.isOpened()) return;
+    UI_SLOT_SCOPE();
+    QString message;
+    if (!pipeline->setSessionRecording(!pipeline->isSessionRecording(), message))
+        showToast(message);
+}
 
-    cv::Mat frame;
-    cap.read(frame);
-    if (frame.empty()) return;
+void MainWindow::onSessionRecordingChanged(bool recording, const QString &message)
+{
+    UI_SLOT_SCOPE();
+    sessionBtn->setText(recording ? "■ 停止录制" : "● 开始录制");
+    showToast(message);
+}
 
-    // 生成带时间戳的文件名
-    QString timestamp = QDateTime::currentDateTime().toString("yyyyMMdd_hhmmss");
-    QString savePath = QString("/root/q8_yolov11n_capture_%1_%2x%2.jpg").arg(timestamp).arg(MODEL_INPUT_SIZE);
-    cv::imwrite(savePath.toStdString(), frame);
+void MainWindow::onStatusMessage(const QString &text)
+{
+    UI_SLOT_SCOPE();
+    this->statusBar()->showMessage(text);
+}
 
-    // 提示保存成功
-    QMessageBox::information(this, "截图成功", "Q8摄像头截图已保存：\n" + savePath);
-    this->statusBar()->showMessage("截图已保存：" + savePath +
-                           " | 输入尺寸：" + QString("%1x%1").arg(MODEL_INPUT_SIZE) + " | 异步推理不卡UI | 792MHz");
+void MainWindow::showToast(const QString &text)
+{
+    toastLabel->setText(text);
+    toastLabel->adjustSize();
+    int bottom = statusBar()->isVisible() ? statusBar()->y() : height();
+    toastLabel->move((width() - toastLabel->width()) / 2, bottom - toastLabel->height() - 16);
+    toastLabel->raise();
+    toastLabel->show();
+    toastTimer->start();
 }
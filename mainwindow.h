@@ -15,79 +15,13 @@
 #include <QFile>
 #include <QThread>
 #include <QMutex>
-#include <QMetaType>
+#include <QSocketNotifier>
 #include <QDebug>
+#include <QElapsedTimer>
 #include "inference.h"  // 引入宏定义
-#include "uart_master.h" // 新增：引入UART头文件
-
-Q_DECLARE_METATYPE(std::vector<Detection>);
-
-// 推理线程类（完全不变）
-class YoloInferThread : public QThread
-{
-    Q_OBJECT
-public:
-    YoloInferThread(const std::string& onnxPath, QObject *parent = nullptr)
-        : QThread(parent), onnxModelPath(onnxPath), running(false), newFrameAvailable(false), isInitSuccess(false) {
-        // 使用宏定义初始化尺寸
-        try {
-            yoloInfer = new Inference(onnxModelPath, cv::Size(MODEL_INPUT_SIZE, MODEL_INPUT_SIZE), "", false);
-            isInitSuccess = true;
-        } catch (...) {
-            isInitSuccess = false;
-        }
-    }
-
-    ~YoloInferThread() {
-        stop();
-        if (yoloInfer) {
-            yoloInfer->release();
-            delete yoloInfer;
-        }
-    }
-
-    void setFrame(const cv::Mat& frame) {
-        QMutexLocker locker(&mutex);
-        inputFrame = frame.clone();
-        newFrameAvailable = true;
-    }
-
-    void stop() {
-        running = false;
-        wait();
-    }
-
-    bool isInit() const { return isInitSuccess; }
-
-signals:
-    void inferenceFinished(const std::vector<Detection>& detections);
-
-protected:
-    void run() override {
-        running = true;
-        while (running) {
-            if (newFrameAvailable) {
-                QMutexLocker locker(&mutex);
-                std::vector<Detection> dets;
-                if (yoloInfer) {
-                    dets = yoloInfer->runInference(inputFrame);
-                }
-                newFrameAvailable = false;
-                emit inferenceFinished(dets);
-            }
-            msleep(20);
-        }
-    }
-
-private:
-    std::string onnxModelPath;
-    bool running;
-    QMutex mutex;
-    cv::Mat inputFrame;
-    bool newFrameAvailable;
-    bool isInitSuccess;
-    Inference *yoloInfer;
-};
+#include "video_widget.h"
+#include "app_config.h"
+#include "pipeline.h"
 
 // 主窗口类（新增方向按钮+停止按钮成员变量）
 class MainWindow : public QMainWindow
@@ -95,23 +29,41 @@ class MainWindow : public QMainWindow
     Q_OBJECT
 
 public:
-    MainWindow(QWidget *parent = nullptr);
+    explicit MainWindow(const AppConfig &appConfig, QWidget *parent = nullptr);
     ~MainWindow();
 
 private slots:
     void toggleCamera();
-    void updateCameraFrame();
+    void presentFrame();        // 显示定时器：把最新采集帧交给显示控件
+    void updateFrameRates();    // 每秒刷新显示帧率与端到端延迟
     void captureScreenshot();
-    void onInferenceFinished(const std::vector<Detection>& detections);
     // 新增：方向按钮+停止按钮槽函数
     void onForwardBtnClicked();   // 向前 → F
     void onBackwardBtnClicked();  // 向后 → B
     void onLeftBtnClicked();      // 向左 → L
     void onRightBtnClicked();     // 向右 → R
     void onStopBtnClicked();      // 停止 → S
+    void onResumeAutoBtnClicked(); // 确认恢复自动控制
+    void onInputCommand(char cmd); // 物理输入（已由控制线程下发，这里只做界面反馈）
+    void onSnapshotSaved(const QString &path, bool ok, qint64 costMs);
+    void onRecorderDumpClicked();   // 手动转储黑匣子
+    void onSessionRecordClicked();  // 开始/停止连续录制
+
+    // 流水线状态 → 界面
+    void onRunningChanged(bool running);
+    void onOpenFailed(const QString &message);
+    void onFrameCaptured(bool inferenceRequested);
+    void onFrameReadFailed();
+    void onDetectionFinished(const DetectionResult &result, qint64 inferMs);
+    void onReplayFinished(const QString &brief, const QString &throughput);
+    void onSessionRecordingChanged(bool recording, const QString &message);
+    void onStatusMessage(const QString &text);
 
 private:
-    QLabel *cameraLabel;
+    void showToast(const QString &text);   // 非模态提示，数秒后自动消失
+
+    VideoWidget *videoWidget;
+    QLabel *latencyLabel;       // 状态栏常驻：端到端延迟
     QPushButton *startStopBtn;
     QPushButton *captureBtn;
 
@@ -121,17 +73,22 @@ private:
     QPushButton *leftBtn;      // 向左（左）
     QPushButton *rightBtn;     // 向右（右）
     QPushButton *stopBtn;      // 停止（中）
-
-    cv::VideoCapture cap;
-    QTimer *timer;
-    bool isCameraRunning;
-    int cameraIndex;
-    int frameCounter;  // 先声明
-    bool isYoloInit;   // 后声明
-    YoloInferThread *inferThread;
-
-    //UART文件描述符
-    int uart_fd;
+    QPushButton *resumeAutoBtn; // 恢复自动控制
+    QPushButton *recorderBtn;   // 保存黑匣子
+    QPushButton *sessionBtn;    // 连续录制
+
+    AppConfig config;
+    Pipeline *pipeline;         // 采集/推理/控制（无界面模式下单独运行）
+    QTimer *displayTimer;       // 显示与采集解耦，按displayFpsCap独立节拍
+    QLabel *toastLabel;
+    QTimer *toastTimer;
+
+    // 显示调度：采集节拍滞后时（CPU被推理/控制占满）显示降频让路
+    bool displayFramePending;
+    bool skippedLastDisplay;
+    quint64 displayedFrames;
+    quint64 lastDisplayedFrames;
+    double displayFps;
 };
 
 #endif // MAINWINDOW_H
@@ -0,0 +1,161 @@
+#include "metrics_registry.h"
+#include "pipeline_latency.h"
+#include "command_arbiter.h"
+#include <math.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+MetricsRegistry::MetricsRegistry()
+{
+}
+
+MetricsRegistry::~MetricsRegistry()
+{
+    for (size_t i = 0; i < entries.size(); ++i) {
+        delete entries[i].ownCounter;
+        delete entries[i].ownGauge;
+    }
+}
+
+MetricsRegistry::Entry &MetricsRegistry::add(const char *name, const char *help, Kind kind, const std::string &labels)
+{
+    Entry e;
+    e.name = name;
+    e.help = help;
+    e.kind = kind;
+    e.labels = labels;
+    e.ownCounter = nullptr;
+    e.ownGauge = nullptr;
+    e.hist = nullptr;
+    e.latency = nullptr;
+    entries.push_back(e);
+    return entries.back();
+}
+
+MetricCounter *MetricsRegistry::counter(const char *name, const char *help, const std::string &labels)
+{
+    Entry &e = add(name, help, KindCounter, labels);
+    e.ownCounter = new MetricCounter;
+    return e.ownCounter;
+}
+
+MetricGauge *MetricsRegistry::gauge(const char *name, const char *help, const std::string &labels)
+{
+    Entry &e = add(name, help, KindGauge, labels);
+    e.ownGauge = new MetricGauge;
+    return e.ownGauge;
+}
+
+void MetricsRegistry::counterFn(const char *name, const char *help, std::function<double()> read,
+                                const std::string &labels)
+{
+    add(name, help, KindCounter, labels).read = read;
+}
+
+void MetricsRegistry::gaugeFn(const char *name, const char *help, std::function<double()> read,
+                              const std::string &labels)
+{
+    add(name, help, KindGauge, labels).read = read;
+}
+
+void MetricsRegistry::histogram(const char *name, const char *help, const LatencyHistogram *hist,
+                                const std::string &labels)
+{
+    add(name, help, KindHistogram, labels).hist = hist;
+}
+
+void MetricsRegistry::summary(const char *name, const char *help, const LatencyCounter *counter,
+                              const std::string &labels)
+{
+    add(name, help, KindSummary, labels).latency = counter;
+}
+
+static void appendf(std::string &out, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+
+static void appendf(std::string &out, const char *fmt, ...)
+{
+    char buf[512];
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(buf, sizeof(buf), fmt, ap);
+    va_end(ap);
+    if (n > 0)
+        out.append(buf, static_cast<size_t>(n) < sizeof(buf) ? n : sizeof(buf) - 1);
+}
+
+// name{labels,extra} value
+static void appendSample(std::string &out, const char *name, const char *suffix, const std::string &labels,
+                         const char *extra, double value)
+{
+    out += name;
+    out += suffix;
+    if (!labels.empty() || extra) {
+        out += '{';
+        out += labels;
+        if (extra) {
+            if (!labels.empty())
+                out += ',';
+            out += extra;
+        }
+        out += '}';
+    }
+    // 计数类按整数原样输出，其余保留9位有效数字
+    if (value == floor(value) && fabs(value) < 9007199254740992.0)
+        appendf(out, " %.0f\n", value);
+    else
+        appendf(out, " %.9g\n", value);
+}
+
+// 桶计数先读一遍再求累计值与总数，保证+Inf桶与_count一致（写端并发时各桶之间不要求同一时刻）
+void MetricsRegistry::renderHistogram(const Entry &e, std::string &out) const
+{
+    uint64_t counts[LatencyHistogram::kBuckets];
+    for (int i = 0; i < LatencyHistogram::kBuckets; ++i)
+        counts[i] = e.hist->bucketCount(i);
+
+    uint64_t cumulative = 0;
+    char le[48];
+    // 最后一个桶收纳所有超出范围的样本，只在+Inf中体现
+    for (int i = 0; i < LatencyHistogram::kBuckets - 1; ++i) {
+        cumulative += counts[i];
+        // 样本按纳秒截断到微秒入桶，桶上界+1us即真实值的上界
+        snprintf(le, sizeof(le), "le=\"%.9g\"", (LatencyHistogram::bucketUpperUs(i) + 1) / 1e6);
+        appendSample(out, e.name, "_bucket", e.labels, le, static_cast<double>(cumulative));
+    }
+    cumulative += counts[LatencyHistogram::kBuckets - 1];
+    appendSample(out, e.name, "_bucket", e.labels, "le=\"+Inf\"", static_cast<double>(cumulative));
+    appendSample(out, e.name, "_sum", e.labels, nullptr, e.hist->sumNs() / 1e9);
+    appendSample(out, e.name, "_count", e.labels, nullptr, static_cast<double>(cumulative));
+}
+
+void MetricsRegistry::render(std::string &out) const
+{
+    static const char *const kTypeNames[] = {"counter", "gauge", "histogram", "summary"};
+    const char *lastName = nullptr;
+    for (size_t i = 0; i < entries.size(); ++i) {
+        const Entry &e = entries[i];
+        if (!lastName || strcmp(lastName, e.name) != 0) {
+            appendf(out, "# HELP %s %s\n# TYPE %s %s\n", e.name, e.help, e.name, kTypeNames[e.kind]);
+            lastName = e.name;
+        }
+        switch (e.kind) {
+        case KindCounter:
+            appendSample(out, e.name, "", e.labels, nullptr,
+                         e.ownCounter ? static_cast<double>(e.ownCounter->value()) : e.read());
+            break;
+        case KindGauge:
+            appendSample(out, e.name, "", e.labels, nullptr,
+                         e.ownGauge ? static_cast<double>(e.ownGauge->value()) : e.read());
+            break;
+        case KindHistogram:
+            renderHistogram(e, out);
+            break;
+        case KindSummary:
+            appendSample(out, e.name, "_sum", e.labels, nullptr, e.latency->total.load(std::memory_order_relaxed) / 1e9);
+            appendSample(out, e.name, "_count", e.labels, nullptr,
+                         static_cast<double>(e.latency->count.load(std::memory_order_relaxed)));
+            break;
+        }
+    }
+}
@@ -0,0 +1,86 @@
+#ifndef METRICS_REGISTRY_H
+#define METRICS_REGISTRY_H
+
+#include <atomic>
+#include <functional>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+class LatencyHistogram;
+struct LatencyCounter;
+
+// 计数器：只增不减，任意线程无锁累加
+class MetricCounter
+{
+public:
+    void inc(uint64_t n = 1) { v.fetch_add(n, std::memory_order_relaxed); }
+    uint64_t value() const { return v.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> v {0};
+};
+
+// 仪表：当前值，任意线程无锁写入
+class MetricGauge
+{
+public:
+    void set(int64_t x) { v.store(x, std::memory_order_relaxed); }
+    void add(int64_t d) { v.fetch_add(d, std::memory_order_relaxed); }
+    int64_t value() const { return v.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<int64_t> v {0};
+};
+
+// 进程内指标注册表，按Prometheus文本格式（0.0.4）导出。
+// - 热点路径只碰原子变量：自有计数器/仪表是relaxed原子操作，已有模块的原子计数与
+//   LatencyHistogram直接登记引用/读取函数，不增加任何写端开销
+// - 登记只在启动时（导出线程start()之前）进行，之后条目表只读，导出时不加锁
+// - 读取函数在导出线程中调用，只能读取原子变量或其他线程安全的状态
+// name同名的多条（标签不同）共用一组HELP/TYPE，须连续登记。
+class MetricsRegistry
+{
+public:
+    MetricsRegistry();
+    ~MetricsRegistry();
+
+    // labels为Prometheus标签串（不含花括号），如 stage="infer"
+    MetricCounter *counter(const char *name, const char *help, const std::string &labels = std::string());
+    MetricGauge *gauge(const char *name, const char *help, const std::string &labels = std::string());
+    void counterFn(const char *name, const char *help, std::function<double()> read,
+                   const std::string &labels = std::string());
+    void gaugeFn(const char *name, const char *help, std::function<double()> read,
+                 const std::string &labels = std::string());
+    // 延迟直方图：桶边界换算为秒（对数分桶，每个2的幂区间4个子桶）
+    void histogram(const char *name, const char *help, const LatencyHistogram *hist,
+                   const std::string &labels = std::string());
+    // 只有总和与次数的延迟汇总（LatencyCounter，纳秒），导出为不带分位数的summary
+    void summary(const char *name, const char *help, const LatencyCounter *counter,
+                 const std::string &labels = std::string());
+
+    // 导出全部指标，追加到out
+    void render(std::string &out) const;
+
+private:
+    enum Kind { KindCounter, KindGauge, KindHistogram, KindSummary };
+    struct Entry
+    {
+        const char *name;
+        const char *help;
+        Kind kind;
+        std::string labels;
+        MetricCounter *ownCounter;
+        MetricGauge *ownGauge;
+        std::function<double()> read;
+        const LatencyHistogram *hist;
+        const LatencyCounter *latency;
+    };
+
+    Entry &add(const char *name, const char *help, Kind kind, const std::string &labels);
+    void renderHistogram(const Entry &e, std::string &out) const;
+
+    std::vector<Entry> entries;
+};
+
+#endif // METRICS_REGISTRY_H
@@ -0,0 +1,207 @@
+#include "metrics_server.h"
+#include "metrics_registry.h"
+#include <sys/eventfd.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <poll.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+static bool sendAll(int fd, const char *data, size_t len)
+{
+    while (len > 0) {
+        ssize_t n = send(fd, data, len, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        data += n;
+        len -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+MetricsServer::MetricsServer(const MetricsRegistry *registry, QObject *parent)
+    : QThread(parent)
+    , registry(registry)
+    , listenFd(-1)
+    , running(true)   // run()只读不写：stop()可能早于run()执行
+    , served(0)
+{
+    wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+}
+
+MetricsServer::~MetricsServer()
+{
+    stop();
+    if (listenFd >= 0)
+        close(listenFd);
+    if (!unixPath.empty())
+        unlink(unixPath.c_str());
+    if (wakeFd >= 0)
+        close(wakeFd);
+}
+
+bool MetricsServer::listen(const std::string &address, std::string &error)
+{
+    struct sockaddr_storage storage;
+    memset(&storage, 0, sizeof(storage));
+    socklen_t length;
+    int family;
+
+    if (address.compare(0, 5, "unix:") == 0) {
+        struct sockaddr_un *un = reinterpret_cast<struct sockaddr_un *>(&storage);
+        std::string path = address.substr(5);
+        if (path.empty() || path.size() >= sizeof(un->sun_path)) {
+            error = "Unix域套接字路径无效: " + path;
+            return false;
+        }
+        un->sun_family = AF_UNIX;
+        memcpy(un->sun_path, path.c_str(), path.size() + 1);
+        length = sizeof(struct sockaddr_un);
+        family = AF_UNIX;
+        // 上次异常退出留下的套接字文件
+        unlink(path.c_str());
+        unixPath = path;
+    } else {
+        struct sockaddr_in *in = reinterpret_cast<struct sockaddr_in *>(&storage);
+        std::string host = "127.0.0.1";
+        std::string port = address;
+        size_t colon = address.rfind(':');
+        if (colon != std::string::npos) {
+            host = address.substr(0, colon);
+            port = address.substr(colon + 1);
+        }
+        char *end = nullptr;
+        long portValue = strtol(port.c_str(), &end, 10);
+        if (port.empty() || *end != '\0' || portValue <= 0 || portValue > 65535) {
+            error = "端口无效: " + address;
+            return false;
+        }
+        in->sin_family = AF_INET;
+        in->sin_port = htons(static_cast<uint16_t>(portValue));
+        if (inet_pton(AF_INET, host.c_str(), &in->sin_addr) != 1) {
+            error = "IPv4地址无效: " + host;
+            return false;
+        }
+        length = sizeof(struct sockaddr_in);
+        family = AF_INET;
+    }
+
+    int fd = socket(family, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        error = strerror(errno);
+        return false;
+    }
+    if (family == AF_INET) {
+        int one = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    }
+    if (bind(fd, reinterpret_cast<struct sockaddr *>(&storage), length) < 0 || ::listen(fd, 4) < 0) {
+        error = address + ": " + strerror(errno);
+        close(fd);
+        unixPath.clear();
+        return false;
+    }
+    listenFd = fd;
+    bound = address;
+    return true;
+}
+
+void MetricsServer::stop()
+{
+    if (!isRunning())
+        return;
+    running = false;
+    uint64_t one = 1;
+    if (write(wakeFd, &one, sizeof(one)) != sizeof(one)) {
+    }
+    wait();
+}
+
+void MetricsServer::run()
+{
+    // 只影响本线程（Linux下PRIO_PROCESS作用于线程）：抓取时让出CPU给采集/推理/控制
+    setpriority(PRIO_PROCESS, 0, 10);
+
+    struct pollfd pfd[2];
+    pfd[0].fd = listenFd;
+    pfd[0].events = POLLIN;
+    pfd[1].fd = wakeFd;
+    pfd[1].events = POLLIN;
+    while (running) {
+        pfd[0].revents = pfd[1].revents = 0;
+        if (poll(pfd, 2, -1) < 0 && errno != EINTR)
+            break;
+        if (pfd[1].revents & POLLIN) {
+            uint64_t n;
+            while (read(wakeFd, &n, sizeof(n)) == sizeof(n)) {
+            }
+        }
+        if (!running)
+            break;
+        if (!(pfd[0].revents & POLLIN))
+            continue;
+        int client = accept4(listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (client < 0)
+            continue;
+        serve(client);
+        close(client);
+    }
+}
+
+// 读请求行，只认GET /metrics（和/）；其余返回404/405
+void MetricsServer::serve(int fd)
+{
+    struct timeval timeout;
+    timeout.tv_sec = 1;
+    timeout.tv_usec = 0;
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+    char request[2048];
+    size_t used = 0;
+    while (used < sizeof(request) - 1) {
+        ssize_t n = recv(fd, request + used, sizeof(request) - 1 - used, 0);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            break;
+        used += static_cast<size_t>(n);
+        request[used] = '\0';
+        if (strstr(request, "\r\n\r\n") || strstr(request, "\n\n"))
+            break;
+    }
+    request[used] = '\0';
+
+    const char *status = "200 OK";
+    bool isGet = strncmp(request, "GET ", 4) == 0;
+    const char *path = request + 4;
+    size_t pathLen = isGet ? strcspn(path, " ?\r\n") : 0;
+    body.clear();
+    if (!isGet) {
+        status = "405 Method Not Allowed";
+        body = "only GET is supported\n";
+    } else if ((pathLen == 8 && strncmp(path, "/metrics", 8) == 0) || (pathLen == 1 && path[0] == '/')) {
+        registry->render(body);
+    } else {
+        status = "404 Not Found";
+        body = "try /metrics\n";
+    }
+
+    char header[256];
+    int headerLen = snprintf(header, sizeof(header),
+                             "HTTP/1.0 %s\r\nContent-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+                             "Content-Length: %zu\r\nConnection: close\r\n\r\n",
+                             status, body.size());
+    if (sendAll(fd, header, static_cast<size_t>(headerLen)))
+        sendAll(fd, body.data(), body.size());
+    served.fetch_add(1, std::memory_order_relaxed);
+}
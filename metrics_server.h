@@ -0,0 +1,46 @@
+#ifndef METRICS_SERVER_H
+#define METRICS_SERVER_H
+
+#include <QThread>
+#include <atomic>
+#include <string>
+#include <stdint.h>
+
+class MetricsRegistry;
+
+// 指标导出线程：监听本机TCP端口或Unix域套接字，对 GET /metrics 返回Prometheus文本格式。
+//   curl http://127.0.0.1:9101/metrics
+//   curl --unix-socket /run/wheelchair.sock http://localhost/metrics
+// - 逐个处理连接（HTTP/1.0，响应后关闭），读写都有超时，慢客户端不会拖住线程
+// - 导出只读取原子变量，不与采集/推理/控制线程争锁；本线程降低调度优先级，抓取时不抢占热点线程
+class MetricsServer : public QThread
+{
+    Q_OBJECT
+public:
+    explicit MetricsServer(const MetricsRegistry *registry, QObject *parent = nullptr);
+    ~MetricsServer();
+
+    // address："端口"、"主机:端口"（主机为IPv4地址）或"unix:/路径"；失败时返回false并在error中给出原因
+    bool listen(const std::string &address, std::string &error);
+    void stop();
+
+    const std::string &boundAddress() const { return bound; }
+    uint64_t requestsServed() const { return served.load(std::memory_order_relaxed); }
+
+protected:
+    void run() override;
+
+private:
+    void serve(int fd);
+
+    const MetricsRegistry *registry;
+    int listenFd;
+    int wakeFd;
+    std::string unixPath;   // Unix域套接字路径，停止时删除
+    std::string bound;
+    std::atomic<bool> running;
+    std::atomic<uint64_t> served;
+    std::string body;       // 导出线程内复用
+};
+
+#endif // METRICS_SERVER_H
@@ -0,0 +1,61 @@
+// 自研native后端：固定尺寸YOLO专用的精简运行时（见native_model.h），不依赖第三方推理库，始终编译
+#include "inference_backend.h"
+#include "native_model.h"
+#include "async_logger.h"
+#include <vector>
+
+// 模型首次加载时打包成同名.wcm并mmap；输入直接引用inputTensor()的内存，输出引用arena，保留到下一帧
+class NativeBackend : public InferenceBackend
+{
+public:
+    const char *name() const override { return "native"; }
+
+    // 单线程执行，options中的线程数/Winograd不适用
+    bool load(const std::string &modelPath, const cv::Size &inputShape,
+              const InferenceBackendOptions &options, std::string &error) override
+    {
+        (void)options;
+        if (!model.load(modelPath, inputShape, false, error))
+            return false;
+        if (!model.repackReason().empty())
+            LOG_INFO(LogInfer, "native模型已重新打包（%s）: %s", model.repackReason(), model.packedPath());
+        LOG_INFO(LogInfer, "native模型: %d个算子，arena %d KB，权重 %d KB", model.opCount(),
+                 static_cast<int>(model.arenaBytes() / 1024), static_cast<int>(model.weightsBytes() / 1024));
+        return true;
+    }
+
+    cv::Mat &inputTensor() override { return blob; }
+
+    bool run() override
+    {
+        if (!model.isLoaded() || blob.empty() || !blob.isContinuous() || blob.type() != CV_32F)
+            return false;
+        if (blob.total() * sizeof(float) != model.inputBytes())
+            return false;
+        if (!model.run(blob.ptr<float>()))
+            return false;
+        outputs.resize(model.outputCount());
+        for (int i = 0; i < model.outputCount(); ++i)
+            outputs[i] = model.output(i);
+        return !outputs.empty();
+    }
+
+    int outputCount() const override { return static_cast<int>(outputs.size()); }
+    const cv::Mat &outputTensor(int index) const override { return outputs[index]; }
+
+    void release() override
+    {
+        outputs.clear();
+        model.release();
+    }
+
+private:
+    NativeModel model;
+    cv::Mat blob;
+    std::vector<cv::Mat> outputs;
+};
+
+InferenceBackend *createNativeBackend()
+{
+    return new NativeBackend;
+}
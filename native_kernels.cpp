@@ -0,0 +1,477 @@
+#include "native_kernels.h"
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+
+#ifdef __ARM_NEON
+#include <arm_neon.h>
+#endif
+
+static inline float scalarActivate(float x, int act)
+{
+    switch (act) {
+    case ActSilu:
+        return x / (1.0f + expf(-x));
+    case ActSigmoid:
+        return 1.0f / (1.0f + expf(-x));
+    case ActRelu:
+        return x > 0.0f ? x : 0.0f;
+    default:
+        return x;
+    }
+}
+
+#ifdef __ARM_NEON
+// exp(x)：x = n*ln2 + r，2^n直接拼指数位，e^r用cephes的5阶多项式，相对误差约1e-7
+static inline float32x4_t expNeon(float32x4_t x)
+{
+    x = vminq_f32(x, vdupq_n_f32(88.3762626647949f));
+    x = vmaxq_f32(x, vdupq_n_f32(-88.3762626647949f));
+
+    // n = floor(x*log2(e) + 0.5)；vcvtq向零取整，负数需再减1
+    float32x4_t fx = vmlaq_f32(vdupq_n_f32(0.5f), x, vdupq_n_f32(1.44269504088896341f));
+    float32x4_t n = vcvtq_f32_s32(vcvtq_s32_f32(fx));
+    uint32x4_t over = vcgtq_f32(n, fx);
+    n = vsubq_f32(n, vreinterpretq_f32_u32(vandq_u32(over, vreinterpretq_u32_f32(vdupq_n_f32(1.0f)))));
+
+    // r = x - n*ln2（ln2拆成高低两部分减少误差）
+    x = vmlsq_f32(x, n, vdupq_n_f32(0.693359375f));
+    x = vmlsq_f32(x, n, vdupq_n_f32(-2.12194440e-4f));
+
+    float32x4_t y = vdupq_n_f32(1.9875691500e-4f);
+    y = vmlaq_f32(vdupq_n_f32(1.3981999507e-3f), y, x);
+    y = vmlaq_f32(vdupq_n_f32(8.3334519073e-3f), y, x);
+    y = vmlaq_f32(vdupq_n_f32(4.1665795894e-2f), y, x);
+    y = vmlaq_f32(vdupq_n_f32(1.6666665459e-1f), y, x);
+    y = vmlaq_f32(vdupq_n_f32(5.0000001201e-1f), y, x);
+    y = vmlaq_f32(x, y, vmulq_f32(x, x));
+    y = vaddq_f32(y, vdupq_n_f32(1.0f));
+
+    int32x4_t e = vshlq_n_s32(vaddq_s32(vcvtq_s32_f32(n), vdupq_n_s32(127)), 23);
+    return vmulq_f32(y, vreinterpretq_f32_s32(e));
+}
+
+// 1/(1+exp(-x))：倒数用vrecpe估计再做两次牛顿迭代（ARMv7 NEON没有除法）
+static inline float32x4_t sigmoidNeon(float32x4_t x)
+{
+    float32x4_t d = vaddq_f32(vdupq_n_f32(1.0f), expNeon(vnegq_f32(x)));
+    float32x4_t r = vrecpeq_f32(d);
+    r = vmulq_f32(vrecpsq_f32(d, r), r);
+    r = vmulq_f32(vrecpsq_f32(d, r), r);
+    return r;
+}
+
+static inline float32x4_t activateNeon(float32x4_t v, int act)
+{
+    switch (act) {
+    case ActSilu:
+        return vmulq_f32(v, sigmoidNeon(v));
+    case ActSigmoid:
+        return sigmoidNeon(v);
+    case ActRelu:
+        return vmaxq_f32(v, vdupq_n_f32(0.0f));
+    default:
+        return v;
+    }
+}
+#endif
+
+void nativeActivate(float *data, size_t n, int act)
+{
+    if (act == ActNone)
+        return;
+    size_t i = 0;
+#ifdef __ARM_NEON
+    for (; i + 4 <= n; i += 4)
+        vst1q_f32(data + i, activateNeon(vld1q_f32(data + i), act));
+#endif
+    for (; i < n; ++i)
+        data[i] = scalarActivate(data[i], act);
+}
+
+static inline float scalarBinary(int op, float a, float b)
+{
+    switch (op) {
+    case BinaryAdd:
+        return a + b;
+    case BinarySub:
+        return a - b;
+    case BinaryMul:
+        return a * b;
+    default:
+        return a / b;
+    }
+}
+
+#ifdef __ARM_NEON
+static inline float32x4_t binaryNeon(int op, float32x4_t a, float32x4_t b)
+{
+    switch (op) {
+    case BinaryAdd:
+        return vaddq_f32(a, b);
+    case BinarySub:
+        return vsubq_f32(a, b);
+    case BinaryMul:
+        return vmulq_f32(a, b);
+    default: {
+        float32x4_t r = vrecpeq_f32(b);
+        r = vmulq_f32(vrecpsq_f32(b, r), r);
+        r = vmulq_f32(vrecpsq_f32(b, r), r);
+        return vmulq_f32(a, r);
+    }
+    }
+}
+#endif
+
+void nativeBinary(int op, const float *a, const float *b, float *out, size_t n)
+{
+    size_t i = 0;
+#ifdef __ARM_NEON
+    for (; i + 4 <= n; i += 4)
+        vst1q_f32(out + i, binaryNeon(op, vld1q_f32(a + i), vld1q_f32(b + i)));
+#endif
+    for (; i < n; ++i)
+        out[i] = scalarBinary(op, a[i], b[i]);
+}
+
+void nativeBinaryScalar(int op, float s, const float *b, float *out, size_t n, bool scalarFirst)
+{
+    size_t i = 0;
+#ifdef __ARM_NEON
+    float32x4_t vs = vdupq_n_f32(s);
+    if (scalarFirst) {
+        for (; i + 4 <= n; i += 4)
+            vst1q_f32(out + i, binaryNeon(op, vs, vld1q_f32(b + i)));
+    } else {
+        for (; i + 4 <= n; i += 4)
+            vst1q_f32(out + i, binaryNeon(op, vld1q_f32(b + i), vs));
+    }
+#endif
+    for (; i < n; ++i)
+        out[i] = scalarFirst ? scalarBinary(op, s, b[i]) : scalarBinary(op, b[i], s);
+}
+
+// ---------------- GEMM ----------------
+
+size_t nativePackedWeightsFloats(int m, int k)
+{
+    return static_cast<size_t>((m + 3) / 4) * 4 * k;
+}
+
+void nativePackWeights(const float *a, int m, int k, float *packed)
+{
+    for (int mb = 0; mb < m; mb += 4) {
+        float *panel = packed + static_cast<size_t>(mb) * k;
+        for (int p = 0; p < k; ++p) {
+            for (int r = 0; r < 4; ++r)
+                panel[p * 4 + r] = mb + r < m ? a[static_cast<size_t>(mb + r) * k + p] : 0.0f;
+        }
+    }
+}
+
+// 4行 x w列（w<=8）的块：累加在acc中，写回时加bias、做激活
+static inline void storeBlock(const float acc[4][8], int rows, int w, float *c, int ldc, int act)
+{
+    for (int r = 0; r < rows; ++r) {
+        float *dst = c + static_cast<size_t>(r) * ldc;
+        for (int j = 0; j < w; ++j)
+            dst[j] = scalarActivate(acc[r][j], act);
+    }
+}
+
+void nativeGemm(const float *packedA, const float *b, int ldb, float *c, int ldc,
+                int m, int k, int n, const float *bias, int act)
+{
+    for (int mb = 0; mb < m; mb += 4) {
+        const float *ap = packedA + static_cast<size_t>(mb) * k;
+        int rows = std::min(4, m - mb);
+        float b4[4];
+        for (int r = 0; r < 4; ++r)
+            b4[r] = bias && r < rows ? bias[mb + r] : 0.0f;
+        float *crow = c + static_cast<size_t>(mb) * ldc;
+
+        int j = 0;
+#ifdef __ARM_NEON
+        // 4x8微内核：8个q寄存器做累加，每步1次A加载、2次B加载、8次乘加
+        for (; j + 8 <= n; j += 8) {
+            float32x4_t c00 = vdupq_n_f32(b4[0]), c01 = c00;
+            float32x4_t c10 = vdupq_n_f32(b4[1]), c11 = c10;
+            float32x4_t c20 = vdupq_n_f32(b4[2]), c21 = c20;
+            float32x4_t c30 = vdupq_n_f32(b4[3]), c31 = c30;
+            const float *bp = b + j;
+            for (int p = 0; p < k; ++p, bp += ldb) {
+                float32x4_t a = vld1q_f32(ap + p * 4);
+                float32x4_t b0 = vld1q_f32(bp);
+                float32x4_t b1 = vld1q_f32(bp + 4);
+                float32x2_t alo = vget_low_f32(a);
+                float32x2_t ahi = vget_high_f32(a);
+                c00 = vmlaq_lane_f32(c00, b0, alo, 0);
+                c01 = vmlaq_lane_f32(c01, b1, alo, 0);
+                c10 = vmlaq_lane_f32(c10, b0, alo, 1);
+                c11 = vmlaq_lane_f32(c11, b1, alo, 1);
+                c20 = vmlaq_lane_f32(c20, b0, ahi, 0);
+                c21 = vmlaq_lane_f32(c21, b1, ahi, 0);
+                c30 = vmlaq_lane_f32(c30, b0, ahi, 1);
+                c31 = vmlaq_lane_f32(c31, b1, ahi, 1);
+            }
+            float32x4_t out[4][2] = {{c00, c01}, {c10, c11}, {c20, c21}, {c30, c31}};
+            for (int r = 0; r < rows; ++r) {
+                float *dst = crow + static_cast<size_t>(r) * ldc + j;
+                vst1q_f32(dst, activateNeon(out[r][0], act));
+                vst1q_f32(dst + 4, activateNeon(out[r][1], act));
+            }
+        }
+        for (; j + 4 <= n; j += 4) {
+            float32x4_t c0 = vdupq_n_f32(b4[0]);
+            float32x4_t c1 = vdupq_n_f32(b4[1]);
+            float32x4_t c2 = vdupq_n_f32(b4[2]);
+            float32x4_t c3 = vdupq_n_f32(b4[3]);
+            const float *bp = b + j;
+            for (int p = 0; p < k; ++p, bp += ldb) {
+                float32x4_t a = vld1q_f32(ap + p * 4);
+                float32x4_t b0 = vld1q_f32(bp);
+                c0 = vmlaq_lane_f32(c0, b0, vget_low_f32(a), 0);
+                c1 = vmlaq_lane_f32(c1, b0, vget_low_f32(a), 1);
+                c2 = vmlaq_lane_f32(c2, b0, vget_high_f32(a), 0);
+                c3 = vmlaq_lane_f32(c3, b0, vget_high_f32(a), 1);
+            }
+            float32x4_t out[4] = {c0, c1, c2, c3};
+            for (int r = 0; r < rows; ++r)
+                vst1q_f32(crow + static_cast<size_t>(r) * ldc + j, activateNeon(out[r], act));
+        }
+#endif
+        // 标量路径（无NEON时处理全部列，有NEON时只处理不足4列的尾部）
+        for (; j < n; j += 8) {
+            int w = std::min(8, n - j);
+            float acc[4][8];
+            for (int r = 0; r < 4; ++r)
+                for (int q = 0; q < 8; ++q)
+                    acc[r][q] = b4[r];
+            const float *bp = b + j;
+            if (w == 8) {
+                for (int p = 0; p < k; ++p, bp += ldb) {
+                    const float *a = ap + p * 4;
+                    for (int r = 0; r < 4; ++r)
+                        for (int q = 0; q < 8; ++q)
+                            acc[r][q] += a[r] * bp[q];
+                }
+            } else {
+                for (int p = 0; p < k; ++p, bp += ldb) {
+                    const float *a = ap + p * 4;
+                    for (int r = 0; r < 4; ++r)
+                        for (int q = 0; q < w; ++q)
+                            acc[r][q] += a[r] * bp[q];
+                }
+            }
+            storeBlock(acc, rows, w, crow + j, ldc, act);
+        }
+    }
+}
+
+// ---------------- 卷积 ----------------
+
+static bool isPointwise(const NativeConvShape &s)
+{
+    return s.kernelH == 1 && s.kernelW == 1 && s.strideH == 1 && s.strideW == 1
+        && s.padTop == 0 && s.padLeft == 0;
+}
+
+size_t nativeConvScratchFloats(const NativeConvShape &s)
+{
+    if (isPointwise(s))
+        return 0;
+    return static_cast<size_t>(s.inC / s.group) * s.kernelH * s.kernelW * s.outH * s.outW;
+}
+
+// 一组输入通道展开成[channels*kH*kW, outH*outW]，越界处补零
+static void im2col(const NativeConvShape &s, const float *input, int channels, float *dst)
+{
+    int outPlane = s.outH * s.outW;
+    for (int ch = 0; ch < channels; ++ch) {
+        const float *src = input + static_cast<size_t>(ch) * s.inH * s.inW;
+        for (int ky = 0; ky < s.kernelH; ++ky) {
+            for (int kx = 0; kx < s.kernelW; ++kx) {
+                float *row = dst;
+                dst += outPlane;
+                int xOffset = kx * s.dilationW - s.padLeft;
+                // 有效的ox范围：0 <= ox*strideW + xOffset < inW
+                int oxBegin = xOffset >= 0 ? 0 : (-xOffset + s.strideW - 1) / s.strideW;
+                int oxEnd = s.inW - xOffset <= 0 ? 0 : (s.inW - xOffset + s.strideW - 1) / s.strideW;
+                oxBegin = std::min(oxBegin, s.outW);
+                oxEnd = std::max(oxBegin, std::min(oxEnd, s.outW));
+                for (int oy = 0; oy < s.outH; ++oy, row += s.outW) {
+                    int iy = oy * s.strideH - s.padTop + ky * s.dilationH;
+                    if (iy < 0 || iy >= s.inH) {
+                        memset(row, 0, sizeof(float) * s.outW);
+                        continue;
+                    }
+                    const float *line = src + static_cast<size_t>(iy) * s.inW + xOffset;
+                    for (int ox = 0; ox < oxBegin; ++ox)
+                        row[ox] = 0.0f;
+                    if (s.strideW == 1) {
+                        memcpy(row + oxBegin, line + oxBegin, sizeof(float) * (oxEnd - oxBegin));
+                    } else {
+                        for (int ox = oxBegin; ox < oxEnd; ++ox)
+                            row[ox] = line[ox * s.strideW];
+                    }
+                    for (int ox = oxEnd; ox < s.outW; ++ox)
+                        row[ox] = 0.0f;
+                }
+            }
+        }
+    }
+}
+
+void nativeConv(const NativeConvShape &s, const float *input, const float *packedWeights, const float *bias,
+                int act, float *output, float *scratch)
+{
+    int inGroup = s.inC / s.group;
+    int outGroup = s.outC / s.group;
+    int k = inGroup * s.kernelH * s.kernelW;
+    int n = s.outH * s.outW;
+    size_t groupWeights = nativePackedWeightsFloats(outGroup, k);
+    bool pointwise = isPointwise(s);
+
+    for (int g = 0; g < s.group; ++g) {
+        const float *groupInput = input + static_cast<size_t>(g) * inGroup * s.inH * s.inW;
+        const float *b = groupInput;
+        if (!pointwise) {
+            im2col(s, groupInput, inGroup, scratch);
+            b = scratch;
+        }
+        nativeGemm(packedWeights + g * groupWeights, b, n,
+                   output + static_cast<size_t>(g) * outGroup * n, n,
+                   outGroup, k, n, bias ? bias + g * outGroup : nullptr, act);
+    }
+}
+
+// 带边界检查的单点逐通道卷积（边框与非3x3的通用路径）
+static inline float depthwisePoint(const NativeConvShape &s, const float *src, const float *w, float sum,
+                                   int oy, int ox)
+{
+    for (int ky = 0; ky < s.kernelH; ++ky) {
+        int iy = oy * s.strideH - s.padTop + ky * s.dilationH;
+        if (iy < 0 || iy >= s.inH)
+            continue;
+        for (int kx = 0; kx < s.kernelW; ++kx) {
+            int ix = ox * s.strideW - s.padLeft + kx * s.dilationW;
+            if (ix >= 0 && ix < s.inW)
+                sum += src[iy * s.inW + ix] * w[ky * s.kernelW + kx];
+        }
+    }
+    return sum;
+}
+
+// 3x3内部区域（三行都不越界）的一行输出，[oxBegin, oxEnd)内三列也不越界
+static void depthwise3x3Row(const NativeConvShape &s, const float *r0, const float *r1, const float *r2,
+                            const float *w, float bias, float *dst, int oxBegin, int oxEnd)
+{
+    int ox = oxBegin;
+#ifdef __ARM_NEON
+    float32x4_t vb = vdupq_n_f32(bias);
+    if (s.strideW == 1) {
+        for (; ox + 4 <= oxEnd; ox += 4) {
+            int ix = ox - s.padLeft;
+            float32x4_t acc = vb;
+            acc = vmlaq_n_f32(acc, vld1q_f32(r0 + ix), w[0]);
+            acc = vmlaq_n_f32(acc, vld1q_f32(r0 + ix + 1), w[1]);
+            acc = vmlaq_n_f32(acc, vld1q_f32(r0 + ix + 2), w[2]);
+            acc = vmlaq_n_f32(acc, vld1q_f32(r1 + ix), w[3]);
+            acc = vmlaq_n_f32(acc, vld1q_f32(r1 + ix + 1), w[4]);
+            acc = vmlaq_n_f32(acc, vld1q_f32(r1 + ix + 2), w[5]);
+            acc = vmlaq_n_f32(acc, vld1q_f32(r2 + ix), w[6]);
+            acc = vmlaq_n_f32(acc, vld1q_f32(r2 + ix + 1), w[7]);
+            acc = vmlaq_n_f32(acc, vld1q_f32(r2 + ix + 2), w[8]);
+            vst1q_f32(dst + ox, acc);
+        }
+    } else if (s.strideW == 2) {
+        // vld2q按奇偶拆开8个输入：val[0]为第0/2列抽头，val[1]为第1列；第2列从ix+2再拆一次，
+        // 最远读到ix+9，所以要求ix+9仍在行内
+        for (; ox + 4 <= oxEnd && (ox + 3) * 2 - s.padLeft + 3 < s.inW; ox += 4) {
+            int ix = ox * 2 - s.padLeft;
+            float32x4x2_t a0 = vld2q_f32(r0 + ix), b0 = vld2q_f32(r0 + ix + 2);
+            float32x4x2_t a1 = vld2q_f32(r1 + ix), b1 = vld2q_f32(r1 + ix + 2);
+            float32x4x2_t a2 = vld2q_f32(r2 + ix), b2 = vld2q_f32(r2 + ix + 2);
+            float32x4_t acc = vb;
+            acc = vmlaq_n_f32(acc, a0.val[0], w[0]);
+            acc = vmlaq_n_f32(acc, a0.val[1], w[1]);
+            acc = vmlaq_n_f32(acc, b0.val[0], w[2]);
+            acc = vmlaq_n_f32(acc, a1.val[0], w[3]);
+            acc = vmlaq_n_f32(acc, a1.val[1], w[4]);
+            acc = vmlaq_n_f32(acc, b1.val[0], w[5]);
+            acc = vmlaq_n_f32(acc, a2.val[0], w[6]);
+            acc = vmlaq_n_f32(acc, a2.val[1], w[7]);
+            acc = vmlaq_n_f32(acc, b2.val[0], w[8]);
+            vst1q_f32(dst + ox, acc);
+        }
+    }
+#endif
+    for (; ox < oxEnd; ++ox) {
+        int ix = ox * s.strideW - s.padLeft;
+        dst[ox] = bias
+            + r0[ix] * w[0] + r0[ix + 1] * w[1] + r0[ix + 2] * w[2]
+            + r1[ix] * w[3] + r1[ix + 1] * w[4] + r1[ix + 2] * w[5]
+            + r2[ix] * w[6] + r2[ix + 1] * w[7] + r2[ix + 2] * w[8];
+    }
+}
+
+void nativeDepthwiseConv(const NativeConvShape &s, const float *input, const float *weights, const float *bias,
+                         int act, float *output)
+{
+    bool fast3x3 = s.kernelH == 3 && s.kernelW == 3 && s.dilationH == 1 && s.dilationW == 1
+                && s.strideH == s.strideW && (s.strideW == 1 || s.strideW == 2);
+    // 三列都不越界的输出列范围
+    int oxBegin = (s.padLeft + s.strideW - 1) / s.strideW;
+    int oxEnd = s.inW - 3 + s.padLeft < 0 ? 0 : (s.inW - 3 + s.padLeft) / s.strideW + 1;
+    oxBegin = std::min(oxBegin, s.outW);
+    oxEnd = std::max(oxBegin, std::min(oxEnd, s.outW));
+
+    int kernel = s.kernelH * s.kernelW;
+    for (int c = 0; c < s.outC; ++c) {
+        const float *src = input + static_cast<size_t>(c) * s.inH * s.inW;
+        const float *w = weights + static_cast<size_t>(c) * kernel;
+        float b = bias ? bias[c] : 0.0f;
+        float *dst = output + static_cast<size_t>(c) * s.outH * s.outW;
+
+        for (int oy = 0; oy < s.outH; ++oy) {
+            float *row = dst + oy * s.outW;
+            int iy = oy * s.strideH - s.padTop;
+            if (fast3x3 && iy >= 0 && iy + 2 < s.inH) {
+                for (int ox = 0; ox < oxBegin; ++ox)
+                    row[ox] = depthwisePoint(s, src, w, b, oy, ox);
+                const float *r0 = src + static_cast<size_t>(iy) * s.inW;
+                depthwise3x3Row(s, r0, r0 + s.inW, r0 + 2 * s.inW, w, b, row, oxBegin, oxEnd);
+                for (int ox = oxEnd; ox < s.outW; ++ox)
+                    row[ox] = depthwisePoint(s, src, w, b, oy, ox);
+            } else {
+                for (int ox = 0; ox < s.outW; ++ox)
+                    row[ox] = depthwisePoint(s, src, w, b, oy, ox);
+            }
+        }
+        nativeActivate(dst, static_cast<size_t>(s.outH) * s.outW, act);
+    }
+}
+
+// ---------------- softmax ----------------
+
+void nativeSoftmax(const float *src, float *dst, int outer, int axis, int inner)
+{
+    for (int o = 0; o < outer; ++o) {
+        const float *in = src + static_cast<size_t>(o) * axis * inner;
+        float *out = dst + static_cast<size_t>(o) * axis * inner;
+        for (int i = 0; i < inner; ++i) {
+            float maxValue = in[i];
+            for (int a = 1; a < axis; ++a)
+                maxValue = std::max(maxValue, in[a * inner + i]);
+            float sum = 0.0f;
+            for (int a = 0; a < axis; ++a) {
+                float e = expf(in[a * inner + i] - maxValue);
+                out[a * inner + i] = e;
+                sum += e;
+            }
+            float scale = 1.0f / sum;
+            for (int a = 0; a < axis; ++a)
+                out[a * inner + i] *= scale;
+        }
+    }
+}
@@ -0,0 +1,70 @@
+#ifndef NATIVE_KERNELS_H
+#define NATIVE_KERNELS_H
+
+#include <stddef.h>
+
+// native推理后端的计算内核（float32，NCHW，batch=1）。
+// 编译器开启NEON（__ARM_NEON，i.MX6ULL需-mfpu=neon，见inference_backends.pri）时走手写NEON路径，
+// 否则走同一分块方式的标量实现（x86上由编译器自动向量化），两者结果只在舍入误差内不同
+
+// 卷积/GEMM输出上融合的激活
+enum NativeActivation
+{
+    ActNone = 0,
+    ActSilu,      // x * sigmoid(x)
+    ActSigmoid,
+    ActRelu
+};
+
+// 逐元素二元运算
+enum NativeBinary
+{
+    BinaryAdd = 0,
+    BinarySub,
+    BinaryMul,
+    BinaryDiv
+};
+
+// ---- GEMM：C[M x N] = A[M x K] * B[K x N] + bias，A为打包后的权重 ----
+
+// A按4行一组交织打包（每组K*4个float，M不足4的倍数补零），打包在生成.wcm时完成一次
+size_t nativePackedWeightsFloats(int m, int k);
+void nativePackWeights(const float *a, int m, int k, float *packed);
+// B行距为ldb，C行距为ldc；bias可为nullptr；act在写回C时一并完成
+void nativeGemm(const float *packedA, const float *b, int ldb, float *c, int ldc,
+                int m, int k, int n, const float *bias, int act);
+
+// ---- 卷积 ----
+
+struct NativeConvShape
+{
+    int inC, inH, inW;
+    int outC, outH, outW;
+    int kernelH, kernelW;
+    int strideH, strideW;
+    int padTop, padLeft;
+    int dilationH, dilationW;
+    int group;
+};
+
+// im2col所需的临时缓冲大小（float个数）；1x1、步长1、无padding的卷积不需要
+size_t nativeConvScratchFloats(const NativeConvShape &s);
+// 普通/分组卷积：im2col + nativeGemm；weights为按组打包的权重（每组nativePackedWeightsFloats(outC/group, inC/group*kH*kW)）
+void nativeConv(const NativeConvShape &s, const float *input, const float *packedWeights, const float *bias,
+                int act, float *output, float *scratch);
+// 逐通道卷积（group == inC == outC），weights为原始[C, 1, kH, kW]；3x3步长1/2走专用内核
+void nativeDepthwiseConv(const NativeConvShape &s, const float *input, const float *weights, const float *bias,
+                         int act, float *output);
+
+// ---- 逐元素与归约 ----
+
+// 原地激活
+void nativeActivate(float *data, size_t n, int act);
+// out[i] = a[i] op b[i]（out可与a或b相同）
+void nativeBinary(int op, const float *a, const float *b, float *out, size_t n);
+// 一侧为标量：scalarFirst时out[i] = s op b[i]，否则out[i] = b[i] op s
+void nativeBinaryScalar(int op, float s, const float *b, float *out, size_t n, bool scalarFirst);
+// 把形状[outer, axis, inner]的src沿axis做softmax写入dst（可原地）
+void nativeSoftmax(const float *src, float *dst, int outer, int axis, int inner);
+
+#endif // NATIVE_KERNELS_H
@@ -0,0 +1,628 @@
+#include "native_model.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <algorithm>
+
+// ---------------- 单算子执行 ----------------
+
+static size_t elementCount(const NativeTensorDesc &t)
+{
+    size_t n = 1;
+    for (int d = 0; d < t.dims; ++d)
+        n *= t.shape[d];
+    return n;
+}
+
+static int normalizeAxis(int axis, int dims)
+{
+    return axis < 0 ? axis + dims : axis;
+}
+
+// 形状右对齐展开到NATIVE_MAX_DIMS维，前面补1；strides为对应的行主序步长（元素）
+static void expandShape(const NativeTensorDesc &t, int shape[NATIVE_MAX_DIMS], int64_t strides[NATIVE_MAX_DIMS])
+{
+    int pad = NATIVE_MAX_DIMS - t.dims;
+    int64_t stride = 1;
+    for (int d = NATIVE_MAX_DIMS - 1; d >= 0; --d) {
+        shape[d] = d >= pad ? t.shape[d - pad] : 1;
+        strides[d] = stride;
+        stride *= shape[d];
+    }
+}
+
+// 按输出形状遍历，源地址由srcStrides给出（转置、切片、广播都归结为这一种拷贝）
+static void stridedCopy(const float *src, const int64_t srcStrides[NATIVE_MAX_DIMS],
+                        const int shape[NATIVE_MAX_DIMS], float *dst)
+{
+    const int last = NATIVE_MAX_DIMS - 1;
+    int inner = shape[last];
+    int64_t innerStride = srcStrides[last];
+    size_t outer = 1;
+    for (int d = 0; d < last; ++d)
+        outer *= shape[d];
+
+    int index[NATIVE_MAX_DIMS] = {0};
+    int64_t base = 0;
+    for (size_t o = 0; o < outer; ++o, dst += inner) {
+        const float *s = src + base;
+        if (innerStride == 1) {
+            memcpy(dst, s, sizeof(float) * inner);
+        } else {
+            for (int j = 0; j < inner; ++j)
+                dst[j] = s[j * innerStride];
+        }
+        for (int d = last - 1; d >= 0; --d) {
+            base += srcStrides[d];
+            if (++index[d] < shape[d])
+                break;
+            base -= srcStrides[d] * shape[d];
+            index[d] = 0;
+        }
+    }
+}
+
+static void runBinary(const NativeOpDesc &op, const NativeTensorDesc *tensors, float *const *data)
+{
+    const NativeTensorDesc &ta = tensors[op.inputs[0]];
+    const NativeTensorDesc &tb = tensors[op.inputs[1]];
+    const NativeTensorDesc &to = tensors[op.outputs[0]];
+    const float *a = data[op.inputs[0]];
+    const float *b = data[op.inputs[1]];
+    float *out = data[op.outputs[0]];
+    int kind = op.params[0];
+    size_t na = elementCount(ta), nb = elementCount(tb), n = elementCount(to);
+
+    if (na == n && nb == n) {
+        nativeBinary(kind, a, b, out, n);
+        return;
+    }
+    if (nb == 1) {
+        nativeBinaryScalar(kind, b[0], a, out, n, false);
+        return;
+    }
+    if (na == 1) {
+        nativeBinaryScalar(kind, a[0], b, out, n, true);
+        return;
+    }
+
+    // 一般广播：广播维步长为0，按输出遍历，最内层连续时整段交给向量内核
+    int shape[NATIVE_MAX_DIMS], shapeA[NATIVE_MAX_DIMS], shapeB[NATIVE_MAX_DIMS];
+    int64_t strides[NATIVE_MAX_DIMS], sa[NATIVE_MAX_DIMS], sb[NATIVE_MAX_DIMS];
+    expandShape(to, shape, strides);
+    expandShape(ta, shapeA, sa);
+    expandShape(tb, shapeB, sb);
+    for (int d = 0; d < NATIVE_MAX_DIMS; ++d) {
+        if (shapeA[d] == 1 && shape[d] != 1)
+            sa[d] = 0;
+        if (shapeB[d] == 1 && shape[d] != 1)
+            sb[d] = 0;
+    }
+
+    const int last = NATIVE_MAX_DIMS - 1;
+    int inner = shape[last];
+    size_t outer = n / inner;
+    int index[NATIVE_MAX_DIMS] = {0};
+    int64_t baseA = 0, baseB = 0;
+    for (size_t o = 0; o < outer; ++o, out += inner) {
+        const float *pa = a + baseA;
+        const float *pb = b + baseB;
+        if (sa[last] == 1 && sb[last] == 1) {
+            nativeBinary(kind, pa, pb, out, inner);
+        } else if (sa[last] == 1) {
+            nativeBinaryScalar(kind, pb[0], pa, out, inner, false);
+        } else if (sb[last] == 1) {
+            nativeBinaryScalar(kind, pa[0], pb, out, inner, true);
+        } else {
+            nativeBinaryScalar(kind, pa[0], pb, out, 1, true);
+            for (int j = 1; j < inner; ++j)
+                out[j] = out[0];
+        }
+        for (int d = last - 1; d >= 0; --d) {
+            baseA += sa[d];
+            baseB += sb[d];
+            if (++index[d] < shape[d])
+                break;
+            baseA -= sa[d] * shape[d];
+            baseB -= sb[d] * shape[d];
+            index[d] = 0;
+        }
+    }
+}
+
+static NativeConvShape convShape(const NativeOpDesc &op, const NativeTensorDesc &in, const NativeTensorDesc &out)
+{
+    NativeConvShape s;
+    s.inC = in.shape[1];
+    s.inH = in.shape[2];
+    s.inW = in.shape[3];
+    s.outC = out.shape[1];
+    s.outH = out.shape[2];
+    s.outW = out.shape[3];
+    s.kernelH = op.params[0];
+    s.kernelW = op.params[1];
+    s.strideH = op.params[2];
+    s.strideW = op.params[3];
+    s.padTop = op.params[4];
+    s.padLeft = op.params[5];
+    s.dilationH = op.params[6];
+    s.dilationW = op.params[7];
+    s.group = op.params[8];
+    return s;
+}
+
+static void runMaxPool(const NativeOpDesc &op, const NativeTensorDesc &in, const NativeTensorDesc &out,
+                       const float *src, float *dst)
+{
+    int kh = op.params[0], kw = op.params[1], sh = op.params[2], sw = op.params[3];
+    int pt = op.params[4], pl = op.params[5];
+    int h = in.shape[2], w = in.shape[3], oh = out.shape[2], ow = out.shape[3];
+    int planes = in.shape[0] * in.shape[1];
+    for (int p = 0; p < planes; ++p, src += h * w) {
+        for (int oy = 0; oy < oh; ++oy) {
+            int y0 = std::max(oy * sh - pt, 0), y1 = std::min(oy * sh - pt + kh, h);
+            for (int ox = 0; ox < ow; ++ox) {
+                int x0 = std::max(ox * sw - pl, 0), x1 = std::min(ox * sw - pl + kw, w);
+                float m = -INFINITY;
+                for (int y = y0; y < y1; ++y)
+                    for (int x = x0; x < x1; ++x)
+                        m = std::max(m, src[y * w + x]);
+                *dst++ = m;
+            }
+        }
+    }
+}
+
+// 最近邻的源坐标（ONNX Resize语义）
+static int nearestIndex(int outIndex, int inSize, int outSize, float scale, int coord, int round)
+{
+    float x;
+    if (coord == ResizeAlignCorners)
+        x = outSize > 1 ? outIndex * float(inSize - 1) / float(outSize - 1) : 0.0f;
+    else if (coord == ResizeHalfPixel)
+        x = (outIndex + 0.5f) / scale - 0.5f;
+    else
+        x = outIndex / scale;
+
+    int i;
+    switch (round) {
+    case RoundPreferFloor:
+        i = static_cast<int>(ceilf(x - 0.5f));
+        break;
+    case RoundPreferCeil:
+        i = static_cast<int>(floorf(x + 0.5f));
+        break;
+    case RoundCeil:
+        i = static_cast<int>(ceilf(x));
+        break;
+    default:
+        i = static_cast<int>(floorf(x));
+        break;
+    }
+    return std::min(std::max(i, 0), inSize - 1);
+}
+
+static void runResize(const NativeOpDesc &op, const NativeTensorDesc &in, const NativeTensorDesc &out,
+                      const float *src, float *dst)
+{
+    int h = in.shape[2], w = in.shape[3], oh = out.shape[2], ow = out.shape[3];
+    int planes = in.shape[0] * in.shape[1];
+    int coord = op.params[0], round = op.params[1];
+    for (int p = 0; p < planes; ++p, src += h * w) {
+        for (int oy = 0; oy < oh; ++oy) {
+            const float *row = src + nearestIndex(oy, h, oh, op.fparams[0], coord, round) * w;
+            for (int ox = 0; ox < ow; ++ox)
+                *dst++ = row[nearestIndex(ox, w, ow, op.fparams[1], coord, round)];
+        }
+    }
+}
+
+static void runMatMul(const NativeTensorDesc &ta, const NativeTensorDesc &tb, const NativeTensorDesc &to,
+                      const float *a, const float *b, float *out)
+{
+    int m = ta.shape[ta.dims - 2], k = ta.shape[ta.dims - 1], n = tb.shape[tb.dims - 1];
+    size_t batchA = elementCount(ta) / (size_t(m) * k);
+    size_t batchB = elementCount(tb) / (size_t(k) * n);
+    size_t batch = elementCount(to) / (size_t(m) * n);
+    for (size_t bi = 0; bi < batch; ++bi) {
+        const float *pa = a + (batchA == 1 ? 0 : bi) * m * k;
+        const float *pb = b + (batchB == 1 ? 0 : bi) * k * n;
+        float *po = out + bi * m * n;
+        for (int i = 0; i < m; ++i) {
+            float *row = po + i * n;
+            memset(row, 0, sizeof(float) * n);
+            for (int p = 0; p < k; ++p) {
+                float av = pa[i * k + p];
+                const float *brow = pb + p * n;
+                for (int j = 0; j < n; ++j)
+                    row[j] += av * brow[j];
+            }
+        }
+    }
+}
+
+void nativeRunOp(const NativeOpDesc &op, const NativeTensorDesc *tensors, float *const *data, float *scratch)
+{
+    const NativeTensorDesc &in = tensors[op.inputs[0]];
+    const NativeTensorDesc &out = tensors[op.outputs[0]];
+    const float *src = data[op.inputs[0]];
+    float *dst = data[op.outputs[0]];
+
+    switch (op.type) {
+    case OpConv:
+    case OpDepthwiseConv: {
+        NativeConvShape s = convShape(op, in, out);
+        const float *bias = op.inputCount > 2 ? data[op.inputs[2]] : nullptr;
+        if (op.type == OpConv)
+            nativeConv(s, src, data[op.inputs[1]], bias, op.params[9], dst, scratch);
+        else
+            nativeDepthwiseConv(s, src, data[op.inputs[1]], bias, op.params[9], dst);
+        break;
+    }
+    case OpActivation:
+        if (dst != src)
+            memcpy(dst, src, sizeof(float) * elementCount(in));
+        nativeActivate(dst, elementCount(out), op.params[0]);
+        break;
+    case OpBinary:
+        runBinary(op, tensors, data);
+        break;
+    case OpConcat:
+    case OpSplit: {
+        // outer x [各段axis长度 x inner]，Concat与Split只是拷贝方向相反
+        const NativeTensorDesc &whole = op.type == OpConcat ? out : in;
+        int axis = normalizeAxis(op.params[0], whole.dims);
+        size_t outer = 1, inner = 1;
+        for (int d = 0; d < axis; ++d)
+            outer *= whole.shape[d];
+        for (int d = axis + 1; d < whole.dims; ++d)
+            inner *= whole.shape[d];
+        size_t wholeChunk = whole.shape[axis] * inner;
+        size_t offset = 0;
+        int parts = op.type == OpConcat ? op.inputCount : op.outputCount;
+        for (int i = 0; i < parts; ++i) {
+            int index = op.type == OpConcat ? op.inputs[i] : op.outputs[i];
+            size_t chunk = tensors[index].shape[axis] * inner;
+            float *part = data[index];
+            for (size_t o = 0; o < outer; ++o) {
+                if (op.type == OpConcat)
+                    memcpy(dst + o * wholeChunk + offset, part + o * chunk, sizeof(float) * chunk);
+                else
+                    memcpy(part + o * chunk, src + o * wholeChunk + offset, sizeof(float) * chunk);
+            }
+            offset += chunk;
+        }
+        break;
+    }
+    case OpSlice:
+    case OpTranspose: {
+        int shape[NATIVE_MAX_DIMS], inShape[NATIVE_MAX_DIMS];
+        int64_t strides[NATIVE_MAX_DIMS], inStrides[NATIVE_MAX_DIMS], srcStrides[NATIVE_MAX_DIMS];
+        expandShape(out, shape, strides);
+        expandShape(in, inShape, inStrides);
+        int pad = NATIVE_MAX_DIMS - in.dims;
+        int64_t base = 0;
+        for (int d = 0; d < NATIVE_MAX_DIMS; ++d) {
+            if (d < pad) {
+                srcStrides[d] = 0;
+            } else if (op.type == OpSlice) {
+                srcStrides[d] = inStrides[d] * op.params[6 + d - pad];
+                base += inStrides[d] * op.params[d - pad];
+            } else {
+                srcStrides[d] = inStrides[pad + op.params[d - pad]];
+            }
+        }
+        stridedCopy(src + base, srcStrides, shape, dst);
+        break;
+    }
+    case OpMaxPool:
+        runMaxPool(op, in, out, src, dst);
+        break;
+    case OpResize:
+        runResize(op, in, out, src, dst);
+        break;
+    case OpCopy:
+        if (dst != src)
+            memcpy(dst, src, sizeof(float) * elementCount(out));
+        break;
+    case OpSoftmax: {
+        int axis = normalizeAxis(op.params[0], in.dims);
+        int outer = 1, inner = 1;
+        for (int d = 0; d < axis; ++d)
+            outer *= in.shape[d];
+        for (int d = axis + 1; d < in.dims; ++d)
+            inner *= in.shape[d];
+        nativeSoftmax(src, dst, outer, in.shape[axis], inner);
+        break;
+    }
+    case OpMatMul:
+        runMatMul(in, tensors[op.inputs[1]], out, src, data[op.inputs[1]], dst);
+        break;
+    default:
+        break;
+    }
+}
+
+// ---------------- 模型加载与执行 ----------------
+
+static const size_t kArenaAlign = 64;
+
+static size_t alignUp(size_t value, size_t align)
+{
+    return (value + align - 1) / align * align;
+}
+
+const char *NativeModel::opTypeName(uint32_t type)
+{
+    static const char *names[OpTypeCount] = {
+        "Conv", "DepthwiseConv", "Activation", "Binary", "Concat", "Split", "Slice",
+        "MaxPool", "Resize", "Copy", "Transpose", "Softmax", "MatMul"
+    };
+    return type < OpTypeCount ? names[type] : "?";
+}
+
+NativeModel::NativeModel()
+    : mapped(nullptr), mappedSize(0), mappedIsHeap(false), header(nullptr), tensors(nullptr), ops(nullptr),
+      strings(nullptr), weights(nullptr), arena(nullptr), arenaSize(0), scratch(nullptr)
+{
+}
+
+NativeModel::~NativeModel()
+{
+    release();
+}
+
+void NativeModel::release()
+{
+    if (mapped) {
+        if (mappedIsHeap)
+            free(mapped);
+        else
+            munmap(mapped, mappedSize);
+    }
+    free(arena);
+    mapped = nullptr;
+    mappedSize = 0;
+    header = nullptr;
+    tensors = nullptr;
+    ops = nullptr;
+    strings = nullptr;
+    weights = nullptr;
+    arena = nullptr;
+    arenaSize = 0;
+    scratch = nullptr;
+    pointers.clear();
+}
+
+// 校验镜像的各段边界与全部下标，通过后才解引用；data须至少64字节对齐
+bool NativeModel::attach(const char *data, size_t size, std::string &error)
+{
+    const NativeModelHeader *h = reinterpret_cast<const NativeModelHeader *>(data);
+    if (size < sizeof(NativeModelHeader) || memcmp(h->magic, NATIVE_MODEL_MAGIC, 8) != 0) {
+        error = "不是native模型文件";
+        return false;
+    }
+    if (h->version != NATIVE_MODEL_VERSION) {
+        error = "native模型文件版本不符";
+        return false;
+    }
+    if (h->tensorsOffset + uint64_t(h->tensorCount) * sizeof(NativeTensorDesc) > size
+        || h->opsOffset + uint64_t(h->opCount) * sizeof(NativeOpDesc) > size
+        || h->stringsOffset + h->stringsBytes > size || h->stringsBytes == 0
+        || h->weightsOffset + h->weightsBytes > size || h->weightsOffset % kArenaAlign != 0
+        || h->outputCount <= 0 || h->outputCount > NATIVE_MAX_OUTPUTS
+        || h->inputTensor < 0 || uint32_t(h->inputTensor) >= h->tensorCount
+        || data[h->stringsOffset + h->stringsBytes - 1] != '\0') {
+        error = "native模型文件已损坏";
+        return false;
+    }
+
+    const NativeTensorDesc *t = reinterpret_cast<const NativeTensorDesc *>(data + h->tensorsOffset);
+    for (uint32_t i = 0; i < h->tensorCount; ++i) {
+        uint64_t limit = t[i].storage == StorageWeights ? h->weightsBytes : h->arenaBytes;
+        bool ok = t[i].dims >= 1 && t[i].dims <= NATIVE_MAX_DIMS && t[i].nameOffset < h->stringsBytes
+               && t[i].bytes == elementCount(t[i]) * sizeof(float) && t[i].storage <= StorageInput
+               && (t[i].storage == StorageInput || t[i].offset + t[i].bytes <= limit);
+        for (int d = 0; ok && d < t[i].dims; ++d)
+            ok = t[i].shape[d] > 0;
+        if (!ok) {
+            error = "native模型文件张量表损坏";
+            return false;
+        }
+    }
+    const NativeOpDesc *o = reinterpret_cast<const NativeOpDesc *>(data + h->opsOffset);
+    for (uint32_t i = 0; i < h->opCount; ++i) {
+        bool ok = o[i].type < OpTypeCount && o[i].nameOffset < h->stringsBytes
+               && o[i].inputCount >= 1 && o[i].inputCount <= NATIVE_MAX_OPERANDS
+               && o[i].outputCount >= 1 && o[i].outputCount <= NATIVE_MAX_OUTPUTS;
+        for (int k = 0; ok && k < o[i].inputCount; ++k)
+            ok = o[i].inputs[k] >= 0 && uint32_t(o[i].inputs[k]) < h->tensorCount;
+        for (int k = 0; ok && k < o[i].outputCount; ++k)
+            ok = o[i].outputs[k] >= 0 && uint32_t(o[i].outputs[k]) < h->tensorCount
+              && t[o[i].outputs[k]].storage == StorageArena;
+        if (!ok) {
+            error = "native模型文件算子表损坏";
+            return false;
+        }
+    }
+    for (int i = 0; i < h->outputCount; ++i) {
+        if (h->outputs[i] < 0 || uint32_t(h->outputs[i]) >= h->tensorCount) {
+            error = "native模型文件输出表损坏";
+            return false;
+        }
+    }
+
+    header = h;
+    tensors = t;
+    ops = o;
+    strings = data + h->stringsOffset;
+    weights = data + h->weightsOffset;
+    return true;
+}
+
+static bool mapFile(const std::string &path, void *&data, size_t &size)
+{
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(NativeModelHeader))) {
+        close(fd);
+        return false;
+    }
+    void *p = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED)
+        return false;
+    data = p;
+    size = st.st_size;
+    return true;
+}
+
+bool NativeModel::load(const std::string &onnxPath, const cv::Size &inputShape, bool keepIntermediates,
+                       std::string &error)
+{
+    release();
+    repacked.clear();
+    path = onnxPath;
+    if (path.size() > 5 && path.compare(path.size() - 5, 5, ".onnx") == 0)
+        path.resize(path.size() - 5);
+    path += ".wcm";
+
+    // 只部署.wcm而没有ONNX时直接使用，不做过期检查
+    struct stat onnxStat;
+    bool haveOnnx = stat(onnxPath.c_str(), &onnxStat) == 0;
+
+    std::string reason;
+    if (mapFile(path, mapped, mappedSize)) {
+        bool ok = attach(static_cast<const char *>(mapped), mappedSize, reason);
+        if (ok && haveOnnx && (header->sourceBytes != uint64_t(onnxStat.st_size)
+                               || header->sourceMtime != int64_t(onnxStat.st_mtime))) {
+            ok = false;
+            reason = "ONNX已更新";
+        }
+        if (ok) {
+            const NativeTensorDesc &input = tensors[header->inputTensor];
+            if (input.dims != 4 || input.shape[2] != inputShape.height || input.shape[3] != inputShape.width) {
+                ok = false;
+                reason = "输入尺寸与配置不一致";
+            }
+        }
+        if (!ok)
+            release();
+    } else {
+        reason = "不存在";
+    }
+
+    if (!header) {
+        if (!haveOnnx) {
+            error = "找不到模型: " + onnxPath;
+            return false;
+        }
+        std::vector<char> image;
+        if (!nativePackOnnx(onnxPath, inputShape, image, error))
+            return false;
+
+        // 写临时文件再rename，避免半截文件；只读文件系统上退回内存镜像
+        std::string tmp = path + ".tmp";
+        bool written = false;
+        int fd = open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd >= 0) {
+            size_t done = 0;
+            while (done < image.size()) {
+                ssize_t n = write(fd, image.data() + done, image.size() - done);
+                if (n < 0 && errno == EINTR)
+                    continue;
+                if (n <= 0)
+                    break;
+                done += n;
+            }
+            written = done == image.size() && fsync(fd) == 0;
+            close(fd);
+            written = written && rename(tmp.c_str(), path.c_str()) == 0;
+            if (!written)
+                unlink(tmp.c_str());
+        }
+        if (!written || !mapFile(path, mapped, mappedSize)) {
+            void *copy = nullptr;
+            if (posix_memalign(&copy, kArenaAlign, image.size()) != 0) {
+                error = "内存不足";
+                return false;
+            }
+            memcpy(copy, image.data(), image.size());
+            mapped = copy;
+            mappedSize = image.size();
+            mappedIsHeap = true;
+        }
+        if (!attach(static_cast<const char *>(mapped), mappedSize, error)) {
+            release();
+            return false;
+        }
+        repacked = written ? reason : reason + "，.wcm写入失败，使用内存镜像";
+    }
+    return plan(keepIntermediates, error);
+}
+
+bool NativeModel::plan(bool keepIntermediates, std::string &error)
+{
+    // 正常模式用打包时的静态规划；逐层对比时每个中间张量独占一段，保证run()后仍可读
+    std::vector<size_t> offsets(header->tensorCount, 0);
+    size_t total = header->arenaBytes;
+    if (keepIntermediates) {
+        total = 0;
+        for (uint32_t i = 0; i < header->tensorCount; ++i) {
+            if (tensors[i].storage != StorageArena)
+                continue;
+            offsets[i] = total;
+            total += alignUp(tensors[i].bytes, kArenaAlign);
+        }
+    } else {
+        for (uint32_t i = 0; i < header->tensorCount; ++i)
+            offsets[i] = tensors[i].offset;
+    }
+    arenaSize = alignUp(total, kArenaAlign);
+
+    void *memory = nullptr;
+    if (posix_memalign(&memory, kArenaAlign, arenaSize + header->scratchBytes + kArenaAlign) != 0) {
+        error = "arena分配失败";
+        release();
+        return false;
+    }
+    arena = static_cast<float *>(memory);
+    scratch = arena + arenaSize / sizeof(float);
+
+    pointers.assign(header->tensorCount, nullptr);
+    for (uint32_t i = 0; i < header->tensorCount; ++i) {
+        if (tensors[i].storage == StorageArena)
+            pointers[i] = arena + offsets[i] / sizeof(float);
+        else if (tensors[i].storage == StorageWeights)
+            pointers[i] = const_cast<float *>(reinterpret_cast<const float *>(weights + tensors[i].offset));
+    }
+    return true;
+}
+
+bool NativeModel::run(const float *input)
+{
+    if (!header || !input)
+        return false;
+    pointers[header->inputTensor] = const_cast<float *>(input);
+    for (uint32_t i = 0; i < header->opCount; ++i)
+        nativeRunOp(ops[i], tensors, pointers.data(), scratch);
+    return true;
+}
+
+cv::Mat NativeModel::tensor(int index) const
+{
+    const NativeTensorDesc &t = tensors[index];
+    return cv::Mat(t.dims, t.shape, CV_32F, pointers[index]);
+}
+
+cv::Mat NativeModel::output(int index) const
+{
+    return tensor(header->outputs[index]);
+}
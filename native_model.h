@@ -0,0 +1,177 @@
+#ifndef NATIVE_MODEL_H
+#define NATIVE_MODEL_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <opencv2/core.hpp>
+#include "native_kernels.h"
+
+// native推理后端的模型：固定输入尺寸的YOLO网络，离线打包、启动时mmap、按静态内存规划逐算子执行。
+//
+// 打包（nativePackOnnx）在第一次加载ONNX时完成，结果写到同目录的同名.wcm，ONNX变化后自动重打包：
+//   - 自带最小protobuf解析，不依赖onnx/protobuf库
+//   - 按输入尺寸做静态形状推导，全常量子图在打包时折叠
+//   - Conv+BatchNormalization折叠，Conv+Sigmoid+Mul（SiLU）/Sigmoid/Relu融合成带激活的卷积
+//   - 卷积权重预先按GEMM微内核的4行交织布局打包
+//   - 按张量生存期做贪心内存规划：全部中间结果共用一块arena，运行时零分配
+// 只实现YOLOv8/YOLO11导出模型用到的算子；含其他算子（或未化简的Shape/Gather子图）时打包失败，
+// 应先用onnxsim（或yolo export simplify=True）化简，否则后端退回OpenCV DNN。
+//
+// .wcm布局：NativeModelHeader | 张量表 | 算子表 | 名字表 | 权重（64字节对齐，mmap后直接使用）
+
+#define NATIVE_MODEL_MAGIC "WCMODEL"
+#define NATIVE_MODEL_VERSION 1
+#define NATIVE_MAX_DIMS 6
+#define NATIVE_MAX_OPERANDS 8
+#define NATIVE_MAX_OUTPUTS 4
+
+enum NativeStorage
+{
+    StorageArena = 0,   // 中间结果/输出，位于arena
+    StorageWeights,     // 常量，位于文件权重区
+    StorageInput        // 模型输入，直接引用调用方的blob
+};
+
+enum NativeOpType
+{
+    OpConv = 0,         // params: kH kW sH sW padT padL dilH dilW group act；inputs: x 打包权重 [bias]
+    OpDepthwiseConv,    // 同上，权重为原始[C,1,kH,kW]
+    OpActivation,       // params[0]: NativeActivation
+    OpBinary,           // params[0]: NativeBinary，numpy广播
+    OpConcat,           // params[0]: axis
+    OpSplit,            // params[0]: axis，各段长度取自输出形状
+    OpSlice,            // params[0..5]: 各维起点，params[6..11]: 各维步长
+    OpMaxPool,          // params: kH kW sH sW padT padL
+    OpResize,           // 最近邻，params[0]: 坐标变换，params[1]: 取整方式；fparams[0..1]: 高/宽缩放
+    OpCopy,             // Reshape/Flatten/Squeeze/Unsqueeze/Identity
+    OpTranspose,        // params[0..5]: perm
+    OpSoftmax,          // params[0]: axis
+    OpMatMul,
+    OpTypeCount
+};
+
+enum NativeResizeCoord
+{
+    ResizeAsymmetric = 0,
+    ResizeHalfPixel,
+    ResizeAlignCorners
+};
+
+enum NativeResizeRound
+{
+    RoundFloor = 0,
+    RoundPreferFloor,
+    RoundPreferCeil,
+    RoundCeil
+};
+
+struct NativeTensorDesc
+{
+    uint32_t nameOffset;   // 名字表中的偏移（ONNX张量名）
+    int32_t dims;
+    int32_t shape[NATIVE_MAX_DIMS];
+    uint32_t storage;      // NativeStorage
+    int32_t firstOp;       // 生存期：产生它的算子 ~ 最后使用它的算子（内存规划用）
+    int32_t lastOp;
+    uint32_t reserved;
+    uint64_t offset;       // arena或权重区内的字节偏移
+    uint64_t bytes;
+};
+
+struct NativeOpDesc
+{
+    uint32_t type;         // NativeOpType
+    uint32_t nameOffset;   // 对应的ONNX节点名（融合算子取最后一个节点），逐层对比时用来找cv::dnn的层
+    int32_t inputCount;
+    int32_t outputCount;
+    int32_t inputs[NATIVE_MAX_OPERANDS];
+    int32_t outputs[NATIVE_MAX_OUTPUTS];
+    int32_t params[16];
+    float fparams[4];
+};
+
+struct NativeModelHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t tensorCount;
+    uint32_t opCount;
+    int32_t inputTensor;
+    int32_t outputCount;
+    int32_t outputs[NATIVE_MAX_OUTPUTS];
+    uint32_t reserved;
+    uint64_t arenaBytes;     // 按内存规划的arena大小
+    uint64_t scratchBytes;   // im2col临时缓冲
+    uint64_t tensorsOffset;
+    uint64_t opsOffset;
+    uint64_t stringsOffset;
+    uint64_t stringsBytes;
+    uint64_t weightsOffset;
+    uint64_t weightsBytes;
+    uint64_t sourceBytes;    // 源ONNX的大小与修改时间，不一致时重打包
+    int64_t sourceMtime;
+};
+
+// 把ONNX模型按给定输入尺寸打包成.wcm镜像；失败时返回false并在error中给出原因（含不支持的算子名）
+bool nativePackOnnx(const std::string &onnxPath, const cv::Size &inputShape,
+                    std::vector<char> &image, std::string &error);
+
+class NativeModel
+{
+public:
+    NativeModel();
+    ~NativeModel();
+
+    // 读取onnxPath同名的.wcm（缺失、过期或输入尺寸不符时先打包并尝试写回）。
+    // keepIntermediates为逐层对比用：每个中间张量独占内存，run()后全部保留
+    bool load(const std::string &onnxPath, const cv::Size &inputShape, bool keepIntermediates, std::string &error);
+    // input为NCHW float32，形状须与模型输入一致
+    bool run(const float *input);
+    void release();
+
+    bool isLoaded() const { return header != nullptr; }
+    const std::string &packedPath() const { return path; }
+    // 本次加载是否重新打包及原因（日志用），直接使用已有.wcm时为空
+    const std::string &repackReason() const { return repacked; }
+    size_t arenaBytes() const { return arenaSize; }
+    size_t weightsBytes() const { return header ? header->weightsBytes : 0; }
+    size_t inputBytes() const { return header ? tensors[header->inputTensor].bytes : 0; }
+
+    int outputCount() const { return header ? header->outputCount : 0; }
+    // 输出/中间张量的cv::Mat视图（引用内部内存，下一次run()前有效）
+    cv::Mat output(int index) const;
+    cv::Mat tensor(int index) const;
+
+    int tensorCount() const { return header ? header->tensorCount : 0; }
+    int opCount() const { return header ? header->opCount : 0; }
+    const NativeOpDesc &op(int index) const { return ops[index]; }
+    const NativeTensorDesc &tensorDesc(int index) const { return tensors[index]; }
+    const char *name(uint32_t offset) const { return strings + offset; }
+    static const char *opTypeName(uint32_t type);
+
+private:
+    bool attach(const char *data, size_t size, std::string &error);
+    bool plan(bool keepIntermediates, std::string &error);
+
+    std::string path;
+    std::string repacked;
+    void *mapped;             // mmap的.wcm，或写回失败时持有的内存镜像
+    size_t mappedSize;
+    bool mappedIsHeap;
+    const NativeModelHeader *header;
+    const NativeTensorDesc *tensors;
+    const NativeOpDesc *ops;
+    const char *strings;
+    const char *weights;
+
+    float *arena;
+    size_t arenaSize;
+    float *scratch;
+    std::vector<float *> pointers;   // 每个张量的数据指针（输入张量每次run()时填）
+};
+
+// 执行单个算子（打包时的常量折叠与运行时共用）；data按张量下标索引
+void nativeRunOp(const NativeOpDesc &op, const NativeTensorDesc *tensors, float *const *data, float *scratch);
+
+#endif // NATIVE_MODEL_H
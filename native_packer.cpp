@@ -0,0 +1,1748 @@
+// ONNX → .wcm打包：最小protobuf解析、静态形状推导、常量折叠、Conv+BN+激活融合、权重预打包、内存规划
+#include "native_model.h"
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <deque>
+#include <map>
+
+// ---------------- protobuf wire format ----------------
+
+// 只读解析器：越界或编码错误时ok置false，之后的读取都返回空值，调用方在消息结束时统一检查
+struct PbReader
+{
+    const uint8_t *p;
+    const uint8_t *end;
+    bool ok;
+
+    PbReader(const uint8_t *begin, size_t size) : p(begin), end(begin + size), ok(true) {}
+
+    bool next(int &field, int &wire)
+    {
+        if (!ok || p >= end)
+            return false;
+        uint64_t key = varint();
+        field = static_cast<int>(key >> 3);
+        wire = static_cast<int>(key & 7);
+        return ok;
+    }
+
+    uint64_t varint()
+    {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64 && p < end; shift += 7) {
+            uint8_t b = *p++;
+            value |= uint64_t(b & 0x7f) << shift;
+            if (!(b & 0x80))
+                return value;
+        }
+        ok = false;
+        return 0;
+    }
+
+    PbReader bytes()
+    {
+        uint64_t n = varint();
+        if (!ok || n > uint64_t(end - p)) {
+            ok = false;
+            return PbReader(end, 0);
+        }
+        PbReader sub(p, static_cast<size_t>(n));
+        p += n;
+        return sub;
+    }
+
+    std::string string()
+    {
+        PbReader sub = bytes();
+        return std::string(reinterpret_cast<const char *>(sub.p), sub.end - sub.p);
+    }
+
+    float fixed32()
+    {
+        float value = 0.0f;
+        if (end - p < 4) {
+            ok = false;
+            return value;
+        }
+        memcpy(&value, p, 4);
+        p += 4;
+        return value;
+    }
+
+    double fixed64()
+    {
+        double value = 0.0;
+        if (end - p < 8) {
+            ok = false;
+            return value;
+        }
+        memcpy(&value, p, 8);
+        p += 8;
+        return value;
+    }
+
+    void skip(int wire)
+    {
+        switch (wire) {
+        case 0:
+            varint();
+            break;
+        case 1:
+            fixed64();
+            break;
+        case 2:
+            bytes();
+            break;
+        case 5:
+            fixed32();
+            break;
+        default:
+            ok = false;
+            break;
+        }
+    }
+};
+
+// repeated数值字段可能是packed（wire 2）也可能逐个编码
+static void readVarints(PbReader &r, int wire, std::vector<int64_t> &out)
+{
+    if (wire == 2) {
+        PbReader sub = r.bytes();
+        while (sub.ok && sub.p < sub.end)
+            out.push_back(static_cast<int64_t>(sub.varint()));
+        r.ok = r.ok && sub.ok;
+    } else {
+        out.push_back(static_cast<int64_t>(r.varint()));
+    }
+}
+
+static void readFloats(PbReader &r, int wire, std::vector<float> &out)
+{
+    if (wire == 2) {
+        PbReader sub = r.bytes();
+        while (sub.ok && sub.p < sub.end)
+            out.push_back(sub.fixed32());
+        r.ok = r.ok && sub.ok;
+    } else {
+        out.push_back(r.fixed32());
+    }
+}
+
+// ---------------- ONNX消息（只取打包需要的字段） ----------------
+
+enum OnnxDataType
+{
+    OnnxFloat = 1,
+    OnnxInt32 = 6,
+    OnnxInt64 = 7,
+    OnnxDouble = 11
+};
+
+struct OnnxTensor
+{
+    std::string name;
+    std::vector<int64_t> dims;
+    int dataType {0};
+    bool external {false};
+    std::vector<float> floats;     // FLOAT/DOUBLE
+    std::vector<int64_t> ints;     // INT32/INT64
+};
+
+struct OnnxAttribute
+{
+    std::string name;
+    float f {0.0f};
+    int64_t i {0};
+    std::string s;
+    bool hasTensor {false};
+    OnnxTensor t;
+    std::vector<float> floats;
+    std::vector<int64_t> ints;
+};
+
+struct OnnxNode
+{
+    std::string name;
+    std::string opType;
+    std::string domain;
+    std::vector<std::string> inputs;
+    std::vector<std::string> outputs;
+    std::vector<OnnxAttribute> attributes;
+};
+
+struct OnnxValueInfo
+{
+    std::string name;
+    std::vector<int64_t> dims;   // 未知维（dim_param）记为-1
+};
+
+struct OnnxGraph
+{
+    std::vector<OnnxNode> nodes;
+    std::vector<OnnxTensor> initializers;
+    std::vector<OnnxValueInfo> inputs;
+    std::vector<OnnxValueInfo> outputs;
+    int opset {0};
+};
+
+static bool parseTensor(PbReader r, OnnxTensor &t)
+{
+    std::string raw;
+    std::vector<double> doubles;
+    int field, wire;
+    while (r.next(field, wire)) {
+        switch (field) {
+        case 1: readVarints(r, wire, t.dims); break;
+        case 2: t.dataType = static_cast<int>(r.varint()); break;
+        case 4: readFloats(r, wire, t.floats); break;
+        case 5: readVarints(r, wire, t.ints); break;    // int32_data
+        case 7: readVarints(r, wire, t.ints); break;    // int64_data
+        case 8: t.name = r.string(); break;
+        case 9: raw = r.string(); break;
+        case 10:
+            if (wire == 2) {
+                PbReader sub = r.bytes();
+                while (sub.ok && sub.p < sub.end)
+                    doubles.push_back(sub.fixed64());
+            } else {
+                doubles.push_back(r.fixed64());
+            }
+            break;
+        case 14: t.external = r.varint() == 1; break;   // data_location = EXTERNAL
+        default: r.skip(wire); break;
+        }
+    }
+    if (!r.ok)
+        return false;
+
+    // raw_data为小端紧排
+    size_t count = 1;
+    for (size_t d = 0; d < t.dims.size(); ++d)
+        count *= static_cast<size_t>(t.dims[d]);
+    if (!raw.empty()) {
+        if (t.dataType == OnnxFloat && raw.size() == count * 4) {
+            t.floats.resize(count);
+            memcpy(t.floats.data(), raw.data(), raw.size());
+        } else if (t.dataType == OnnxInt64 && raw.size() == count * 8) {
+            t.ints.resize(count);
+            memcpy(t.ints.data(), raw.data(), raw.size());
+        } else if (t.dataType == OnnxInt32 && raw.size() == count * 4) {
+            t.ints.resize(count);
+            for (size_t i = 0; i < count; ++i) {
+                int32_t v;
+                memcpy(&v, raw.data() + i * 4, 4);
+                t.ints[i] = v;
+            }
+        } else if (t.dataType == OnnxDouble && raw.size() == count * 8) {
+            doubles.resize(count);
+            memcpy(doubles.data(), raw.data(), raw.size());
+        }
+    }
+    for (size_t i = 0; i < doubles.size(); ++i)
+        t.floats.push_back(static_cast<float>(doubles[i]));
+    return true;
+}
+
+static bool parseAttribute(PbReader r, OnnxAttribute &a)
+{
+    int field, wire;
+    while (r.next(field, wire)) {
+        switch (field) {
+        case 1: a.name = r.string(); break;
+        case 2: a.f = r.fixed32(); break;
+        case 3: a.i = static_cast<int64_t>(r.varint()); break;
+        case 4: a.s = r.string(); break;
+        case 5:
+            a.hasTensor = true;
+            if (!parseTensor(r.bytes(), a.t))
+                return false;
+            break;
+        case 7: readFloats(r, wire, a.floats); break;
+        case 8: readVarints(r, wire, a.ints); break;
+        default: r.skip(wire); break;
+        }
+    }
+    return r.ok;
+}
+
+static bool parseNode(PbReader r, OnnxNode &n)
+{
+    int field, wire;
+    while (r.next(field, wire)) {
+        switch (field) {
+        case 1: n.inputs.push_back(r.string()); break;
+        case 2: n.outputs.push_back(r.string()); break;
+        case 3: n.name = r.string(); break;
+        case 4: n.opType = r.string(); break;
+        case 5:
+            n.attributes.push_back(OnnxAttribute());
+            if (!parseAttribute(r.bytes(), n.attributes.back()))
+                return false;
+            break;
+        case 7: n.domain = r.string(); break;
+        default: r.skip(wire); break;
+        }
+    }
+    return r.ok;
+}
+
+// ValueInfoProto.type(2) → TypeProto.tensor_type(1) → shape(2) → dim(1) → dim_value(1)/dim_param(2)
+static bool parseValueInfo(PbReader r, OnnxValueInfo &v)
+{
+    int field, wire;
+    while (r.next(field, wire)) {
+        if (field == 1) {
+            v.name = r.string();
+        } else if (field == 2 && wire == 2) {
+            PbReader type = r.bytes();
+            while (type.next(field, wire)) {
+                if (field != 1 || wire != 2) {
+                    type.skip(wire);
+                    continue;
+                }
+                PbReader tensorType = type.bytes();
+                while (tensorType.next(field, wire)) {
+                    if (field != 2 || wire != 2) {
+                        tensorType.skip(wire);
+                        continue;
+                    }
+                    PbReader shape = tensorType.bytes();
+                    while (shape.next(field, wire)) {
+                        if (field != 1 || wire != 2) {
+                            shape.skip(wire);
+                            continue;
+                        }
+                        PbReader dim = shape.bytes();
+                        int64_t value = -1;
+                        while (dim.next(field, wire)) {
+                            if (field == 1)
+                                value = static_cast<int64_t>(dim.varint());
+                            else
+                                dim.skip(wire);
+                        }
+                        v.dims.push_back(value);
+                    }
+                }
+            }
+        } else {
+            r.skip(wire);
+        }
+    }
+    return r.ok;
+}
+
+static bool parseGraph(PbReader r, OnnxGraph &g)
+{
+    int field, wire;
+    while (r.next(field, wire)) {
+        bool ok = true;
+        switch (field) {
+        case 1:
+            g.nodes.push_back(OnnxNode());
+            ok = parseNode(r.bytes(), g.nodes.back());
+            break;
+        case 5:
+            g.initializers.push_back(OnnxTensor());
+            ok = parseTensor(r.bytes(), g.initializers.back());
+            break;
+        case 11:
+            g.inputs.push_back(OnnxValueInfo());
+            ok = parseValueInfo(r.bytes(), g.inputs.back());
+            break;
+        case 12:
+            g.outputs.push_back(OnnxValueInfo());
+            ok = parseValueInfo(r.bytes(), g.outputs.back());
+            break;
+        default:
+            r.skip(wire);
+            break;
+        }
+        if (!ok)
+            return false;
+    }
+    return r.ok;
+}
+
+// ModelProto：graph(7)，opset_import(8){domain(1), version(2)}
+static bool parseModel(const std::vector<uint8_t> &bytes, OnnxGraph &g)
+{
+    PbReader r(bytes.data(), bytes.size());
+    bool haveGraph = false;
+    int field, wire;
+    while (r.next(field, wire)) {
+        if (field == 7 && wire == 2) {
+            if (!parseGraph(r.bytes(), g))
+                return false;
+            haveGraph = true;
+        } else if (field == 8 && wire == 2) {
+            PbReader opset = r.bytes();
+            std::string domain;
+            int64_t version = 0;
+            while (opset.next(field, wire)) {
+                if (field == 1)
+                    domain = opset.string();
+                else if (field == 2)
+                    version = static_cast<int64_t>(opset.varint());
+                else
+                    opset.skip(wire);
+            }
+            if (domain.empty() || domain == "ai.onnx")
+                g.opset = static_cast<int>(version);
+        } else {
+            r.skip(wire);
+        }
+    }
+    return r.ok && haveGraph;
+}
+
+// ---------------- 打包图 ----------------
+
+namespace {
+
+struct PackValue
+{
+    std::string name;
+    std::vector<int> shape;
+    bool constant {false};
+    bool isInt {false};
+    std::vector<float> data;
+    std::vector<int64_t> ints;
+    int producer {-1};      // 产生它的算子（ops下标）
+};
+
+struct PackOp
+{
+    NativeOpDesc desc;      // inputs/outputs此时为values下标
+    std::string name;
+    bool dead {false};
+};
+
+class Packer
+{
+public:
+    Packer(const OnnxGraph &graph) : g(graph) {}
+
+    bool build(const cv::Size &inputShape);
+    bool serialize(const struct stat &source, std::vector<char> &image);
+
+    std::string error;
+
+private:
+    bool fail(const std::string &message)
+    {
+        if (error.empty())
+            error = message;
+        return false;
+    }
+    bool unsupported(const OnnxNode &node, const char *what);
+
+    int find(const std::string &name) const
+    {
+        std::map<std::string, int>::const_iterator it = byName.find(name);
+        return it == byName.end() ? -1 : it->second;
+    }
+    int addValue(const std::string &name, const std::vector<int> &shape);
+    int addConst(const std::string &name, const std::vector<int> &shape, const std::vector<float> &data);
+    int addOp(int type, const OnnxNode &node, const std::vector<int> &inputs, const std::vector<int> &outputs);
+    bool foldIfConstant(int opIndex);
+    // op的输出改指向新值（融合后沿用后一个节点的输出名）
+    void redirect(int opIndex, int outputValue, const OnnxNode &node);
+    // value是否由无激活的卷积产生，且恰好被expectedUses处使用（可以把后续的BN/激活融合进去）；
+    // uses里含图输出，所以同时是模型输出的中间结果不会被融合掉
+    int fusableConv(int value, int expectedUses) const;
+
+    bool input(const OnnxNode &node, size_t i, int &value);
+    bool activationInput(const OnnxNode &node, size_t i, int &value);
+    const PackValue *constInput(const OnnxNode &node, size_t i) const;
+    bool constInts(const OnnxNode &node, size_t i, std::vector<int64_t> &out);
+
+    const OnnxAttribute *attr(const OnnxNode &node, const char *name) const;
+    int64_t attrInt(const OnnxNode &node, const char *name, int64_t fallback) const;
+    float attrFloat(const OnnxNode &node, const char *name, float fallback) const;
+    std::string attrString(const OnnxNode &node, const char *name, const char *fallback) const;
+    std::vector<int64_t> attrInts(const OnnxNode &node, const char *name) const;
+
+    bool handleNode(const OnnxNode &node);
+    bool handleConstant(const OnnxNode &node);
+    bool handleConv(const OnnxNode &node);
+    bool handleBatchNorm(const OnnxNode &node);
+    bool handleActivation(const OnnxNode &node, int act);
+    bool handleBinary(const OnnxNode &node, int kind);
+    bool handleConcat(const OnnxNode &node);
+    bool handleSplit(const OnnxNode &node);
+    bool handleSlice(const OnnxNode &node);
+    bool handleMaxPool(const OnnxNode &node);
+    bool handleResize(const OnnxNode &node);
+    bool handleReshape(const OnnxNode &node);
+    bool handleTranspose(const OnnxNode &node);
+    bool handleSoftmax(const OnnxNode &node);
+    bool handleMatMul(const OnnxNode &node);
+
+    int useCount(const std::string &name) const
+    {
+        std::map<std::string, int>::const_iterator it = uses.find(name);
+        return it == uses.end() ? 0 : it->second;
+    }
+
+    const OnnxGraph &g;
+    std::deque<PackValue> values;     // deque：追加新值时已有元素的引用不失效
+    std::map<std::string, int> byName;
+    std::map<std::string, int> uses;   // 每个张量被节点输入/图输出引用的次数
+    std::vector<PackOp> ops;
+    int inputValue {-1};
+    std::vector<int> outputValues;
+};
+
+} // namespace
+
+static size_t shapeElements(const std::vector<int> &shape)
+{
+    size_t n = 1;
+    for (size_t d = 0; d < shape.size(); ++d)
+        n *= shape[d];
+    return n;
+}
+
+static std::string shapeText(const std::vector<int> &shape)
+{
+    std::string text = "[";
+    for (size_t d = 0; d < shape.size(); ++d) {
+        char buf[16];
+        snprintf(buf, sizeof(buf), d ? ",%d" : "%d", shape[d]);
+        text += buf;
+    }
+    return text + "]";
+}
+
+int Packer::addValue(const std::string &name, const std::vector<int> &shape)
+{
+    PackValue v;
+    v.name = name;
+    v.shape = shape.empty() ? std::vector<int>(1, 1) : shape;
+    values.push_back(v);
+    byName[name] = static_cast<int>(values.size()) - 1;
+    return static_cast<int>(values.size()) - 1;
+}
+
+int Packer::addConst(const std::string &name, const std::vector<int> &shape, const std::vector<float> &data)
+{
+    int index = addValue(name, shape);
+    values[index].constant = true;
+    values[index].data = data;
+    return index;
+}
+
+int Packer::addOp(int type, const OnnxNode &node, const std::vector<int> &inputs, const std::vector<int> &outputs)
+{
+    PackOp op;
+    memset(&op.desc, 0, sizeof(op.desc));
+    op.desc.type = type;
+    op.desc.inputCount = static_cast<int>(inputs.size());
+    op.desc.outputCount = static_cast<int>(outputs.size());
+    for (size_t i = 0; i < inputs.size(); ++i)
+        op.desc.inputs[i] = inputs[i];
+    for (size_t i = 0; i < outputs.size(); ++i)
+        op.desc.outputs[i] = outputs[i];
+    op.name = node.name;
+    ops.push_back(op);
+    int index = static_cast<int>(ops.size()) - 1;
+    for (size_t i = 0; i < outputs.size(); ++i)
+        values[outputs[i]].producer = index;
+    return index;
+}
+
+// 输入全是常量的算子在打包时直接算出来（如锚点/步长的预处理），运行时不再执行
+bool Packer::foldIfConstant(int opIndex)
+{
+    PackOp &op = ops[opIndex];
+    if (op.desc.type == OpConv || op.desc.type == OpDepthwiseConv)
+        return true;
+    for (int i = 0; i < op.desc.inputCount; ++i) {
+        if (!values[op.desc.inputs[i]].constant)
+            return true;
+    }
+
+    NativeOpDesc local = op.desc;
+    NativeTensorDesc descs[NATIVE_MAX_OPERANDS + NATIVE_MAX_OUTPUTS];
+    float *data[NATIVE_MAX_OPERANDS + NATIVE_MAX_OUTPUTS];
+    std::vector<std::vector<float> > inputs(op.desc.inputCount);
+    int n = 0;
+    for (int i = 0; i < op.desc.inputCount; ++i, ++n) {
+        const PackValue &v = values[op.desc.inputs[i]];
+        if (v.isInt)
+            return fail("节点" + op.name + "的输入是int64常量（未化简的形状计算），请先用onnxsim化简模型");
+        memset(&descs[n], 0, sizeof(descs[n]));
+        descs[n].dims = static_cast<int32_t>(v.shape.size());
+        for (size_t d = 0; d < v.shape.size(); ++d)
+            descs[n].shape[d] = v.shape[d];
+        inputs[i] = v.data;
+        data[n] = inputs[i].data();
+        local.inputs[i] = n;
+    }
+    for (int i = 0; i < op.desc.outputCount; ++i, ++n) {
+        PackValue &v = values[op.desc.outputs[i]];
+        memset(&descs[n], 0, sizeof(descs[n]));
+        descs[n].dims = static_cast<int32_t>(v.shape.size());
+        for (size_t d = 0; d < v.shape.size(); ++d)
+            descs[n].shape[d] = v.shape[d];
+        v.data.assign(shapeElements(v.shape), 0.0f);
+        data[n] = v.data.data();
+        local.outputs[i] = n;
+    }
+    nativeRunOp(local, descs, data, nullptr);
+
+    for (int i = 0; i < op.desc.outputCount; ++i) {
+        values[op.desc.outputs[i]].constant = true;
+        values[op.desc.outputs[i]].producer = -1;
+    }
+    op.dead = true;
+    return true;
+}
+
+void Packer::redirect(int opIndex, int outputValue, const OnnxNode &node)
+{
+    ops[opIndex].desc.outputs[0] = outputValue;
+    ops[opIndex].name = node.name;
+    values[outputValue].producer = opIndex;
+}
+
+int Packer::fusableConv(int value, int expectedUses) const
+{
+    const PackValue &v = values[value];
+    if (v.producer < 0 || useCount(v.name) != expectedUses)
+        return -1;
+    const PackOp &op = ops[v.producer];
+    if (op.dead || (op.desc.type != OpConv && op.desc.type != OpDepthwiseConv) || op.desc.params[9] != ActNone)
+        return -1;
+    return v.producer;
+}
+
+bool Packer::unsupported(const OnnxNode &node, const char *what)
+{
+    std::string message = "不支持的" + node.opType + "（节点" + node.name + "）";
+    if (what && *what)
+        message += std::string("：") + what;
+    return fail(message + "；可先用onnxsim化简模型，或改用opencv后端");
+}
+
+bool Packer::input(const OnnxNode &node, size_t i, int &value)
+{
+    if (i >= node.inputs.size() || node.inputs[i].empty())
+        return fail("节点" + node.name + "缺少输入");
+    value = find(node.inputs[i]);
+    if (value < 0)
+        return fail("节点" + node.name + "的输入" + node.inputs[i] + "未定义");
+    return true;
+}
+
+bool Packer::activationInput(const OnnxNode &node, size_t i, int &value)
+{
+    if (!input(node, i, value))
+        return false;
+    if (values[value].isInt)
+        return unsupported(node, "输入是int64张量");
+    return true;
+}
+
+const PackValue *Packer::constInput(const OnnxNode &node, size_t i) const
+{
+    if (i >= node.inputs.size() || node.inputs[i].empty())
+        return nullptr;
+    int value = find(node.inputs[i]);
+    return value >= 0 && values[value].constant ? &values[value] : nullptr;
+}
+
+bool Packer::constInts(const OnnxNode &node, size_t i, std::vector<int64_t> &out)
+{
+    const PackValue *v = constInput(node, i);
+    if (!v)
+        return unsupported(node, "形状/下标参数不是常量");
+    if (v->isInt) {
+        out = v->ints;
+    } else {
+        out.clear();
+        for (size_t k = 0; k < v->data.size(); ++k)
+            out.push_back(static_cast<int64_t>(v->data[k]));
+    }
+    return true;
+}
+
+const OnnxAttribute *Packer::attr(const OnnxNode &node, const char *name) const
+{
+    for (size_t i = 0; i < node.attributes.size(); ++i) {
+        if (node.attributes[i].name == name)
+            return &node.attributes[i];
+    }
+    return nullptr;
+}
+
+int64_t Packer::attrInt(const OnnxNode &node, const char *name, int64_t fallback) const
+{
+    const OnnxAttribute *a = attr(node, name);
+    return a ? a->i : fallback;
+}
+
+float Packer::attrFloat(const OnnxNode &node, const char *name, float fallback) const
+{
+    const OnnxAttribute *a = attr(node, name);
+    return a ? a->f : fallback;
+}
+
+std::string Packer::attrString(const OnnxNode &node, const char *name, const char *fallback) const
+{
+    const OnnxAttribute *a = attr(node, name);
+    return a ? a->s : fallback;
+}
+
+std::vector<int64_t> Packer::attrInts(const OnnxNode &node, const char *name) const
+{
+    const OnnxAttribute *a = attr(node, name);
+    return a ? a->ints : std::vector<int64_t>();
+}
+
+static bool tensorToValue(const OnnxTensor &t, PackValue &v, std::string &error)
+{
+    if (t.external) {
+        error = "张量" + t.name + "使用外部数据文件，不支持";
+        return false;
+    }
+    v.shape.clear();
+    for (size_t d = 0; d < t.dims.size(); ++d)
+        v.shape.push_back(static_cast<int>(t.dims[d]));
+    if (v.shape.empty())
+        v.shape.push_back(1);
+    size_t count = shapeElements(v.shape);
+    v.constant = true;
+    if (t.dataType == OnnxFloat || t.dataType == OnnxDouble) {
+        v.data = t.floats;
+        v.isInt = false;
+        if (v.data.size() != count) {
+            error = "张量" + t.name + "数据长度与形状不符";
+            return false;
+        }
+    } else if (t.dataType == OnnxInt64 || t.dataType == OnnxInt32) {
+        v.ints = t.ints;
+        v.isInt = true;
+        if (v.ints.size() != count) {
+            error = "张量" + t.name + "数据长度与形状不符";
+            return false;
+        }
+    } else {
+        char buf[64];
+        snprintf(buf, sizeof(buf), "张量数据类型%d不支持", t.dataType);
+        error = t.name + buf;
+        return false;
+    }
+    return true;
+}
+
+bool Packer::build(const cv::Size &inputShape)
+{
+    if (g.opset < 7)
+        return fail("ONNX opset过旧（<7）");
+    for (size_t i = 0; i < g.nodes.size(); ++i) {
+        for (size_t k = 0; k < g.nodes[i].inputs.size(); ++k)
+            ++uses[g.nodes[i].inputs[k]];
+    }
+    for (size_t i = 0; i < g.outputs.size(); ++i)
+        ++uses[g.outputs[i].name];
+
+    for (size_t i = 0; i < g.initializers.size(); ++i) {
+        PackValue v;
+        if (!tensorToValue(g.initializers[i], v, error))
+            return false;
+        v.name = g.initializers[i].name;
+        values.push_back(v);
+        byName[v.name] = static_cast<int>(values.size()) - 1;
+    }
+
+    // 模型输入：唯一一个不是初始化器的图输入，固定为[1, C, H, W]
+    for (size_t i = 0; i < g.inputs.size(); ++i) {
+        if (find(g.inputs[i].name) >= 0)
+            continue;
+        if (inputValue >= 0)
+            return fail("模型有多个输入");
+        const std::vector<int64_t> &dims = g.inputs[i].dims;
+        if (dims.size() != 4)
+            return fail("模型输入须为4维NCHW");
+        std::vector<int> shape(4);
+        shape[0] = 1;
+        shape[1] = dims[1] > 0 ? static_cast<int>(dims[1]) : 3;
+        shape[2] = inputShape.height;
+        shape[3] = inputShape.width;
+        if ((dims[2] > 0 && dims[2] != shape[2]) || (dims[3] > 0 && dims[3] != shape[3]))
+            return fail("模型输入尺寸" + shapeText(std::vector<int>(dims.begin(), dims.end()))
+                        + "与配置" + shapeText(shape) + "不一致");
+        inputValue = addValue(g.inputs[i].name, shape);
+    }
+    if (inputValue < 0)
+        return fail("找不到模型输入");
+
+    for (size_t i = 0; i < g.outputs.size(); ++i)
+        outputValues.push_back(-1);
+    if (outputValues.empty() || outputValues.size() > NATIVE_MAX_OUTPUTS)
+        return fail("模型输出数量不支持");
+
+    for (size_t i = 0; i < g.nodes.size(); ++i) {
+        if (!handleNode(g.nodes[i]))
+            return false;
+    }
+
+    for (size_t i = 0; i < g.outputs.size(); ++i) {
+        int v = find(g.outputs[i].name);
+        if (v < 0 || values[v].constant)
+            return fail("模型输出" + g.outputs[i].name + "不是网络计算结果");
+        outputValues[i] = v;
+    }
+    return true;
+}
+
+bool Packer::handleNode(const OnnxNode &node)
+{
+    if (!node.domain.empty() && node.domain != "ai.onnx")
+        return unsupported(node, "非标准算子域");
+    if (node.outputs.empty())
+        return fail("节点" + node.name + "没有输出");
+
+    const std::string &t = node.opType;
+    if (t == "Constant")
+        return handleConstant(node);
+    if (t == "Conv")
+        return handleConv(node);
+    if (t == "BatchNormalization")
+        return handleBatchNorm(node);
+    if (t == "Sigmoid")
+        return handleActivation(node, ActSigmoid);
+    if (t == "Relu")
+        return handleActivation(node, ActRelu);
+    if (t == "Add")
+        return handleBinary(node, BinaryAdd);
+    if (t == "Sub")
+        return handleBinary(node, BinarySub);
+    if (t == "Mul")
+        return handleBinary(node, BinaryMul);
+    if (t == "Div")
+        return handleBinary(node, BinaryDiv);
+    if (t == "Concat")
+        return handleConcat(node);
+    if (t == "Split")
+        return handleSplit(node);
+    if (t == "Slice")
+        return handleSlice(node);
+    if (t == "MaxPool")
+        return handleMaxPool(node);
+    if (t == "Resize" || t == "Upsample")
+        return handleResize(node);
+    if (t == "Reshape" || t == "Flatten" || t == "Squeeze" || t == "Unsqueeze" || t == "Identity" || t == "Dropout")
+        return handleReshape(node);
+    if (t == "Transpose")
+        return handleTranspose(node);
+    if (t == "Softmax")
+        return handleSoftmax(node);
+    if (t == "MatMul")
+        return handleMatMul(node);
+    return unsupported(node, "");
+}
+
+bool Packer::handleConstant(const OnnxNode &node)
+{
+    PackValue v;
+    const OnnxAttribute *a;
+    if ((a = attr(node, "value")) && a->hasTensor) {
+        if (!tensorToValue(a->t, v, error))
+            return false;
+    } else if ((a = attr(node, "value_float"))) {
+        v.constant = true;
+        v.shape.assign(1, 1);
+        v.data.assign(1, a->f);
+    } else if ((a = attr(node, "value_floats"))) {
+        v.constant = true;
+        v.shape.assign(1, static_cast<int>(a->floats.size()));
+        v.data = a->floats;
+    } else if ((a = attr(node, "value_int"))) {
+        v.constant = true;
+        v.isInt = true;
+        v.shape.assign(1, 1);
+        v.ints.assign(1, a->i);
+    } else if ((a = attr(node, "value_ints"))) {
+        v.constant = true;
+        v.isInt = true;
+        v.shape.assign(1, static_cast<int>(a->ints.size()));
+        v.ints = a->ints;
+    } else {
+        return unsupported(node, "常量类型");
+    }
+    v.name = node.outputs[0];
+    values.push_back(v);
+    byName[v.name] = static_cast<int>(values.size()) - 1;
+    return true;
+}
+
+// auto_pad=SAME_*时按ONNX规则算出前后padding
+static void autoPad(const std::string &mode, int in, int kernel, int stride, int dilation, int &begin, int &end)
+{
+    int out = (in + stride - 1) / stride;
+    int total = std::max((out - 1) * stride + (kernel - 1) * dilation + 1 - in, 0);
+    begin = mode == "SAME_LOWER" ? (total + 1) / 2 : total / 2;
+    end = total - begin;
+}
+
+bool Packer::handleConv(const OnnxNode &node)
+{
+    int x;
+    if (!activationInput(node, 0, x))
+        return false;
+    const PackValue *w = constInput(node, 1);
+    const PackValue *b = constInput(node, 2);
+    const std::vector<int> &in = values[x].shape;
+    if (!w || w->isInt || w->shape.size() != 4 || in.size() != 4)
+        return unsupported(node, "只支持常量权重的2D卷积");
+    if (node.inputs.size() > 2 && !node.inputs[2].empty() && (!b || b->isInt))
+        return unsupported(node, "偏置不是常量");
+
+    int group = static_cast<int>(attrInt(node, "group", 1));
+    int outC = w->shape[0], kh = w->shape[2], kw = w->shape[3];
+    std::vector<int64_t> strides = attrInts(node, "strides");
+    std::vector<int64_t> dilations = attrInts(node, "dilations");
+    std::vector<int64_t> pads = attrInts(node, "pads");
+    int sh = strides.size() == 2 ? static_cast<int>(strides[0]) : 1;
+    int sw = strides.size() == 2 ? static_cast<int>(strides[1]) : 1;
+    int dh = dilations.size() == 2 ? static_cast<int>(dilations[0]) : 1;
+    int dw = dilations.size() == 2 ? static_cast<int>(dilations[1]) : 1;
+    int pt = 0, pl = 0, pb = 0, pr = 0;
+    std::string autoPadMode = attrString(node, "auto_pad", "NOTSET");
+    if (autoPadMode == "SAME_UPPER" || autoPadMode == "SAME_LOWER") {
+        autoPad(autoPadMode, in[2], kh, sh, dh, pt, pb);
+        autoPad(autoPadMode, in[3], kw, sw, dw, pl, pr);
+    } else if (pads.size() == 4) {
+        pt = static_cast<int>(pads[0]);
+        pl = static_cast<int>(pads[1]);
+        pb = static_cast<int>(pads[2]);
+        pr = static_cast<int>(pads[3]);
+    }
+    if (group <= 0 || in[1] % group != 0 || outC % group != 0 || w->shape[1] != in[1] / group)
+        return unsupported(node, "分组与通道数不匹配");
+    if (b && static_cast<int>(b->data.size()) != outC)
+        return unsupported(node, "偏置长度与输出通道数不符");
+
+    std::vector<int> shape(4);
+    shape[0] = in[0];
+    shape[1] = outC;
+    shape[2] = (in[2] + pt + pb - dh * (kh - 1) - 1) / sh + 1;
+    shape[3] = (in[3] + pl + pr - dw * (kw - 1) - 1) / sw + 1;
+    if (in[0] != 1 || shape[2] <= 0 || shape[3] <= 0)
+        return unsupported(node, "输出尺寸非法或batch不为1");
+
+    // 权重/偏置各自复制一份，后面的BN折叠只改这份
+    std::vector<int> inputs(1, x);
+    inputs.push_back(addConst(node.outputs[0] + "/weight", w->shape, w->data));
+    if (b)
+        inputs.push_back(addConst(node.outputs[0] + "/bias", b->shape, b->data));
+
+    bool depthwise = group > 1 && group == in[1] && group == outC;
+    int op = addOp(depthwise ? OpDepthwiseConv : OpConv, node, inputs,
+                   std::vector<int>(1, addValue(node.outputs[0], shape)));
+    int32_t *p = ops[op].desc.params;
+    p[0] = kh;
+    p[1] = kw;
+    p[2] = sh;
+    p[3] = sw;
+    p[4] = pt;
+    p[5] = pl;
+    p[6] = dh;
+    p[7] = dw;
+    p[8] = group;
+    p[9] = ActNone;
+    return true;
+}
+
+bool Packer::handleBatchNorm(const OnnxNode &node)
+{
+    int x;
+    if (!activationInput(node, 0, x))
+        return false;
+    const PackValue *scale = constInput(node, 1);
+    const PackValue *shift = constInput(node, 2);
+    const PackValue *mean = constInput(node, 3);
+    const PackValue *var = constInput(node, 4);
+    const std::vector<int> &in = values[x].shape;
+    if (!scale || !shift || !mean || !var || in.size() < 2)
+        return unsupported(node, "参数不是常量");
+    int channels = in[1];
+    if (static_cast<int>(scale->data.size()) != channels || static_cast<int>(shift->data.size()) != channels
+        || static_cast<int>(mean->data.size()) != channels || static_cast<int>(var->data.size()) != channels)
+        return unsupported(node, "参数长度与通道数不符");
+
+    float eps = attrFloat(node, "epsilon", 1e-5f);
+    std::vector<float> a(channels), c(channels);
+    for (int i = 0; i < channels; ++i) {
+        a[i] = scale->data[i] / sqrtf(var->data[i] + eps);
+        c[i] = shift->data[i] - mean->data[i] * a[i];
+    }
+
+    int conv = fusableConv(x, 1);
+    if (conv >= 0) {
+        // y = a*(W*x + b) + c：每个输出通道的权重乘a，偏置变为a*b + c
+        PackOp &op = ops[conv];
+        PackValue &w = values[op.desc.inputs[1]];
+        size_t perChannel = w.data.size() / channels;
+        for (int m = 0; m < channels; ++m)
+            for (size_t k = 0; k < perChannel; ++k)
+                w.data[m * perChannel + k] *= a[m];
+        if (op.desc.inputCount < 3) {
+            op.desc.inputs[2] = addConst(node.outputs[0] + "/bias", std::vector<int>(1, channels),
+                                         std::vector<float>(channels, 0.0f));
+            op.desc.inputCount = 3;
+        }
+        PackValue &bias = values[op.desc.inputs[2]];
+        for (int m = 0; m < channels; ++m)
+            bias.data[m] = bias.data[m] * a[m] + c[m];
+        redirect(conv, addValue(node.outputs[0], in), node);
+        return true;
+    }
+
+    // 前面不是卷积：展开成按通道的Mul + Add
+    std::vector<int> perChannel(in.size(), 1);
+    perChannel[1] = channels;
+    int scaled = addValue(node.outputs[0] + "/scaled", in);
+    int mul = addOp(OpBinary, node, {x, addConst(node.outputs[0] + "/a", perChannel, a)}, std::vector<int>(1, scaled));
+    ops[mul].desc.params[0] = BinaryMul;
+    int add = addOp(OpBinary, node, {scaled, addConst(node.outputs[0] + "/c", perChannel, c)},
+                    std::vector<int>(1, addValue(node.outputs[0], in)));
+    ops[add].desc.params[0] = BinaryAdd;
+    return true;
+}
+
+bool Packer::handleActivation(const OnnxNode &node, int act)
+{
+    int x;
+    if (!activationInput(node, 0, x))
+        return false;
+    int conv = fusableConv(x, 1);
+    if (conv >= 0) {
+        ops[conv].desc.params[9] = act;
+        redirect(conv, addValue(node.outputs[0], values[x].shape), node);
+        return true;
+    }
+    int op = addOp(OpActivation, node, std::vector<int>(1, x),
+                   std::vector<int>(1, addValue(node.outputs[0], values[x].shape)));
+    ops[op].desc.params[0] = act;
+    return foldIfConstant(op);
+}
+
+static bool broadcastShape(const std::vector<int> &a, const std::vector<int> &b, std::vector<int> &out)
+{
+    size_t rank = std::max(a.size(), b.size());
+    out.assign(rank, 1);
+    for (size_t i = 0; i < rank; ++i) {
+        int da = i < rank - a.size() ? 1 : a[i - (rank - a.size())];
+        int db = i < rank - b.size() ? 1 : b[i - (rank - b.size())];
+        if (da != db && da != 1 && db != 1)
+            return false;
+        out[i] = std::max(da, db);
+    }
+    return rank <= NATIVE_MAX_DIMS;
+}
+
+bool Packer::handleBinary(const OnnxNode &node, int kind)
+{
+    int a, b;
+    if (!activationInput(node, 0, a) || !activationInput(node, 1, b))
+        return false;
+
+    // SiLU：Mul(x, Sigmoid(x))，Sigmoid只被这个Mul使用
+    if (kind == BinaryMul) {
+        for (int side = 0; side < 2; ++side) {
+            int s = side ? a : b, x = side ? b : a;
+            int sig = values[s].producer;
+            if (sig < 0 || ops[sig].dead || ops[sig].desc.type != OpActivation
+                || ops[sig].desc.params[0] != ActSigmoid || ops[sig].desc.inputs[0] != x
+                || useCount(values[s].name) != 1)
+                continue;
+            int conv = fusableConv(x, 2);
+            int out = addValue(node.outputs[0], values[x].shape);
+            if (conv >= 0) {
+                ops[sig].dead = true;
+                ops[conv].desc.params[9] = ActSilu;
+                redirect(conv, out, node);
+            } else {
+                ops[sig].desc.params[0] = ActSilu;
+                redirect(sig, out, node);
+            }
+            return true;
+        }
+    }
+
+    std::vector<int> shape;
+    if (!broadcastShape(values[a].shape, values[b].shape, shape))
+        return unsupported(node, ("形状无法广播：" + shapeText(values[a].shape) + " vs "
+                                  + shapeText(values[b].shape)).c_str());
+    int op = addOp(OpBinary, node, {a, b}, std::vector<int>(1, addValue(node.outputs[0], shape)));
+    ops[op].desc.params[0] = kind;
+    return foldIfConstant(op);
+}
+
+bool Packer::handleConcat(const OnnxNode &node)
+{
+    if (node.inputs.size() > NATIVE_MAX_OPERANDS)
+        return unsupported(node, "输入过多");
+    std::vector<int> inputs;
+    for (size_t i = 0; i < node.inputs.size(); ++i) {
+        int v;
+        if (!activationInput(node, i, v))
+            return false;
+        inputs.push_back(v);
+    }
+    std::vector<int> shape = values[inputs[0]].shape;
+    int rank = static_cast<int>(shape.size());
+    int axis = static_cast<int>(attrInt(node, "axis", 0));
+    axis = axis < 0 ? axis + rank : axis;
+    if (axis < 0 || axis >= rank)
+        return unsupported(node, "axis越界");
+    shape[axis] = 0;
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        const std::vector<int> &s = values[inputs[i]].shape;
+        if (static_cast<int>(s.size()) != rank)
+            return unsupported(node, "输入维数不一致");
+        for (int d = 0; d < rank; ++d) {
+            if (d != axis && s[d] != shape[d])
+                return unsupported(node, "非拼接维尺寸不一致");
+        }
+        shape[axis] += s[axis];
+    }
+    int op = addOp(OpConcat, node, inputs, std::vector<int>(1, addValue(node.outputs[0], shape)));
+    ops[op].desc.params[0] = axis;
+    return foldIfConstant(op);
+}
+
+bool Packer::handleSplit(const OnnxNode &node)
+{
+    int x;
+    if (!activationInput(node, 0, x))
+        return false;
+    const std::vector<int> &in = values[x].shape;
+    int rank = static_cast<int>(in.size());
+    int axis = static_cast<int>(attrInt(node, "axis", 0));
+    axis = axis < 0 ? axis + rank : axis;
+    int parts = static_cast<int>(node.outputs.size());
+    if (axis < 0 || axis >= rank || parts > NATIVE_MAX_OUTPUTS)
+        return unsupported(node, "axis越界或输出超过4个");
+
+    // 段长：opset13起为第二个输入，之前为split属性，都没有时均分（opset18的num_outputs规则）
+    std::vector<int64_t> sizes;
+    if (node.inputs.size() > 1 && !node.inputs[1].empty()) {
+        if (!constInts(node, 1, sizes))
+            return false;
+    } else {
+        sizes = attrInts(node, "split");
+    }
+    if (sizes.empty()) {
+        int chunk = (in[axis] + parts - 1) / parts;
+        for (int i = 0; i < parts; ++i)
+            sizes.push_back(std::min(chunk, in[axis] - chunk * i));
+    }
+    int64_t total = 0;
+    for (size_t i = 0; i < sizes.size(); ++i)
+        total += sizes[i];
+    if (static_cast<int>(sizes.size()) != parts || total != in[axis])
+        return unsupported(node, "分段长度与输入不符");
+
+    std::vector<int> outputs;
+    for (int i = 0; i < parts; ++i) {
+        std::vector<int> shape = in;
+        shape[axis] = static_cast<int>(sizes[i]);
+        if (shape[axis] <= 0)
+            return unsupported(node, "空分段");
+        outputs.push_back(addValue(node.outputs[i], shape));
+    }
+    int op = addOp(OpSplit, node, std::vector<int>(1, x), outputs);
+    ops[op].desc.params[0] = axis;
+    return foldIfConstant(op);
+}
+
+bool Packer::handleSlice(const OnnxNode &node)
+{
+    int x;
+    if (!activationInput(node, 0, x))
+        return false;
+    const std::vector<int> &in = values[x].shape;
+    int rank = static_cast<int>(in.size());
+
+    std::vector<int64_t> starts, ends, axes, steps;
+    if (g.opset >= 10) {
+        if (!constInts(node, 1, starts) || !constInts(node, 2, ends))
+            return false;
+        if (node.inputs.size() > 3 && !node.inputs[3].empty() && !constInts(node, 3, axes))
+            return false;
+        if (node.inputs.size() > 4 && !node.inputs[4].empty() && !constInts(node, 4, steps))
+            return false;
+    } else {
+        starts = attrInts(node, "starts");
+        ends = attrInts(node, "ends");
+        axes = attrInts(node, "axes");
+    }
+    if (axes.empty()) {
+        for (size_t i = 0; i < starts.size(); ++i)
+            axes.push_back(static_cast<int64_t>(i));
+    }
+    if (steps.empty())
+        steps.assign(starts.size(), 1);
+    if (starts.size() != ends.size() || starts.size() != axes.size() || starts.size() != steps.size())
+        return unsupported(node, "参数长度不一致");
+
+    std::vector<int> shape = in;
+    int op = addOp(OpSlice, node, std::vector<int>(1, x), std::vector<int>());
+    int32_t *p = ops[op].desc.params;
+    for (int d = 0; d < rank; ++d) {
+        p[d] = 0;
+        p[6 + d] = 1;
+    }
+    for (size_t i = 0; i < axes.size(); ++i) {
+        int axis = static_cast<int>(axes[i] < 0 ? axes[i] + rank : axes[i]);
+        int64_t dim = in[axis], step = steps[i];
+        if (axis < 0 || axis >= rank || step == 0)
+            return unsupported(node, "axis越界或步长为0");
+        int64_t start = starts[i] < 0 ? starts[i] + dim : starts[i];
+        int64_t end = ends[i] < 0 ? ends[i] + dim : ends[i];
+        int64_t length;
+        if (step > 0) {
+            start = std::min(std::max(start, int64_t(0)), dim);
+            end = std::min(std::max(end, int64_t(0)), dim);
+            length = std::max(int64_t(0), (end - start + step - 1) / step);
+        } else {
+            start = std::min(std::max(start, int64_t(0)), dim - 1);
+            end = std::min(std::max(end, int64_t(-1)), dim - 1);
+            length = std::max(int64_t(0), (start - end - step - 1) / -step);
+        }
+        if (length == 0)
+            return unsupported(node, "切片结果为空");
+        shape[axis] = static_cast<int>(length);
+        p[axis] = static_cast<int32_t>(start);
+        p[6 + axis] = static_cast<int32_t>(step);
+    }
+    int out = addValue(node.outputs[0], shape);
+    ops[op].desc.outputs[0] = out;
+    ops[op].desc.outputCount = 1;
+    values[out].producer = op;
+    return foldIfConstant(op);
+}
+
+bool Packer::handleMaxPool(const OnnxNode &node)
+{
+    int x;
+    if (!activationInput(node, 0, x))
+        return false;
+    const std::vector<int> &in = values[x].shape;
+    std::vector<int64_t> kernel = attrInts(node, "kernel_shape");
+    std::vector<int64_t> strides = attrInts(node, "strides");
+    std::vector<int64_t> pads = attrInts(node, "pads");
+    std::vector<int64_t> dilations = attrInts(node, "dilations");
+    if (in.size() != 4 || kernel.size() != 2 || node.outputs.size() > 1
+        || (dilations.size() == 2 && (dilations[0] != 1 || dilations[1] != 1)))
+        return unsupported(node, "只支持无膨胀的2D池化");
+    int kh = static_cast<int>(kernel[0]), kw = static_cast<int>(kernel[1]);
+    int sh = strides.size() == 2 ? static_cast<int>(strides[0]) : 1;
+    int sw = strides.size() == 2 ? static_cast<int>(strides[1]) : 1;
+    int pt = 0, pl = 0, pb = 0, pr = 0;
+    std::string autoPadMode = attrString(node, "auto_pad", "NOTSET");
+    if (autoPadMode == "SAME_UPPER" || autoPadMode == "SAME_LOWER") {
+        autoPad(autoPadMode, in[2], kh, sh, 1, pt, pb);
+        autoPad(autoPadMode, in[3], kw, sw, 1, pl, pr);
+    } else if (pads.size() == 4) {
+        pt = static_cast<int>(pads[0]);
+        pl = static_cast<int>(pads[1]);
+        pb = static_cast<int>(pads[2]);
+        pr = static_cast<int>(pads[3]);
+    }
+
+    // ceil_mode时最后一个窗口须从输入（含前padding）内开始
+    bool ceilMode = attrInt(node, "ceil_mode", 0) != 0;
+    int spanH = in[2] + pt + pb - kh, spanW = in[3] + pl + pr - kw;
+    std::vector<int> shape = in;
+    shape[2] = (ceilMode ? (spanH + sh - 1) / sh : spanH / sh) + 1;
+    shape[3] = (ceilMode ? (spanW + sw - 1) / sw : spanW / sw) + 1;
+    if (ceilMode && (shape[2] - 1) * sh >= in[2] + pt)
+        --shape[2];
+    if (ceilMode && (shape[3] - 1) * sw >= in[3] + pl)
+        --shape[3];
+    if (shape[2] <= 0 || shape[3] <= 0)
+        return unsupported(node, "输出尺寸非法");
+
+    int op = addOp(OpMaxPool, node, std::vector<int>(1, x), std::vector<int>(1, addValue(node.outputs[0], shape)));
+    int32_t *p = ops[op].desc.params;
+    p[0] = kh;
+    p[1] = kw;
+    p[2] = sh;
+    p[3] = sw;
+    p[4] = pt;
+    p[5] = pl;
+    return true;
+}
+
+bool Packer::handleResize(const OnnxNode &node)
+{
+    int x;
+    if (!activationInput(node, 0, x))
+        return false;
+    const std::vector<int> &in = values[x].shape;
+    if (in.size() != 4)
+        return unsupported(node, "只支持4D输入");
+    if (attrString(node, "mode", "nearest") != "nearest")
+        return unsupported(node, "只支持最近邻插值");
+
+    bool upsample = node.opType == "Upsample";
+    std::vector<float> scales;
+    std::vector<int64_t> sizes;
+    if (upsample) {
+        const PackValue *s = constInput(node, 1);
+        if (s && !s->isInt)
+            scales = s->data;
+        else if (const OnnxAttribute *a = attr(node, "scales"))
+            scales = a->floats;
+    } else {
+        // opset10：(X, scales)；opset11起：(X, roi, scales, sizes)
+        size_t scalesIndex = g.opset >= 11 ? 2 : 1;
+        const PackValue *s = constInput(node, scalesIndex);
+        if (s && !s->isInt && !s->data.empty())
+            scales = s->data;
+        if (g.opset >= 11 && node.inputs.size() > 3 && !node.inputs[3].empty() && !constInts(node, 3, sizes))
+            return false;
+    }
+
+    std::vector<int> shape = in;
+    float scaleH, scaleW;
+    if (sizes.size() == 4) {
+        shape[2] = static_cast<int>(sizes[2]);
+        shape[3] = static_cast<int>(sizes[3]);
+        scaleH = float(shape[2]) / in[2];
+        scaleW = float(shape[3]) / in[3];
+    } else if (scales.size() == 4) {
+        scaleH = scales[2];
+        scaleW = scales[3];
+        shape[2] = static_cast<int>(floorf(in[2] * scaleH));
+        shape[3] = static_cast<int>(floorf(in[3] * scaleW));
+    } else {
+        return unsupported(node, "缺少常量scales/sizes");
+    }
+    if (shape[0] != in[0] || shape[1] != in[1] || shape[2] <= 0 || shape[3] <= 0)
+        return unsupported(node, "只支持空间维缩放");
+
+    // Upsample与opset10的Resize固定为asymmetric + floor
+    bool legacy = upsample || g.opset < 11;
+    std::string coord = legacy ? "asymmetric" : attrString(node, "coordinate_transformation_mode", "half_pixel");
+    std::string rounding = legacy ? "floor" : attrString(node, "nearest_mode", "round_prefer_floor");
+    int coordMode, roundMode;
+    if (coord == "asymmetric")
+        coordMode = ResizeAsymmetric;
+    else if (coord == "half_pixel" || coord == "pytorch_half_pixel")
+        coordMode = ResizeHalfPixel;
+    else if (coord == "align_corners")
+        coordMode = ResizeAlignCorners;
+    else
+        return unsupported(node, ("坐标变换" + coord).c_str());
+    if (rounding == "floor")
+        roundMode = RoundFloor;
+    else if (rounding == "round_prefer_floor")
+        roundMode = RoundPreferFloor;
+    else if (rounding == "round_prefer_ceil")
+        roundMode = RoundPreferCeil;
+    else if (rounding == "ceil")
+        roundMode = RoundCeil;
+    else
+        return unsupported(node, ("取整方式" + rounding).c_str());
+
+    int op = addOp(OpResize, node, std::vector<int>(1, x), std::vector<int>(1, addValue(node.outputs[0], shape)));
+    ops[op].desc.params[0] = coordMode;
+    ops[op].desc.params[1] = roundMode;
+    ops[op].desc.fparams[0] = scaleH;
+    ops[op].desc.fparams[1] = scaleW;
+    return true;
+}
+
+// Reshape/Flatten/Squeeze/Unsqueeze/Identity/Dropout：只改形状，运行时为一次拷贝；
+// int64常量（形状子图的中间结果）按元素搬运，直接在打包时完成
+bool Packer::handleReshape(const OnnxNode &node)
+{
+    int x;
+    if (!input(node, 0, x))
+        return false;
+    const std::vector<int> &in = values[x].shape;
+    int rank = static_cast<int>(in.size());
+    size_t count = shapeElements(in);
+    const std::string &t = node.opType;
+    std::vector<int> shape;
+
+    if (t == "Reshape") {
+        std::vector<int64_t> target;
+        if (!constInts(node, 1, target))
+            return false;
+        bool allowZero = attrInt(node, "allowzero", 0) != 0;
+        int inferred = -1;
+        size_t known = 1;
+        for (size_t d = 0; d < target.size(); ++d) {
+            int dim = static_cast<int>(target[d]);
+            if (dim == 0 && !allowZero)
+                dim = d < in.size() ? in[d] : 1;
+            if (dim == -1) {
+                if (inferred >= 0)
+                    return unsupported(node, "多个-1");
+                inferred = static_cast<int>(d);
+            } else {
+                known *= dim;
+            }
+            shape.push_back(dim);
+        }
+        if (inferred >= 0)
+            shape[inferred] = known ? static_cast<int>(count / known) : 0;
+    } else if (t == "Flatten") {
+        int axis = static_cast<int>(attrInt(node, "axis", 1));
+        axis = axis < 0 ? axis + rank : axis;
+        size_t outer = 1;
+        for (int d = 0; d < axis; ++d)
+            outer *= in[d];
+        shape.push_back(static_cast<int>(outer));
+        shape.push_back(static_cast<int>(count / outer));
+    } else if (t == "Squeeze" || t == "Unsqueeze") {
+        std::vector<int64_t> axes = attrInts(node, "axes");
+        if (node.inputs.size() > 1 && !node.inputs[1].empty() && !constInts(node, 1, axes))
+            return false;
+        if (t == "Squeeze") {
+            for (int d = 0; d < rank; ++d) {
+                bool listed = axes.empty() ? in[d] == 1 : false;
+                for (size_t i = 0; i < axes.size(); ++i)
+                    listed = listed || (axes[i] < 0 ? axes[i] + rank : axes[i]) == d;
+                if (!listed)
+                    shape.push_back(in[d]);
+            }
+        } else {
+            int outRank = rank + static_cast<int>(axes.size());
+            std::vector<bool> inserted(outRank, false);
+            for (size_t i = 0; i < axes.size(); ++i) {
+                int64_t a = axes[i] < 0 ? axes[i] + outRank : axes[i];
+                if (a < 0 || a >= outRank)
+                    return unsupported(node, "axes越界");
+                inserted[a] = true;
+            }
+            for (int d = 0, k = 0; d < outRank; ++d)
+                shape.push_back(inserted[d] ? 1 : in[k++]);
+        }
+    } else {
+        shape = in;
+    }
+    if (shape.empty())
+        shape.push_back(1);
+    if (shapeElements(shape) != count || shape.size() > NATIVE_MAX_DIMS)
+        return unsupported(node, ("目标形状" + shapeText(shape) + "与输入" + shapeText(in) + "不符").c_str());
+
+    if (values[x].constant) {
+        PackValue v = values[x];
+        v.name = node.outputs[0];
+        v.shape = shape;
+        values.push_back(v);
+        byName[v.name] = static_cast<int>(values.size()) - 1;
+        return true;
+    }
+    addOp(OpCopy, node, std::vector<int>(1, x), std::vector<int>(1, addValue(node.outputs[0], shape)));
+    return true;
+}
+
+bool Packer::handleTranspose(const OnnxNode &node)
+{
+    int x;
+    if (!activationInput(node, 0, x))
+        return false;
+    const std::vector<int> &in = values[x].shape;
+    int rank = static_cast<int>(in.size());
+    std::vector<int64_t> perm = attrInts(node, "perm");
+    if (perm.empty()) {
+        for (int d = rank - 1; d >= 0; --d)
+            perm.push_back(d);
+    }
+    if (static_cast<int>(perm.size()) != rank)
+        return unsupported(node, "perm长度与维数不符");
+    std::vector<int> shape(rank);
+    std::vector<bool> seen(rank, false);
+    for (int d = 0; d < rank; ++d) {
+        if (perm[d] < 0 || perm[d] >= rank || seen[perm[d]])
+            return unsupported(node, "perm非法");
+        seen[perm[d]] = true;
+        shape[d] = in[perm[d]];
+    }
+    int op = addOp(OpTranspose, node, std::vector<int>(1, x), std::vector<int>(1, addValue(node.outputs[0], shape)));
+    for (int d = 0; d < rank; ++d)
+        ops[op].desc.params[d] = static_cast<int32_t>(perm[d]);
+    return foldIfConstant(op);
+}
+
+bool Packer::handleSoftmax(const OnnxNode &node)
+{
+    int x;
+    if (!activationInput(node, 0, x))
+        return false;
+    int rank = static_cast<int>(values[x].shape.size());
+    int axis = static_cast<int>(attrInt(node, "axis", g.opset >= 13 ? -1 : 1));
+    axis = axis < 0 ? axis + rank : axis;
+    // opset13之前是把axis之后的维展平后整体softmax，只有axis为最后一维时两者一致
+    if (axis < 0 || axis >= rank || (g.opset < 13 && axis != rank - 1))
+        return unsupported(node, "opset13之前只支持最后一维");
+    int op = addOp(OpSoftmax, node, std::vector<int>(1, x),
+                   std::vector<int>(1, addValue(node.outputs[0], values[x].shape)));
+    ops[op].desc.params[0] = axis;
+    return foldIfConstant(op);
+}
+
+bool Packer::handleMatMul(const OnnxNode &node)
+{
+    int a, b;
+    if (!activationInput(node, 0, a) || !activationInput(node, 1, b))
+        return false;
+    const std::vector<int> &sa = values[a].shape, &sb = values[b].shape;
+    if (sa.size() < 2 || sb.size() < 2 || sa[sa.size() - 1] != sb[sb.size() - 2])
+        return unsupported(node, "只支持至少2维、内维一致的矩阵乘");
+
+    // batch维：两边一致，或一边全为1
+    std::vector<int> batchA(sa.begin(), sa.end() - 2), batchB(sb.begin(), sb.end() - 2), batch;
+    size_t na = shapeElements(batchA), nb = shapeElements(batchB);
+    if (!broadcastShape(batchA, batchB, batch) || (na != 1 && nb != 1 && batchA != batchB))
+        return unsupported(node, "batch维广播");
+    std::vector<int> shape = batch;
+    shape.push_back(sa[sa.size() - 2]);
+    shape.push_back(sb[sb.size() - 1]);
+    if (shape.size() > NATIVE_MAX_DIMS)
+        return unsupported(node, "维数过多");
+    int op = addOp(OpMatMul, node, {a, b}, std::vector<int>(1, addValue(node.outputs[0], shape)));
+    return foldIfConstant(op);
+}
+
+// ---------------- 内存规划与序列化 ----------------
+
+static const size_t kAlign = 64;
+
+static size_t alignTo(size_t value)
+{
+    return (value + kAlign - 1) / kAlign * kAlign;
+}
+
+bool Packer::serialize(const struct stat &source, std::vector<char> &image)
+{
+    // 存活算子按原顺序编号；只保留被它们引用的张量
+    std::vector<int> live;
+    for (size_t i = 0; i < ops.size(); ++i) {
+        if (!ops[i].dead)
+            live.push_back(static_cast<int>(i));
+    }
+    if (live.empty())
+        return fail("模型没有可执行的算子");
+
+    std::vector<int> tensorOf(values.size(), -1);
+    std::vector<int> order;   // 张量下标 → values下标
+    std::vector<NativeTensorDesc> tensors;
+    std::string strings(1, '\0');
+    std::vector<std::vector<float> > weightData;
+
+    auto tensorFor = [&](int value) -> int {
+        if (tensorOf[value] >= 0)
+            return tensorOf[value];
+        const PackValue &v = values[value];
+        NativeTensorDesc t;
+        memset(&t, 0, sizeof(t));
+        t.nameOffset = static_cast<uint32_t>(strings.size());
+        strings += v.name;
+        strings += '\0';
+        t.dims = static_cast<int32_t>(v.shape.size());
+        for (size_t d = 0; d < v.shape.size(); ++d)
+            t.shape[d] = v.shape[d];
+        t.storage = value == inputValue ? StorageInput : v.constant ? StorageWeights : StorageArena;
+        t.bytes = shapeElements(v.shape) * sizeof(float);
+        t.firstOp = -1;
+        t.lastOp = -1;
+        tensors.push_back(t);
+        order.push_back(value);
+        weightData.push_back(std::vector<float>());
+        tensorOf[value] = static_cast<int>(tensors.size()) - 1;
+        return tensorOf[value];
+    };
+
+    tensorFor(inputValue);
+    std::vector<NativeOpDesc> descs;
+    size_t scratchFloats = 0;
+    for (size_t i = 0; i < live.size(); ++i) {
+        const PackOp &op = ops[live[i]];
+        NativeOpDesc d = op.desc;
+        d.nameOffset = static_cast<uint32_t>(strings.size());
+        strings += op.name;
+        strings += '\0';
+        for (int k = 0; k < d.inputCount; ++k) {
+            int t = tensorFor(op.desc.inputs[k]);
+            d.inputs[k] = t;
+            if (tensors[t].storage == StorageArena && tensors[t].firstOp < 0)
+                return fail("张量" + values[op.desc.inputs[k]].name + "在产生之前被使用");
+            tensors[t].lastOp = static_cast<int32_t>(i);
+        }
+        for (int k = 0; k < d.outputCount; ++k) {
+            int t = tensorFor(op.desc.outputs[k]);
+            d.outputs[k] = t;
+            tensors[t].firstOp = static_cast<int32_t>(i);
+            tensors[t].lastOp = std::max(tensors[t].lastOp, static_cast<int32_t>(i));
+        }
+
+        // 卷积权重换成GEMM打包布局（逐组打包，组内输出通道补齐到4的倍数）
+        if (d.type == OpConv) {
+            const PackValue &w = values[op.desc.inputs[1]];
+            const NativeTensorDesc &in = tensors[d.inputs[0]];
+            const NativeTensorDesc &out = tensors[d.outputs[0]];
+            int group = d.params[8];
+            int m = out.shape[1] / group;
+            int k = w.shape[1] * w.shape[2] * w.shape[3];
+            size_t groupFloats = nativePackedWeightsFloats(m, k);
+            std::vector<float> &packed = weightData[d.inputs[1]];
+            packed.assign(groupFloats * group, 0.0f);
+            for (int gi = 0; gi < group; ++gi)
+                nativePackWeights(w.data.data() + static_cast<size_t>(gi) * m * k, m, k,
+                                  packed.data() + gi * groupFloats);
+            // 形状记为[组数, 打包长度]，bytes与之一致
+            NativeTensorDesc &wt = tensors[d.inputs[1]];
+            wt.dims = 2;
+            wt.shape[0] = group;
+            wt.shape[1] = static_cast<int32_t>(groupFloats);
+            wt.bytes = packed.size() * sizeof(float);
+
+            NativeConvShape s;
+            s.inC = in.shape[1];
+            s.inH = in.shape[2];
+            s.inW = in.shape[3];
+            s.outC = out.shape[1];
+            s.outH = out.shape[2];
+            s.outW = out.shape[3];
+            s.kernelH = d.params[0];
+            s.kernelW = d.params[1];
+            s.strideH = d.params[2];
+            s.strideW = d.params[3];
+            s.padTop = d.params[4];
+            s.padLeft = d.params[5];
+            s.dilationH = d.params[6];
+            s.dilationW = d.params[7];
+            s.group = group;
+            scratchFloats = std::max(scratchFloats, nativeConvScratchFloats(s));
+        }
+        descs.push_back(d);
+    }
+
+    NativeModelHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, NATIVE_MODEL_MAGIC, 8);
+    header.version = NATIVE_MODEL_VERSION;
+    header.inputTensor = tensorOf[inputValue];
+    header.outputCount = static_cast<int32_t>(outputValues.size());
+    for (size_t i = 0; i < outputValues.size(); ++i) {
+        int t = tensorOf[outputValues[i]];
+        if (t < 0 || tensors[t].storage != StorageArena)
+            return fail("模型输出" + values[outputValues[i]].name + "没有被计算");
+        tensors[t].lastOp = static_cast<int32_t>(live.size());   // 输出活到最后
+        header.outputs[i] = t;
+    }
+
+    // 贪心规划：按大小降序，每个张量放到与它生存期重叠的已放置张量之间最低的空隙
+    std::vector<int> bySize;
+    for (size_t i = 0; i < tensors.size(); ++i) {
+        if (tensors[i].storage == StorageArena)
+            bySize.push_back(static_cast<int>(i));
+    }
+    std::stable_sort(bySize.begin(), bySize.end(), [&](int a, int b) { return tensors[a].bytes > tensors[b].bytes; });
+    std::vector<int> placed;
+    uint64_t arenaBytes = 0;
+    for (size_t i = 0; i < bySize.size(); ++i) {
+        NativeTensorDesc &t = tensors[bySize[i]];
+        std::vector<std::pair<uint64_t, uint64_t> > busy;
+        for (size_t k = 0; k < placed.size(); ++k) {
+            const NativeTensorDesc &o = tensors[placed[k]];
+            if (o.firstOp <= t.lastOp && t.firstOp <= o.lastOp)
+                busy.push_back(std::make_pair(o.offset, o.offset + alignTo(o.bytes)));
+        }
+        std::sort(busy.begin(), busy.end());
+        uint64_t offset = 0, size = alignTo(t.bytes);
+        for (size_t k = 0; k < busy.size(); ++k) {
+            if (offset + size <= busy[k].first)
+                break;
+            offset = std::max(offset, busy[k].second);
+        }
+        t.offset = offset;
+        arenaBytes = std::max(arenaBytes, offset + size);
+        placed.push_back(bySize[i]);
+    }
+    header.arenaBytes = arenaBytes;
+    header.scratchBytes = alignTo(scratchFloats * sizeof(float));
+
+    // 权重区：常量依次排放，每个64字节对齐
+    uint64_t weightsBytes = 0;
+    for (size_t i = 0; i < tensors.size(); ++i) {
+        if (tensors[i].storage != StorageWeights)
+            continue;
+        if (weightData[i].empty())
+            weightData[i] = values[order[i]].data;
+        if (weightData[i].size() * sizeof(float) != tensors[i].bytes)
+            return fail("常量" + values[order[i]].name + "数据长度与形状不符");
+        tensors[i].offset = weightsBytes;
+        weightsBytes += alignTo(tensors[i].bytes);
+    }
+
+    header.tensorCount = static_cast<uint32_t>(tensors.size());
+    header.opCount = static_cast<uint32_t>(descs.size());
+    header.tensorsOffset = alignTo(sizeof(header));
+    header.opsOffset = alignTo(header.tensorsOffset + tensors.size() * sizeof(NativeTensorDesc));
+    header.stringsOffset = alignTo(header.opsOffset + descs.size() * sizeof(NativeOpDesc));
+    header.stringsBytes = strings.size();
+    header.weightsOffset = alignTo(header.stringsOffset + strings.size());
+    header.weightsBytes = weightsBytes;
+    header.sourceBytes = static_cast<uint64_t>(source.st_size);
+    header.sourceMtime = static_cast<int64_t>(source.st_mtime);
+
+    image.assign(header.weightsOffset + weightsBytes, 0);
+    memcpy(image.data(), &header, sizeof(header));
+    memcpy(image.data() + header.tensorsOffset, tensors.data(), tensors.size() * sizeof(NativeTensorDesc));
+    memcpy(image.data() + header.opsOffset, descs.data(), descs.size() * sizeof(NativeOpDesc));
+    memcpy(image.data() + header.stringsOffset, strings.data(), strings.size());
+    for (size_t i = 0; i < tensors.size(); ++i) {
+        if (tensors[i].storage == StorageWeights)
+            memcpy(image.data() + header.weightsOffset + tensors[i].offset, weightData[i].data(), tensors[i].bytes);
+    }
+    return true;
+}
+
+bool nativePackOnnx(const std::string &onnxPath, const cv::Size &inputShape,
+                    std::vector<char> &image, std::string &error)
+{
+    struct stat st;
+    FILE *f = fopen(onnxPath.c_str(), "rb");
+    if (!f || fstat(fileno(f), &st) != 0) {
+        if (f)
+            fclose(f);
+        error = "无法读取ONNX模型: " + onnxPath;
+        return false;
+    }
+    std::vector<uint8_t> bytes(static_cast<size_t>(st.st_size));
+    size_t n = bytes.empty() ? 0 : fread(bytes.data(), 1, bytes.size(), f);
+    fclose(f);
+    if (n != bytes.size()) {
+        error = "读取ONNX模型不完整: " + onnxPath;
+        return false;
+    }
+
+    OnnxGraph graph;
+    if (!parseModel(bytes, graph)) {
+        error = "ONNX解析失败: " + onnxPath;
+        return false;
+    }
+    bytes.clear();
+    bytes.shrink_to_fit();
+
+    Packer packer(graph);
+    if (!packer.build(inputShape) || !packer.serialize(st, image)) {
+        error = packer.error;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,14 @@
+# 交叉编译的OpenCV 4.8（/usr/local/arm_opencv480），各子工程共用
+INCLUDEPATH += /usr/local/arm_opencv480/include/opencv4
+
+LIBS += -L/usr/local/arm_opencv480/lib \
+        -l:libopencv_core.so.4.8.0 \
+        -l:libopencv_highgui.so.4.8.0 \
+        -l:libopencv_imgproc.so.4.8.0 \
+        -l:libopencv_videoio.so.4.8.0 \
+        -l:libopencv_imgcodecs.so.4.8.0 \
+        -l:libopencv_dnn.so.4.8.0 \
+        -l:libopencv_objdetect.so.4.8.0 \
+        -l:libopencv_video.so.4.8.0
+
+QMAKE_LFLAGS += -Wl,-rpath=/usr/local/arm_opencv480/lib
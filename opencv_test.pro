@@ -1,29 +1,20 @@
-QT       += core gui widgets
-
-CONFIG   += c++11
-
-TARGET = OpenCV_CameraMonitor
-TEMPLATE = app
-
-INCLUDEPATH += /usr/local/arm_opencv480/include/opencv4
-
-LIBS += -L/usr/local/arm_opencv480/lib \
-        -l:libopencv_core.so.4.8.0 \
-        -l:libopencv_highgui.so.4.8.0 \
-        -l:libopencv_imgproc.so.4.8.0 \
-        -l:libopencv_videoio.so.4.8.0 \
-        -l:libopencv_imgcodecs.so.4.8.0 \
-        -l:libopencv_dnn.so.4.8.0
-
-QMAKE_LFLAGS += -Wl,-rpath=/usr/local/arm_opencv480/lib
-
-SOURCES += main.cpp\
-           inference.cpp \
-           mainwindow.cpp \
-           uart_master.cpp
-
-HEADERS  += mainwindow.h\
-            inference.h \
-            uart_master.h
-
-DEFINES += QT_DEPRECATED_WARNINGS
+# 顶层工程：核心静态库 + 各可执行程序
+#   core            流水线核心（无QtWidgets），其余目标都链接它
+#   gui             OpenCV_CameraMonitor，图形界面版
+#   headless        OpenCV_CameraMonitor_headless，无界面版
+#   bench           wheelchair_bench，热点函数微基准
+#   wheelchair_sim  下位机模拟器（只用uart_master，不依赖核心库）
+#   tests           单元测试（QtTest，make check运行）
+TEMPLATE = subdirs
+
+SUBDIRS += core \
+           gui \
+           headless \
+           bench \
+           wheelchair_sim \
+           tests
+
+gui.depends = core
+headless.depends = core
+bench.depends = core
+tests.depends = core
@@ -0,0 +1,111 @@
+// ONNX Runtime后端（qmake CONFIG+=ort ORT_DIR=<onnxruntime目录>）
+#ifdef WHEELCHAIR_WITH_ORT
+
+#include "inference_backend.h"
+#include "async_logger.h"
+#include <onnxruntime_cxx_api.h>
+#include <memory>
+#include <vector>
+
+// 顺序执行（算子内线程数由options.threads决定，默认1），开启全部图优化（常量折叠、Conv+BN+激活融合等）。
+// 输入直接引用inputTensor()的内存，不拷贝；输出引用ORT返回的张量，保留到下一帧
+class OrtBackend : public InferenceBackend
+{
+public:
+    OrtBackend()
+        : env(ORT_LOGGING_LEVEL_WARNING, "wheelchair")
+        , memoryInfo(Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault))
+    {
+    }
+
+    const char *name() const override { return "ort"; }
+
+    bool load(const std::string &modelPath, const cv::Size &inputShape,
+              const InferenceBackendOptions &backendOptions, std::string &error) override
+    {
+        (void)inputShape;
+        try {
+            Ort::SessionOptions options;
+            options.SetIntraOpNumThreads(backendOptions.threads);
+            options.SetInterOpNumThreads(1);
+            options.SetExecutionMode(ExecutionMode::ORT_SEQUENTIAL);
+            options.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_ALL);
+            session.reset(new Ort::Session(env, modelPath.c_str(), options));
+
+            Ort::AllocatorWithDefaultOptions allocator;
+            inputName = session->GetInputNameAllocated(0, allocator).get();
+            size_t outputTotal = session->GetOutputCount();
+            outputNameStore.clear();
+            for (size_t i = 0; i < outputTotal; ++i)
+                outputNameStore.push_back(session->GetOutputNameAllocated(i, allocator).get());
+        } catch (const Ort::Exception &e) {
+            error = e.what();
+            session.reset();
+            return false;
+        }
+        outputNames.clear();
+        for (size_t i = 0; i < outputNameStore.size(); ++i)
+            outputNames.push_back(outputNameStore[i].c_str());
+        return true;
+    }
+
+    cv::Mat &inputTensor() override { return blob; }
+
+    bool run() override
+    {
+        if (!session || blob.empty() || !blob.isContinuous() || blob.type() != CV_32F)
+            return false;
+        int64_t shape[4];
+        for (int i = 0; i < blob.dims && i < 4; ++i)
+            shape[i] = blob.size[i];
+        const char *inputNames[1] = {inputName.c_str()};
+        try {
+            Ort::Value input = Ort::Value::CreateTensor<float>(memoryInfo, blob.ptr<float>(), blob.total(),
+                                                               shape, static_cast<size_t>(blob.dims));
+            results = session->Run(Ort::RunOptions{nullptr}, inputNames, &input, 1,
+                                   outputNames.data(), outputNames.size());
+        } catch (const Ort::Exception &e) {
+            LOG_ERROR(LogInfer, "ONNX Runtime推理失败: %s", e.what());
+            return false;
+        }
+
+        outputs.resize(results.size());
+        for (size_t i = 0; i < results.size(); ++i) {
+            std::vector<int64_t> dims = results[i].GetTensorTypeAndShapeInfo().GetShape();
+            int sizes[8];
+            int n = static_cast<int>(dims.size() < 8 ? dims.size() : 8);
+            for (int d = 0; d < n; ++d)
+                sizes[d] = static_cast<int>(dims[d]);
+            outputs[i] = cv::Mat(n, sizes, CV_32F, results[i].GetTensorMutableData<float>());
+        }
+        return !outputs.empty();
+    }
+
+    int outputCount() const override { return static_cast<int>(outputs.size()); }
+    const cv::Mat &outputTensor(int index) const override { return outputs[index]; }
+
+    void release() override
+    {
+        outputs.clear();
+        results.clear();
+        session.reset();
+    }
+
+private:
+    Ort::Env env;
+    Ort::MemoryInfo memoryInfo;
+    std::unique_ptr<Ort::Session> session;
+    std::string inputName;
+    std::vector<std::string> outputNameStore;
+    std::vector<const char *> outputNames;
+    cv::Mat blob;
+    std::vector<Ort::Value> results;
+    std::vector<cv::Mat> outputs;
+};
+
+InferenceBackend *createOrtBackend()
+{
+    return new OrtBackend;
+}
+
+#endif // WHEELCHAIR_WITH_ORT
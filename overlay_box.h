@@ -0,0 +1,26 @@
+#ifndef OVERLAY_BOX_H
+#define OVERLAY_BOX_H
+
+#include <QtGlobal>
+#include <chrono>
+
+// 叠加层状态（帧坐标），由推理线程/跟踪器通过SeqLock无锁发布，绘制时只读不等待
+struct OverlayBox
+{
+    int x;
+    int y;
+    int width;          // 0表示无目标
+    int height;
+    int classId;        // -1表示仅有跟踪框
+    float confidence;
+    qint64 stampMs;     // 发布时刻（steady clock，毫秒）
+    char label[16];
+};
+
+inline qint64 overlayClockMs()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+#endif // OVERLAY_BOX_H
@@ -0,0 +1,803 @@
+#include "pipeline.h"
+#include "uart_master.h"
+#include "pipeline_clock.h"
+#include <QCoreApplication>
+#include <QDateTime>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+
+Pipeline::Pipeline(const AppConfig &appConfig, QObject *parent)
+    : QObject(parent)
+    , cfg(appConfig)
+    , logger(nullptr)
+    , uartFd(-1)
+    , cameraIndex(1)
+    , frameSource(nullptr)
+    , cameraSource(nullptr)
+    , replaySource(nullptr)
+    , flightRecorder(nullptr)
+    , controlDispatcher(nullptr)
+    , inputReader(nullptr)
+    , snapshotWriter(nullptr)
+    , sessionRecorder(nullptr)
+    , inferThread(nullptr)
+    , loopMonitor(nullptr)
+    , metrics(nullptr)
+    , metricsServer(nullptr)
+    , resultNotifier(nullptr)
+    , captureTimer(nullptr)
+    , rateTimer(nullptr)
+    , yoloInit(false)
+    , running(false)
+    , lastFrameId(0)
+    , seedFrameNext(0)
+    , awaitingReplayFrame(0)
+    , replayStartNs(0)
+    , inferNsTotal(0)
+    , lastCaptureTickMs(0)
+    , contended(false)
+    , frames(0)
+    , captured(0)
+    , inferred(0)
+    , lastCaptured(0)
+    , lastInferred(0)
+    , captureRate(0.0)
+    , inferRate(0.0)
+    , rateTicks(0)
+    , lastLogDropped(0)
+    , lastLogSuppressed(0)
+    , lastLoopStalls(0)
+    , lastSessionCpuNs(0)
+    , lastSessionStatNs(0)
+    , capturedCounter(nullptr)
+    , readFailedCounter(nullptr)
+    , inferRequestedCounter(nullptr)
+    , inferredCounter(nullptr)
+    , runningGauge(nullptr)
+{
+    // 异步日志线程（先于其他线程启动，其余线程的日志都经由它写出）
+    logger = new AsyncLogger(cfg.logPath, cfg.logRateLimit);
+    std::string logError;
+    bool logLevelsOk = AsyncLogger::configure(cfg.logLevels, logError);
+    logger->start();
+    if (!logLevelsOk)
+        LOG_WARN(LogSystem, "日志级别配置无效（%s），未生效部分保持info", logError);
+
+    // UART初始化（先于推理线程，控制分发线程需要串口句柄）
+    if (!cfg.replayPath.empty()) {
+        // 回放模式绝不打开真实串口：只写到--uart-out指定的文件或pty（如wheelchair_sim）
+        struct stat st;
+        if (cfg.uartOut.empty()) {
+            uartFd = -1;
+            LOG_INFO(LogReplay, "【回放】未指定--uart-out，指令不输出");
+        } else if (stat(cfg.uartOut.c_str(), &st) == 0 && S_ISCHR(st.st_mode)) {
+            uartFd = uart_init(cfg.uartOut.c_str());
+        } else {
+            uartFd = uart_open_capture(cfg.uartOut.c_str());
+        }
+        if (uartFd >= 0)
+            LOG_INFO(LogReplay, "【回放】串口输出写入 %s", cfg.uartOut);
+        replaySource = new ReplaySource(cfg.replayPath, static_cast<ReplayMode>(cfg.replayMode));
+        frameSource = replaySource;
+    } else {
+        uartFd = uart_init(cfg.uartPath.c_str());
+        if (uartFd < 0) {
+            LOG_ERROR(LogControl, "【UART初始化失败】无法发送控制指令，请检查%s是否存在并以ROOT权限运行", cfg.uartPath);
+        } else {
+            LOG_INFO(LogControl, "【UART初始化成功】已打开 %s，波特率115200", cfg.uartPath);
+        }
+        cameraSource = new CameraSource(cameraIndex, cfg.rawMjpeg);
+        frameSource = cameraSource;
+    }
+
+    // 黑匣子：内存一次性预分配，崩溃时也能转储
+    flightRecorder = new FlightRecorder(static_cast<size_t>(cfg.recorderBudgetMb) * 1024 * 1024,
+                                        static_cast<size_t>(cfg.recorderSlotKb) * 1024,
+                                        cfg.recorderDir.c_str(), this);
+    if (flightRecorder->isEnabled()) {
+        flightRecorder->installCrashHandler();
+        flightRecorder->start();
+        LOG_INFO(LogRecord, "【黑匣子】%d MB，%zu帧 / %zu条事件，转储目录 %s", cfg.recorderBudgetMb,
+                 flightRecorder->frameCapacity(), flightRecorder->eventCapacity(), cfg.recorderDir);
+    }
+    FlightRecorder *recorder = flightRecorder->isEnabled() ? flightRecorder : nullptr;
+
+    // 控制分发线程：推理结果直达UART，不经过事件循环
+    controlDispatcher = new ControlDispatcher(uartFd, cfg, this);
+    controlDispatcher->setFlightRecorder(recorder);
+    controlDispatcher->start();
+
+    // 物理按键/摇杆输入线程：事件直达控制分发线程
+    if (cfg.inputEnabled) {
+        inputReader = new InputReader(cfg.inputDevices, controlDispatcher, this);
+        connect(inputReader, &InputReader::inputCommand, this, &Pipeline::inputCommand);
+        LOG_INFO(LogInput, "【物理输入】已打开%d个输入设备", inputReader->deviceCount());
+        inputReader->start();
+    }
+
+    // 截图写盘线程
+    snapshotWriter = new SnapshotWriter(this);
+    connect(snapshotWriter, &SnapshotWriter::snapshotSaved, this, &Pipeline::snapshotSaved);
+    snapshotWriter->start();
+
+    // 连续录制写盘线程（回放时不录制）
+    if (!replaySource) {
+        SessionRecorder::Options sessionOptions;
+        sessionOptions.dir = cfg.sessionDir;
+        sessionOptions.avi = cfg.sessionAvi;
+        sessionOptions.segmentMb = cfg.sessionSegmentMb;
+        sessionOptions.segmentSec = cfg.sessionSegmentSec;
+        sessionOptions.minFreeMb = cfg.sessionMinFreeMb;
+        sessionRecorder = new SessionRecorder(sessionOptions, this);
+        connect(sessionRecorder, &SessionRecorder::segmentFinished, this, &Pipeline::onSessionSegmentFinished);
+        connect(sessionRecorder, &SessionRecorder::recordingStopped, this, &Pipeline::onSessionRecordingStopped);
+        sessionRecorder->start();
+    }
+
+    // 初始化推理线程
+    InferenceConfig inferenceConfig;
+    inferenceConfig.engine = cfg.inferenceEngine;
+    inferenceConfig.backend = cfg.inferenceBackend;
+    inferenceConfig.backendOptions.threads = cfg.inferenceThreads;
+    inferenceConfig.backendOptions.winograd = cfg.winograd;
+    inferenceConfig.inputSize = cfg.inputSize;
+    inferenceConfig.letterBox = cfg.letterBox;
+    inferenceConfig.gateModelPath = cfg.gateModelPath;
+    inferenceConfig.gateInputSize = cfg.gateInputSize;
+    inferenceConfig.gateMargin = cfg.gateMarginPct / 100.0f;
+    inferenceConfig.gateAuditInterval = cfg.gateAuditInterval;
+    if (!cfg.faceCascadePath.empty())
+        inferenceConfig.faceCascadePath = cfg.faceCascadePath;
+    inferenceConfig.faceModelPath = cfg.faceModelPath;
+    inferenceConfig.faceInputSize = cfg.faceInputSize;
+    if (cfg.tuningLoaded)
+        LOG_INFO(LogInfer, "推理配置读取自调优文件%s（环境变量优先）", cfg.tuningPath);
+    inferThread = new YoloInferThread(cfg.modelPath, inferenceConfig, this);
+    inferThread->setControlDispatcher(controlDispatcher);
+    inferThread->setFlightRecorder(recorder);
+    inferThread->setSessionRecorder(sessionRecorder);
+    yoloInit = inferThread->isInit();
+
+    // 监听推理结果eventfd
+    resultNotifier = new QSocketNotifier(inferThread->resultNotifyFd(), QSocketNotifier::Read, this);
+    // activated在Qt 5.15有重载，用字符串形式连接以兼容板端Qt 5.12
+    connect(resultNotifier, SIGNAL(activated(int)), this, SLOT(onInferenceFinished()));
+    inferThread->start();
+
+    if (yoloInit) {
+        LOG_INFO(LogInfer, "YOLOv11n推理线程初始化成功：%s（%s） 输入尺寸：%d x %d 每%d帧推理一次", cfg.modelPath,
+                 inferThread->backendName(), cfg.inputSize, cfg.inputSize, cfg.inferenceInterval);
+    } else {
+        LOG_ERROR(LogInfer, "YOLOv11n推理线程初始化失败");
+    }
+
+    // 采集定时器；回放模式由回放节奏驱动（单次定时器逐帧重新安排）
+    captureTimer = new QTimer(this);
+    captureTimer->setInterval(cfg.captureIntervalMs);
+    captureTimer->setTimerType(Qt::PreciseTimer);
+    captureTimer->setSingleShot(replaySource != nullptr);
+    connect(captureTimer, &QTimer::timeout, this, &Pipeline::captureFrame);
+
+    rateTimer = new QTimer(this);
+    rateTimer->setInterval(1000);
+    connect(rateTimer, &QTimer::timeout, this, &Pipeline::updateRates);
+
+    // 事件循环卡顿监测：探测事件在本线程的事件循环中分发，持续卡顿时经控制分发线程停车
+    if (cfg.uiStallMs > 0) {
+        loopMonitor = new EventLoopMonitor(cfg.uiStallMs, cfg.uiWatchdogMs, controlDispatcher, this);
+        loopMonitor->start();
+    }
+
+    // 指标导出线程（只读原子变量，不在任何控制路径上）
+    metrics = new MetricsRegistry;
+    registerMetrics();
+    if (!cfg.metricsAddress.empty()) {
+        metricsServer = new MetricsServer(metrics, this);
+        std::string metricsError;
+        if (metricsServer->listen(cfg.metricsAddress, metricsError)) {
+            metricsServer->start();
+            LOG_INFO(LogSystem, "【指标】Prometheus导出：%s/metrics", cfg.metricsAddress);
+        } else {
+            LOG_WARN(LogSystem, "【指标】导出端口监听失败（%s），不导出指标", metricsError);
+            delete metricsServer;
+            metricsServer = nullptr;
+        }
+    }
+}
+
+Pipeline::~Pipeline()
+{
+    // 先停指标导出：其读取函数引用下面各线程对象
+    if (metricsServer) {
+        metricsServer->stop();
+        delete metricsServer;
+    }
+    delete metrics;
+    // 卡顿监测会调用控制分发线程，先于它停止
+    if (loopMonitor) {
+        loopMonitor->stop();
+        delete loopMonitor;
+    }
+
+    // 释放摄像头/回放源
+    if (frameSource) {
+        frameSource->release();
+        delete frameSource;
+    }
+
+    // 停止推理线程（结果生产者），再停控制分发线程
+    if (inferThread) {
+        inferThread->stop();
+        delete inferThread;
+    }
+    if (inputReader) {
+        inputReader->stop();
+        delete inputReader;
+    }
+    // 写完队列中的帧并收尾当前段（回填AVI索引）
+    if (sessionRecorder) {
+        sessionRecorder->stop();
+        delete sessionRecorder;
+    }
+    // 等待已接受的截图写完
+    if (snapshotWriter) {
+        snapshotWriter->stop();
+        delete snapshotWriter;
+    }
+    if (controlDispatcher) {
+        controlDispatcher->stop();
+        delete controlDispatcher;
+    }
+    // 最后停黑匣子：待处理的转储会在退出前写完
+    if (flightRecorder) {
+        flightRecorder->stop();
+        delete flightRecorder;
+    }
+
+    // 关闭UART
+    if (uartFd >= 0) {
+        uart_close(uartFd);
+        LOG_INFO(LogControl, "【UART已关闭】释放串口资源");
+    }
+    logResourceUsage(true);
+
+    // 其余线程都已停止，写出队列中剩余的日志
+    logger->stop();
+    delete logger;
+}
+
+void Pipeline::start()
+{
+    UI_SLOT_SCOPE();
+    if (running)
+        return;
+    if (!frameSource->open()) {
+        if (replaySource) {
+            emit openFailed("无法打开回放文件！\n" + QString::fromStdString(replaySource->errorString()));
+            if (cfg.exitOnReplayEnd)
+                QCoreApplication::exit(2);
+        } else {
+            emit openFailed(QString("无法打开Q8 HD摄像头（尝试索引：%1,%2）").arg(cameraIndex).arg(cameraIndex == 1 ? 0 : 1));
+        }
+        return;
+    }
+
+    frames = 0;
+    captured = inferred = 0;
+    lastCaptured = lastInferred = 0;
+    captureRate = inferRate = 0.0;
+    contended = false;
+    captureClock.start();
+    lastCaptureTickMs = 0;
+    awaitingReplayFrame = 0;
+    replayStartNs = monotonicNowNs();
+    inferNsTotal = 0;
+
+    // 启动定时器（回放的第一帧立即送出）
+    if (replaySource)
+        captureTimer->start(0);
+    else
+        captureTimer->start(cfg.captureIntervalMs);
+    rateTimer->start();
+    running = true;
+    runningGauge->set(1);
+
+    if (replaySource) {
+        LOG_INFO(LogReplay, "【回放】%s", replaySource->description());
+    } else {
+        cv::Size size = cameraSource->frameSize();
+        LOG_INFO(LogCapture, "【摄像头已启动】索引%d 分辨率%dx%d %s", cameraSource->openedIndex(), size.width, size.height,
+                 cameraSource->isRawMjpeg() ? "原始MJPEG" : "解码输出");
+    }
+    emit runningChanged(true);
+
+    if (sessionRecorder && cfg.sessionAutoStart) {
+        QString message;
+        setSessionRecording(true, message);
+    }
+}
+
+void Pipeline::stop()
+{
+    UI_SLOT_SCOPE();
+    if (!running)
+        return;
+    captureTimer->stop();
+    rateTimer->stop();
+    if (isSessionRecording()) {
+        QString message;
+        setSessionRecording(false, message);
+    }
+    frameSource->release();
+    headTracker.reset();
+    lastFrame.release();
+    lastJpeg.release();
+    for (int i = 0; i < kSeedFrames; ++i)
+        seedFrames[i].release();
+    running = false;
+    runningGauge->set(0);
+    emit runningChanged(false);
+}
+
+// 采集一帧（采集源可以是摄像头或回放）
+void Pipeline::captureFrame()
+{
+    UI_SLOT_SCOPE();
+    if (!frameSource->isOpened()) return;
+
+    CapturedFrame capturedFrame;
+    if (!frameSource->read(capturedFrame)) {
+        if (frameSource->atEnd()) {
+            finishReplay();
+            return;
+        }
+        readFailedCounter->inc();
+        emit frameReadFailed();
+        if (replaySource)
+            scheduleNextReplayFrame();
+        return;
+    }
+
+    const cv::Mat &frame = capturedFrame.bgr;
+    frames++;
+    captured++;
+    capturedCounter->inc();
+    lastFrame = frame;
+    lastFrameId = capturedFrame.frameId;
+    lastJpeg = capturedFrame.jpeg;
+    // 原始MJPEG直接拷入黑匣子预分配槽位（无原始数据时只记录事件，不在采集线程上编码）
+    if (!lastJpeg.empty() && lastJpeg.isContinuous()) {
+        flightRecorder->recordFrame(capturedFrame.frameId, capturedFrame.captureNs, lastJpeg.ptr(), lastJpeg.total());
+    }
+    if (sessionRecorder) {
+        sessionRecorder->recordFrame(lastJpeg, capturedFrame.frameId, capturedFrame.captureNs);
+    }
+
+    // 采集节拍滞后超过半个周期，说明CPU紧张，显示需要让路
+    qint64 nowMs = captureClock.elapsed();
+    contended = lastCaptureTickMs > 0 &&
+                nowMs - lastCaptureTickMs > cfg.captureIntervalMs * 3 / 2;
+    lastCaptureTickMs = nowMs;
+
+    // 推理间隔内逐帧跟踪头部；跟踪失败时立即触发一次整帧推理
+    bool tracked = false;
+    bool trackLost = false;
+    if (headTracker.isTracking()) {
+        tracked = headTracker.update(frame);
+        trackLost = !tracked;
+    }
+
+    // 每N帧触发一次推理（跟踪中只推理跟踪框附近的ROI）；确定性回放只推理录制时推理过的帧
+    bool lockstep = replaySource && replaySource->mode() == ReplayLockstep;
+    bool inferNow = lockstep && replaySource->hasRecordedInference()
+                        ? replaySource->wasInferred(capturedFrame.frameId)
+                        : (frames % cfg.inferenceInterval == 0 || trackLost);
+    bool inferenceRequested = yoloInit && inferNow;
+    if (inferenceRequested) {
+        inferThread->setFrame(frame, tracked ? headTracker.inferenceRoi(frame.size()) : cv::Rect(),
+                              tracked ? headTracker.box() : cv::Rect(), capturedFrame.frameId, capturedFrame.captureNs);
+        inferRequestedCounter->inc();
+        seedFrames[seedFrameNext] = frame;
+        seedFrameIds[seedFrameNext] = capturedFrame.frameId;
+        seedFrameNext = (seedFrameNext + 1) % kSeedFrames;
+        if (lockstep)
+            awaitingReplayFrame = capturedFrame.frameId;
+    }
+
+    // 发布跟踪框叠加层；显示端按自己的节拍取走最新帧
+    OverlayBox trackBox;
+    memset(&trackBox, 0, sizeof(trackBox));
+    trackBox.classId = -1;
+    if (tracked) {
+        cv::Rect box = headTracker.box();
+        trackBox.x = box.x;
+        trackBox.y = box.y;
+        trackBox.width = box.width;
+        trackBox.height = box.height;
+    }
+    trackBox.stampMs = overlayClockMs();
+    trackBoxOverlay.store(trackBox);
+    emit frameCaptured(inferenceRequested);
+
+    if (replaySource && awaitingReplayFrame == 0)
+        scheduleNextReplayFrame();
+}
+
+void Pipeline::scheduleNextReplayFrame()
+{
+    if (running)
+        captureTimer->start(replaySource->nextFrameDelayMs());
+}
+
+void Pipeline::finishReplay()
+{
+    captureTimer->stop();
+    rateTimer->stop();
+    double wallSec = (monotonicNowNs() - replayStartNs) / 1e9;
+    const LatencyHistogram &total = controlDispatcher->pipelineLatency().stages[StageTotal];
+    char throughput[256];
+    snprintf(throughput, sizeof(throughput),
+             "throughput: %llu frames in %.2fs (%.1f fps), %llu inferences (avg %.1fms), glass-to-wire p50 %.1fms p99 %.1fms",
+             static_cast<unsigned long long>(captured), wallSec, wallSec > 0 ? captured / wallSec : 0.0,
+             static_cast<unsigned long long>(inferred),
+             inferred ? inferNsTotal / 1e6 / inferred : 0.0,
+             total.percentileUs(50) / 1000.0, total.percentileUs(99) / 1000.0);
+    std::string summary = replaySource->summary();
+    fprintf(stderr, "【回放结束】%s\n%s\n", summary.c_str(), throughput);
+
+    bool mismatched = replaySource->classMismatches() > 0 || replaySource->commandMismatches() > 0;
+    QString brief = QString("回放结束：比对%1次推理，类别不一致%2，指令不一致%3")
+                        .arg(replaySource->comparedFrames()).arg(replaySource->classMismatches())
+                        .arg(replaySource->commandMismatches());
+    emit replayFinished(brief, throughput);
+    if (cfg.exitOnReplayEnd)
+        QCoreApplication::exit(mismatched ? 1 : 0);
+}
+
+// 推理完成（由结果eventfd触发）：控制指令已由控制分发线程发出，这里只做观察、跟踪器播种与回放比对
+void Pipeline::onInferenceFinished()
+{
+    UI_SLOT_SCOPE();
+    DetectionResult result;
+    if (!inferThread->takeResult(result)) {
+        return;
+    }
+    inferred++;
+    inferredCounter->inc();
+    inferNsTotal += result.t_infer_end_ns - result.t_infer_start_ns;
+    qint64 inferMs = (result.t_infer_end_ns - result.t_infer_start_ns) / 1000000;
+
+    // 回放：与录制结果逐帧比对；确定性模式下收到等待的结果后才送下一帧
+    if (replaySource) {
+        const Detection *top = result.best();
+        replaySource->compare(result, top ? ControlDispatcher::commandForClass(top->class_id) : 0);
+        if (awaitingReplayFrame != 0 && result.frame_id == awaitingReplayFrame) {
+            awaitingReplayFrame = 0;
+            scheduleNextReplayFrame();
+        }
+    }
+    // 结果已按置信度降序，首个即最优目标
+    const Detection *best = result.best();
+
+    // 检测到有效目标
+    if (best) {
+        const char *poseName = Inference::getClassName(best->class_id);
+        LOG_INFO(LogInfer, "【检测】帧#%u 姿态：%s 置信度：%.4f 框：x=%d y=%d 宽度=%d 高度=%d",
+                 result.frame_id, poseName, best->confidence, best->box.x, best->box.y, best->box.width, best->box.height);
+
+        seedTracker(result.frame_id, best->box);
+
+        // UART指令已由控制分发线程发出，这里只观察结果
+        CommandTrace trace;
+        if (uartFd >= 0) {
+            if (controlDispatcher->lastAutoTrace(trace) && trace.frameId == result.frame_id) {
+                LOG_INFO(LogControl, "【UART发送成功】帧#%u → 字符：%c 采集→上线：%lldus（排队%lldus 推理%lldus 分发%lldus 串口%lldus）",
+                         trace.frameId, trace.cmd, (trace.tSentNs - trace.tCaptureNs) / 1000,
+                         (trace.tInferStartNs - trace.tCaptureNs) / 1000, (trace.tInferEndNs - trace.tInferStartNs) / 1000,
+                         (trace.tDispatchNs - trace.tInferEndNs) / 1000, (trace.tSentNs - trace.tDispatchNs) / 1000);
+            } else if (controlDispatcher->arbiterMode() == CommandArbiter::ModeAuto) {
+                LOG_INFO(LogControl, "【UART发送成功】姿态：%s → 字符：%c 结果→上线：%lldus", poseName,
+                         ControlDispatcher::commandForClass(best->class_id), controlDispatcher->lastLatencyNs() / 1000);
+            } else {
+                LOG_INFO(LogControl, "【自动指令被仲裁】姿态：%s 手动控制优先，已作废%llu条自动指令", poseName,
+                         controlDispatcher->cancelledAutoCount());
+            }
+        } else {
+            LOG_WARN(LogControl, "【UART发送失败】串口未初始化，无法发送字符");
+        }
+    } else {
+        LOG_DEBUG(LogInfer, "【检测】帧#%u 未检测到头部姿态", result.frame_id);
+        headTracker.reset();
+    }
+    emit detectionFinished(result, inferMs);
+}
+
+// 用检测框重新播种跟踪器：框属于推理用的那一帧，结果到达时已过去几帧，
+// 在那一帧上取角点后用光流一步传播到最新帧；那一帧已不在缓存中时不播种（过期框放到新帧上会跟错目标）
+void Pipeline::seedTracker(uint32_t frameId, const cv::Rect &box)
+{
+    for (int i = 0; i < kSeedFrames; ++i) {
+        if (seedFrames[i].empty() || seedFrameIds[i] != frameId)
+            continue;
+        if (headTracker.seed(seedFrames[i], box) && frameId != lastFrameId)
+            headTracker.update(lastFrame);
+        return;
+    }
+    LOG_DEBUG(LogInfer, "【跟踪】帧#%u 已不在缓存中（最新帧#%u），不播种", frameId, lastFrameId);
+}
+
+void Pipeline::updateRates()
+{
+    UI_SLOT_SCOPE();
+    captureRate = static_cast<double>(captured - lastCaptured);
+    inferRate = static_cast<double>(inferred - lastInferred);
+    lastCaptured = captured;
+    lastInferred = inferred;
+
+    // 驱动没有协商到MJPEG时采集端会退回解码输出，此时没有可直接写出的原始数据
+    if (isSessionRecording() && cameraSource && !cameraSource->isRawMjpeg()) {
+        sessionRecorder->endRecording();
+        onSessionRecordingStopped("摄像头未输出原始MJPEG");
+    }
+
+    // 每10秒把各环节直方图汇总写入日志
+    const PipelineLatency &pipeline = controlDispatcher->pipelineLatency();
+    if (++rateTicks % 10 == 0 && pipeline.stages[StageTotal].count() > 0) {
+        char summary[512];
+        pipeline.format(summary, sizeof(summary));
+        LOG_INFO(LogStats, "【端到端延迟】%s", summary);
+    }
+
+    // 每10秒汇总录制开销：采集线程入队耗时、写盘线程CPU占用
+    if (rateTicks % 10 == 0 && isSessionRecording()) {
+        SessionRecorder::Stats st = sessionRecorder->stats();
+        int64_t now = monotonicNowNs();
+        double cpuPercent = lastSessionStatNs > 0 && now > lastSessionStatNs
+                                ? 100.0 * (st.writerCpuNs - lastSessionCpuNs) / (now - lastSessionStatNs) : 0.0;
+        lastSessionCpuNs = st.writerCpuNs;
+        lastSessionStatNs = now;
+        LOG_INFO(LogStats, "【连续录制】%llu帧 %.1fMB %llu段 丢帧%llu | 入队平均%.2fus 写盘线程CPU %.2f%%",
+                 st.frames, st.bytes / 1048576.0, st.segments, st.dropped,
+                 st.frames + st.dropped ? st.enqueueNs / (st.frames + st.dropped) / 1000.0 : 0.0, cpuPercent);
+    }
+
+    // 每10秒汇总级联效果：门控采用率、相对每帧跑完整模型的耗时降低、抽查不一致率（均为累计值）
+    if (rateTicks % 10 == 0 && inferThread->isCascade()) {
+        CascadeStats cs = inferThread->cascadeStats();
+        if (cs.frames > 0) {
+            LOG_INFO(LogStats, "【级联】%llu帧 门控采用%.1f%% | 平均%.1fms（完整模型%.1fms，降低%.0f%%） | 抽查%llu帧 不一致%.1f%%",
+                     cs.frames, 100.0 * cs.accepted / cs.frames, cs.averageMs(), cs.fullAverageMs(),
+                     100.0 * cs.latencyReduction(), cs.audited, 100.0 * cs.disagreementRate());
+        }
+    }
+
+    // 每10秒记录进程RSS与CPU（界面/无界面两种入口格式相同，直接对比）
+    if (rateTicks % 10 == 0)
+        logResourceUsage(false);
+
+    // 事件循环：有新的卡顿时记一条，附上分发延迟分布
+    if (rateTicks % 10 == 0 && loopMonitor && loopMonitor->stallCount() != lastLoopStalls) {
+        const LatencyHistogram &lag = loopMonitor->lag();
+        LOG_INFO(LogStats, "【事件循环】近10秒卡顿%llu次 | 分发延迟 p50=%.1fms p99=%.1fms 最大%.1fms 看门狗停车累计%llu次",
+                 loopMonitor->stallCount() - lastLoopStalls, lag.percentileUs(50) / 1000.0, lag.percentileUs(99) / 1000.0,
+                 loopMonitor->worstLagUs() / 1000.0, loopMonitor->watchdogCount());
+        lastLoopStalls = loopMonitor->stallCount();
+    }
+
+    // 日志本身的丢弃（队列满）与限流：有新增时记一条，便于判断日志是否完整
+    if (rateTicks % 10 == 0) {
+        uint64_t droppedLogs = logger->droppedCount();
+        uint64_t suppressedLogs = logger->suppressedCount();
+        if (droppedLogs != lastLogDropped || suppressedLogs != lastLogSuppressed) {
+            LOG_INFO(LogStats, "【日志】近10秒队列满丢弃%llu条 限流%llu条",
+                     droppedLogs - lastLogDropped, suppressedLogs - lastLogSuppressed);
+            lastLogDropped = droppedLogs;
+            lastLogSuppressed = suppressedLogs;
+        }
+    }
+
+    emit ratesUpdated();
+}
+
+void Pipeline::logResourceUsage(bool final)
+{
+    ResourceSample s = resources.sample();
+    if (final) {
+        LOG_INFO(LogStats, "【资源】运行%.0f秒 平均CPU %.1f%% 峰值RSS %.1fMB",
+                 resources.elapsedSec(), resources.averageCpuPercent(), s.peakRssMb);
+    } else {
+        LOG_INFO(LogStats, "【资源】RSS %.1fMB（峰值%.1fMB） CPU %.1f%%", s.rssMb, s.peakRssMb, s.cpuPercent);
+    }
+}
+
+// 指标命名遵循Prometheus约定：计数以_total结尾，时间单位为秒，字节为bytes。
+// 读取函数都在导出线程中调用，只读原子变量；各线程对象在导出线程停止后才销毁。
+void Pipeline::registerMetrics()
+{
+    MetricsRegistry &m = *metrics;
+
+    runningGauge = m.gauge("wheelchair_running", "采集是否在运行（1运行，0停止）");
+    capturedCounter = m.counter("wheelchair_frames_captured_total", "采集成功的帧数");
+    readFailedCounter = m.counter("wheelchair_frame_read_failures_total", "采集读帧失败次数");
+    inferRequestedCounter = m.counter("wheelchair_inference_requests_total", "送入推理线程的帧数");
+    inferredCounter = m.counter("wheelchair_frames_inferred_total", "完成推理并被主线程取走结果的帧数");
+    YoloInferThread *infer = inferThread;
+    m.counterFn("wheelchair_inference_superseded_total", "送入推理后未被处理即被新帧覆盖的帧数",
+                [infer]() { return static_cast<double>(infer->supersededFrames()); });
+    if (infer->isCascade()) {
+        m.counterFn("wheelchair_cascade_frames_total", "经过门控模型的帧数",
+                    [infer]() { return static_cast<double>(infer->cascadeStats().frames); });
+        m.counterFn("wheelchair_cascade_accepted_total", "直接采用门控结果的帧数",
+                    [infer]() { return static_cast<double>(infer->cascadeStats().accepted); });
+        m.counterFn("wheelchair_cascade_audited_total", "采用门控结果后抽查完整模型的帧数",
+                    [infer]() { return static_cast<double>(infer->cascadeStats().audited); });
+        m.counterFn("wheelchair_cascade_disagreed_total", "抽查中门控与完整模型类别不一致的帧数",
+                    [infer]() { return static_cast<double>(infer->cascadeStats().disagreed); });
+        m.gaugeFn("wheelchair_cascade_latency_reduction_ratio", "相对每帧都跑完整模型的推理耗时降低比例",
+                  [infer]() { return infer->cascadeStats().latencyReduction(); });
+    }
+
+    // 控制分发：串口指令与端到端延迟
+    ControlDispatcher *dispatch = controlDispatcher;
+    m.counterFn("wheelchair_uart_commands_sent_total", "成功写入串口的指令数",
+                [dispatch]() { return static_cast<double>(dispatch->commandsSent()); });
+    m.counterFn("wheelchair_uart_commands_failed_total", "写串口失败的指令数",
+                [dispatch]() { return static_cast<double>(dispatch->commandsFailed()); });
+    m.counterFn("wheelchair_commands_over_budget_total", "结果→上线超出延迟预算的指令数",
+                [dispatch]() { return static_cast<double>(dispatch->overBudgetCount()); });
+    m.counterFn("wheelchair_auto_commands_cancelled_total", "被手动控制仲裁作废的自动指令数",
+                [dispatch]() { return static_cast<double>(dispatch->cancelledAutoCount()); });
+    m.counterFn("wheelchair_setpoint_frames_sent_total", "帧协议下发出的速度设定值帧数",
+                [dispatch]() { return static_cast<double>(dispatch->setpointFramesSent()); });
+    m.counterFn("wheelchair_setpoint_timeouts_total", "帧协议下超时无新指令、目标归零的次数",
+                [dispatch]() { return static_cast<double>(dispatch->setpointTimeoutCount()); });
+    m.gaugeFn("wheelchair_arbiter_mode", "仲裁状态（0自动 1手动保持 2等待确认 3停止锁存）",
+              [dispatch]() { return static_cast<double>(dispatch->arbiterMode()); });
+    m.gaugeFn("wheelchair_setpoint_linear_mm_per_second", "当前线速度设定值（帧协议）",
+              [dispatch]() { return static_cast<double>(dispatch->currentLinear()); });
+    m.gaugeFn("wheelchair_setpoint_angular_mrad_per_second", "当前角速度设定值（帧协议）",
+              [dispatch]() { return static_cast<double>(dispatch->currentAngular()); });
+    const PipelineLatency &latency = controlDispatcher->pipelineLatency();
+    for (int stage = 0; stage < StageCount; ++stage) {
+        m.histogram("wheelchair_stage_latency_seconds", "自动指令各环节延迟（total为采集→指令上线）",
+                    &latency.stages[stage], std::string("stage=\"") + PipelineLatency::stageName(stage) + "\"");
+    }
+    static const char *const kSourceNames[SourceCount] = {"auto", "button", "input", "watchdog"};
+    for (int source = 0; source < SourceCount; ++source) {
+        m.summary("wheelchair_command_latency_seconds", "各指令来源从产生到写完串口的延迟",
+                  &controlDispatcher->latency(static_cast<CommandSource>(source)),
+                  std::string("source=\"") + kSourceNames[source] + "\"");
+    }
+    if (inputReader) {
+        InputReader *input = inputReader;
+        m.counterFn("wheelchair_input_events_total", "读取的物理输入事件数",
+                    [input]() { return static_cast<double>(input->eventsRead()); });
+        m.counterFn("wheelchair_input_commands_total", "物理输入产生的指令数",
+                    [input]() { return static_cast<double>(input->commandsIssued()); });
+    }
+
+    // 黑匣子/录制/截图
+    FlightRecorder *recorder = flightRecorder;
+    m.counterFn("wheelchair_flight_recorder_dumps_total", "黑匣子转储次数",
+                [recorder]() { return static_cast<double>(recorder->dumpsWritten()); });
+    m.counterFn("wheelchair_flight_recorder_oversized_frames_total", "超出单帧上限未存入黑匣子的帧数",
+                [recorder]() { return static_cast<double>(recorder->framesTooLarge()); });
+    if (sessionRecorder) {
+        SessionRecorder *session = sessionRecorder;
+        m.counterFn("wheelchair_session_frames_total", "连续录制写入的帧数",
+                    [session]() { return static_cast<double>(session->stats().frames); });
+        m.counterFn("wheelchair_session_bytes_total", "连续录制写入的字节数",
+                    [session]() { return static_cast<double>(session->stats().bytes); });
+        m.counterFn("wheelchair_session_dropped_frames_total", "连续录制队列满丢弃的帧数",
+                    [session]() { return static_cast<double>(session->stats().dropped); });
+        m.counterFn("wheelchair_session_segments_total", "连续录制完成的段文件数",
+                    [session]() { return static_cast<double>(session->stats().segments); });
+    }
+    SnapshotWriter *snapshots = snapshotWriter;
+    m.counterFn("wheelchair_snapshots_saved_total", "写盘成功的截图数",
+                [snapshots]() { return static_cast<double>(snapshots->savedCount()); });
+    m.counterFn("wheelchair_snapshots_rejected_total", "队列满被拒绝的截图数",
+                [snapshots]() { return static_cast<double>(snapshots->rejectedCount()); });
+
+    // 后台队列深度
+    AsyncLogger *log = logger;
+    if (sessionRecorder) {
+        SessionRecorder *session = sessionRecorder;
+        m.gaugeFn("wheelchair_queue_depth", "后台线程队列中待处理的条目数",
+                  [session]() { return static_cast<double>(session->queueDepth()); }, "queue=\"session\"");
+    }
+    m.gaugeFn("wheelchair_queue_depth", "后台线程队列中待处理的条目数",
+              [snapshots]() { return static_cast<double>(snapshots->queueDepth()); }, "queue=\"snapshot\"");
+    m.gaugeFn("wheelchair_queue_depth", "后台线程队列中待处理的条目数",
+              [log]() { return static_cast<double>(log->backlog()); }, "queue=\"log\"");
+    m.counterFn("wheelchair_log_dropped_total", "日志队列满丢弃的条数",
+                [log]() { return static_cast<double>(log->droppedCount()); });
+    m.counterFn("wheelchair_log_suppressed_total", "日志限流丢弃的条数",
+                [log]() { return static_cast<double>(log->suppressedCount()); });
+
+    // 主线程事件循环
+    if (loopMonitor) {
+        EventLoopMonitor *loop = loopMonitor;
+        m.histogram("wheelchair_event_loop_lag_seconds", "探测事件从投递到在主线程分发的延迟", &loop->lag());
+        m.counterFn("wheelchair_event_loop_stalls_total", "主线程事件循环卡顿次数",
+                    [loop]() { return static_cast<double>(loop->stallCount()); });
+        m.counterFn("wheelchair_event_loop_watchdog_stops_total", "持续卡顿触发的看门狗停止次数",
+                    [loop]() { return static_cast<double>(loop->watchdogCount()); });
+    }
+
+    // 进程资源
+    m.gaugeFn("process_resident_memory_bytes", "进程常驻内存（VmRSS）", []() {
+        long rssKb, peakRssKb;
+        ResourceUsage::readMemoryKb(rssKb, peakRssKb);
+        return rssKb * 1024.0;
+    });
+    m.gaugeFn("wheelchair_peak_resident_memory_bytes", "进程常驻内存峰值（VmHWM）", []() {
+        long rssKb, peakRssKb;
+        ResourceUsage::readMemoryKb(rssKb, peakRssKb);
+        return peakRssKb * 1024.0;
+    });
+    m.counterFn("process_cpu_seconds_total", "进程累计CPU时间（用户态+内核态）",
+                []() { return ResourceUsage::processCpuNs() / 1e9; });
+}
+
+bool Pipeline::captureSnapshot(QString &path)
+{
+    if (lastFrame.empty())
+        return false;
+
+    // 生成带时间戳的文件名（毫秒，连续截图不会互相覆盖）
+    QString timestamp = QDateTime::currentDateTime().toString("yyyyMMdd_hhmmss_zzz");
+    path = QString("/root/q8_yolov11n_capture_%1_%2x%2.jpg").arg(timestamp).arg(MODEL_INPUT_SIZE);
+    return snapshotWriter->enqueue(lastFrame, lastJpeg, path);
+}
+
+void Pipeline::dumpFlightRecorder()
+{
+    flightRecorder->trigger(TriggerManual);
+}
+
+bool Pipeline::setSessionRecording(bool on, QString &message)
+{
+    if (!sessionRecorder) {
+        message = "回放模式下不录制";
+        return false;
+    }
+    if (!on) {
+        if (sessionRecorder->isRecording()) {
+            sessionRecorder->endRecording();
+            message = "连续录制已停止，段文件保存在 " + QString::fromStdString(cfg.sessionDir);
+            emit sessionRecordingChanged(false, message);
+        }
+        return true;
+    }
+    if (sessionRecorder->isRecording())
+        return true;
+    if (!running || !cameraSource->isRawMjpeg()) {
+        message = "连续录制需要原始MJPEG采集（WHEELCHAIR_RAW_MJPEG未关闭且摄像头输出MJPEG）";
+        LOG_WARN(LogRecord, "【连续录制】%s", message);
+        return false;
+    }
+    // AVI按采集定时器的名义帧率写头，每帧真实采集时刻见.idx索引
+    sessionRecorder->beginRecording(cameraSource->frameSize(), 1000.0 / cfg.captureIntervalMs);
+    lastSessionCpuNs = sessionRecorder->stats().writerCpuNs;
+    lastSessionStatNs = monotonicNowNs();
+    message = "连续录制中（原始MJPEG直写）：" + QString::fromStdString(cfg.sessionDir);
+    LOG_INFO(LogRecord, "【连续录制】%s", message);
+    emit sessionRecordingChanged(true, message);
+    return true;
+}
+
+void Pipeline::onSessionSegmentFinished(const QString &path, quint64 frameCount, quint64 bytes)
+{
+    UI_SLOT_SCOPE();
+    LOG_INFO(LogRecord, "【连续录制】段文件完成 %s %llu帧 %.1fMB", path, frameCount, bytes / 1048576.0);
+    emit statusMessage("录制段已保存：" + path + " | " + QString::number(frameCount) + "帧");
+}
+
+void Pipeline::onSessionRecordingStopped(const QString &reason)
+{
+    UI_SLOT_SCOPE();
+    LOG_WARN(LogRecord, "【连续录制】已停止：%s", reason);
+    emit sessionRecordingChanged(false, "连续录制已停止：" + reason);
+}
@@ -0,0 +1,169 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <QObject>
+#include <QTimer>
+#include <QString>
+#include <QElapsedTimer>
+#include <QSocketNotifier>
+#include <opencv2/core.hpp>
+#include "app_config.h"
+#include "inference.h"
+#include "infer_thread.h"
+#include "head_tracker.h"
+#include "control_dispatcher.h"
+#include "input_reader.h"
+#include "snapshot_writer.h"
+#include "flight_recorder.h"
+#include "session_recorder.h"
+#include "frame_source.h"
+#include "replay_source.h"
+#include "resource_usage.h"
+#include "async_logger.h"
+#include "metrics_registry.h"
+#include "metrics_server.h"
+#include "event_loop_monitor.h"
+#include "overlay_box.h"
+#include "seqlock.h"
+
+// 采集→推理→控制流水线（不依赖QtWidgets）：图形界面与无界面（--headless）两种入口共用。
+// 运行在创建它的线程的事件循环上：采集定时器、推理结果eventfd、每秒统计都在这里处理，
+// 推理/控制分发/物理输入/写盘各自在后台线程。界面只通过信号与只读接口观察状态，
+// 不参与控制路径，因此两种入口的控制行为完全一致。
+class Pipeline : public QObject
+{
+    Q_OBJECT
+public:
+    explicit Pipeline(const AppConfig &appConfig, QObject *parent = nullptr);
+    ~Pipeline();
+
+    const AppConfig &config() const { return cfg; }
+    bool isYoloInit() const { return yoloInit; }
+    bool isRunning() const { return running; }
+    bool isReplay() const { return replaySource != nullptr; }
+    bool uartReady() const { return uartFd >= 0; }
+
+    ControlDispatcher *dispatcher() const { return controlDispatcher; }
+    FlightRecorder *recorder() const { return flightRecorder; }
+    CameraSource *camera() const { return cameraSource; }
+    ReplaySource *replay() const { return replaySource; }
+
+    // 显示端只读：最新采集帧（cv::Mat引用计数共享）与两路叠加层
+    const cv::Mat &latestFrame() const { return lastFrame; }
+    bool captureContended() const { return contended; }
+    const SeqLock<OverlayBox> *detectionOverlay() const { return inferThread->overlayState(); }
+    const SeqLock<OverlayBox> *trackOverlay() const { return &trackBoxOverlay; }
+
+    int frameCounter() const { return frames; }
+    quint64 capturedFrames() const { return captured; }
+    quint64 inferredFrames() const { return inferred; }
+    double captureFps() const { return captureRate; }
+    double inferFps() const { return inferRate; }
+
+    // 截图：取最新帧交给写盘线程；返回false表示没有帧或队列已满
+    bool captureSnapshot(QString &path);
+    void dumpFlightRecorder();
+    // 开始/停止连续录制；需要原始MJPEG采集，不满足时返回false并给出原因
+    bool setSessionRecording(bool on, QString &message);
+    bool isSessionRecording() const { return sessionRecorder && sessionRecorder->isRecording(); }
+
+public slots:
+    void start();
+    void stop();
+
+signals:
+    void runningChanged(bool running);
+    void openFailed(const QString &message);
+    // 每采集一帧发出一次（直连，同一线程内只是一次函数调用）
+    void frameCaptured(bool inferenceRequested);
+    void frameReadFailed();
+    void detectionFinished(const DetectionResult &result, qint64 inferMs);
+    void ratesUpdated();   // 每秒一次，帧率与端到端延迟已更新
+    void replayFinished(const QString &brief, const QString &throughput);
+    void inputCommand(char cmd);
+    void snapshotSaved(const QString &path, bool ok, qint64 costMs);
+    void sessionRecordingChanged(bool recording, const QString &message);
+    void statusMessage(const QString &text);
+
+private slots:
+    void captureFrame();
+    void onInferenceFinished();
+    void updateRates();
+    void onSessionSegmentFinished(const QString &path, quint64 frameCount, quint64 bytes);
+    void onSessionRecordingStopped(const QString &reason);
+
+private:
+    void scheduleNextReplayFrame();   // 回放：按模式安排下一帧的送出时刻
+    void finishReplay();              // 回放：读完全部帧，输出比对与吞吐汇总
+    void logResourceUsage(bool final);
+    void seedTracker(uint32_t frameId, const cv::Rect &box);   // 检测结果播种跟踪器并传播到最新帧
+    void registerMetrics();           // 登记全部导出指标（各线程对象创建之后、导出线程启动之前）
+
+    AppConfig cfg;
+    AsyncLogger *logger;          // 最先创建、最后销毁：其余线程都停下后才停日志线程
+    int uartFd;
+    int cameraIndex;
+    FrameSource *frameSource;     // 摄像头或录制回放
+    CameraSource *cameraSource;   // 摄像头模式下指向frameSource，否则为空
+    ReplaySource *replaySource;   // 回放模式下指向frameSource，否则为空
+    FlightRecorder *flightRecorder;
+    ControlDispatcher *controlDispatcher;
+    InputReader *inputReader;
+    SnapshotWriter *snapshotWriter;
+    SessionRecorder *sessionRecorder;   // 回放模式下为空
+    YoloInferThread *inferThread;
+    EventLoopMonitor *loopMonitor;   // WHEELCHAIR_UI_STALL_MS=0时为空
+    MetricsRegistry *metrics;
+    MetricsServer *metricsServer;   // 未配置导出地址或监听失败时为空
+    QSocketNotifier *resultNotifier;
+    QTimer *captureTimer;
+    QTimer *rateTimer;
+    bool yoloInit;
+    bool running;
+
+    // 推理间隔内的头部跟踪
+    HeadTracker headTracker;
+    cv::Mat lastFrame;       // 最近一次采集的帧（检测结果经光流传播到这一帧，截图也取自这里）
+    cv::Mat lastJpeg;        // lastFrame对应的原始MJPEG数据（原始采集模式下才有）
+    uint32_t lastFrameId;
+    // 最近送去推理的几帧（每帧独立解码，持有引用不拷贝）：结果到达时在推理用的那一帧上播种跟踪器，
+    // 推理跟不上时推理线程只取最新一帧，保留几帧足以覆盖排队中的结果
+    static const int kSeedFrames = 4;
+    cv::Mat seedFrames[kSeedFrames];
+    uint32_t seedFrameIds[kSeedFrames];
+    int seedFrameNext;
+    SeqLock<OverlayBox> trackBoxOverlay;   // 跟踪框叠加层（采集线程写）
+    uint32_t awaitingReplayFrame;   // 确定性回放：等待该帧的推理结果后才送下一帧（0表示不等待）
+    int64_t replayStartNs;
+    int64_t inferNsTotal;
+
+    // 采集节拍：滞后时（CPU被推理/控制占满）显示端降频让路
+    QElapsedTimer captureClock;
+    qint64 lastCaptureTickMs;
+    bool contended;
+
+    // 帧计数与帧率
+    int frames;
+    quint64 captured;
+    quint64 inferred;
+    quint64 lastCaptured;
+    quint64 lastInferred;
+    double captureRate;
+    double inferRate;
+    int rateTicks;
+    uint64_t lastLogDropped;       // 上次汇总时的日志丢弃/限流条数
+    uint64_t lastLogSuppressed;
+    uint64_t lastLoopStalls;       // 上次汇总时的事件循环卡顿次数
+    uint64_t lastSessionCpuNs;     // 上次汇总时的录制写盘线程CPU时间
+    int64_t lastSessionStatNs;
+    ResourceUsage resources;
+
+    // 导出用计数（与上面的帧计数同步累加；上面的只在本线程读写，这里供导出线程读取）
+    MetricCounter *capturedCounter;
+    MetricCounter *readFailedCounter;
+    MetricCounter *inferRequestedCounter;
+    MetricCounter *inferredCounter;
+    MetricGauge *runningGauge;
+};
+
+#endif // PIPELINE_H
@@ -0,0 +1,15 @@
+#ifndef PIPELINE_CLOCK_H
+#define PIPELINE_CLOCK_H
+
+#include <stdint.h>
+#include <time.h>
+
+// 流水线各环节统一使用的单调时钟（纳秒），与V4L2缓冲区时间戳同源
+static inline int64_t monotonicNowNs()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+}
+
+#endif // PIPELINE_CLOCK_H
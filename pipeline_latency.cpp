@@ -0,0 +1,106 @@
+#include "pipeline_latency.h"
+#include <stdio.h>
+
+static const char *kStageNames[StageCount] = {"queue", "infer", "dispatch", "uart", "total"};
+
+LatencyHistogram::LatencyHistogram()
+    : total(0)
+    , sum(0)
+    , maxValue(0)
+    , lastValue(0)
+{
+    for (int i = 0; i < kBuckets; ++i)
+        buckets[i].store(0, std::memory_order_relaxed);
+}
+
+// 0~3us各占一个桶；之后每个[2^k, 2^(k+1))区间分kSubBuckets个桶
+int LatencyHistogram::bucketFor(int64_t us)
+{
+    if (us < kSubBuckets)
+        return us < 0 ? 0 : static_cast<int>(us);
+    int octave = 63 - __builtin_clzll(static_cast<unsigned long long>(us));
+    int sub = static_cast<int>((us >> (octave - 2)) & (kSubBuckets - 1));
+    int index = kSubBuckets + (octave - 2) * kSubBuckets + sub;
+    return index < kBuckets ? index : kBuckets - 1;
+}
+
+int64_t LatencyHistogram::bucketUpperUs(int index)
+{
+    if (index < kSubBuckets)
+        return index;
+    int octave = (index - kSubBuckets) / kSubBuckets + 2;
+    int sub = (index - kSubBuckets) % kSubBuckets;
+    return ((static_cast<int64_t>(kSubBuckets + sub + 1)) << (octave - 2)) - 1;
+}
+
+void LatencyHistogram::record(int64_t ns)
+{
+    int64_t us = ns / 1000;
+    buckets[bucketFor(us)].fetch_add(1, std::memory_order_relaxed);
+    total.fetch_add(1, std::memory_order_relaxed);
+    sum.fetch_add(ns > 0 ? static_cast<uint64_t>(ns) : 0, std::memory_order_relaxed);
+    lastValue.store(us, std::memory_order_relaxed);
+    if (us > maxValue.load(std::memory_order_relaxed))
+        maxValue.store(us, std::memory_order_relaxed);
+}
+
+void LatencyHistogram::reset()
+{
+    for (int i = 0; i < kBuckets; ++i)
+        buckets[i].store(0, std::memory_order_relaxed);
+    total.store(0, std::memory_order_relaxed);
+    sum.store(0, std::memory_order_relaxed);
+    maxValue.store(0, std::memory_order_relaxed);
+    lastValue.store(0, std::memory_order_relaxed);
+}
+
+int64_t LatencyHistogram::percentileUs(double p) const
+{
+    uint64_t n = count();
+    if (n == 0)
+        return 0;
+    uint64_t rank = static_cast<uint64_t>(n * p / 100.0 + 0.5);
+    if (rank < 1)
+        rank = 1;
+    uint64_t seen = 0;
+    for (int i = 0; i < kBuckets; ++i) {
+        seen += buckets[i].load(std::memory_order_relaxed);
+        if (seen >= rank) {
+            int64_t upper = bucketUpperUs(i);
+            int64_t maxUs = maxValue.load(std::memory_order_relaxed);
+            return upper < maxUs ? upper : maxUs;
+        }
+    }
+    return maxUs();
+}
+
+void PipelineLatency::record(const CommandTrace &trace)
+{
+    stages[StageQueue].record(trace.tInferStartNs - trace.tCaptureNs);
+    stages[StageInfer].record(trace.tInferEndNs - trace.tInferStartNs);
+    stages[StageDispatch].record(trace.tDispatchNs - trace.tInferEndNs);
+    stages[StageUart].record(trace.tSentNs - trace.tDispatchNs);
+    stages[StageTotal].record(trace.tSentNs - trace.tCaptureNs);
+}
+
+void PipelineLatency::reset()
+{
+    for (int i = 0; i < StageCount; ++i)
+        stages[i].reset();
+}
+
+const char *PipelineLatency::stageName(int stage)
+{
+    return (stage >= 0 && stage < StageCount) ? kStageNames[stage] : "unknown";
+}
+
+int PipelineLatency::format(char *buf, size_t size) const
+{
+    int used = snprintf(buf, size, "n=%llu", static_cast<unsigned long long>(stages[StageTotal].count()));
+    for (int i = 0; i < StageCount && used >= 0 && static_cast<size_t>(used) < size; ++i) {
+        const LatencyHistogram &h = stages[i];
+        used += snprintf(buf + used, size - used, " %s p50=%.1fms p99=%.1fms max=%.1fms", kStageNames[i],
+                         h.percentileUs(50) / 1000.0, h.percentileUs(99) / 1000.0, h.maxUs() / 1000.0);
+    }
+    return used;
+}
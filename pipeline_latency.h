@@ -0,0 +1,78 @@
+#ifndef PIPELINE_LATENCY_H
+#define PIPELINE_LATENCY_H
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+// 对数分桶的延迟直方图（微秒）：每个2的幂区间再等分4个子桶，相对误差≤25%。
+// 桶计数为原子变量，写端（控制分发线程）无锁，读端（界面/日志）任意线程随时读取。
+class LatencyHistogram
+{
+public:
+    static const int kSubBuckets = 4;
+    static const int kBuckets = 4 + 24 * kSubBuckets;   // 覆盖0us ~ 约67s
+
+    LatencyHistogram();
+
+    void record(int64_t ns);
+    void reset();
+
+    uint64_t count() const { return total.load(std::memory_order_relaxed); }
+    int64_t maxUs() const { return maxValue.load(std::memory_order_relaxed); }
+    int64_t lastUs() const { return lastValue.load(std::memory_order_relaxed); }
+    // 百分位（0~100），返回所在桶的上界（微秒）；没有样本时返回0
+    int64_t percentileUs(double p) const;
+
+    // 原始桶计数与样本总和（指标导出用）；index桶包含[bucketUpperUs(index-1)+1, bucketUpperUs(index)]微秒
+    uint64_t bucketCount(int index) const { return buckets[index].load(std::memory_order_relaxed); }
+    static int64_t bucketUpperUs(int index);
+    uint64_t sumNs() const { return sum.load(std::memory_order_relaxed); }
+
+private:
+    static int bucketFor(int64_t us);
+
+    std::atomic<uint64_t> buckets[kBuckets];
+    std::atomic<uint64_t> total;
+    std::atomic<uint64_t> sum;
+    std::atomic<int64_t> maxValue;
+    std::atomic<int64_t> lastValue;
+};
+
+// 端到端链路的各个环节（全部基于CLOCK_MONOTONIC）
+enum PipelineStage
+{
+    StageQueue = 0,      // 采集 → 推理开始（拷贝帧、等待推理线程）
+    StageInfer,          // 推理开始 → 推理结束
+    StageDispatch,       // 推理结束 → 控制分发线程取到结果
+    StageUart,           // 取到结果 → write+tcdrain返回（仲裁、滤波与写串口）
+    StageTotal,          // 采集 → 指令上线（glass-to-wire）
+    StageCount
+};
+
+// 一条自动指令的完整时间线：由哪一帧产生、各环节时刻、串口帧序号（帧协议）
+struct CommandTrace
+{
+    uint32_t frameId;
+    char cmd;
+    unsigned char uartSeq;
+    int64_t tCaptureNs;
+    int64_t tInferStartNs;
+    int64_t tInferEndNs;
+    int64_t tDispatchNs;
+    int64_t tSentNs;
+};
+
+struct PipelineLatency
+{
+    LatencyHistogram stages[StageCount];
+
+    void record(const CommandTrace &trace);
+    void reset();
+
+    static const char *stageName(int stage);
+    // 单行汇总：各环节 p50/p99/max，写入buf（用于日志与界面）
+    int format(char *buf, size_t size) const;
+};
+
+#endif // PIPELINE_LATENCY_H
@@ -0,0 +1,170 @@
+#include "replay_source.h"
+#include "inference.h"
+#include "command_arbiter.h"
+#include "pipeline_clock.h"
+#include <opencv2/imgcodecs.hpp>
+#include <fstream>
+#include <iterator>
+#include <stdio.h>
+#include <string.h>
+
+static const size_t kMaxMismatchLog = 20;
+
+ReplaySource::ReplaySource(const std::string &dumpPath, ReplayMode mode)
+    : path(dumpPath)
+    , replayMode(mode)
+    , opened(false)
+    , position(0)
+    , startNs(0)
+    , compared(0)
+    , classMismatch(0)
+    , commandMismatch(0)
+{
+    memset(&header, 0, sizeof(header));
+}
+
+bool ReplaySource::open()
+{
+    release();
+    std::ifstream in(path.c_str(), std::ios::binary);
+    if (!in) {
+        error = "无法打开 " + path;
+        return false;
+    }
+    content.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+
+    if (content.size() < sizeof(header)) {
+        error = "文件过短";
+        return false;
+    }
+    memcpy(&header, content.data(), sizeof(header));
+    if (memcmp(header.magic, "WCFLIGHT", 8) != 0 || header.version != 1 || header.eventSize != sizeof(FlightEvent)) {
+        error = "不是受支持的黑匣子转储（魔数/版本/事件大小不匹配）";
+        return false;
+    }
+
+    size_t offset = sizeof(header);
+    if (offset + static_cast<size_t>(header.eventCount) * sizeof(FlightEvent) > content.size()) {
+        error = "事件区被截断";
+        return false;
+    }
+    for (uint32_t i = 0; i < header.eventCount; ++i, offset += sizeof(FlightEvent)) {
+        FlightEvent ev;
+        memcpy(&ev, content.data() + offset, sizeof(ev));
+        if (ev.type == FlightDetection) {
+            RecordedDetection det;
+            det.classId = ev.classId;
+            det.confidence = ev.confidence;
+            detections[ev.frameId] = det;
+        } else if (ev.type == FlightCommand && ev.source == SourceAuto && ev.frameId != 0) {
+            commands[ev.frameId] = ev.cmd;
+        }
+    }
+
+    for (uint32_t i = 0; i < header.frameCount; ++i) {
+        FrameEntry entry;
+        if (offset + sizeof(FlightFrameHeader) > content.size())
+            break;
+        memcpy(&entry.header, content.data() + offset, sizeof(FlightFrameHeader));
+        entry.offset = offset + sizeof(FlightFrameHeader);
+        if (entry.offset + entry.header.length > content.size())
+            break;
+        frames.push_back(entry);
+        offset = entry.offset + entry.header.length;
+    }
+    if (frames.empty()) {
+        error = "转储中没有帧（录制时未开启原始MJPEG采集？）";
+        return false;
+    }
+    opened = true;
+    return true;
+}
+
+void ReplaySource::release()
+{
+    opened = false;
+    content.clear();
+    frames.clear();
+    detections.clear();
+    commands.clear();
+    position = 0;
+    startNs = 0;
+    compared = classMismatch = commandMismatch = 0;
+    mismatchLog.clear();
+}
+
+std::string ReplaySource::description() const
+{
+    static const char *kModeNames[] = {"lockstep", "realtime", "fast"};
+    return "replay " + path + " (" + kModeNames[replayMode] + ", " + std::to_string(frames.size()) + " frames)";
+}
+
+int ReplaySource::nextFrameDelayMs() const
+{
+    if (replayMode != ReplayRealtime || startNs == 0 || position >= frames.size())
+        return 0;
+    int64_t due = startNs + (frames[position].header.tCaptureNs - frames[0].header.tCaptureNs);
+    int64_t left = due - monotonicNowNs();
+    return left > 0 ? static_cast<int>(left / 1000000) : 0;
+}
+
+bool ReplaySource::read(CapturedFrame &frame)
+{
+    if (!opened || position >= frames.size())
+        return false;
+
+    const FrameEntry &entry = frames[position++];
+    int64_t now = monotonicNowNs();
+    if (startNs == 0)
+        startNs = now;
+
+    // 拷贝一份JPEG（约10KB）：截图/黑匣子可能在回放结束后仍持有该帧
+    frame.jpeg = cv::Mat(1, static_cast<int>(entry.header.length), CV_8UC1,
+                         const_cast<char *>(content.data() + entry.offset)).clone();
+    frame.bgr = cv::imdecode(frame.jpeg, cv::IMREAD_COLOR);
+    frame.frameId = entry.header.frameId;
+    frame.captureNs = replayMode == ReplayRealtime
+                          ? startNs + (entry.header.tCaptureNs - frames[0].header.tCaptureNs)
+                          : now;
+    return !frame.bgr.empty();
+}
+
+void ReplaySource::compare(const DetectionResult &result, char command)
+{
+    std::map<uint32_t, RecordedDetection>::const_iterator det = detections.find(result.frame_id);
+    if (det == detections.end())
+        return;   // 录制时没有推理这一帧（非确定性模式下常见），无可比对象
+    compared++;
+
+    const Detection *best = result.best();
+    int classId = best ? best->class_id : -1;
+    std::map<uint32_t, char>::const_iterator cmd = commands.find(result.frame_id);
+    char recordedCmd = cmd != commands.end() ? cmd->second : 0;
+
+    bool classDiffers = classId != det->second.classId;
+    // 录制时该帧的指令可能被手动控制仲裁掉，录制里没有指令时不判定为不一致
+    bool commandDiffers = recordedCmd != 0 && command != recordedCmd;
+    if (classDiffers)
+        classMismatch++;
+    if (commandDiffers)
+        commandMismatch++;
+
+    if ((classDiffers || commandDiffers) && mismatchLog.size() < kMaxMismatchLog) {
+        char line[160];
+        snprintf(line, sizeof(line), "frame %u: class %d (recorded %d, %.2f) command %c (recorded %c)",
+                 result.frame_id, classId, det->second.classId, det->second.confidence,
+                 command ? command : '-', recordedCmd ? recordedCmd : '-');
+        mismatchLog.push_back(line);
+    }
+}
+
+std::string ReplaySource::summary() const
+{
+    char line[200];
+    snprintf(line, sizeof(line), "replayed %zu/%zu frames, compared %d inferences: %d class mismatches, %d command mismatches",
+             position, frames.size(), compared, classMismatch, commandMismatch);
+    std::string text = line;
+    for (size_t i = 0; i < mismatchLog.size(); ++i)
+        text += "\n  " + mismatchLog[i];
+    return text;
+}
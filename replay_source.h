@@ -0,0 +1,82 @@
+#ifndef REPLAY_SOURCE_H
+#define REPLAY_SOURCE_H
+
+#include <map>
+#include <string>
+#include <vector>
+#include "frame_source.h"
+#include "flight_recorder.h"
+
+struct DetectionResult;
+
+enum ReplayMode
+{
+    ReplayLockstep = 0,   // 确定性：只推理录制时推理过的帧，每帧等结果返回后才送下一帧
+    ReplayRealtime,       // 按录制时的帧间隔送帧，流水线照常异步运行
+    ReplayFast            // 不等待，尽快送帧（整条流水线的吞吐基准）
+};
+
+// 黑匣子转储回放：把录制的MJPEG帧按原始帧号与时间间隔送入采集接口，
+// 并用录制的检测结果/指令与本次运行的结果逐帧比对
+class ReplaySource : public FrameSource
+{
+public:
+    ReplaySource(const std::string &dumpPath, ReplayMode mode);
+
+    bool open() override;   // 解析整份转储（文件头校验失败返回false，见errorString()）
+    void release() override;
+    bool isOpened() const override { return opened; }
+    // 实时模式下采集时刻按录制间隔重新定基准到回放开始时刻；其他模式取送帧时刻
+    bool read(CapturedFrame &frame) override;
+    bool atEnd() const override { return opened && position >= frames.size(); }
+    std::string description() const override;
+
+    ReplayMode mode() const { return replayMode; }
+    const std::string &errorString() const { return error; }
+    size_t frameCount() const { return frames.size(); }
+    size_t framePosition() const { return position; }
+    // 实时模式：距下一帧应送出的时刻还有多久（毫秒）；其他模式为0
+    int nextFrameDelayMs() const;
+
+    // 录制中是否有该帧的推理结果（转储里没有任何推理记录时hasRecordedInference()为false）
+    bool hasRecordedInference() const { return !detections.empty(); }
+    bool wasInferred(uint32_t frameId) const { return detections.count(frameId) > 0; }
+
+    // 比对本次运行对某帧的推理结果与由此产生的自动指令（0表示不下发）
+    void compare(const DetectionResult &result, char command);
+    int comparedFrames() const { return compared; }
+    int classMismatches() const { return classMismatch; }
+    int commandMismatches() const { return commandMismatch; }
+    std::string summary() const;
+
+private:
+    struct FrameEntry
+    {
+        FlightFrameHeader header;
+        size_t offset;        // JPEG数据在文件内容中的偏移
+    };
+    struct RecordedDetection
+    {
+        int classId;
+        float confidence;
+    };
+
+    std::string path;
+    ReplayMode replayMode;
+    bool opened;
+    std::string error;
+    std::vector<char> content;
+    FlightDumpHeader header;
+    std::vector<FrameEntry> frames;
+    std::map<uint32_t, RecordedDetection> detections;
+    std::map<uint32_t, char> commands;    // 自动指令（按产生它的帧号）
+    size_t position;
+    int64_t startNs;
+
+    int compared;
+    int classMismatch;
+    int commandMismatch;
+    std::vector<std::string> mismatchLog;   // 前若干条不一致记录
+};
+
+#endif // REPLAY_SOURCE_H
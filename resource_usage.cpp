@@ -0,0 +1,63 @@
+#include "resource_usage.h"
+#include "pipeline_clock.h"
+#include <stdio.h>
+#include <time.h>
+
+int64_t ResourceUsage::processCpuNs()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+}
+
+ResourceUsage::ResourceUsage()
+    : startNs(monotonicNowNs())
+    , startCpuNs(processCpuNs())
+{
+    lastNs = startNs;
+    lastCpuNs = startCpuNs;
+}
+
+void ResourceUsage::readMemoryKb(long &rssKb, long &peakRssKb)
+{
+    rssKb = peakRssKb = 0;
+    FILE *f = fopen("/proc/self/status", "re");
+    if (!f)
+        return;
+    char line[128];
+    long kb;
+    while (fgets(line, sizeof(line), f)) {
+        if (sscanf(line, "VmRSS: %ld kB", &kb) == 1)
+            rssKb = kb;
+        else if (sscanf(line, "VmHWM: %ld kB", &kb) == 1)
+            peakRssKb = kb;
+    }
+    fclose(f);
+}
+
+ResourceSample ResourceUsage::sample()
+{
+    ResourceSample s;
+    long rssKb, peakRssKb;
+    readMemoryKb(rssKb, peakRssKb);
+    s.rssMb = rssKb / 1024.0;
+    s.peakRssMb = peakRssKb / 1024.0;
+
+    int64_t now = monotonicNowNs();
+    int64_t cpu = processCpuNs();
+    s.cpuPercent = now > lastNs ? 100.0 * (cpu - lastCpuNs) / (now - lastNs) : 0.0;
+    lastNs = now;
+    lastCpuNs = cpu;
+    return s;
+}
+
+double ResourceUsage::averageCpuPercent() const
+{
+    int64_t now = monotonicNowNs();
+    return now > startNs ? 100.0 * (processCpuNs() - startCpuNs) / (now - startNs) : 0.0;
+}
+
+double ResourceUsage::elapsedSec() const
+{
+    return (monotonicNowNs() - startNs) / 1e9;
+}
@@ -0,0 +1,35 @@
+#ifndef RESOURCE_USAGE_H
+#define RESOURCE_USAGE_H
+
+#include <stdint.h>
+
+// 进程资源占用采样：RSS取自/proc/self/status（VmRSS/VmHWM），CPU取进程CPU时钟。
+// 图形界面与无界面模式用同一套采样与日志格式，便于直接对比两种部署的开销。
+struct ResourceSample
+{
+    double rssMb;
+    double peakRssMb;
+    double cpuPercent;   // 距上次采样的CPU占用（单核百分比）
+};
+
+class ResourceUsage
+{
+public:
+    ResourceUsage();
+
+    ResourceSample sample();
+    double averageCpuPercent() const;   // 自构造以来的平均CPU占用
+    double elapsedSec() const;
+
+    // 无状态读取，任意线程可调用（指标导出线程用）
+    static void readMemoryKb(long &rssKb, long &peakRssKb);
+    static int64_t processCpuNs();
+
+private:
+    int64_t startNs;
+    int64_t startCpuNs;
+    int64_t lastNs;
+    int64_t lastCpuNs;
+};
+
+#endif // RESOURCE_USAGE_H
@@ -0,0 +1,54 @@
+#ifndef SEQLOCK_H
+#define SEQLOCK_H
+
+#include <atomic>
+#include <cstring>
+#include <type_traits>
+
+// 单写者/多读者的顺序锁：写端从不阻塞，读端遇到并发写入时重试。
+// 用于在线程间传递"最新值"（检测结果、叠加层状态等），T必须是可平凡拷贝的POD。
+template <typename T>
+class SeqLock
+{
+#if !defined(__GNUC__) || defined(__clang__) || __GNUC__ >= 5
+    static_assert(std::is_trivially_copyable<T>::value, "SeqLock<T> requires a trivially copyable T");
+#endif
+
+public:
+    SeqLock() : seq(0), data() {}
+
+    // 仅允许一个线程调用
+    void store(const T &value)
+    {
+        unsigned s = seq.load(std::memory_order_relaxed);
+        seq.store(s + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        std::memcpy(&data, &value, sizeof(T));
+        seq.store(s + 2, std::memory_order_release);
+    }
+
+    // 读取最新值；从未写入过时返回false
+    bool load(T &out) const
+    {
+        for (;;) {
+            unsigned s1 = seq.load(std::memory_order_acquire);
+            if (s1 == 0)
+                return false;
+            if (s1 & 1u)
+                continue;
+            std::memcpy(&out, &data, sizeof(T));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (seq.load(std::memory_order_relaxed) == s1)
+                return true;
+        }
+    }
+
+    // 每次store()递增2，可用来判断是否有新值
+    unsigned sequence() const { return seq.load(std::memory_order_acquire); }
+
+private:
+    std::atomic<unsigned> seq;
+    T data;
+};
+
+#endif // SEQLOCK_H
@@ -0,0 +1,581 @@
+#include "session_recorder.h"
+#include "pipeline_clock.h"
+#include "async_logger.h"
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <sys/eventfd.h>
+#include <sys/stat.h>
+#include <sys/statvfs.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+
+// 与截图写盘线程相同，使用最低的尽力而为I/O优先级
+#define IOPRIO_CLASS_SHIFT 13
+#define IOPRIO_CLASS_BE 2
+#define IOPRIO_WHO_PROCESS 1
+
+static const uint64_t kWritebackChunk = 1 << 20;   // 每写出1MB提交一次回写
+static const uint32_t kAviHeaderSize = 224;        // RIFF/hdrl/movi头，第一个数据块从这里开始
+static const uint32_t kAviMoviOffset = 220;        // 'movi'类型字段的位置
+static const int kDiskCheckFrames = 100;
+
+static void put32(uint8_t *p, uint32_t v)
+{
+    p[0] = v & 0xff;
+    p[1] = (v >> 8) & 0xff;
+    p[2] = (v >> 16) & 0xff;
+    p[3] = (v >> 24) & 0xff;
+}
+
+static void put16(uint8_t *p, uint16_t v)
+{
+    p[0] = v & 0xff;
+    p[1] = (v >> 8) & 0xff;
+}
+
+static void putFourcc(uint8_t *p, const char *cc)
+{
+    memcpy(p, cc, 4);
+}
+
+static bool writevAll(int fd, struct iovec *iov, int count)
+{
+    while (count > 0) {
+        ssize_t n = writev(fd, iov, count);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            return false;
+        }
+        while (count > 0 && static_cast<size_t>(n) >= iov->iov_len) {
+            n -= iov->iov_len;
+            iov++;
+            count--;
+        }
+        if (count > 0) {
+            iov->iov_base = static_cast<char *>(iov->iov_base) + n;
+            iov->iov_len -= n;
+        }
+    }
+    return true;
+}
+
+static bool pwriteAll(int fd, const uint8_t *data, size_t len, off_t offset)
+{
+    while (len > 0) {
+        ssize_t n = pwrite(fd, data, len, offset);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            return false;
+        }
+        data += n;
+        len -= static_cast<size_t>(n);
+        offset += n;
+    }
+    return true;
+}
+
+SessionRecorder::SessionRecorder(const Options &options, QObject *parent)
+    : QThread(parent)
+    , opts(options)
+    , head(0)
+    , count(0)
+    , running(true)   // 在构造时置位：start()后立即stop()时run()还没开始，不能让run()把停止标志覆盖掉
+    , recording(false)
+    , generation(0)
+    , requestedFps(10.0)
+    , openedGeneration(0)
+    , finishedGeneration(0)
+    , fps(10.0)
+    , fd(-1)
+    , index(nullptr)
+    , segmentBytes(0)
+    , segmentFrames(0)
+    , segmentStartNs(0)
+    , segmentSeq(0)
+    , moviOffset(kAviMoviOffset)
+    , submittedBytes(0)
+    , evictedBytes(0)
+    , reportedDrops(0)
+    , frames(0)
+    , bytes(0)
+    , dropped(0)
+    , segments(0)
+    , enqueueNs(0)
+    , writerCpuNs(0)
+{
+    // AVI 1.0的偏移与长度都是32位，段文件限制在1GB以内
+    if (opts.segmentMb < 1)
+        opts.segmentMb = 1;
+    if (opts.segmentMb > 1024)
+        opts.segmentMb = 1024;
+    wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+}
+
+SessionRecorder::~SessionRecorder()
+{
+    stop();
+    if (wakeFd >= 0) {
+        close(wakeFd);
+    }
+}
+
+void SessionRecorder::beginRecording(const cv::Size &frameSize, double frameRate)
+{
+    {
+        QMutexLocker locker(&mutex);
+        requestedSize = frameSize;
+        requestedFps = frameRate > 0 ? frameRate : 10.0;
+    }
+    generation.fetch_add(1, std::memory_order_release);
+    recording.store(true, std::memory_order_release);
+}
+
+void SessionRecorder::endRecording()
+{
+    recording.store(false, std::memory_order_release);
+    wake();   // 写盘线程写完队列中剩余的帧后关闭当前段
+}
+
+void SessionRecorder::wake()
+{
+    uint64_t one = 1;
+    if (write(wakeFd, &one, sizeof(one)) != sizeof(one)) {
+        // 计数溢出才会失败，此时线程必然已被唤醒
+    }
+}
+
+bool SessionRecorder::push(Job &job)
+{
+    {
+        QMutexLocker locker(&mutex);
+        if (count == kQueueSize) {
+            return false;
+        }
+        Job &slot = queue[(head + count) % kQueueSize];
+        slot.isFrame = job.isFrame;
+        slot.jpeg = job.jpeg;
+        slot.frameId = job.frameId;
+        slot.captureNs = job.captureNs;
+        slot.generation = job.generation;
+        if (!job.isFrame)
+            slot.result = job.result;
+        count++;
+    }
+    wake();
+    return true;
+}
+
+void SessionRecorder::recordFrame(const cv::Mat &jpeg, uint32_t frameId, int64_t captureNs)
+{
+    if (!recording.load(std::memory_order_relaxed) || jpeg.empty() || !jpeg.isContinuous())
+        return;
+    int64_t start = monotonicNowNs();
+    Job job;
+    job.isFrame = true;
+    job.jpeg = jpeg;
+    job.frameId = frameId;
+    job.captureNs = captureNs;
+    job.generation = generation.load(std::memory_order_acquire);
+    if (!push(job))
+        dropped.fetch_add(1, std::memory_order_relaxed);
+    enqueueNs.fetch_add(monotonicNowNs() - start, std::memory_order_relaxed);
+}
+
+void SessionRecorder::recordDetection(const DetectionResult &result)
+{
+    if (!recording.load(std::memory_order_relaxed))
+        return;
+    Job job;
+    job.isFrame = false;
+    job.frameId = result.frame_id;
+    job.captureNs = result.t_capture_ns;
+    job.generation = generation.load(std::memory_order_acquire);
+    job.result = result;
+    push(job);   // 队列满时帧已在丢弃，检测结果随之丢弃即可
+}
+
+void SessionRecorder::stop()
+{
+    if (!isRunning()) {
+        return;
+    }
+    recording = false;
+    running = false;
+    wake();
+    wait();
+}
+
+SessionRecorder::Stats SessionRecorder::stats() const
+{
+    Stats s;
+    s.frames = frames.load(std::memory_order_relaxed);
+    s.bytes = bytes.load(std::memory_order_relaxed);
+    s.dropped = dropped.load(std::memory_order_relaxed);
+    s.segments = segments.load(std::memory_order_relaxed);
+    s.enqueueNs = enqueueNs.load(std::memory_order_relaxed);
+    s.writerCpuNs = writerCpuNs.load(std::memory_order_relaxed);
+    return s;
+}
+
+void SessionRecorder::run()
+{
+    syscall(SYS_ioprio_set, IOPRIO_WHO_PROCESS, 0, (IOPRIO_CLASS_BE << IOPRIO_CLASS_SHIFT) | 7);
+
+    struct pollfd pfd;
+    pfd.fd = wakeFd;
+    pfd.events = POLLIN;
+    Job job;
+    for (;;) {
+        // 先写完已入队的数据（含退出前），再处理停止录制
+        for (;;) {
+            {
+                QMutexLocker locker(&mutex);
+                if (count == 0)
+                    break;
+                Job &slot = queue[head];
+                job.isFrame = slot.isFrame;
+                job.jpeg = slot.jpeg;
+                job.frameId = slot.frameId;
+                job.captureNs = slot.captureNs;
+                job.generation = slot.generation;
+                if (!slot.isFrame)
+                    job.result = slot.result;
+                slot.jpeg.release();   // 尽早释放对采集帧的引用
+                head = (head + 1) % kQueueSize;
+                count--;
+            }
+            handleJob(job);
+            job.jpeg.release();
+        }
+        if (fd >= 0 && (!recording.load(std::memory_order_acquire) ||
+                        generation.load(std::memory_order_acquire) != openedGeneration)) {
+            if (!recording.load(std::memory_order_acquire))
+                finishedGeneration = openedGeneration;
+            closeSegment();
+        }
+
+        struct timespec cpu;
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpu);
+        writerCpuNs.store(static_cast<uint64_t>(cpu.tv_sec) * 1000000000ULL + cpu.tv_nsec, std::memory_order_relaxed);
+
+        if (!running)
+            break;
+        if (poll(&pfd, 1, -1) <= 0) {
+            continue;
+        }
+        uint64_t n;
+        while (read(wakeFd, &n, sizeof(n)) == sizeof(n)) {
+        }
+    }
+}
+
+void SessionRecorder::handleJob(const Job &job)
+{
+    if (!job.isFrame) {
+        if (index)
+            writeDetection(job.result);
+        return;
+    }
+    // 结束录制前入队的帧照常写完；该次录制已收尾（或因空间不足/写入失败停止）后才轮到的帧丢弃
+    unsigned gen = job.generation;
+    if (gen == finishedGeneration)
+        return;
+    if (fd >= 0 && gen != openedGeneration)
+        closeSegment();
+    if (fd >= 0) {
+        size_t len = job.jpeg.total() * job.jpeg.elemSize();
+        bool full = segmentBytes + len + 8 > static_cast<uint64_t>(opts.segmentMb) << 20;
+        bool old = monotonicNowNs() - segmentStartNs > static_cast<int64_t>(opts.segmentSec) * 1000000000LL;
+        if (full || old)
+            closeSegment();
+    }
+    if (fd < 0) {
+        if (gen != generation.load(std::memory_order_acquire))
+            return;   // 已开始新的录制，旧录制的残余帧不再单独成段
+        if (gen != openedGeneration) {
+            openedGeneration = gen;
+            segmentSeq = 0;
+        }
+        if (!openSegment())
+            return;
+    }
+    if (!writeFrame(job)) {
+        stopWith(QString("写入失败：%1").arg(strerror(errno)));
+        return;
+    }
+    if (segmentFrames % kDiskCheckFrames == 0 && !diskHasRoom())
+        stopWith(QString("剩余空间不足%1MB").arg(opts.minFreeMb));
+}
+
+bool SessionRecorder::diskHasRoom() const
+{
+    struct statvfs vfs;
+    if (statvfs(opts.dir.c_str(), &vfs) != 0)
+        return true;   // 查询失败不阻止录制，写入失败时再停止
+    uint64_t freeBytes = static_cast<uint64_t>(vfs.f_bavail) * vfs.f_frsize;
+    return freeBytes >= static_cast<uint64_t>(opts.minFreeMb) << 20;
+}
+
+bool SessionRecorder::openSegment()
+{
+    mkdir(opts.dir.c_str(), 0755);
+    if (!diskHasRoom()) {
+        stopWith(QString("剩余空间不足%1MB").arg(opts.minFreeMb));
+        return false;
+    }
+    {
+        QMutexLocker locker(&mutex);
+        size = requestedSize;
+        fps = requestedFps;
+    }
+    if (segmentSeq == 0) {
+        char stamp[32];
+        time_t now = time(nullptr);
+        struct tm local;
+        localtime_r(&now, &local);
+        strftime(stamp, sizeof(stamp), "%Y%m%d_%H%M%S", &local);
+        sessionStamp = stamp;
+    }
+    char name[64];
+    snprintf(name, sizeof(name), "/session_%s_%03d", sessionStamp.c_str(), segmentSeq);
+    segmentPath = opts.dir + name;
+    std::string mediaPart = segmentPath + (opts.avi ? ".avi.part" : ".mjpeg.part");
+    std::string indexPart = segmentPath + ".idx.part";
+
+    fd = open(mediaPart.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        stopWith(QString("无法创建%1：%2").arg(mediaPart.c_str()).arg(strerror(errno)));
+        return false;
+    }
+    index = fopen(indexPart.c_str(), "we");
+    if (!index) {
+        close(fd);
+        fd = -1;
+        unlink(mediaPart.c_str());
+        stopWith(QString("无法创建%1：%2").arg(indexPart.c_str()).arg(strerror(errno)));
+        return false;
+    }
+    setvbuf(index, nullptr, _IOFBF, 64 * 1024);
+
+    segmentBytes = 0;
+    segmentFrames = 0;
+    segmentStartNs = monotonicNowNs();
+    submittedBytes = evictedBytes = 0;
+    reportedDrops = dropped.load(std::memory_order_relaxed);
+    aviIndex.clear();
+
+    if (opts.avi) {
+        // 帧数与各长度字段在段关闭时回填
+        uint8_t h[kAviHeaderSize];
+        memset(h, 0, sizeof(h));
+        uint32_t usPerFrame = static_cast<uint32_t>(1000000.0 / fps + 0.5);
+        putFourcc(h + 0, "RIFF");
+        putFourcc(h + 8, "AVI ");
+        putFourcc(h + 12, "LIST");
+        put32(h + 16, 212 - 20);
+        putFourcc(h + 20, "hdrl");
+        putFourcc(h + 24, "avih");
+        put32(h + 28, 56);
+        put32(h + 32, usPerFrame);          // dwMicroSecPerFrame
+        put32(h + 44, 0x10);                // dwFlags = AVIF_HASINDEX
+        put32(h + 56, 1);                   // dwStreams
+        put32(h + 64, size.width);
+        put32(h + 68, size.height);
+        putFourcc(h + 88, "LIST");
+        put32(h + 92, 212 - 96);
+        putFourcc(h + 96, "strl");
+        putFourcc(h + 100, "strh");
+        put32(h + 104, 56);
+        putFourcc(h + 108, "vids");
+        putFourcc(h + 112, "MJPG");
+        put32(h + 128, 1000);               // dwScale
+        put32(h + 132, static_cast<uint32_t>(fps * 1000.0 + 0.5));   // dwRate
+        put32(h + 148, 0xffffffff);         // dwQuality
+        put16(h + 160, static_cast<uint16_t>(size.width));
+        put16(h + 162, static_cast<uint16_t>(size.height));
+        putFourcc(h + 164, "strf");
+        put32(h + 168, 40);
+        put32(h + 172, 40);                 // BITMAPINFOHEADER.biSize
+        put32(h + 176, size.width);
+        put32(h + 180, size.height);
+        put16(h + 184, 1);                  // biPlanes
+        put16(h + 186, 24);                 // biBitCount
+        putFourcc(h + 188, "MJPG");
+        put32(h + 192, size.width * size.height * 3);
+        putFourcc(h + 212, "LIST");
+        putFourcc(h + 220, "movi");
+        struct iovec iov;
+        iov.iov_base = h;
+        iov.iov_len = sizeof(h);
+        if (!writevAll(fd, &iov, 1)) {
+            closeSegment();
+            return false;
+        }
+        segmentBytes = sizeof(h);
+        moviOffset = kAviMoviOffset;
+    }
+
+    fprintf(index, "# session %s segment %d format %s size %dx%d fps %.2f\n",
+            sessionStamp.c_str(), segmentSeq, opts.avi ? "avi" : "mjpeg", size.width, size.height, fps);
+    fprintf(index, "# F frame_id capture_ns offset length | D frame_id class_id confidence x y w h | X dropped_frames\n");
+    segmentSeq++;
+    return true;
+}
+
+bool SessionRecorder::writeFrame(const Job &job)
+{
+    size_t len = job.jpeg.total() * job.jpeg.elemSize();
+    uint64_t chunkOffset = segmentBytes;
+    uint64_t dataOffset = segmentBytes;
+    bool ok;
+    if (opts.avi) {
+        // '00dc'数据块：8字节块头 + JPEG + 奇数长度时补一个字节
+        uint8_t hdr[8];
+        uint8_t pad = 0;
+        putFourcc(hdr, "00dc");
+        put32(hdr + 4, static_cast<uint32_t>(len));
+        struct iovec iov[3];
+        iov[0].iov_base = hdr;
+        iov[0].iov_len = sizeof(hdr);
+        iov[1].iov_base = const_cast<uchar *>(job.jpeg.ptr());
+        iov[1].iov_len = len;
+        iov[2].iov_base = &pad;
+        iov[2].iov_len = len & 1;
+        ok = writevAll(fd, iov, (len & 1) ? 3 : 2);
+        dataOffset = chunkOffset + 8;
+        segmentBytes += 8 + len + (len & 1);
+        IndexEntry entry;
+        entry.offset = static_cast<uint32_t>(chunkOffset - moviOffset);
+        entry.size = static_cast<uint32_t>(len);
+        aviIndex.push_back(entry);
+    } else {
+        struct iovec iov;
+        iov.iov_base = const_cast<uchar *>(job.jpeg.ptr());
+        iov.iov_len = len;
+        ok = writevAll(fd, &iov, 1);
+        segmentBytes += len;
+    }
+    if (!ok)
+        return false;
+
+    uint64_t drops = dropped.load(std::memory_order_relaxed);
+    if (drops != reportedDrops) {
+        fprintf(index, "X %llu\n", static_cast<unsigned long long>(drops - reportedDrops));
+        reportedDrops = drops;
+    }
+    fprintf(index, "F %u %lld %llu %zu\n", job.frameId, static_cast<long long>(job.captureNs),
+            static_cast<unsigned long long>(dataOffset), len);
+    segmentFrames++;
+    frames.fetch_add(1, std::memory_order_relaxed);
+    bytes.fetch_add(len, std::memory_order_relaxed);
+    writeback(false);
+    return true;
+}
+
+void SessionRecorder::writeDetection(const DetectionResult &result)
+{
+    for (int i = 0; i < result.count; ++i) {
+        const Detection &det = result.detections[i];
+        fprintf(index, "D %u %d %.4f %d %d %d %d\n", result.frame_id, det.class_id, det.confidence,
+                det.box.x, det.box.y, det.box.width, det.box.height);
+    }
+    if (result.count == 0)
+        fprintf(index, "D %u -1 0 0 0 0 0\n", result.frame_id);
+}
+
+// 持续顺序写时，每攒够1MB就异步提交回写，并等上一批落盘后把它移出页缓存：
+// 脏页不会堆积到内核集中回写的阈值，也不会挤占推理需要的内存
+void SessionRecorder::writeback(bool final)
+{
+    if (final) {
+        fdatasync(fd);
+        posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+        return;
+    }
+    if (segmentBytes - submittedBytes < kWritebackChunk)
+        return;
+    if (evictedBytes < submittedBytes) {
+        sync_file_range(fd, evictedBytes, submittedBytes - evictedBytes,
+                        SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WRITE | SYNC_FILE_RANGE_WAIT_AFTER);
+        posix_fadvise(fd, evictedBytes, submittedBytes - evictedBytes, POSIX_FADV_DONTNEED);
+        evictedBytes = submittedBytes;
+    }
+    sync_file_range(fd, submittedBytes, segmentBytes - submittedBytes, SYNC_FILE_RANGE_WRITE);
+    submittedBytes = segmentBytes;
+}
+
+void SessionRecorder::closeSegment()
+{
+    if (fd < 0)
+        return;
+
+    std::string media = segmentPath + (opts.avi ? ".avi" : ".mjpeg");
+    std::string mediaPart = media + ".part";
+    std::string indexPath = segmentPath + ".idx";
+    std::string indexPart = indexPath + ".part";
+
+    bool ok = true;
+    if (opts.avi && segmentFrames > 0) {
+        // 追加idx1索引，回填RIFF/movi长度与帧数
+        uint32_t moviEnd = static_cast<uint32_t>(segmentBytes);
+        std::vector<uint8_t> idx(8 + aviIndex.size() * 16);
+        putFourcc(&idx[0], "idx1");
+        put32(&idx[4], static_cast<uint32_t>(aviIndex.size() * 16));
+        for (size_t i = 0; i < aviIndex.size(); ++i) {
+            uint8_t *e = &idx[8 + i * 16];
+            putFourcc(e, "00dc");
+            put32(e + 4, 0x10);   // AVIIF_KEYFRAME（MJPEG每帧都是关键帧）
+            put32(e + 8, aviIndex[i].offset);
+            put32(e + 12, aviIndex[i].size);
+        }
+        ok = pwriteAll(fd, idx.data(), idx.size(), moviEnd);
+        uint32_t fileSize = moviEnd + static_cast<uint32_t>(idx.size());
+        uint8_t v[4];
+        put32(v, fileSize - 8);
+        ok = ok && pwriteAll(fd, v, 4, 4);
+        put32(v, static_cast<uint32_t>(segmentFrames));
+        ok = ok && pwriteAll(fd, v, 4, 48);    // avih.dwTotalFrames
+        ok = ok && pwriteAll(fd, v, 4, 140);   // strh.dwLength
+        put32(v, moviEnd - kAviMoviOffset);
+        ok = ok && pwriteAll(fd, v, 4, 216);   // movi列表长度
+        segmentBytes = fileSize;
+    }
+    writeback(true);
+    close(fd);
+    fd = -1;
+    fflush(index);
+    fsync(fileno(index));
+    fclose(index);
+    index = nullptr;
+
+    if (segmentFrames == 0) {
+        unlink(mediaPart.c_str());
+        unlink(indexPart.c_str());
+        return;
+    }
+    if (!ok || rename(mediaPart.c_str(), media.c_str()) != 0 || rename(indexPart.c_str(), indexPath.c_str()) != 0) {
+        LOG_WARN(LogRecord, "录制段收尾失败 %s: %s", media, strerror(errno));
+    }
+    // rename本身也要落盘
+    int dirFd = open(opts.dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dirFd >= 0) {
+        fsync(dirFd);
+        close(dirFd);
+    }
+    segments.fetch_add(1, std::memory_order_relaxed);
+    emit segmentFinished(QString::fromStdString(media), segmentFrames, segmentBytes);
+}
+
+void SessionRecorder::stopWith(const QString &reason)
+{
+    recording.store(false, std::memory_order_release);
+    finishedGeneration = generation.load(std::memory_order_acquire);
+    closeSegment();
+    emit recordingStopped(reason);
+}
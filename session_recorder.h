@@ -0,0 +1,137 @@
+#ifndef SESSION_RECORDER_H
+#define SESSION_RECORDER_H
+
+#include <QThread>
+#include <QMutex>
+#include <QString>
+#include <atomic>
+#include <string>
+#include <vector>
+#include <stdio.h>
+#include <stdint.h>
+#include <opencv2/core.hpp>
+#include "inference.h"
+
+// 连续录制（用于收集再训练数据）：摄像头原始MJPEG直接封装进AVI（或裸MJPEG流），不重新编码。
+// - 采集线程只把cv::Mat引用放进定长队列（不拷贝、不编码），写盘全部在后台线程完成
+// - 写盘跟不上时丢弃新帧并在索引里记下丢帧数，不阻塞采集
+// - 按大小/时长切分段文件，段文件写完才从.part改为正式文件名
+// - 每段一个文本索引（.idx）：帧号、采集时刻、在段文件中的偏移，以及推理线程给出的检测结果
+// - 已写出的数据分批提交回写并从页缓存中丢弃，避免SD卡集中回写拖慢其他线程
+// - 剩余空间低于下限时自动停止录制
+// 开销统计（入队耗时、写盘线程CPU时间）见stats()，由界面定期写入日志。
+class SessionRecorder : public QThread
+{
+    Q_OBJECT
+public:
+    struct Options
+    {
+        std::string dir;
+        bool avi {true};             // false：裸MJPEG流（JPEG首尾相接，ffmpeg -f mjpeg可直接读取）
+        int segmentMb {256};
+        int segmentSec {600};
+        int minFreeMb {200};
+    };
+
+    struct Stats
+    {
+        uint64_t frames;
+        uint64_t bytes;
+        uint64_t dropped;             // 队列满丢弃的帧
+        uint64_t segments;
+        uint64_t enqueueNs;           // 采集线程累计入队耗时
+        uint64_t writerCpuNs;         // 写盘线程累计CPU时间
+    };
+
+    explicit SessionRecorder(const Options &options, QObject *parent = nullptr);
+    ~SessionRecorder();
+
+    // GUI线程调用：frameSize/fps写入AVI文件头（AVI为定帧率容器，真实采集时刻以索引为准）
+    void beginRecording(const cv::Size &frameSize, double fps);
+    void endRecording();
+    bool isRecording() const { return recording.load(std::memory_order_relaxed); }
+
+    // 采集线程调用：jpeg与采集端共享数据（引用计数），不拷贝；jpeg为空（非原始采集）时忽略
+    void recordFrame(const cv::Mat &jpeg, uint32_t frameId, int64_t captureNs);
+    // 推理线程调用：检测结果写入索引（可能落在帧所在段的下一段，按帧号关联）
+    void recordDetection(const DetectionResult &result);
+
+    void stop();
+    Stats stats() const;
+    int queueDepth() const { return count.load(std::memory_order_relaxed); }
+
+signals:
+    void segmentFinished(const QString &path, quint64 frames, quint64 bytes);
+    void recordingStopped(const QString &reason);
+
+protected:
+    void run() override;
+
+private:
+    struct Job
+    {
+        bool isFrame;       // false：检测结果
+        cv::Mat jpeg;
+        uint32_t frameId;
+        int64_t captureNs;
+        unsigned generation;   // 入队时的录制序号
+        DetectionResult result;
+    };
+    struct IndexEntry
+    {
+        uint32_t offset;   // 相对movi列表类型字段的偏移（AVI idx1约定）
+        uint32_t size;
+    };
+
+    bool push(Job &job);
+    void wake();
+    void handleJob(const Job &job);
+    bool openSegment();
+    void closeSegment();
+    bool writeFrame(const Job &job);
+    void writeDetection(const DetectionResult &result);
+    void writeback(bool final);
+    bool diskHasRoom() const;
+    void stopWith(const QString &reason);
+
+    Options opts;
+    static const int kQueueSize = 64;   // 约6秒（10fps）的缓冲
+    QMutex mutex;
+    Job queue[kQueueSize];
+    int head;
+    std::atomic<int> count;   // 受mutex保护；原子变量只为指标导出线程无锁读取队列深度
+    int wakeFd;
+    std::atomic<bool> running;
+    std::atomic<bool> recording;
+    std::atomic<unsigned> generation;    // 每次beginRecording加一，写盘线程据此切换到新的录制
+    cv::Size requestedSize;              // 受mutex保护
+    double requestedFps;
+
+    // 以下仅写盘线程访问
+    unsigned openedGeneration;
+    unsigned finishedGeneration;         // 已收尾的录制：其后出队的帧丢弃
+    cv::Size size;
+    double fps;
+    int fd;
+    FILE *index;
+    std::string segmentPath;
+    uint64_t segmentBytes;
+    uint64_t segmentFrames;
+    int64_t segmentStartNs;
+    int segmentSeq;
+    std::string sessionStamp;
+    uint32_t moviOffset;                 // movi列表类型字段在文件中的偏移
+    std::vector<IndexEntry> aviIndex;
+    uint64_t submittedBytes;             // 已提交异步回写的文件前缀
+    uint64_t evictedBytes;               // 已落盘并移出页缓存的文件前缀
+    uint64_t reportedDrops;              // 已写入索引的丢帧数
+
+    std::atomic<uint64_t> frames;
+    std::atomic<uint64_t> bytes;
+    std::atomic<uint64_t> dropped;
+    std::atomic<uint64_t> segments;
+    std::atomic<uint64_t> enqueueNs;
+    std::atomic<uint64_t> writerCpuNs;
+};
+
+#endif // SESSION_RECORDER_H
@@ -0,0 +1,162 @@
+#include "snapshot_writer.h"
+#include "pipeline_clock.h"
+#include "async_logger.h"
+#include <QFileInfo>
+#include <opencv2/imgcodecs.hpp>
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/eventfd.h>
+#include <sys/syscall.h>
+
+// 写盘线程使用最低的尽力而为I/O优先级，不与视频采集争抢SD卡带宽
+#define IOPRIO_CLASS_SHIFT 13
+#define IOPRIO_CLASS_BE 2
+#define IOPRIO_WHO_PROCESS 1
+
+static bool writeAll(int fd, const uchar *data, size_t len)
+{
+    while (len > 0) {
+        ssize_t n = write(fd, data, len);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            return false;
+        }
+        data += n;
+        len -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+SnapshotWriter::SnapshotWriter(QObject *parent)
+    : QThread(parent)
+    , head(0)
+    , count(0)
+    , running(false)
+    , saved(0)
+    , rejected(0)
+{
+    wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+}
+
+SnapshotWriter::~SnapshotWriter()
+{
+    stop();
+    if (wakeFd >= 0) {
+        close(wakeFd);
+    }
+}
+
+bool SnapshotWriter::enqueue(const cv::Mat &frame, const cv::Mat &jpeg, const QString &path)
+{
+    {
+        QMutexLocker locker(&mutex);
+        if (count == kQueueSize) {
+            rejected.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        Job &job = queue[(head + count) % kQueueSize];
+        job.frame = frame;
+        job.jpeg = jpeg;
+        job.path = path;
+        count++;
+    }
+    uint64_t one = 1;
+    if (write(wakeFd, &one, sizeof(one)) != sizeof(one)) {
+        // 计数溢出才会失败，此时线程必然已被唤醒
+    }
+    return true;
+}
+
+void SnapshotWriter::stop()
+{
+    if (!isRunning()) {
+        return;
+    }
+    running = false;
+    uint64_t one = 1;
+    if (write(wakeFd, &one, sizeof(one)) != sizeof(one)) {
+    }
+    wait();
+}
+
+void SnapshotWriter::run()
+{
+    syscall(SYS_ioprio_set, IOPRIO_WHO_PROCESS, 0, (IOPRIO_CLASS_BE << IOPRIO_CLASS_SHIFT) | 7);
+
+    running = true;
+    struct pollfd pfd;
+    pfd.fd = wakeFd;
+    pfd.events = POLLIN;
+    Job job;
+    while (running) {
+        if (poll(&pfd, 1, -1) <= 0) {
+            continue;
+        }
+        uint64_t n;
+        while (read(wakeFd, &n, sizeof(n)) == sizeof(n)) {
+        }
+
+        // 退出前把已接受的截图全部写完
+        for (;;) {
+            {
+                QMutexLocker locker(&mutex);
+                if (count == 0)
+                    break;
+                job = queue[head];
+                queue[head] = Job();   // 尽早释放对采集帧的引用
+                head = (head + 1) % kQueueSize;
+                count--;
+            }
+            int64_t start = monotonicNowNs();
+            bool ok = writeJob(job);
+            if (ok)
+                saved.fetch_add(1, std::memory_order_relaxed);
+            emit snapshotSaved(job.path, ok, (monotonicNowNs() - start) / 1000000);
+            job = Job();
+        }
+    }
+}
+
+bool SnapshotWriter::writeJob(const Job &job)
+{
+    const uchar *data;
+    size_t len;
+    if (!job.jpeg.empty() && job.jpeg.isContinuous()) {
+        data = job.jpeg.ptr();
+        len = job.jpeg.total() * job.jpeg.elemSize();
+    } else {
+        if (job.frame.empty() || !cv::imencode(".jpg", job.frame, encodeBuffer))
+            return false;
+        data = encodeBuffer.data();
+        len = encodeBuffer.size();
+    }
+
+    QByteArray finalPath = job.path.toLocal8Bit();
+    QByteArray tmpPath = finalPath + ".tmp";
+    int fd = open(tmpPath.constData(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        LOG_WARN(LogRecord, "截图写入失败 %s: %s", tmpPath.constData(), strerror(errno));
+        return false;
+    }
+    bool ok = writeAll(fd, data, len) && fsync(fd) == 0;
+    close(fd);
+    if (!ok || rename(tmpPath.constData(), finalPath.constData()) != 0) {
+        LOG_WARN(LogRecord, "截图写入失败 %s: %s", finalPath.constData(), strerror(errno));
+        unlink(tmpPath.constData());
+        return false;
+    }
+
+    // rename本身也要落盘
+    QByteArray dir = QFileInfo(job.path).absolutePath().toLocal8Bit();
+    int dirFd = open(dir.constData(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dirFd >= 0) {
+        fsync(dirFd);
+        close(dirFd);
+    }
+    return true;
+}
@@ -0,0 +1,61 @@
+#ifndef SNAPSHOT_WRITER_H
+#define SNAPSHOT_WRITER_H
+
+#include <QThread>
+#include <QMutex>
+#include <QString>
+#include <atomic>
+#include <vector>
+#include <stdint.h>
+#include <opencv2/core.hpp>
+
+// 截图写盘线程：JPEG编码、写SD卡与fsync全部在后台完成，采集/推理/界面线程从不等待磁盘。
+// - 有原始MJPEG数据时直接写出（无需重新编码，画质无损失）；否则对BGR帧做JPEG编码
+// - 先写临时文件并fsync，再rename为正式文件名，掉电时不会留下半个JPEG
+// - 队列定长，写盘跟不上时拒绝新的截图请求而不是无限堆积
+// 完成后通过snapshotSaved信号通知界面。
+class SnapshotWriter : public QThread
+{
+    Q_OBJECT
+public:
+    explicit SnapshotWriter(QObject *parent = nullptr);
+    ~SnapshotWriter();
+
+    // GUI线程调用：frame/jpeg与采集端共享数据（cv::Mat引用计数），不拷贝；jpeg为空时编码frame
+    // 返回false表示队列已满
+    bool enqueue(const cv::Mat &frame, const cv::Mat &jpeg, const QString &path);
+    void stop();
+
+    uint64_t savedCount() const { return saved.load(std::memory_order_relaxed); }
+    uint64_t rejectedCount() const { return rejected.load(std::memory_order_relaxed); }
+    int queueDepth() const { return count.load(std::memory_order_relaxed); }
+
+signals:
+    void snapshotSaved(const QString &path, bool ok, qint64 costMs);
+
+protected:
+    void run() override;
+
+private:
+    struct Job
+    {
+        cv::Mat frame;
+        cv::Mat jpeg;
+        QString path;
+    };
+
+    bool writeJob(const Job &job);
+
+    static const int kQueueSize = 4;
+    QMutex mutex;
+    Job queue[kQueueSize];
+    int head;
+    std::atomic<int> count;   // 受mutex保护；原子变量只为指标导出线程无锁读取队列深度
+    int wakeFd;
+    std::atomic<bool> running;
+    std::atomic<uint64_t> saved;
+    std::atomic<uint64_t> rejected;
+    std::vector<uchar> encodeBuffer;   // 写盘线程内复用
+};
+
+#endif // SNAPSHOT_WRITER_H
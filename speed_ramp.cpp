@@ -0,0 +1,125 @@
+#include "speed_ramp.h"
+#include <math.h>
+#include <algorithm>
+
+static float clampf(float x, float lo, float hi)
+{
+    return x < lo ? lo : (x > hi ? hi : x);
+}
+
+// 刹车约束：这一步加速度为x，之后每步按jerk上限减小jerkStep直到零，速度总变化
+// dt·(x + (x - jerkStep) + ...) 不超过剩余误差e时x的最大值（连续情形即e = a²/(2·maxJerk)）
+static float brakingAccel(float e, float jerkStep, float dt)
+{
+    if (jerkStep <= 0.0f)
+        return 0.0f;
+    for (int n = 0;; ++n) {
+        // 假设共n+1步加速度为正，解出x；x落在这n+1步的范围内即为所求
+        float x = (e / dt + jerkStep * 0.5f * n * (n + 1)) / (n + 1);
+        if (x <= (n + 1) * jerkStep)
+            return x;
+    }
+}
+
+void AxisRamp::step(float target, float dt, const RampLimits &limits)
+{
+    if (dt <= 0.0f) {
+        return;
+    }
+
+    float err = target - v;
+    float dir = err < 0.0f ? -1.0f : 1.0f;
+    float jerkStep = limits.maxJerk * dt;
+    // 到达：剩余误差这一步就能走完，且这一步和下一步（加速度归零）的变化都不超过jerkStep
+    float arrive = err / dt;
+    if (fabsf(arrive) <= std::min(jerkStep, limits.maxAccel) && fabsf(arrive - a) <= jerkStep) {
+        a = arrive;
+        v = target;
+        return;
+    }
+
+    // 比例给出期望加速度，再受最大加速度与jerk约束
+    float aDes = clampf(err / limits.tau, -limits.maxAccel, limits.maxAccel);
+    float next = a + clampf(aDes - a, -jerkStep, jerkStep);
+    // 接近目标时提前刹车：朝目标方向的加速度不超过刹车约束，但每步最多减小jerkStep
+    float brake = brakingAccel(fabsf(err), jerkStep, dt);
+    if (dir * next > brake)
+        next = dir * std::max(brake, dir * a - jerkStep);
+    a = next;
+    v += a * dt;
+}
+
+PoseFilter::PoseFilter(float maxLinear, float maxReverse, float maxAngular, float alpha)
+    : maxLinear(maxLinear)
+    , maxReverse(maxReverse)
+    , maxAngular(maxAngular)
+    , alpha(alpha)
+    , lin(0.0f)
+    , ang(0.0f)
+{
+}
+
+void PoseFilter::nominal(char cmd, float &linear, float &angular) const
+{
+    linear = 0.0f;
+    angular = 0.0f;
+    switch (cmd) {
+    case 'F': linear = maxLinear; break;
+    case 'B': linear = -maxReverse; break;
+    case 'L': angular = maxAngular; break;
+    case 'R': angular = -maxAngular; break;
+    default: break;   // 'S'及未知指令：停止
+    }
+}
+
+void PoseFilter::update(char cmd, float confidence)
+{
+    float l, w;
+    nominal(cmd, l, w);
+    float k = alpha * clampf(confidence, 0.0f, 1.0f);
+    lin += k * (l - lin);
+    ang += k * (w - ang);
+}
+
+void PoseFilter::force(char cmd)
+{
+    nominal(cmd, lin, ang);
+}
+
+SpeedRamp::SpeedRamp(const RampLimits &linearLimits, const RampLimits &angularLimits)
+    : linearLimits(linearLimits)
+    , angularLimits(angularLimits)
+    , targetLin(0.0f)
+    , targetAng(0.0f)
+    , lastNs(0)
+{
+}
+
+void SpeedRamp::setTarget(float linear, float angular)
+{
+    targetLin = linear;
+    targetAng = angular;
+}
+
+void SpeedRamp::step(int64_t nowNs)
+{
+    if (lastNs == 0) {
+        lastNs = nowNs;
+        return;
+    }
+    float dt = static_cast<float>(nowNs - lastNs) * 1e-9f;
+    lastNs = nowNs;
+    // 线程被长时间抢占时限制单步时长，防止一步跳变
+    dt = clampf(dt, 0.0f, 0.1f);
+    linearAxis.step(targetLin, dt, linearLimits);
+    angularAxis.step(targetAng, dt, angularLimits);
+}
+
+void SpeedRamp::reset(int64_t nowNs)
+{
+    targetLin = 0.0f;
+    targetAng = 0.0f;
+    linearAxis.reset();
+    angularAxis.reset();
+    lastNs = nowNs;
+}
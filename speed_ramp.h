@@ -0,0 +1,81 @@
+#ifndef SPEED_RAMP_H
+#define SPEED_RAMP_H
+
+#include <stdint.h>
+
+// 单轴速度斜坡：比例跟踪目标速度，加速度与加加速度（jerk）受限
+struct RampLimits
+{
+    float maxAccel;   // 最大加速度（单位/s²）
+    float maxJerk;    // 最大加加速度（单位/s³）
+    float tau;        // 比例时间常数（s）：期望加速度 = 速度误差 / tau
+};
+
+class AxisRamp
+{
+public:
+    AxisRamp() : v(0.0f), a(0.0f) {}
+    void step(float target, float dt, const RampLimits &limits);
+    void reset() { v = 0.0f; a = 0.0f; }
+    float velocity() const { return v; }
+    float accel() const { return a; }
+
+private:
+    float v;
+    float a;
+};
+
+// 头部姿态滤波：置信度加权的指数平滑，把离散姿态变成连续的目标线速度/角速度
+class PoseFilter
+{
+public:
+    PoseFilter(float maxLinear, float maxReverse, float maxAngular, float alpha);
+
+    // 指令字符（F/B/L/R/S）对应的名义速度
+    void nominal(char cmd, float &linear, float &angular) const;
+    // 自动指令：按置信度加权平滑
+    void update(char cmd, float confidence);
+    // 手动指令：直接跳到名义速度，不做平滑
+    void force(char cmd);
+
+    float linear() const { return lin; }
+    float angular() const { return ang; }
+
+private:
+    float maxLinear;
+    float maxReverse;
+    float maxAngular;
+    float alpha;
+    float lin;
+    float ang;
+};
+
+// 固定频率控制环使用的速度斜坡发生器（线速度 + 角速度）。
+// 时间由调用方传入（CLOCK_MONOTONIC纳秒），可以用模拟时钟逐步驱动来验证斜坡曲线。
+class SpeedRamp
+{
+public:
+    SpeedRamp(const RampLimits &linearLimits, const RampLimits &angularLimits);
+
+    void setTarget(float linear, float angular);
+    // 按距离上次step的实际时间推进；首次调用只记录时间
+    void step(int64_t nowNs);
+    // 急停：速度、加速度立即归零
+    void reset(int64_t nowNs);
+
+    float linear() const { return linearAxis.velocity(); }
+    float angular() const { return angularAxis.velocity(); }
+    float targetLinear() const { return targetLin; }
+    float targetAngular() const { return targetAng; }
+
+private:
+    RampLimits linearLimits;
+    RampLimits angularLimits;
+    AxisRamp linearAxis;
+    AxisRamp angularAxis;
+    float targetLin;
+    float targetAng;
+    int64_t lastNs;
+};
+
+#endif // SPEED_RAMP_H
@@ -0,0 +1,11 @@
+# 各测试程序共用：QtTest + 核心静态库 + OpenCV（testcase使make check运行测试）
+QT       = core testlib
+
+CONFIG   += console c++11 testcase
+CONFIG   -= app_bundle
+
+TEMPLATE = app
+
+CORE_OUT = $$OUT_PWD/../../core
+include($$PWD/../core.pri)
+include($$PWD/../opencv.pri)
@@ -0,0 +1,16 @@
+# 单元测试：每个模块一个QtTest程序，都链接核心静态库；make check逐个运行
+TEMPLATE = subdirs
+
+SUBDIRS += tst_inference_postprocess \
+           tst_command_arbiter \
+           tst_uart_frame \
+           tst_speed_ramp \
+           tst_replay_source \
+           tst_session_recorder \
+           tst_async_logger \
+           tst_metrics_registry \
+           tst_event_loop_monitor \
+           tst_inference_backend \
+           tst_native_kernels \
+           tst_native_model \
+           tst_auto_tuner
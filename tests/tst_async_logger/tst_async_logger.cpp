@@ -0,0 +1,235 @@
+#include <QtTest>
+#include <stdio.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+#include "async_logger.h"
+
+// 异步日志：写日志线程不启动，stop()时一次取走队列，核对限流、丢弃计数、级别配置与离线格式化结果
+static const int64_t kSecondNs = 1000000000LL;
+
+// 去掉"[秒.微秒] "前缀，只留"级别 类别 消息"
+static std::vector<std::string> readMessages(const std::string &file)
+{
+    std::vector<std::string> lines;
+    FILE *fp = fopen(file.c_str(), "r");
+    if (!fp)
+        return lines;
+    char buffer[1024];
+    while (fgets(buffer, sizeof(buffer), fp)) {
+        std::string line = buffer;
+        if (!line.empty() && line[line.size() - 1] == '\n')
+            line.resize(line.size() - 1);
+        size_t end = line.find("] ");
+        lines.push_back(end == std::string::npos ? line : line.substr(end + 2));
+    }
+    fclose(fp);
+    return lines;
+}
+
+class TestAsyncLogger : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+    void rateLimitIsPerSite();
+    void suppressedCountReportedAfterWindow();
+    void unlimitedWhenRateIsZero();
+    void fullQueueDropsInsteadOfBlocking();
+    void stopWaitsForInFlightProducers();
+    void formatsArgumentsOffline();
+    void configureLevels();
+
+private:
+    std::string logPath;
+};
+
+void TestAsyncLogger::init()
+{
+    char pattern[] = "/tmp/tst_async_logger_XXXXXX";
+    int fd = mkstemp(pattern);
+    QVERIFY(fd >= 0);
+    close(fd);
+    logPath = pattern;
+    AsyncLogger::setLevel(LogInfer, LogInfo);
+}
+
+void TestAsyncLogger::cleanup()
+{
+    unlink(logPath.c_str());
+}
+
+void TestAsyncLogger::rateLimitIsPerSite()
+{
+    AsyncLogger logger(logPath, 5);
+    uint64_t suppressedBefore = logger.suppressedCount();
+    LogSite busy("busy %d", LogInfer, LogInfo);
+    LogSite quiet("quiet %d", LogInfer, LogInfo);
+    for (int i = 0; i < 20; ++i)
+        AsyncLogger::log(busy, i);
+    // 另一个日志点不受busy的限流影响
+    for (int i = 0; i < 3; ++i)
+        AsyncLogger::log(quiet, i);
+    QCOMPARE(logger.suppressedCount() - suppressedBefore, uint64_t(15));
+    QCOMPARE(busy.suppressed.load(), uint32_t(15));
+    QCOMPARE(quiet.suppressed.load(), uint32_t(0));
+    logger.stop();
+
+    std::vector<std::string> lines = readMessages(logPath);
+    QCOMPARE(lines.size(), size_t(8));
+    QCOMPARE(lines[0], std::string("I infer   busy 0"));
+    QCOMPARE(lines[4], std::string("I infer   busy 4"));
+    QCOMPARE(lines[5], std::string("I infer   quiet 0"));
+    QCOMPARE(logger.writtenCount(), uint64_t(8));
+    QCOMPARE(logger.droppedCount(), uint64_t(0));
+}
+
+void TestAsyncLogger::suppressedCountReportedAfterWindow()
+{
+    AsyncLogger logger(logPath, 2);
+    LogSite site("tick %d", LogInfer, LogWarn);
+    for (int i = 0; i < 7; ++i)
+        AsyncLogger::log(site, i);
+
+    // 窗口起点回拨一秒，相当于过了一秒：放行并附上被限流的条数，计数清零
+    site.windowStartNs.store(site.windowStartNs.load() - kSecondNs);
+    AsyncLogger::log(site, 7);
+    QCOMPARE(site.suppressed.load(), uint32_t(0));
+    AsyncLogger::log(site, 8);
+    logger.stop();
+
+    std::vector<std::string> lines = readMessages(logPath);
+    QCOMPARE(lines.size(), size_t(4));
+    QCOMPARE(lines[1], std::string("W infer   tick 1"));
+    QCOMPARE(lines[2], std::string("W infer   tick 7（此前5条被限流）"));
+    QCOMPARE(lines[3], std::string("W infer   tick 8"));
+}
+
+void TestAsyncLogger::unlimitedWhenRateIsZero()
+{
+    AsyncLogger logger(logPath, 0);
+    LogSite site("n %d", LogInfer, LogInfo);
+    for (int i = 0; i < 100; ++i)
+        AsyncLogger::log(site, i);
+    logger.stop();
+    QCOMPARE(readMessages(logPath).size(), size_t(100));
+    QCOMPARE(site.suppressed.load(), uint32_t(0));
+}
+
+void TestAsyncLogger::fullQueueDropsInsteadOfBlocking()
+{
+    // 容量取整到2的幂；没有消费者时填满后直接丢弃
+    AsyncLogger logger(logPath, 0, 4);
+    LogSite site("n %d", LogInfer, LogInfo);
+    for (int i = 0; i < 10; ++i)
+        AsyncLogger::log(site, i);
+    QCOMPARE(logger.backlog(), uint64_t(4));
+    QCOMPARE(logger.droppedCount(), uint64_t(6));
+    logger.stop();
+
+    std::vector<std::string> lines = readMessages(logPath);
+    QCOMPARE(lines.size(), size_t(4));
+    QCOMPARE(lines[3], std::string("I infer   n 3"));
+    QCOMPARE(logger.backlog(), uint64_t(0));
+}
+
+void TestAsyncLogger::stopWaitsForInFlightProducers()
+{
+    // 多个线程一直写日志时stop()：摘下实例前已读到它的生产者都要在最后一次取走之前提交，
+    // 不能有槽位在stop()之后才写入（那时环形队列可能已经释放）。
+    // 摘下实例之后的日志同步写stderr，这里临时指向/dev/null
+    int savedStderr = dup(STDERR_FILENO);
+    int devNull = open("/dev/null", O_WRONLY);
+    QVERIFY(savedStderr >= 0 && devNull >= 0);
+    dup2(devNull, STDERR_FILENO);
+    close(devNull);
+
+    LogSite site("n %d", LogInfer, LogInfo);
+    bool ok = true;
+    for (int round = 0; round < 50 && ok; ++round) {
+        if (truncate(logPath.c_str(), 0) != 0) {
+            ok = false;
+            break;
+        }
+        AsyncLogger logger(logPath, 0, 256);
+        logger.start();
+        std::atomic<int> started(0);
+        std::vector<std::thread> producers;
+        for (int t = 0; t < 4; ++t) {
+            producers.push_back(std::thread([&site, &started] {
+                started.fetch_add(1);
+                for (int i = 0; AsyncLogger::instance(); ++i)
+                    AsyncLogger::log(site, i);
+            }));
+        }
+        while (started.load() < 4)
+            std::this_thread::yield();
+        logger.stop();
+        uint64_t backlog = logger.backlog();
+        for (size_t t = 0; t < producers.size(); ++t)
+            producers[t].join();
+        ok = backlog == 0 && logger.backlog() == 0
+             && readMessages(logPath).size() == logger.writtenCount();
+    }
+
+    dup2(savedStderr, STDERR_FILENO);
+    close(savedStderr);
+    QVERIFY(ok);
+}
+
+void TestAsyncLogger::formatsArgumentsOffline()
+{
+    AsyncLogger logger(logPath, 0);
+    // 长度修饰符可省略：按参数的实际类型输出
+    LogSite mixed("id=%u cmd=%c conf=%.2f name=%s %d%% %s", LogInfer, LogError);
+    AsyncLogger::log(mixed, 4000000000u, 'F', 0.876, "yolo", -3, std::string("ok"));
+    // %s配数值、缺少的参数输出'?'
+    LogSite loose("v=%s w=%s x=%d", LogInfer, LogInfo);
+    AsyncLogger::log(loose, 12, 0.5);
+    // 字符串参数共用96字节，超出的截断
+    LogSite text("%s|%s", LogInfer, LogInfo);
+    std::string longText(120, 'a');
+    AsyncLogger::log(text, longText, "tail");
+    logger.stop();
+
+    std::vector<std::string> lines = readMessages(logPath);
+    QCOMPARE(lines.size(), size_t(3));
+    QCOMPARE(lines[0], std::string("E infer   id=4000000000 cmd=F conf=0.88 name=yolo -3% ok"));
+    QCOMPARE(lines[1], std::string("I infer   v=12 w=0.5 x=?"));
+    QCOMPARE(lines[2], std::string("I infer   ") + std::string(95, 'a') + "|");
+}
+
+void TestAsyncLogger::configureLevels()
+{
+    std::string error;
+    QVERIFY(AsyncLogger::configure("infer=debug,ui=warn", error));
+    QVERIFY(AsyncLogger::enabled(LogInfer, LogDebug));
+    QVERIFY(!AsyncLogger::enabled(LogUi, LogInfo));
+    QVERIFY(AsyncLogger::enabled(LogUi, LogWarn));
+    QVERIFY(AsyncLogger::enabled(LogCapture, LogInfo));
+    QVERIFY(!AsyncLogger::enabled(LogCapture, LogDebug));
+
+    // 不带类别即全部
+    QVERIFY(AsyncLogger::configure("off", error));
+    QVERIFY(!AsyncLogger::enabled(LogSystem, LogError));
+
+    QVERIFY(!AsyncLogger::configure("infer=loud", error));
+    QVERIFY(error.find("loud") != std::string::npos);
+    QVERIFY(!AsyncLogger::configure("camera=debug", error));
+    QVERIFY(error.find("camera") != std::string::npos);
+
+    // 关闭的级别不求值参数
+    QVERIFY(AsyncLogger::configure("*=info", error));
+    int evaluated = 0;
+    LOG_DEBUG(LogInfer, "never %d", ++evaluated);
+    QCOMPARE(evaluated, 0);
+}
+
+QTEST_APPLESS_MAIN(TestAsyncLogger)
+#include "tst_async_logger.moc"
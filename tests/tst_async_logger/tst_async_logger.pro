@@ -0,0 +1,4 @@
+TARGET = tst_async_logger
+include(../tests.pri)
+
+SOURCES += tst_async_logger.cpp
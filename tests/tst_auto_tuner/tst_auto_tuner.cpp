@@ -0,0 +1,146 @@
+#include <QtTest>
+#include <string>
+#include <vector>
+#include "auto_tuner.h"
+
+// 自动调优的选择规则：推理间隔取满足精度下限且跟得上采集节拍的最大值，组合取每帧摊到的推理耗时最小者
+static AutoTuner::Trial makeTrial(double inferMs, int interval = 0)
+{
+    AutoTuner::Trial trial;
+    trial.inferMs = inferMs;
+    trial.interval = interval;
+    trial.agreement = 0.0;
+    return trial;
+}
+
+// 20帧，前10帧类别0，后10帧类别1
+static std::vector<int> twoSegments()
+{
+    std::vector<int> classes(20, 0);
+    for (size_t i = 10; i < classes.size(); ++i)
+        classes[i] = 1;
+    return classes;
+}
+
+class TestAutoTuner : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void largestIntervalAboveFloor();
+    void intervalMustKeepUpWithCapture();
+    void disagreeingConfigRejected();
+    void mismatchedFramesRejected();
+    void bestHasLowestCostPerFrame();
+    void describeConfig();
+};
+
+void TestAutoTuner::largestIntervalAboveFloor()
+{
+    std::vector<int> reference = twoSegments();
+    // 逐帧一致率：间隔1/2/5/10为100%，3为90%（第10、11帧沿用第9帧），15为75%，20为50%
+    AutoTuner::Trial trial = makeTrial(10.0);
+    AutoTuner::pickInterval(trial, reference, reference, 95, 80);
+    // 间隔3不达标不影响更大的间隔
+    QCOMPARE(trial.interval, 10);
+    QCOMPARE(trial.agreement, 1.0);
+
+    AutoTuner::pickInterval(trial, reference, reference, 75, 80);
+    QCOMPARE(trial.interval, 15);
+    QCOMPARE(trial.agreement, 0.75);
+
+    AutoTuner::pickInterval(trial, reference, reference, 50, 80);
+    QCOMPARE(trial.interval, 20);
+    QCOMPARE(trial.agreement, 0.5);
+}
+
+void TestAutoTuner::intervalMustKeepUpWithCapture()
+{
+    std::vector<int> reference = twoSegments();
+    // 700 ms需要间隔至少9（80 ms × 9），10满足精度
+    AutoTuner::Trial trial = makeTrial(700.0);
+    AutoTuner::pickInterval(trial, reference, reference, 95, 80);
+    QCOMPARE(trial.interval, 10);
+
+    // 900 ms需要间隔至少12，15与20都低于精度下限
+    trial = makeTrial(900.0);
+    AutoTuner::pickInterval(trial, reference, reference, 95, 80);
+    QCOMPARE(trial.interval, 0);
+    QCOMPARE(trial.agreement, 0.0);
+
+    // 恰好等于间隔内的采集时长算跟得上
+    trial = makeTrial(1600.0);
+    AutoTuner::pickInterval(trial, reference, reference, 50, 80);
+    QCOMPARE(trial.interval, 20);
+    trial = makeTrial(1600.5);
+    AutoTuner::pickInterval(trial, reference, reference, 50, 80);
+    QCOMPARE(trial.interval, 0);
+}
+
+void TestAutoTuner::disagreeingConfigRejected()
+{
+    std::vector<int> reference = twoSegments();
+    // 后10帧漏检：逐帧也只有50%
+    std::vector<int> classes(reference.size(), 0);
+    for (size_t i = 10; i < classes.size(); ++i)
+        classes[i] = -1;
+    AutoTuner::Trial trial = makeTrial(10.0, 7);
+    AutoTuner::pickInterval(trial, classes, reference, 95, 80);
+    QCOMPARE(trial.interval, 0);
+
+    // 每个间隔都是前10帧一致
+    AutoTuner::pickInterval(trial, classes, reference, 50, 80);
+    QCOMPARE(trial.interval, 20);
+    QCOMPARE(trial.agreement, 0.5);
+}
+
+void TestAutoTuner::mismatchedFramesRejected()
+{
+    std::vector<int> reference = twoSegments();
+    std::vector<int> shorter(reference.begin(), reference.begin() + 10);
+    AutoTuner::Trial trial = makeTrial(10.0, 5);
+    AutoTuner::pickInterval(trial, shorter, reference, 0, 80);
+    QCOMPARE(trial.interval, 0);
+
+    trial = makeTrial(10.0, 5);
+    AutoTuner::pickInterval(trial, std::vector<int>(), std::vector<int>(), 0, 80);
+    QCOMPARE(trial.interval, 0);
+}
+
+void TestAutoTuner::bestHasLowestCostPerFrame()
+{
+    std::vector<AutoTuner::Trial> trials;
+    trials.push_back(makeTrial(40.0, 1));    // 40 ms/帧
+    trials.push_back(makeTrial(100.0, 5));   // 20 ms/帧
+    trials.push_back(makeTrial(5.0, 0));     // 最快但不满足约束
+    trials.push_back(makeTrial(60.0, 3));    // 同为20 ms/帧，取先出现的
+    QCOMPARE(AutoTuner::pickBest(trials), 1);
+
+    trials.push_back(makeTrial(150.0, 10));  // 15 ms/帧
+    QCOMPARE(AutoTuner::pickBest(trials), 4);
+
+    std::vector<AutoTuner::Trial> unusable;
+    unusable.push_back(makeTrial(5.0, 0));
+    QCOMPARE(AutoTuner::pickBest(unusable), -1);
+    QCOMPARE(AutoTuner::pickBest(std::vector<AutoTuner::Trial>()), -1);
+}
+
+void TestAutoTuner::describeConfig()
+{
+    InferenceConfig config;
+    config.backendOptions.threads = 2;
+    config.backendOptions.winograd = true;
+    config.inputSize = 128;
+    config.letterBox = true;
+    QCOMPARE(AutoTuner::describe(config), std::string("opencv 线程2 winograd 128x128 补零"));
+
+    // Winograd只对opencv显示
+    config.backend = "native";
+    config.backendOptions.threads = 1;
+    config.inputSize = 96;
+    config.letterBox = false;
+    QCOMPARE(AutoTuner::describe(config), std::string("native 线程1 96x96 拉伸"));
+}
+
+QTEST_APPLESS_MAIN(TestAutoTuner)
+#include "tst_auto_tuner.moc"
@@ -0,0 +1,4 @@
+TARGET = tst_auto_tuner
+include(../tests.pri)
+
+SOURCES += tst_auto_tuner.cpp
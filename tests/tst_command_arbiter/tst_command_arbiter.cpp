@@ -0,0 +1,128 @@
+#include <QtTest>
+#include "command_arbiter.h"
+
+// 指令仲裁的模式切换：时间全部由测试给定
+static const int64_t kMs = 1000000;
+static const int64_t kHoldNs = 500 * kMs;
+static const int kConfirmFrames = 3;
+
+class TestCommandArbiter : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void autoPassesThrough();
+    void manualHoldCancelsAuto();
+    void holdExpiryNeedsConfirmation();
+    void confirmationRestartsOnChange();
+    void stopLatchesUntilResume();
+    void staleCaptureIsCancelled();
+    void releaseEndsHoldWithoutLatching();
+    void releaseIgnoredWhenStoppedOrAuto();
+};
+
+void TestCommandArbiter::autoPassesThrough()
+{
+    CommandArbiter arbiter(kHoldNs, kConfirmFrames);
+    QCOMPARE(arbiter.mode(), CommandArbiter::ModeAuto);
+    QCOMPARE(arbiter.onAuto('F', 10 * kMs, 20 * kMs), 'F');
+    QCOMPARE(arbiter.onAuto('L', 30 * kMs, 40 * kMs), 'L');
+    QCOMPARE(arbiter.cancelledAuto(), uint64_t(0));
+}
+
+void TestCommandArbiter::manualHoldCancelsAuto()
+{
+    CommandArbiter arbiter(kHoldNs, kConfirmFrames);
+    QCOMPARE(arbiter.onManual('R', 100 * kMs), 'R');
+    QCOMPARE(arbiter.mode(), CommandArbiter::ModeManualHold);
+    // 手动之后采集的帧，仍在保持期内
+    QCOMPARE(arbiter.onAuto('F', 200 * kMs, 300 * kMs), char(0));
+    QCOMPARE(arbiter.mode(), CommandArbiter::ModeManualHold);
+    QCOMPARE(arbiter.cancelledAuto(), uint64_t(1));
+}
+
+void TestCommandArbiter::holdExpiryNeedsConfirmation()
+{
+    CommandArbiter arbiter(kHoldNs, kConfirmFrames);
+    arbiter.onManual('L', 100 * kMs);
+    int64_t t = 100 * kMs + kHoldNs;
+    QCOMPARE(arbiter.onAuto('F', t, t), char(0));
+    QCOMPARE(arbiter.mode(), CommandArbiter::ModeAwaitConfirm);
+    QCOMPARE(arbiter.onAuto('F', t + 1, t + 1), char(0));
+    QCOMPARE(arbiter.onAuto('F', t + 2, t + 2), 'F');
+    QCOMPARE(arbiter.mode(), CommandArbiter::ModeAuto);
+    QCOMPARE(arbiter.cancelledAuto(), uint64_t(2));
+}
+
+void TestCommandArbiter::confirmationRestartsOnChange()
+{
+    CommandArbiter arbiter(kHoldNs, kConfirmFrames);
+    arbiter.onManual('L', 0);
+    arbiter.resumeAuto();
+    QCOMPARE(arbiter.mode(), CommandArbiter::ModeAwaitConfirm);
+    QCOMPARE(arbiter.onAuto('F', 1, 1), char(0));
+    QCOMPARE(arbiter.onAuto('F', 2, 2), char(0));
+    // 类别变化，重新计数
+    QCOMPARE(arbiter.onAuto('R', 3, 3), char(0));
+    QCOMPARE(arbiter.onAuto('R', 4, 4), char(0));
+    QCOMPARE(arbiter.mode(), CommandArbiter::ModeAwaitConfirm);
+    QCOMPARE(arbiter.onAuto('R', 5, 5), 'R');
+    QCOMPARE(arbiter.mode(), CommandArbiter::ModeAuto);
+}
+
+void TestCommandArbiter::stopLatchesUntilResume()
+{
+    CommandArbiter arbiter(kHoldNs, 1);
+    QCOMPARE(arbiter.onManual('S', 100 * kMs), 'S');
+    QCOMPARE(arbiter.mode(), CommandArbiter::ModeStopped);
+    // 停止锁存：保持期早已过去也不恢复
+    QCOMPARE(arbiter.onAuto('F', 10000 * kMs, 10000 * kMs), char(0));
+    QCOMPARE(arbiter.mode(), CommandArbiter::ModeStopped);
+    arbiter.resumeAuto();
+    QCOMPARE(arbiter.mode(), CommandArbiter::ModeAwaitConfirm);
+    QCOMPARE(arbiter.onAuto('F', 10001 * kMs, 10001 * kMs), 'F');
+    QCOMPARE(arbiter.mode(), CommandArbiter::ModeAuto);
+}
+
+void TestCommandArbiter::staleCaptureIsCancelled()
+{
+    CommandArbiter arbiter(kHoldNs, 1);
+    arbiter.onManual('B', 100 * kMs);
+    arbiter.resumeAuto();
+    // 手动指令之前采集的帧：即使已确认恢复也作废，且不计入确认
+    QCOMPARE(arbiter.onAuto('F', 99 * kMs, 200 * kMs), char(0));
+    QCOMPARE(arbiter.mode(), CommandArbiter::ModeAwaitConfirm);
+    QCOMPARE(arbiter.onAuto('F', 101 * kMs, 201 * kMs), 'F');
+}
+
+void TestCommandArbiter::releaseEndsHoldWithoutLatching()
+{
+    CommandArbiter arbiter(kHoldNs, 2);
+    arbiter.onManual('F', 100 * kMs);
+    // 保持期内松开：目标归零，直接进入确认阶段而不是锁存停止
+    QCOMPARE(arbiter.onRelease(150 * kMs), 'S');
+    QCOMPARE(arbiter.mode(), CommandArbiter::ModeAwaitConfirm);
+    // 松开前采集的帧过期
+    QCOMPARE(arbiter.onAuto('L', 140 * kMs, 160 * kMs), char(0));
+    // 不需要resumeAuto，连续确认后即恢复自动
+    QCOMPARE(arbiter.onAuto('L', 160 * kMs, 170 * kMs), char(0));
+    QCOMPARE(arbiter.onAuto('L', 170 * kMs, 180 * kMs), 'L');
+    QCOMPARE(arbiter.mode(), CommandArbiter::ModeAuto);
+}
+
+void TestCommandArbiter::releaseIgnoredWhenStoppedOrAuto()
+{
+    CommandArbiter arbiter(kHoldNs, 1);
+    // 自动控制下的松开（如自动已接管后才松开按键）不影响自动
+    QCOMPARE(arbiter.onRelease(10 * kMs), char(0));
+    QCOMPARE(arbiter.mode(), CommandArbiter::ModeAuto);
+    QCOMPARE(arbiter.onAuto('F', 5 * kMs, 20 * kMs), 'F');
+
+    // 锁存停止后松开仍保持锁存
+    arbiter.onManual('S', 30 * kMs);
+    QCOMPARE(arbiter.onRelease(40 * kMs), char(0));
+    QCOMPARE(arbiter.mode(), CommandArbiter::ModeStopped);
+}
+
+QTEST_APPLESS_MAIN(TestCommandArbiter)
+#include "tst_command_arbiter.moc"
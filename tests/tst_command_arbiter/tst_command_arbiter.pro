@@ -0,0 +1,4 @@
+TARGET = tst_command_arbiter
+include(../tests.pri)
+
+SOURCES += tst_command_arbiter.cpp
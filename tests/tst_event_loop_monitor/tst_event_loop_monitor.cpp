@@ -0,0 +1,128 @@
+#include <QtTest>
+#include <QCoreApplication>
+#include <unistd.h>
+#include "event_loop_monitor.h"
+
+// 事件循环卡顿监测：测试线程即被监测的事件循环，用usleep模拟阻塞的槽函数，qWait恢复事件分发
+static const int kProbeMs = 10;
+
+// 在已标注的槽函数中阻塞ms毫秒
+static void blockLoop(int ms)
+{
+    EventLoopSlotScope scope("blockLoop");
+    usleep(ms * 1000);
+}
+
+class TestEventLoopMonitor : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void slotScopeNests();
+    void stallCountedOncePerBlock();
+    void watchdogFiresPastThreshold();
+    void noStallBeforeLoopRuns();
+    void stopRightAfterStart();
+};
+
+void TestEventLoopMonitor::slotScopeNests()
+{
+    QVERIFY(EventLoopMonitor::activeSlot() == nullptr);
+    {
+        EventLoopSlotScope outer("outer");
+        QCOMPARE(std::string(EventLoopMonitor::activeSlot()), std::string("outer"));
+        {
+            UI_SLOT_SCOPE();
+            QCOMPARE(std::string(EventLoopMonitor::activeSlot()), std::string("slotScopeNests"));
+        }
+        QCOMPARE(std::string(EventLoopMonitor::activeSlot()), std::string("outer"));
+    }
+    QVERIFY(EventLoopMonitor::activeSlot() == nullptr);
+}
+
+void TestEventLoopMonitor::stallCountedOncePerBlock()
+{
+    EventLoopMonitor monitor(50, 0, nullptr);
+    monitor.probeIntervalMs = kProbeMs;
+    monitor.start();
+    QTest::qWait(100);
+    QCOMPARE(monitor.stallCount(), uint64_t(0));
+    QVERIFY(monitor.lag().count() > 0);
+
+    // 一次长阻塞只告警一次，恢复后的下一次阻塞再计一次
+    blockLoop(200);
+    QTest::qWait(100);
+    uint64_t afterFirst = monitor.stallCount();
+    int64_t worst = monitor.worstLagUs();
+    blockLoop(120);
+    QTest::qWait(100);
+    uint64_t afterSecond = monitor.stallCount();
+    uint64_t watchdogs = monitor.watchdogCount();
+    monitor.stop();
+    QTest::qWait(10);
+
+    QCOMPARE(afterFirst, uint64_t(1));
+    QVERIFY2(worst >= 150000, "最大延迟应包含整个阻塞时长");
+    QCOMPARE(afterSecond, uint64_t(2));
+    // watchdogMs为0时只告警
+    QCOMPARE(watchdogs, uint64_t(0));
+}
+
+void TestEventLoopMonitor::watchdogFiresPastThreshold()
+{
+    EventLoopMonitor monitor(30, 100, nullptr);
+    monitor.probeIntervalMs = kProbeMs;
+    monitor.start();
+    QTest::qWait(100);
+
+    blockLoop(250);
+    QTest::qWait(100);
+    uint64_t stalls = monitor.stallCount();
+    uint64_t watchdogs = monitor.watchdogCount();
+    // 超过告警阈值但不到看门狗阈值
+    blockLoop(60);
+    QTest::qWait(100);
+    uint64_t shortStalls = monitor.stallCount();
+    uint64_t shortWatchdogs = monitor.watchdogCount();
+    monitor.stop();
+    QTest::qWait(10);
+
+    QCOMPARE(stalls, uint64_t(1));
+    QCOMPARE(watchdogs, uint64_t(1));
+    QCOMPARE(shortStalls, uint64_t(2));
+    QCOMPARE(shortWatchdogs, uint64_t(1));
+}
+
+void TestEventLoopMonitor::noStallBeforeLoopRuns()
+{
+    // 第一个探测被处理前（启动阶段）的阻塞不算卡顿
+    EventLoopMonitor monitor(30, 60, nullptr);
+    monitor.probeIntervalMs = kProbeMs;
+    monitor.start();
+    blockLoop(150);
+    uint64_t stalls = monitor.stallCount();
+    uint64_t watchdogs = monitor.watchdogCount();
+    QTest::qWait(50);
+    uint64_t probes = monitor.lag().count();
+    monitor.stop();
+    QTest::qWait(10);
+
+    QCOMPARE(stalls, uint64_t(0));
+    QCOMPARE(watchdogs, uint64_t(0));
+    QVERIFY(probes > 0);
+}
+
+void TestEventLoopMonitor::stopRightAfterStart()
+{
+    // stop()可能赶在run()开始之前：线程仍须退出（卡住时本用例超时）
+    for (int i = 0; i < 50; ++i) {
+        EventLoopMonitor monitor(30, 60, nullptr);
+        monitor.start();
+        monitor.stop();
+        QVERIFY(!monitor.isRunning());
+        QTest::qWait(1);
+    }
+}
+
+QTEST_GUILESS_MAIN(TestEventLoopMonitor)
+#include "tst_event_loop_monitor.moc"
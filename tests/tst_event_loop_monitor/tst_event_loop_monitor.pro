@@ -0,0 +1,4 @@
+TARGET = tst_event_loop_monitor
+include(../tests.pri)
+
+SOURCES += tst_event_loop_monitor.cpp
@@ -0,0 +1,230 @@
+#include <QtTest>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "inference_backend.h"
+
+// 推理后端接口：按名字创建、失败路径，以及通过接口驱动native后端跑tst_native_model的测试模型
+static const cv::Size kInputSize(16, 16);
+
+static std::vector<char> readBytes(const std::string &file)
+{
+    std::vector<char> bytes;
+    FILE *fp = fopen(file.c_str(), "rb");
+    if (!fp)
+        return bytes;
+    char buffer[4096];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), fp)) > 0)
+        bytes.insert(bytes.end(), buffer, buffer + n);
+    fclose(fp);
+    return bytes;
+}
+
+static std::vector<float> readFloats(const std::string &file)
+{
+    std::vector<char> bytes = readBytes(file);
+    std::vector<float> values(bytes.size() / sizeof(float));
+    if (!values.empty())
+        memcpy(values.data(), bytes.data(), values.size() * sizeof(float));
+    return values;
+}
+
+static std::vector<std::string> compiledBackends()
+{
+    std::vector<std::string> names;
+    std::string list = inferenceBackendNames();
+    size_t begin = 0;
+    while (begin <= list.size()) {
+        size_t end = list.find(',', begin);
+        if (end == std::string::npos)
+            end = list.size();
+        if (end > begin)
+            names.push_back(list.substr(begin, end - begin));
+        begin = end + 1;
+    }
+    return names;
+}
+
+class TestInferenceBackend : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+    void createByName();
+    void loadFailureReportsError();
+    void nativeRunsThroughInterface();
+    void nativeRejectsWrongInput();
+
+private:
+    std::string copyModel();
+    void writeInput(InferenceBackend &backend, const std::vector<float> &input);
+
+    std::string dataDir;
+    std::string workDir;
+};
+
+void TestInferenceBackend::init()
+{
+    dataDir = TEST_DATA_DIR;
+    char pattern[] = "/tmp/tst_inference_backend_XXXXXX";
+    QVERIFY(mkdtemp(pattern) != nullptr);
+    workDir = pattern;
+}
+
+void TestInferenceBackend::cleanup()
+{
+    unlink((workDir + "/model.onnx").c_str());
+    unlink((workDir + "/model.wcm").c_str());
+    rmdir(workDir.c_str());
+}
+
+std::string TestInferenceBackend::copyModel()
+{
+    std::vector<char> bytes = readBytes(dataDir + "/model.onnx");
+    std::string target = workDir + "/model.onnx";
+    FILE *fp = fopen(target.c_str(), "wb");
+    if (!fp || bytes.empty())
+        return std::string();
+    fwrite(bytes.data(), 1, bytes.size(), fp);
+    fclose(fp);
+    return target;
+}
+
+// 与makeInputBlob一样写成[1, 3, H, W]
+void TestInferenceBackend::writeInput(InferenceBackend &backend, const std::vector<float> &input)
+{
+    int sizes[] = {1, 3, kInputSize.height, kInputSize.width};
+    cv::Mat &blob = backend.inputTensor();
+    blob.create(4, sizes, CV_32F);
+    memcpy(blob.ptr<float>(), input.data(), input.size() * sizeof(float));
+}
+
+void TestInferenceBackend::createByName()
+{
+    std::vector<std::string> names = compiledBackends();
+    QVERIFY(std::find(names.begin(), names.end(), "opencv") != names.end());
+    QVERIFY(std::find(names.begin(), names.end(), "native") != names.end());
+    // 列出的每个后端都能按名字创建
+    for (size_t i = 0; i < names.size(); ++i) {
+        InferenceBackend *backend = createInferenceBackend(names[i]);
+        QVERIFY2(backend != nullptr, names[i].c_str());
+        QCOMPARE(std::string(backend->name()), names[i]);
+        QCOMPARE(backend->outputCount(), 0);
+        delete backend;
+    }
+
+    // 空名字为默认的opencv
+    InferenceBackend *backend = createInferenceBackend("");
+    QVERIFY(backend != nullptr);
+    QCOMPARE(std::string(backend->name()), std::string("opencv"));
+    delete backend;
+
+    QVERIFY(createInferenceBackend("tensorrt") == nullptr);
+    QVERIFY(createInferenceBackend("Native") == nullptr);
+}
+
+void TestInferenceBackend::loadFailureReportsError()
+{
+    std::vector<std::string> names = compiledBackends();
+    for (size_t i = 0; i < names.size(); ++i) {
+        InferenceBackend *backend = createInferenceBackend(names[i]);
+        QVERIFY(backend != nullptr);
+        std::string error;
+        bool loaded = backend->load(workDir + "/missing.onnx", kInputSize, InferenceBackendOptions(), error);
+        bool ran = backend->run();
+        delete backend;
+        QVERIFY2(!loaded, names[i].c_str());
+        QVERIFY2(!error.empty(), names[i].c_str());
+        // 未加载时run()失败而不是崩溃
+        QVERIFY2(!ran, names[i].c_str());
+    }
+}
+
+void TestInferenceBackend::nativeRunsThroughInterface()
+{
+    std::string onnx = copyModel();
+    QVERIFY(!onnx.empty());
+    std::vector<float> input = readFloats(dataDir + "/input.bin");
+    QCOMPARE(input.size(), size_t(3 * kInputSize.width * kInputSize.height));
+
+    InferenceBackend *backend = createInferenceBackend("native");
+    QVERIFY(backend != nullptr);
+    std::string error;
+    bool loaded = backend->load(onnx, kInputSize, InferenceBackendOptions(), error);
+    QVERIFY2(loaded, error.c_str());
+
+    // 输出顺序与ONNX图的输出一致；跑两遍（输入张量与arena逐帧复用）
+    const char *outputs[] = {"out1", "out2", "mm"};
+    bool ok = true;
+    std::string failure;
+    for (int round = 0; round < 2 && ok; ++round) {
+        writeInput(*backend, input);
+        if (!backend->run() || backend->outputCount() != 3) {
+            ok = false;
+            failure = "run failed";
+            break;
+        }
+        for (int k = 0; k < 3 && ok; ++k) {
+            std::vector<float> ref = readFloats(dataDir + "/" + outputs[k] + ".ref");
+            const cv::Mat &out = backend->outputTensor(k);
+            if (out.type() != CV_32F || out.total() != ref.size()) {
+                ok = false;
+                failure = std::string("shape ") + outputs[k];
+                break;
+            }
+            const float *data = reinterpret_cast<const float *>(out.data);
+            for (size_t i = 0; i < ref.size(); ++i) {
+                if (!(fabs(data[i] - ref[i]) < 1e-4)) {
+                    ok = false;
+                    failure = std::string("value ") + outputs[k];
+                    break;
+                }
+            }
+        }
+    }
+
+    backend->release();
+    QCOMPARE(backend->outputCount(), 0);
+    bool ranAfterRelease = backend->run();
+    delete backend;
+    QVERIFY2(ok, failure.c_str());
+    QVERIFY(!ranAfterRelease);
+}
+
+void TestInferenceBackend::nativeRejectsWrongInput()
+{
+    std::string onnx = copyModel();
+    QVERIFY(!onnx.empty());
+    InferenceBackend *backend = createInferenceBackend("native");
+    QVERIFY(backend != nullptr);
+    std::string error;
+    bool loaded = backend->load(onnx, kInputSize, InferenceBackendOptions(), error);
+
+    // 没写输入
+    bool ranEmpty = backend->run();
+    // 尺寸不符
+    int sizes[] = {1, 3, 8, 8};
+    backend->inputTensor().create(4, sizes, CV_32F);
+    bool ranSmall = backend->run();
+    // 类型不符
+    int fullSizes[] = {1, 3, kInputSize.height, kInputSize.width};
+    backend->inputTensor().create(4, fullSizes, CV_8U);
+    bool ranBytes = backend->run();
+    delete backend;
+
+    QVERIFY2(loaded, error.c_str());
+    QVERIFY(!ranEmpty);
+    QVERIFY(!ranSmall);
+    QVERIFY(!ranBytes);
+}
+
+QTEST_APPLESS_MAIN(TestInferenceBackend)
+#include "tst_inference_backend.moc"
@@ -0,0 +1,7 @@
+TARGET = tst_inference_backend
+include(../tests.pri)
+
+# 复用tst_native_model的测试模型与参考输出
+DEFINES += TEST_DATA_DIR=\\\"$$PWD/../tst_native_model/data\\\"
+
+SOURCES += tst_inference_backend.cpp
@@ -0,0 +1,311 @@
+#include <QtTest>
+#include "inference.h"
+
+// 推理后处理的无状态函数：在手工构造的输出张量上核对解码、NMS、sigmoid、letterBox与级联门控的类别间隔，
+// 以及级联统计的派生比例和face引擎的人脸框选择、裁剪几何与分类得分归一化
+static const cv::Size kInputSize(256, 256);
+static const cv::Size2f kModelShape(128.0f, 128.0f);   // 框坐标还原时放大2倍
+
+// YOLOv5布局[1, rows, 5+类别]：x y w h obj 类别logit...
+static const int kV5Dims = 5 + NUM_CLASSES;
+static const int kV5Rows = 16;   // 须多于kV5Dims，否则按YOLOv8布局解析
+
+static void setV5Row(cv::Mat &output, int row, float x, float y, float w, float h, float obj,
+                     int classId, float classLogit)
+{
+    float *data = output.ptr<float>(0) + row * kV5Dims;
+    data[0] = x;
+    data[1] = y;
+    data[2] = w;
+    data[3] = h;
+    data[4] = obj;
+    for (int c = 0; c < NUM_CLASSES; ++c)
+        data[5 + c] = c == classId ? classLogit : -4.0f;
+}
+
+static cv::Mat makeV5Output()
+{
+    int sizes[] = {1, kV5Rows, kV5Dims};
+    cv::Mat output(3, sizes, CV_32F);
+    for (int r = 0; r < kV5Rows; ++r)
+        setV5Row(output, r, 10.0f, 10.0f, 4.0f, 4.0f, -10.0f, 0, -4.0f);   // obj_conf远低于阈值
+    setV5Row(output, 2, 64.0f, 64.0f, 20.0f, 30.0f, 5.0f, 2, 4.0f);       // 最优：up
+    setV5Row(output, 5, 65.0f, 64.0f, 20.0f, 30.0f, 3.0f, 2, 3.0f);       // 与最优重叠，NMS去掉
+    setV5Row(output, 9, 20.0f, 30.0f, 10.0f, 10.0f, 2.0f, 3, 2.0f);       // 另一处：right
+    setV5Row(output, 12, 100.0f, 100.0f, 10.0f, 10.0f, 5.0f, 1, -3.0f);   // 类别得分低于阈值
+    return output;
+}
+
+class TestInferencePostprocess : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void sigmoid();
+    void formatToSquarePadsBottomRight();
+    void decodeYolov5();
+    void decodeYolov5BestOnly();
+    void decodeYolov8Transposed();
+    void nmsKeepsBestPerOverlap();
+    void bestClassMarginYolov5();
+    void bestClassMarginYolov8();
+    void cascadeStatsRatios();
+    void faceBoxPrefersLargestDetection();
+    void faceCropSquareIsCentred();
+    void faceScoresNormalized();
+};
+
+void TestInferencePostprocess::sigmoid()
+{
+    QCOMPARE(yoloSigmoid(0.0f), 0.5f);
+    QVERIFY(qFuzzyCompare(yoloSigmoid(2.0f) + yoloSigmoid(-2.0f), 1.0f));
+    QVERIFY(yoloSigmoid(20.0f) > 0.9999f);
+    QVERIFY(yoloSigmoid(-20.0f) < 0.0001f);
+    QVERIFY(yoloSigmoid(1.0f) > yoloSigmoid(0.5f));
+}
+
+void TestInferencePostprocess::formatToSquarePadsBottomRight()
+{
+    cv::Mat wide(2, 4, CV_8UC3, cv::Scalar(7, 8, 9));
+    cv::Mat square = formatToSquare(wide);
+    QCOMPARE(square.rows, 4);
+    QCOMPARE(square.cols, 4);
+    QCOMPARE(square.type(), CV_8UC3);
+    // 原图在左上角，其余补零
+    QCOMPARE(cv::norm(square(cv::Rect(0, 0, 4, 2)), wide, cv::NORM_INF), 0.0);
+    QCOMPARE(cv::countNonZero(square(cv::Rect(0, 2, 4, 2)).reshape(1)), 0);
+
+    cv::Mat tall(5, 3, CV_8UC3, cv::Scalar(1, 1, 1));
+    square = formatToSquare(tall);
+    QCOMPARE(square.rows, 5);
+    QCOMPARE(square.cols, 5);
+    QCOMPARE(cv::countNonZero(square(cv::Rect(3, 0, 2, 5)).reshape(1)), 0);
+}
+
+void TestInferencePostprocess::decodeYolov5()
+{
+    cv::Mat output = makeV5Output();
+    cv::Mat transposed;
+    YoloCandidates candidates;
+    decodeYoloOutput(output, kInputSize, kModelShape, YoloThresholds(), false, transposed, candidates);
+
+    QCOMPARE(candidates.size(), 3);
+    QCOMPARE(candidates.classIds[0], 2);
+    QCOMPARE(candidates.classIds[1], 2);
+    QCOMPARE(candidates.classIds[2], 3);
+    QVERIFY(qFuzzyCompare(candidates.confidences[0], yoloSigmoid(5.0f) * yoloSigmoid(4.0f)));
+    QVERIFY(qFuzzyCompare(candidates.confidences[2], yoloSigmoid(2.0f) * yoloSigmoid(2.0f)));
+    // (64 - 10) * 2, (64 - 15) * 2, 20 * 2, 30 * 2
+    QCOMPARE(candidates.boxes[0], cv::Rect(108, 98, 40, 60));
+    QCOMPARE(candidates.boxes[2], cv::Rect(30, 50, 20, 20));
+}
+
+void TestInferencePostprocess::decodeYolov5BestOnly()
+{
+    cv::Mat output = makeV5Output();
+    cv::Mat transposed;
+    YoloCandidates candidates;
+    decodeYoloOutput(output, kInputSize, kModelShape, YoloThresholds(), true, transposed, candidates);
+
+    QCOMPARE(candidates.size(), 1);
+    QCOMPARE(candidates.classIds[0], 2);
+    QCOMPARE(candidates.boxes[0], cv::Rect(108, 98, 40, 60));
+}
+
+void TestInferencePostprocess::decodeYolov8Transposed()
+{
+    // YOLOv8布局[1, 4+类别, N]，逐通道存放
+    const int anchors = 20;
+    const int channels = 4 + NUM_CLASSES;
+    int sizes[] = {1, channels, anchors};
+    cv::Mat output(3, sizes, CV_32F, cv::Scalar(-6.0f));
+    float *data = output.ptr<float>(0);
+    const int anchor = 7;
+    data[0 * anchors + anchor] = 40.0f;
+    data[1 * anchors + anchor] = 50.0f;
+    data[2 * anchors + anchor] = 16.0f;
+    data[3 * anchors + anchor] = 12.0f;
+    data[(4 + 4) * anchors + anchor] = 3.0f;   // down
+    cv::Mat before = output.clone();
+
+    cv::Mat transposed;
+    YoloCandidates candidates;
+    decodeYoloOutput(output, kInputSize, kModelShape, YoloThresholds(), false, transposed, candidates);
+
+    QCOMPARE(candidates.size(), 1);
+    QCOMPARE(candidates.classIds[0], 4);
+    // 无obj_conf，置信度即类别得分
+    QVERIFY(qFuzzyCompare(candidates.confidences[0], yoloSigmoid(3.0f)));
+    QCOMPARE(candidates.boxes[0], cv::Rect(64, 88, 32, 24));
+    QCOMPARE(transposed.rows, anchors);
+    QCOMPARE(transposed.cols, channels);
+    // 输出本身不改
+    QCOMPARE(cv::norm(output.reshape(1, channels), before.reshape(1, channels), cv::NORM_INF), 0.0);
+}
+
+void TestInferencePostprocess::nmsKeepsBestPerOverlap()
+{
+    cv::Mat output = makeV5Output();
+    cv::Mat transposed;
+    YoloCandidates candidates;
+    YoloThresholds thresholds;
+    decodeYoloOutput(output, kInputSize, kModelShape, thresholds, false, transposed, candidates);
+
+    std::vector<int> keep;
+    DetectionResult result;
+    QCOMPARE(selectDetections(candidates, thresholds, keep, result), 2);
+    QCOMPARE(result.count, 2);
+    // 按置信度降序，重叠的次优框被抑制
+    QCOMPARE(result.best()->class_id, 2);
+    QCOMPARE(result.detections[0].box, cv::Rect(108, 98, 40, 60));
+    QCOMPARE(result.detections[1].class_id, 3);
+    QVERIFY(result.detections[0].confidence > result.detections[1].confidence);
+
+    // 候选为空时清零
+    candidates.clear();
+    QCOMPARE(selectDetections(candidates, thresholds, keep, result), 0);
+    QVERIFY(result.best() == nullptr);
+}
+
+void TestInferencePostprocess::bestClassMarginYolov5()
+{
+    cv::Mat output = makeV5Output();
+    cv::Mat transposed;
+    YoloCandidates candidates;
+    decodeYoloOutput(output, kInputSize, kModelShape, YoloThresholds(), true, transposed, candidates);
+    // 最优行（第2行）：obj_conf × (top1 - top2)
+    float expected = yoloSigmoid(5.0f) * (yoloSigmoid(4.0f) - yoloSigmoid(-4.0f));
+    QVERIFY(qFuzzyCompare(yoloBestClassMargin(output, transposed), expected));
+
+    // 最优行的前两类接近时间隔小，即使另一行更确定也只看最优行
+    float *best = output.ptr<float>(0) + 2 * kV5Dims;
+    best[5 + 1] = 3.8f;
+    setV5Row(output, 9, 20.0f, 30.0f, 10.0f, 10.0f, 2.0f, 3, 3.0f);
+    expected = yoloSigmoid(5.0f) * (yoloSigmoid(4.0f) - yoloSigmoid(3.8f));
+    float margin = yoloBestClassMargin(output, transposed);
+    QVERIFY(qFuzzyCompare(margin, expected));
+    QVERIFY(margin < 0.05f);
+
+    // 没有得分高于0的行时为0
+    cv::Mat empty = output.clone();
+    for (int r = 0; r < kV5Rows; ++r)
+        empty.ptr<float>(0)[r * kV5Dims + 4] = -100.0f;
+    QCOMPARE(yoloBestClassMargin(empty, transposed), 0.0f);
+}
+
+void TestInferencePostprocess::bestClassMarginYolov8()
+{
+    const int anchors = 20;
+    const int channels = 4 + NUM_CLASSES;
+    int sizes[] = {1, channels, anchors};
+    cv::Mat output(3, sizes, CV_32F, cv::Scalar(-6.0f));
+    float *data = output.ptr<float>(0);
+    data[(4 + 4) * anchors + 7] = 3.0f;
+    data[(4 + 0) * anchors + 7] = 1.0f;
+    data[(4 + 1) * anchors + 12] = 2.0f;
+
+    // 间隔按转置缓冲逐行计算，无obj_conf
+    cv::Mat transposed;
+    YoloCandidates candidates;
+    decodeYoloOutput(output, kInputSize, kModelShape, YoloThresholds(), true, transposed, candidates);
+    QVERIFY(qFuzzyCompare(yoloBestClassMargin(output, transposed), yoloSigmoid(3.0f) - yoloSigmoid(1.0f)));
+}
+
+void TestInferencePostprocess::cascadeStatsRatios()
+{
+    CascadeStats empty;
+    QCOMPARE(empty.averageMs(), 0.0);
+    QCOMPARE(empty.fullAverageMs(), 0.0);
+    QCOMPARE(empty.latencyReduction(), 0.0);
+    QCOMPARE(empty.disagreementRate(), 0.0);
+
+    // 10帧：门控每帧1 ms；4帧未采用门控结果再跑完整模型，另抽查2帧，完整模型每次10 ms
+    CascadeStats s;
+    s.frames = 10;
+    s.accepted = 6;
+    s.audited = 2;
+    s.disagreed = 1;
+    s.gateNs = 10 * 1000000LL;
+    s.fullNs = 4 * 10000000LL;
+    s.auditNs = 2 * 10000000LL;
+    // 抽查不计入级联耗时，但参与完整模型单次耗时的估计
+    QCOMPARE(s.averageMs(), 5.0);
+    QCOMPARE(s.fullAverageMs(), 10.0);
+    QCOMPARE(s.latencyReduction(), 0.5);
+    QCOMPARE(s.disagreementRate(), 0.5);
+
+    // 门控全部被否决时级联比直接跑完整模型更慢
+    CascadeStats rejected;
+    rejected.frames = 4;
+    rejected.gateNs = 4 * 2000000LL;
+    rejected.fullNs = 4 * 8000000LL;
+    QCOMPARE(rejected.fullAverageMs(), 8.0);
+    QCOMPARE(rejected.latencyReduction(), -0.25);
+}
+
+void TestInferencePostprocess::faceBoxPrefersLargestDetection()
+{
+    const cv::Size frame(320, 240);
+    const cv::Rect hint(300, 200, 60, 80);
+    std::vector<cv::Rect> faces;
+    faces.push_back(cv::Rect(10, 10, 20, 20));
+    faces.push_back(cv::Rect(50, 40, 30, 30));
+    faces.push_back(cv::Rect(0, 0, 25, 25));
+    // 有检出时不看提示框
+    QCOMPARE(pickFaceBox(faces, hint, frame), cv::Rect(50, 40, 30, 30));
+
+    // 没有检出时用提示框，并裁剪到画面内
+    faces.clear();
+    QCOMPARE(pickFaceBox(faces, hint, frame), cv::Rect(300, 200, 20, 40));
+    QCOMPARE(pickFaceBox(faces, cv::Rect(), frame).area(), 0);
+    QCOMPARE(pickFaceBox(faces, cv::Rect(400, 10, 30, 30), frame).area(), 0);
+}
+
+void TestInferencePostprocess::faceCropSquareIsCentred()
+{
+    // 长边60 × 1.4 = 84，中心(120, 110)
+    QCOMPARE(faceCropSquare(cv::Rect(100, 80, 40, 60), 1.4f), cv::Rect(78, 68, 84, 84));
+    QCOMPARE(faceCropSquare(cv::Rect(100, 80, 40, 60), 1.0f), cv::Rect(90, 80, 60, 60));
+    // 边长四舍五入：25 × 1.5 = 37.5 → 38
+    QCOMPARE(faceCropSquare(cv::Rect(10, 10, 25, 25), 1.5f).width, 38);
+    // 奇数边长保持原位
+    QCOMPARE(faceCropSquare(cv::Rect(10, 10, 21, 21), 1.0f), cv::Rect(10, 10, 21, 21));
+    // 靠近画面边缘时不平移，超出部分留给复制边缘
+    QCOMPARE(faceCropSquare(cv::Rect(0, 0, 20, 20), 2.0f), cv::Rect(-10, -10, 40, 40));
+}
+
+void TestInferencePostprocess::faceScoresNormalized()
+{
+    // 已是概率：原样保留
+    float probs[] = {0.1f, 0.6f, 0.3f, 0.0f, 0.0f};
+    std::vector<float> scores(probs, probs + 5);
+    QCOMPARE(normalizeFaceScores(scores), 1);
+    for (int c = 0; c < 5; ++c)
+        QCOMPARE(scores[c], probs[c]);
+
+    // logit：softmax后和为1，相邻logit差1时概率比为e
+    float logits[] = {1.0f, 2.0f, 3.0f, 0.0f, -1.0f};
+    scores.assign(logits, logits + 5);
+    QCOMPARE(normalizeFaceScores(scores), 2);
+    float sum = 0.0f;
+    for (int c = 0; c < 5; ++c)
+        sum += scores[c];
+    QVERIFY(fabsf(sum - 1.0f) < 1e-5f);
+    QVERIFY(fabsf(scores[2] / scores[1] - expf(1.0f)) < 1e-4f);
+
+    // 都在0~1但和不为1、或含负数时也按logit处理
+    float loose[] = {0.9f, 0.8f, 0.0f, 0.0f, 0.0f};
+    scores.assign(loose, loose + 5);
+    QCOMPARE(normalizeFaceScores(scores), 0);
+    QVERIFY(scores[0] < 0.9f);
+    float negative[] = {1.1f, -0.1f, 0.0f, 0.0f, 0.0f};
+    scores.assign(negative, negative + 5);
+    QCOMPARE(normalizeFaceScores(scores), 0);
+    QVERIFY(scores[1] > 0.0f);
+
+    scores.clear();
+    QCOMPARE(normalizeFaceScores(scores), -1);
+}
+
+QTEST_APPLESS_MAIN(TestInferencePostprocess)
+#include "tst_inference_postprocess.moc"
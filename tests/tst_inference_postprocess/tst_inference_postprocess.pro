@@ -0,0 +1,4 @@
+TARGET = tst_inference_postprocess
+include(../tests.pri)
+
+SOURCES += tst_inference_postprocess.cpp
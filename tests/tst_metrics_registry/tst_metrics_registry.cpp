@@ -0,0 +1,194 @@
+#include <QtTest>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+#include "metrics_registry.h"
+#include "pipeline_latency.h"
+#include "command_arbiter.h"
+
+// 指标注册表：逐行核对Prometheus文本格式（HELP/TYPE分组、标签、数值格式、直方图累计桶）
+static std::vector<std::string> splitLines(const std::string &text)
+{
+    std::vector<std::string> lines;
+    size_t begin = 0;
+    while (begin < text.size()) {
+        size_t end = text.find('\n', begin);
+        if (end == std::string::npos)
+            end = text.size();
+        lines.push_back(text.substr(begin, end - begin));
+        begin = end + 1;
+    }
+    return lines;
+}
+
+static bool startsWith(const std::string &s, const std::string &prefix)
+{
+    return s.compare(0, prefix.size(), prefix) == 0;
+}
+
+// 取"name{...} value"中的value
+static double sampleValue(const std::string &line)
+{
+    return atof(line.c_str() + line.rfind(' ') + 1);
+}
+
+class TestMetricsRegistry : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void counterAndGauge();
+    void labelledSeriesShareHeader();
+    void readFunctionsAndNumberFormat();
+    void histogramIsCumulative();
+    void histogramOverflowOnlyInInf();
+    void summaryHasSumAndCount();
+};
+
+void TestMetricsRegistry::counterAndGauge()
+{
+    MetricsRegistry registry;
+    MetricCounter *frames = registry.counter("wheelchair_frames_total", "Frames captured");
+    MetricGauge *depth = registry.gauge("wheelchair_queue_depth", "Queue depth");
+    frames->inc();
+    frames->inc(2);
+    depth->set(7);
+    depth->add(-9);
+
+    std::string out;
+    registry.render(out);
+    QCOMPARE(out, std::string("# HELP wheelchair_frames_total Frames captured\n"
+                              "# TYPE wheelchair_frames_total counter\n"
+                              "wheelchair_frames_total 3\n"
+                              "# HELP wheelchair_queue_depth Queue depth\n"
+                              "# TYPE wheelchair_queue_depth gauge\n"
+                              "wheelchair_queue_depth -2\n"));
+
+    // render追加而不是覆盖
+    registry.render(out);
+    QCOMPARE(splitLines(out).size(), size_t(12));
+}
+
+void TestMetricsRegistry::labelledSeriesShareHeader()
+{
+    MetricsRegistry registry;
+    registry.counter("wheelchair_commands_total", "Commands sent", "source=\"auto\"")->inc(5);
+    registry.counter("wheelchair_commands_total", "Commands sent", "source=\"input\"")->inc(1);
+    registry.gauge("wheelchair_mode", "Arbiter mode")->set(2);
+
+    std::string out;
+    registry.render(out);
+    QCOMPARE(out, std::string("# HELP wheelchair_commands_total Commands sent\n"
+                              "# TYPE wheelchair_commands_total counter\n"
+                              "wheelchair_commands_total{source=\"auto\"} 5\n"
+                              "wheelchair_commands_total{source=\"input\"} 1\n"
+                              "# HELP wheelchair_mode Arbiter mode\n"
+                              "# TYPE wheelchair_mode gauge\n"
+                              "wheelchair_mode 2\n"));
+}
+
+void TestMetricsRegistry::readFunctionsAndNumberFormat()
+{
+    MetricsRegistry registry;
+    uint64_t external = 12;
+    registry.counterFn("ext_total", "External counter", [&external]() { return static_cast<double>(external); });
+    registry.gaugeFn("fraction", "Fraction", []() { return 0.125; });
+    registry.gaugeFn("third", "Third", []() { return 1.0 / 3.0; });
+    registry.gaugeFn("big", "Big integer", []() { return 1e15; });
+    external = 40;   // 导出时才读取
+
+    std::string out;
+    registry.render(out);
+    std::vector<std::string> lines = splitLines(out);
+    QCOMPARE(lines.size(), size_t(12));
+    QCOMPARE(lines[2], std::string("ext_total 40"));
+    QCOMPARE(lines[5], std::string("fraction 0.125"));
+    QCOMPARE(lines[8], std::string("third 0.333333333"));
+    // 整数值不用科学计数法
+    QCOMPARE(lines[11], std::string("big 1000000000000000"));
+}
+
+void TestMetricsRegistry::histogramIsCumulative()
+{
+    LatencyHistogram hist;
+    hist.record(500);        // 0us
+    hist.record(2000);       // 2us
+    hist.record(10000);      // 10us，落在[10, 11]us桶
+    hist.record(10500);
+    MetricsRegistry registry;
+    registry.histogram("wheelchair_latency_seconds", "Stage latency", &hist, "stage=\"infer\"");
+
+    std::string out;
+    registry.render(out);
+    std::vector<std::string> lines = splitLines(out);
+    QCOMPARE(lines[0], std::string("# HELP wheelchair_latency_seconds Stage latency"));
+    QCOMPARE(lines[1], std::string("# TYPE wheelchair_latency_seconds histogram"));
+    // 每个桶一行（最后一个溢出桶只体现在+Inf中），再加_sum与_count
+    QCOMPARE(lines.size(), size_t(2 + LatencyHistogram::kBuckets + 2));
+
+    // 桶上界为微秒上界+1，换算成秒
+    QCOMPARE(lines[2], std::string("wheelchair_latency_seconds_bucket{stage=\"infer\",le=\"1e-06\"} 1"));
+    QCOMPARE(lines[4], std::string("wheelchair_latency_seconds_bucket{stage=\"infer\",le=\"3e-06\"} 2"));
+
+    double lastLe = 0;
+    double lastCount = 0;
+    bool sawTenUs = false;
+    for (int i = 0; i < LatencyHistogram::kBuckets - 1; ++i) {
+        const std::string &line = lines[2 + i];
+        QVERIFY(startsWith(line, "wheelchair_latency_seconds_bucket{stage=\"infer\",le=\""));
+        double le = atof(line.c_str() + line.find("le=\"") + 4);
+        double count = sampleValue(line);
+        QVERIFY(le > lastLe);
+        QVERIFY(count >= lastCount);
+        if (line.find("le=\"1e-05\"") != std::string::npos)
+            QCOMPARE(count, 2.0);
+        if (line.find("le=\"1.2e-05\"") != std::string::npos) {
+            QCOMPARE(count, 4.0);
+            sawTenUs = true;
+        }
+        lastLe = le;
+        lastCount = count;
+    }
+    QVERIFY(sawTenUs);
+    size_t tail = 2 + LatencyHistogram::kBuckets - 1;
+    QCOMPARE(lines[tail], std::string("wheelchair_latency_seconds_bucket{stage=\"infer\",le=\"+Inf\"} 4"));
+    QCOMPARE(lines[tail + 1], std::string("wheelchair_latency_seconds_sum{stage=\"infer\"} 2.3e-05"));
+    QCOMPARE(lines[tail + 2], std::string("wheelchair_latency_seconds_count{stage=\"infer\"} 4"));
+}
+
+void TestMetricsRegistry::histogramOverflowOnlyInInf()
+{
+    LatencyHistogram hist;
+    hist.record(1000);
+    hist.record(200LL * 1000000000LL);   // 超出约67s的范围
+    MetricsRegistry registry;
+    registry.histogram("lat_seconds", "Latency", &hist);
+
+    std::string out;
+    registry.render(out);
+    std::vector<std::string> lines = splitLines(out);
+    size_t tail = 2 + LatencyHistogram::kBuckets - 1;
+    QCOMPARE(sampleValue(lines[tail - 1]), 1.0);
+    QCOMPARE(lines[tail], std::string("lat_seconds_bucket{le=\"+Inf\"} 2"));
+    QCOMPARE(lines[tail + 1], std::string("lat_seconds_sum 200.000001"));
+    QCOMPARE(lines[tail + 2], std::string("lat_seconds_count 2"));
+}
+
+void TestMetricsRegistry::summaryHasSumAndCount()
+{
+    LatencyCounter counter;
+    counter.record(2000000);
+    counter.record(4500000);
+    MetricsRegistry registry;
+    registry.summary("uart_write_seconds", "UART write time", &counter, "port=\"ttyS3\"");
+
+    std::string out;
+    registry.render(out);
+    QCOMPARE(out, std::string("# HELP uart_write_seconds UART write time\n"
+                              "# TYPE uart_write_seconds summary\n"
+                              "uart_write_seconds_sum{port=\"ttyS3\"} 0.0065\n"
+                              "uart_write_seconds_count{port=\"ttyS3\"} 2\n"));
+}
+
+QTEST_APPLESS_MAIN(TestMetricsRegistry)
+#include "tst_metrics_registry.moc"
@@ -0,0 +1,4 @@
+TARGET = tst_metrics_registry
+include(../tests.pri)
+
+SOURCES += tst_metrics_registry.cpp
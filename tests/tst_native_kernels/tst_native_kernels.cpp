@@ -0,0 +1,282 @@
+#include <QtTest>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+#include "native_kernels.h"
+
+// native后端计算内核：与双精度的朴素参考实现逐元素比对（相对误差），形状覆盖
+// 各种步长/padding/分组/空洞卷积、GEMM的M/N尾部、3x3逐通道专用内核的边界宽度
+static const double kTolerance = 2e-5;
+
+static float rnd()
+{
+    return (rand() / static_cast<float>(RAND_MAX)) * 2 - 1;
+}
+
+static double activate(double x, int act)
+{
+    if (act == ActSilu)
+        return x / (1 + exp(-x));
+    if (act == ActSigmoid)
+        return 1 / (1 + exp(-x));
+    if (act == ActRelu)
+        return x > 0 ? x : 0;
+    return x;
+}
+
+static double maxRelativeError(const std::vector<float> &got, const std::vector<double> &ref)
+{
+    double maxDiff = 0;
+    for (size_t i = 0; i < ref.size(); ++i)
+        maxDiff = fmax(maxDiff, fabs(got[i] - ref[i]) / (1 + fabs(ref[i])));
+    return maxDiff;
+}
+
+static NativeConvShape convShape(int inC, int h, int w, int outC, int k, int stride, int pad, int group, int dilation = 1)
+{
+    NativeConvShape s;
+    s.inC = inC;
+    s.inH = h;
+    s.inW = w;
+    s.outC = outC;
+    s.kernelH = s.kernelW = k;
+    s.strideH = s.strideW = stride;
+    s.padTop = s.padLeft = pad;
+    s.dilationH = s.dilationW = dilation;
+    s.group = group;
+    s.outH = (h + 2 * pad - dilation * (k - 1) - 1) / stride + 1;
+    s.outW = (w + 2 * pad - dilation * (k - 1) - 1) / stride + 1;
+    return s;
+}
+
+static void referenceConv(const NativeConvShape &s, const std::vector<float> &in, const std::vector<float> &w,
+                          const std::vector<float> &b, int act, std::vector<double> &out)
+{
+    int ig = s.inC / s.group;
+    int og = s.outC / s.group;
+    out.assign(static_cast<size_t>(s.outC) * s.outH * s.outW, 0);
+    for (int oc = 0; oc < s.outC; ++oc) {
+        int g = oc / og;
+        for (int oy = 0; oy < s.outH; ++oy) {
+            for (int ox = 0; ox < s.outW; ++ox) {
+                double sum = b.empty() ? 0 : b[oc];
+                for (int c = 0; c < ig; ++c) {
+                    for (int ky = 0; ky < s.kernelH; ++ky) {
+                        for (int kx = 0; kx < s.kernelW; ++kx) {
+                            int iy = oy * s.strideH - s.padTop + ky * s.dilationH;
+                            int ix = ox * s.strideW - s.padLeft + kx * s.dilationW;
+                            if (iy < 0 || iy >= s.inH || ix < 0 || ix >= s.inW)
+                                continue;
+                            sum += static_cast<double>(in[(static_cast<size_t>(g * ig + c) * s.inH + iy) * s.inW + ix]) *
+                                   w[((static_cast<size_t>(oc) * ig + c) * s.kernelH + ky) * s.kernelW + kx];
+                        }
+                    }
+                }
+                out[(static_cast<size_t>(oc) * s.outH + oy) * s.outW + ox] = activate(sum, act);
+            }
+        }
+    }
+}
+
+static double convError(const NativeConvShape &s, int act, bool bias)
+{
+    int ig = s.inC / s.group;
+    int og = s.outC / s.group;
+    int k = ig * s.kernelH * s.kernelW;
+    std::vector<float> in(static_cast<size_t>(s.inC) * s.inH * s.inW);
+    std::vector<float> w(static_cast<size_t>(s.outC) * k);
+    std::vector<float> b;
+    for (size_t i = 0; i < in.size(); ++i)
+        in[i] = rnd() * 3;
+    for (size_t i = 0; i < w.size(); ++i)
+        w[i] = rnd();
+    if (bias) {
+        b.resize(s.outC);
+        for (size_t i = 0; i < b.size(); ++i)
+            b[i] = rnd();
+    }
+
+    size_t groupFloats = nativePackedWeightsFloats(og, k);
+    std::vector<float> packed(groupFloats * s.group);
+    for (int g = 0; g < s.group; ++g)
+        nativePackWeights(w.data() + static_cast<size_t>(g) * og * k, og, k, packed.data() + g * groupFloats);
+    std::vector<float> scratch(nativeConvScratchFloats(s) + 1);
+    std::vector<float> out(static_cast<size_t>(s.outC) * s.outH * s.outW);
+    nativeConv(s, in.data(), packed.data(), bias ? b.data() : nullptr, act, out.data(), scratch.data());
+
+    std::vector<double> ref;
+    referenceConv(s, in, w, b, act, ref);
+    return maxRelativeError(out, ref);
+}
+
+static double depthwiseError(const NativeConvShape &s, int act)
+{
+    std::vector<float> in(static_cast<size_t>(s.inC) * s.inH * s.inW);
+    std::vector<float> w(static_cast<size_t>(s.outC) * s.kernelH * s.kernelW);
+    std::vector<float> b(s.outC);
+    for (size_t i = 0; i < in.size(); ++i)
+        in[i] = rnd() * 3;
+    for (size_t i = 0; i < w.size(); ++i)
+        w[i] = rnd();
+    for (size_t i = 0; i < b.size(); ++i)
+        b[i] = rnd();
+    std::vector<float> out(static_cast<size_t>(s.outC) * s.outH * s.outW);
+    nativeDepthwiseConv(s, in.data(), w.data(), b.data(), act, out.data());
+
+    std::vector<double> ref;
+    referenceConv(s, in, w, b, act, ref);
+    return maxRelativeError(out, ref);
+}
+
+class TestNativeKernels : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void conv();
+    void depthwiseConv();
+    void activations();
+    void binary();
+    void softmaxInPlace();
+};
+
+void TestNativeKernels::initTestCase()
+{
+    srand(1);
+}
+
+void TestNativeKernels::conv()
+{
+    struct Case { NativeConvShape shape; int act; bool bias; };
+    const Case cases[] = {
+        {convShape(3, 17, 19, 16, 3, 2, 1, 1), ActSilu, true},       // 首层：步长2，宽高为奇数
+        {convShape(8, 9, 9, 6, 1, 1, 0, 1), ActNone, true},          // 1x1直接GEMM，M不足4的倍数
+        {convShape(8, 10, 7, 12, 3, 1, 1, 2), ActSigmoid, false},    // 分组
+        {convShape(5, 6, 6, 3, 5, 1, 2, 1), ActRelu, true},
+        {convShape(16, 4, 21, 1, 1, 1, 0, 1), ActNone, false},       // 单输出通道
+        {convShape(7, 11, 13, 9, 3, 1, 2, 1, 2), ActSilu, true},     // 空洞
+        {convShape(32, 16, 16, 64, 3, 2, 1, 1), ActSilu, true},
+        {convShape(4, 3, 3, 5, 3, 2, 1, 1), ActSilu, true},          // 输出2x2，N尾部
+    };
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); ++i) {
+        const NativeConvShape &s = cases[i].shape;
+        double err = convError(s, cases[i].act, cases[i].bias);
+        char name[128];
+        snprintf(name, sizeof(name), "conv c%d %dx%d ->%d k%d s%d p%d g%d d%d act%d: %.3g", s.inC, s.inH, s.inW,
+                 s.outC, s.kernelH, s.strideH, s.padTop, s.group, s.dilationH, cases[i].act, err);
+        QVERIFY2(err < kTolerance, name);
+    }
+}
+
+void TestNativeKernels::depthwiseConv()
+{
+    std::vector<NativeConvShape> shapes;
+    std::vector<int> acts;
+    // 3x3专用内核：覆盖NEON主循环的各种尾部宽度
+    const int widths[] = {3, 4, 9, 13, 16, 17, 33};
+    for (size_t i = 0; i < sizeof(widths) / sizeof(widths[0]); ++i) {
+        int w = widths[i];
+        shapes.push_back(convShape(7, w + 1, w, 7, 3, 1, 1, 7));
+        acts.push_back(ActSilu);
+        shapes.push_back(convShape(7, w, w, 7, 3, 2, 1, 7));
+        acts.push_back(ActNone);
+    }
+    // 通用路径：5x5、无padding
+    shapes.push_back(convShape(5, 12, 12, 5, 5, 1, 2, 5));
+    acts.push_back(ActSilu);
+    shapes.push_back(convShape(5, 12, 12, 5, 3, 1, 0, 5));
+    acts.push_back(ActNone);
+    shapes.push_back(convShape(5, 12, 12, 5, 3, 2, 0, 5));
+    acts.push_back(ActNone);
+
+    for (size_t i = 0; i < shapes.size(); ++i) {
+        const NativeConvShape &s = shapes[i];
+        double err = depthwiseError(s, acts[i]);
+        char name[128];
+        snprintf(name, sizeof(name), "dw c%d %dx%d k%d s%d p%d act%d: %.3g", s.inC, s.inH, s.inW, s.kernelH,
+                 s.strideH, s.padTop, acts[i], err);
+        QVERIFY2(err < kTolerance, name);
+    }
+}
+
+void TestNativeKernels::activations()
+{
+    const int acts[] = {ActSilu, ActSigmoid, ActRelu};
+    for (size_t a = 0; a < sizeof(acts) / sizeof(acts[0]); ++a) {
+        // 长度不是向量宽度的倍数；含±100，检查exp不溢出
+        std::vector<float> x(1003);
+        std::vector<double> ref(x.size());
+        for (size_t i = 0; i < x.size(); ++i) {
+            x[i] = (i % 2 ? -1 : 1) * (i * 0.1f);
+            if (i == 5)
+                x[i] = -100;
+            if (i == 7)
+                x[i] = 100;
+            ref[i] = activate(x[i], acts[a]);
+        }
+        nativeActivate(x.data(), x.size(), acts[a]);
+        double err = maxRelativeError(x, ref);
+        char name[64];
+        snprintf(name, sizeof(name), "activation %d: %.3g", acts[a], err);
+        QVERIFY2(err < kTolerance, name);
+    }
+}
+
+void TestNativeKernels::binary()
+{
+    const int n = 37;
+    for (int op = BinaryAdd; op <= BinaryDiv; ++op) {
+        std::vector<float> a(n), b(n), out(n), outScalar(n);
+        std::vector<double> ref(n), refScalar(n);
+        for (int i = 0; i < n; ++i) {
+            a[i] = rnd() * 5;
+            b[i] = rnd() * 5 + (op == BinaryDiv ? 6 : 0);   // 除数远离0
+        }
+        for (int i = 0; i < n; ++i) {
+            double x = a[i];
+            double y = b[i];
+            ref[i] = op == BinaryAdd ? x + y : op == BinarySub ? x - y : op == BinaryMul ? x * y : x / y;
+            refScalar[i] = op == BinaryAdd ? 2.5 + y : op == BinarySub ? 2.5 - y : op == BinaryMul ? 2.5 * y : 2.5 / y;
+        }
+        nativeBinary(op, a.data(), b.data(), out.data(), n);
+        nativeBinaryScalar(op, 2.5f, b.data(), outScalar.data(), n, true);
+        char name[64];
+        double err = maxRelativeError(out, ref);
+        snprintf(name, sizeof(name), "binary %d: %.3g", op, err);
+        QVERIFY2(err < kTolerance, name);
+        err = maxRelativeError(outScalar, refScalar);
+        snprintf(name, sizeof(name), "binary scalar-first %d: %.3g", op, err);
+        QVERIFY2(err < kTolerance, name);
+    }
+}
+
+void TestNativeKernels::softmaxInPlace()
+{
+    // [3, 16, 5]在中间一维上归一化，输入输出同一缓冲
+    const int outer = 3;
+    const int axis = 16;
+    const int inner = 5;
+    std::vector<float> x(outer * axis * inner);
+    for (size_t i = 0; i < x.size(); ++i)
+        x[i] = rnd() * 10;
+    std::vector<double> ref(x.size());
+    for (int o = 0; o < outer; ++o) {
+        for (int i = 0; i < inner; ++i) {
+            double sum = 0;
+            for (int a = 0; a < axis; ++a)
+                sum += exp(x[(o * axis + a) * inner + i]);
+            for (int a = 0; a < axis; ++a)
+                ref[(o * axis + a) * inner + i] = exp(x[(o * axis + a) * inner + i]) / sum;
+        }
+    }
+    nativeSoftmax(x.data(), x.data(), outer, axis, inner);
+    double err = maxRelativeError(x, ref);
+    char name[64];
+    snprintf(name, sizeof(name), "softmax: %.3g", err);
+    QVERIFY2(err < kTolerance, name);
+}
+
+QTEST_APPLESS_MAIN(TestNativeKernels)
+#include "tst_native_kernels.moc"
@@ -0,0 +1,4 @@
+TARGET = tst_native_kernels
+include(../tests.pri)
+
+SOURCES += tst_native_kernels.cpp
@@ -0,0 +1,212 @@
+# 生成tst_native_model的测试数据：手写protobuf编码的小ONNX（覆盖native后端支持的全部算子与融合），
+# 用纯Python参考实现算出输出与若干中间结果；另生成一个含不支持算子（Gather）的模型。
+# 用法：python3 gen_model.py [输出目录，默认data]。随机种子固定，重新生成的结果不变
+import struct, random, math, itertools, sys, os
+random.seed(3)
+
+def varint(v):
+    if v < 0: v += 1 << 64
+    out = b''
+    while True:
+        b = v & 0x7f; v >>= 7
+        if v: out += bytes([b | 0x80])
+        else: return out + bytes([b])
+def key(f, w): return varint((f << 3) | w)
+def ld(f, payload):
+    if isinstance(payload, str): payload = payload.encode()
+    return key(f, 2) + varint(len(payload)) + payload
+def vi(f, v): return key(f, 0) + varint(v)
+def f32(f, v): return key(f, 5) + struct.pack('<f', v)
+
+# ---- tensor lib ----
+class T:
+    def __init__(s, shape, data): s.shape = list(shape); s.data = list(data); assert len(s.data) == prod(shape), (shape, len(data))
+def prod(s):
+    p = 1
+    for d in s: p *= d
+    return p
+def strides(shape):
+    st = [1] * len(shape)
+    for i in range(len(shape) - 2, -1, -1): st[i] = st[i + 1] * shape[i + 1]
+    return st
+def idx(shape, i): return sum(a * b for a, b in zip(i, strides(shape)))
+def rnd(shape, scale=1.0): return T(shape, [random.uniform(-1, 1) * scale for _ in range(prod(shape))])
+
+def conv(x, w, b, stride, pad, group, dil=1):
+    N, C, H, W = x.shape; M, cg, kh, kw = w.shape
+    oh = (H + 2 * pad - dil * (kh - 1) - 1) // stride + 1; ow = (W + 2 * pad - dil * (kw - 1) - 1) // stride + 1
+    out = [0.0] * (M * oh * ow); og = M // group
+    for m in range(M):
+        g = m // og
+        for oy in range(oh):
+            for ox in range(ow):
+                s = b.data[m] if b else 0.0
+                for c in range(cg):
+                    for ky in range(kh):
+                        iy = oy * stride - pad + ky * dil
+                        if iy < 0 or iy >= H: continue
+                        for kx in range(kw):
+                            ix = ox * stride - pad + kx * dil
+                            if ix < 0 or ix >= W: continue
+                            s += x.data[((g * cg + c) * H + iy) * W + ix] * w.data[((m * cg + c) * kh + ky) * kw + kx]
+                out[(m * oh + oy) * ow + ox] = s
+    return T([1, M, oh, ow], out)
+def unary(x, f): return T(x.shape, [f(v) for v in x.data])
+def sig(v): return 1 / (1 + math.exp(-v))
+def bshape(a, b):
+    r = max(len(a), len(b)); a = [1] * (r - len(a)) + a; b = [1] * (r - len(b)) + b
+    return [max(p, q) for p, q in zip(a, b)], a, b
+def binary(x, y, f):
+    shape, sa, sb = bshape(x.shape, y.shape); out = []
+    for i in itertools.product(*[range(d) for d in shape]):
+        ia = [v if d > 1 else 0 for v, d in zip(i, sa)]; ib = [v if d > 1 else 0 for v, d in zip(i, sb)]
+        out.append(f(x.data[idx(sa, ia)], y.data[idx(sb, ib)]))
+    return T(shape, out)
+def transpose(x, perm):
+    shape = [x.shape[p] for p in perm]; out = []
+    for i in itertools.product(*[range(d) for d in shape]):
+        src = [0] * len(perm)
+        for d, p in enumerate(perm): src[p] = i[d]
+        out.append(x.data[idx(x.shape, src)])
+    return T(shape, out)
+def concat(xs, axis):
+    shape = list(xs[0].shape); shape[axis] = sum(x.shape[axis] for x in xs); out = []
+    for i in itertools.product(*[range(d) for d in shape]):
+        a = i[axis]
+        for x in xs:
+            if a < x.shape[axis]:
+                j = list(i); j[axis] = a; out.append(x.data[idx(x.shape, j)]); break
+            a -= x.shape[axis]
+    return T(shape, out)
+def slice_(x, axis, start, length, step):
+    shape = list(x.shape); shape[axis] = length; out = []
+    for i in itertools.product(*[range(d) for d in shape]):
+        j = list(i); j[axis] = start + i[axis] * step; out.append(x.data[idx(x.shape, j)])
+    return T(shape, out)
+def maxpool(x, k, s, p):
+    N, C, H, W = x.shape; oh = (H + 2 * p - k) // s + 1; ow = (W + 2 * p - k) // s + 1; out = []
+    for c in range(C):
+        for oy in range(oh):
+            for ox in range(ow):
+                out.append(max(x.data[(c * H + y) * W + xx] for y in range(max(oy * s - p, 0), min(oy * s - p + k, H)) for xx in range(max(ox * s - p, 0), min(ox * s - p + k, W))))
+    return T([N, C, oh, ow], out)
+def upsample2(x):
+    N, C, H, W = x.shape; out = []
+    for c in range(C):
+        for y in range(2 * H):
+            for xx in range(2 * W): out.append(x.data[(c * H + y // 2) * W + xx // 2])
+    return T([N, C, 2 * H, 2 * W], out)
+def softmax(x, axis):
+    axis %= len(x.shape); out = list(x.data); st = strides(x.shape)
+    for i in itertools.product(*[range(d) if a != axis else range(1) for a, d in enumerate(x.shape)]):
+        ids = [idx(x.shape, list(i[:axis]) + [k] + list(i[axis + 1:])) for k in range(x.shape[axis])]
+        m = max(x.data[j] for j in ids); e = [math.exp(x.data[j] - m) for j in ids]; s = sum(e)
+        for j, v in zip(ids, e): out[j] = v / s
+    return T(x.shape, out)
+def matmul(a, b):
+    M, K = a.shape[-2:]; N = b.shape[-1]; batch = a.shape[:-2] if prod(a.shape[:-2]) >= prod(b.shape[:-2]) else b.shape[:-2]
+    nb = prod(batch); ba = prod(a.shape[:-2]); bb = prod(b.shape[:-2]); out = []
+    for bi in range(nb):
+        oa = (bi if ba > 1 else 0) * M * K; ob = (bi if bb > 1 else 0) * K * N
+        for i in range(M):
+            for j in range(N): out.append(sum(a.data[oa + i * K + p] * b.data[ob + p * N + j] for p in range(K)))
+    return T(list(batch) + [M, N], out)
+
+# ---- graph builder ----
+nodes = []; inits = []; vals = {}
+def tensor_proto(name, t, dtype=1):
+    body = b''.join(vi(1, d) for d in t.shape) + vi(2, dtype) + ld(8, name)
+    if dtype == 1: body += ld(9, struct.pack('<%df' % len(t.data), *t.data))
+    else: body += ld(9, struct.pack('<%dq' % len(t.data), *[int(v) for v in t.data]))
+    return body
+def init(name, t, dtype=1):
+    inits.append(tensor_proto(name, t, dtype)); vals[name] = t; return name
+def attr_i(n, v): return ld(1, n) + vi(3, v) + vi(20, 2)
+def attr_f(n, v): return ld(1, n) + f32(2, v) + vi(20, 1)
+def attr_ints(n, vs): return ld(1, n) + b''.join(vi(8, v) for v in vs) + vi(20, 7)
+def attr_s(n, s): return ld(1, n) + ld(4, s) + vi(20, 3)
+def attr_t(n, t): return ld(1, n) + ld(5, t) + vi(20, 4)
+def node(op, ins, outs, name, attrs=()):
+    nodes.append(b''.join(ld(1, i) for i in ins) + b''.join(ld(2, o) for o in outs) + ld(3, name) + ld(4, op) + b''.join(ld(5, a) for a in attrs))
+
+x = rnd([1, 3, 16, 16], 2.0); vals['images'] = x
+
+# 1 Conv + BN + SiLU
+w0 = init('w0', rnd([8, 3, 3, 3], 0.5)); b0 = init('b0', rnd([8]))
+node('Conv', ['images', 'w0', 'b0'], ['c0'], 'conv0', [attr_ints('kernel_shape', [3, 3]), attr_ints('strides', [2, 2]), attr_ints('pads', [1, 1, 1, 1]), attr_i('group', 1)])
+c0 = conv(x, vals['w0'], vals['b0'], 2, 1, 1)
+g = init('bn_g', T([8], [random.uniform(0.5, 1.5) for _ in range(8)])); bb = init('bn_b', rnd([8])); mu = init('bn_m', rnd([8])); var = init('bn_v', T([8], [random.uniform(0.5, 2) for _ in range(8)]))
+node('BatchNormalization', ['c0', 'bn_g', 'bn_b', 'bn_m', 'bn_v'], ['bn0'], 'bn0', [attr_f('epsilon', 1e-3)])
+bn0 = T(c0.shape, [(c0.data[i] - vals['bn_m'].data[i // 64]) / math.sqrt(vals['bn_v'].data[i // 64] + 1e-3) * vals['bn_g'].data[i // 64] + vals['bn_b'].data[i // 64] for i in range(len(c0.data))])
+node('Sigmoid', ['bn0'], ['s0'], 'sig0'); node('Mul', ['bn0', 's0'], ['a0'], 'mul0')
+a0 = unary(bn0, lambda v: v * sig(v))
+# 2 depthwise + SiLU（Mul操作数顺序反过来）
+init('wd', rnd([8, 1, 3, 3])); init('bd', rnd([8]))
+node('Conv', ['a0', 'wd', 'bd'], ['d1'], 'dw1', [attr_ints('kernel_shape', [3, 3]), attr_ints('pads', [1, 1, 1, 1]), attr_i('group', 8)])
+d1 = conv(a0, vals['wd'], vals['bd'], 1, 1, 8)
+node('Sigmoid', ['d1'], ['d1s'], 'sig1'); node('Mul', ['d1s', 'd1'], ['a1'], 'mul1')
+a1 = unary(d1, lambda v: v * sig(v))
+# 3 Split + MaxPool + Concat
+init('split_sizes', T([2], [4, 4]), 7)
+node('Split', ['a1', 'split_sizes'], ['p', 'q'], 'split', [attr_i('axis', 1)])
+p = slice_(a1, 1, 0, 4, 1); q = slice_(a1, 1, 4, 4, 1)
+node('MaxPool', ['q'], ['m'], 'pool', [attr_ints('kernel_shape', [5, 5]), attr_ints('strides', [1, 1]), attr_ints('pads', [2, 2, 2, 2])])
+m = maxpool(q, 5, 1, 2)
+node('Concat', ['p', 'm', 'a0'], ['cat'], 'cat', [attr_i('axis', 1)])
+cat = concat([p, m, a0], 1)
+# 4 1x1 Conv + Sigmoid（融合）, Resize x2, 广播Add
+init('w2', rnd([6, 16, 1, 1], 0.5))
+node('Conv', ['cat', 'w2'], ['e'], 'conv2', [attr_ints('kernel_shape', [1, 1])])
+e = conv(cat, vals['w2'], None, 1, 0, 1)
+node('Sigmoid', ['e'], ['es'], 'sig2'); es = unary(e, sig)
+init('scales', T([4], [1, 1, 2, 2]))
+node('Resize', ['es', '', 'scales'], ['r'], 'resize', [attr_s('mode', 'nearest'), attr_s('coordinate_transformation_mode', 'asymmetric'), attr_s('nearest_mode', 'floor')])
+r = upsample2(es)
+init('chan_bias', rnd([6, 1, 1]))
+node('Add', ['r', 'chan_bias'], ['ra'], 'addc'); ra = binary(r, vals['chan_bias'], lambda a, b: a + b)
+# 5 Reshape + Transpose + Softmax + MatMul(常量)
+init('shape1', T([3], [1, 6, -1]), 7)
+node('Reshape', ['ra', 'shape1'], ['rs'], 'reshape1'); rs = T([1, 6, 256], ra.data)
+node('Transpose', ['rs'], ['tr'], 'transpose1', [attr_ints('perm', [0, 2, 1])]); tr = transpose(rs, [0, 2, 1])
+node('Softmax', ['tr'], ['sm'], 'softmax1', [attr_i('axis', -1)]); sm = softmax(tr, -1)
+init('wm', rnd([6, 4]))
+node('MatMul', ['sm', 'wm'], ['mm'], 'matmul1'); mm = matmul(sm, vals['wm'])
+# 6 Slice（含步长）、Div、常量折叠、Sub、独立Sigmoid
+init('st', T([2], [0, 1]), 7); init('en', T([2], [2, 1000]), 7); init('ax', T([2], [2, 1]), 7); init('sp', T([2], [1, 3]), 7)
+node('Slice', ['mm', 'st', 'en', 'ax', 'sp'], ['sl'], 'slice1')
+sl = slice_(slice_(mm, 2, 0, 2, 1), 1, 1, 85, 3)
+init('two', T([], [2.0]))
+node('Div', ['sl', 'two'], ['dv'], 'div1'); dv = unary(sl, lambda v: v / 2)
+init('ka', rnd([85, 1])); init('kb', rnd([1, 2]))
+node('Mul', ['ka', 'kb'], ['kab'], 'constmul'); kab = binary(vals['ka'], vals['kb'], lambda a, b: a * b)
+node('Sub', ['dv', 'kab'], ['sb'], 'sub1'); sb = binary(dv, kab, lambda a, b: a - b)
+node('Sigmoid', ['sb'], ['out1'], 'sig_out'); out1 = unary(sb, sig)
+# 7 注意力式的batch MatMul + Relu
+init('shape2', T([4], [1, 2, 4, 64]), 7)
+node('Reshape', ['a0', 'shape2'], ['qk'], 'reshape2'); qk = T([1, 2, 4, 64], a0.data)
+node('Transpose', ['qk'], ['qkt'], 'transpose2', [attr_ints('perm', [0, 1, 3, 2])]); qkt = transpose(qk, [0, 1, 3, 2])
+node('MatMul', ['qk', 'qkt'], ['att'], 'matmul2'); att = matmul(qk, qkt)
+node('Relu', ['att'], ['out2'], 'relu2'); out2 = unary(att, lambda v: max(v, 0.0))
+
+def vinfo(name, shape): return ld(1, name) + ld(2, ld(1, vi(1, 1) + ld(2, b''.join(ld(1, vi(1, d)) for d in shape))))
+def model_bytes(graph_nodes, graph_inits, inputs, outputs):
+    graph = b''.join(ld(1, n) for n in graph_nodes) + ld(2, 'test') + b''.join(ld(5, t) for t in graph_inits) + \
+        b''.join(ld(11, vinfo(n, s)) for n, s in inputs) + b''.join(ld(12, vinfo(n, s)) for n, s in outputs)
+    return vi(1, 8) + ld(7, graph) + ld(8, ld(1, '') + vi(2, 13))
+
+out_dir = sys.argv[1] if len(sys.argv) > 1 else os.path.join(os.path.dirname(os.path.abspath(__file__)), 'data')
+os.makedirs(out_dir, exist_ok=True)
+def write(fn, data): open(os.path.join(out_dir, fn), 'wb').write(data)
+def dump(fn, t): write(fn, struct.pack('<%df' % len(t.data), *t.data))
+
+write('model.onnx', model_bytes(nodes, inits, [('images', [1, 3, 16, 16])], [('out1', out1.shape), ('out2', out2.shape), ('mm', mm.shape)]))
+dump('input.bin', x)
+for n, t in [('out1', out1), ('out2', out2), ('mm', mm), ('a0', a0), ('a1', a1), ('cat', cat), ('es', es), ('sm', sm), ('m', m)]:
+    dump(n + '.ref', t); print(n, t.shape)
+
+# 不支持的算子：Conv之后接Gather（未化简的导出模型常见），打包应失败并给出算子名
+nodes = []; inits = []
+init('w0', vals['w0']); init('b0', vals['b0']); init('indices', T([2], [0, 1]), 7)
+node('Conv', ['images', 'w0', 'b0'], ['c0'], 'conv0', [attr_ints('kernel_shape', [3, 3]), attr_ints('strides', [2, 2]), attr_ints('pads', [1, 1, 1, 1]), attr_i('group', 1)])
+node('Gather', ['c0', 'indices'], ['g0'], 'gather0', [attr_i('axis', 1)])
+write('unsupported.onnx', model_bytes(nodes, inits, [('images', [1, 3, 16, 16])], [('g0', [1, 2, 8, 8])]))
@@ -0,0 +1,258 @@
+#include <QtTest>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <string>
+#include <vector>
+#include "native_model.h"
+
+// native后端的整模型：data/下由gen_model.py手写的小ONNX（覆盖全部支持的算子与融合）与Python参考结果。
+// load()会在ONNX旁写.wcm，所以每个用例先把模型拷到临时目录
+static const cv::Size kInputSize(16, 16);
+static const double kTolerance = 1e-4;
+
+static std::vector<char> readBytes(const std::string &file)
+{
+    std::vector<char> bytes;
+    FILE *fp = fopen(file.c_str(), "rb");
+    if (!fp)
+        return bytes;
+    char buffer[4096];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), fp)) > 0)
+        bytes.insert(bytes.end(), buffer, buffer + n);
+    fclose(fp);
+    return bytes;
+}
+
+static std::vector<float> readFloats(const std::string &file)
+{
+    std::vector<char> bytes = readBytes(file);
+    std::vector<float> values(bytes.size() / sizeof(float));
+    if (!values.empty())
+        memcpy(values.data(), bytes.data(), values.size() * sizeof(float));
+    return values;
+}
+
+static bool writeBytes(const std::string &file, const char *data, size_t size)
+{
+    FILE *fp = fopen(file.c_str(), "wb");
+    if (!fp)
+        return false;
+    bool ok = fwrite(data, 1, size, fp) == size;
+    return fclose(fp) == 0 && ok;
+}
+
+class TestNativeModel : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void init();
+    void cleanup();
+    void outputsMatchReference();
+    void intermediatesMatchReference();
+    void packedImageIsReused();
+    void staleImageIsRepacked();
+    void truncatedOnnxRejected();
+    void unsupportedOpRejected();
+
+private:
+    std::string copyModel(const char *name, size_t truncate = 0);
+    // 按张量名与参考结果比对；返回比对过的张量个数，出错时在failure中给出原因
+    int compareTensors(const NativeModel &model, const char *const *names, int count, std::string &failure);
+
+    std::string dataDir;
+    std::string workDir;
+    std::vector<float> input;
+};
+
+void TestNativeModel::initTestCase()
+{
+    dataDir = TEST_DATA_DIR;
+    input = readFloats(dataDir + "/input.bin");
+    QCOMPARE(input.size(), size_t(3 * kInputSize.width * kInputSize.height));
+}
+
+void TestNativeModel::init()
+{
+    char pattern[] = "/tmp/tst_native_model_XXXXXX";
+    QVERIFY(mkdtemp(pattern) != nullptr);
+    workDir = pattern;
+}
+
+void TestNativeModel::cleanup()
+{
+    const char *files[] = {"model.onnx", "model.wcm", "model.wcm.tmp", "unsupported.onnx", "unsupported.wcm"};
+    for (size_t i = 0; i < sizeof(files) / sizeof(files[0]); ++i)
+        unlink((workDir + "/" + files[i]).c_str());
+    rmdir(workDir.c_str());
+}
+
+std::string TestNativeModel::copyModel(const char *name, size_t truncate)
+{
+    std::vector<char> bytes = readBytes(dataDir + "/" + name);
+    if (truncate && truncate < bytes.size())
+        bytes.resize(truncate);
+    std::string target = workDir + "/" + name;
+    if (bytes.empty() || !writeBytes(target, bytes.data(), bytes.size()))
+        return std::string();
+    return target;
+}
+
+int TestNativeModel::compareTensors(const NativeModel &model, const char *const *names, int count,
+                                    std::string &failure)
+{
+    int compared = 0;
+    for (int k = 0; k < count; ++k) {
+        int index = -1;
+        for (int i = 0; i < model.tensorCount(); ++i) {
+            if (strcmp(model.name(model.tensorDesc(i).nameOffset), names[k]) == 0)
+                index = i;
+        }
+        if (index < 0) {
+            failure = std::string("找不到张量 ") + names[k];
+            return compared;
+        }
+        std::vector<float> ref = readFloats(dataDir + "/" + names[k] + ".ref");
+        const NativeTensorDesc &desc = model.tensorDesc(index);
+        if (ref.empty() || desc.bytes != ref.size() * sizeof(float)) {
+            failure = std::string("大小不符 ") + names[k];
+            return compared;
+        }
+        cv::Mat mat = model.tensor(index);
+        const float *data = reinterpret_cast<const float *>(mat.data);
+        double maxDiff = 0;
+        for (size_t i = 0; i < ref.size(); ++i)
+            maxDiff = fmax(maxDiff, fabs(data[i] - ref[i]));
+        if (!(maxDiff < kTolerance)) {
+            char buffer[96];
+            snprintf(buffer, sizeof(buffer), "%s 最大误差 %.3g", names[k], maxDiff);
+            failure = buffer;
+            return compared;
+        }
+        ++compared;
+    }
+    return compared;
+}
+
+void TestNativeModel::outputsMatchReference()
+{
+    std::string onnx = copyModel("model.onnx");
+    QVERIFY(!onnx.empty());
+    NativeModel model;
+    std::string error;
+    QVERIFY2(model.load(onnx, kInputSize, false, error), error.c_str());
+    QCOMPARE(model.outputCount(), 3);
+    QCOMPARE(model.repackReason(), std::string("不存在"));
+    QCOMPARE(model.packedPath(), workDir + "/model.wcm");
+
+    // 跑两遍：arena复用不能让第二次的结果依赖第一次残留的数据
+    const char *outputs[] = {"out1", "out2", "mm"};
+    for (int round = 0; round < 2; ++round) {
+        QVERIFY(model.run(input.data()));
+        std::string failure;
+        QVERIFY2(compareTensors(model, outputs, 3, failure) == 3, failure.c_str());
+    }
+}
+
+void TestNativeModel::intermediatesMatchReference()
+{
+    std::string onnx = copyModel("model.onnx");
+    QVERIFY(!onnx.empty());
+    NativeModel model;
+    std::string error;
+    QVERIFY2(model.load(onnx, kInputSize, true, error), error.c_str());
+    QVERIFY(model.run(input.data()));
+
+    // 融合后的SiLU卷积、逐通道卷积、Split+MaxPool+Concat、1x1卷积+Sigmoid、Softmax
+    const char *names[] = {"a0", "a1", "m", "cat", "es", "sm", "out1", "out2", "mm"};
+    const int count = sizeof(names) / sizeof(names[0]);
+    std::string failure;
+    QVERIFY2(compareTensors(model, names, count, failure) == count, failure.c_str());
+}
+
+void TestNativeModel::packedImageIsReused()
+{
+    std::string onnx = copyModel("model.onnx");
+    QVERIFY(!onnx.empty());
+    std::string error;
+    {
+        NativeModel first;
+        QVERIFY2(first.load(onnx, kInputSize, false, error), error.c_str());
+        QVERIFY(!first.repackReason().empty());
+    }
+    QVERIFY(access((workDir + "/model.wcm").c_str(), R_OK) == 0);
+
+    NativeModel second;
+    QVERIFY2(second.load(onnx, kInputSize, false, error), error.c_str());
+    QVERIFY(second.repackReason().empty());
+    QVERIFY(second.run(input.data()));
+    const char *outputs[] = {"out1", "out2", "mm"};
+    std::string failure;
+    QVERIFY2(compareTensors(second, outputs, 3, failure) == 3, failure.c_str());
+}
+
+void TestNativeModel::staleImageIsRepacked()
+{
+    std::string onnx = copyModel("model.onnx");
+    QVERIFY(!onnx.empty());
+    std::string error;
+    NativeModel model;
+    QVERIFY2(model.load(onnx, kInputSize, false, error), error.c_str());
+
+    // ONNX修改时间变化
+    struct stat st;
+    QVERIFY(stat(onnx.c_str(), &st) == 0);
+    struct timeval times[2] = {{st.st_atime, 0}, {st.st_mtime + 100, 0}};
+    QVERIFY(utimes(onnx.c_str(), times) == 0);
+    QVERIFY2(model.load(onnx, kInputSize, false, error), error.c_str());
+    QCOMPARE(model.repackReason(), std::string("ONNX已更新"));
+
+    // .wcm损坏（截断到只剩文件头）
+    std::vector<char> image = readBytes(workDir + "/model.wcm");
+    QVERIFY(image.size() > sizeof(NativeModelHeader));
+    QVERIFY(writeBytes(workDir + "/model.wcm", image.data(), sizeof(NativeModelHeader)));
+    QVERIFY2(model.load(onnx, kInputSize, false, error), error.c_str());
+    QVERIFY(!model.repackReason().empty());
+    QVERIFY(model.run(input.data()));
+    const char *outputs[] = {"out1", "out2", "mm"};
+    std::string failure;
+    QVERIFY2(compareTensors(model, outputs, 3, failure) == 3, failure.c_str());
+
+    // 固定输入尺寸的ONNX不能按其他尺寸打包
+    QVERIFY(!model.load(onnx, cv::Size(32, 32), false, error));
+    QVERIFY2(error.find("不一致") != std::string::npos, error.c_str());
+}
+
+void TestNativeModel::truncatedOnnxRejected()
+{
+    std::string onnx = copyModel("model.onnx", 3000);
+    QVERIFY(!onnx.empty());
+    NativeModel model;
+    std::string error;
+    QVERIFY(!model.load(onnx, kInputSize, false, error));
+    QVERIFY(!error.empty());
+    QVERIFY(!model.isLoaded());
+    QVERIFY(access((workDir + "/model.wcm").c_str(), F_OK) != 0);
+}
+
+void TestNativeModel::unsupportedOpRejected()
+{
+    std::string onnx = copyModel("unsupported.onnx");
+    QVERIFY(!onnx.empty());
+    NativeModel model;
+    std::string error;
+    QVERIFY(!model.load(onnx, kInputSize, false, error));
+    // 错误信息要带出算子名，方便定位需要化简的子图
+    QVERIFY2(error.find("Gather") != std::string::npos, error.c_str());
+    QVERIFY(!model.isLoaded());
+}
+
+QTEST_APPLESS_MAIN(TestNativeModel)
+#include "tst_native_model.moc"
@@ -0,0 +1,7 @@
+TARGET = tst_native_model
+include(../tests.pri)
+
+# 测试数据由gen_model.py生成（ONNX + 参考输出），直接从源码目录读取
+DEFINES += TEST_DATA_DIR=\\\"$$PWD/data\\\"
+
+SOURCES += tst_native_model.cpp
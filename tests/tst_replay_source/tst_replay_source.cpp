@@ -0,0 +1,281 @@
+#include <QtTest>
+#include <opencv2/imgcodecs.hpp>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+#include "replay_source.h"
+#include "inference.h"
+#include "command_arbiter.h"
+
+// 黑匣子转储回放：按FlightRecorder的文件布局手工拼一份转储，核对解析、送帧顺序与逐帧比对计数
+static const int64_t kMs = 1000000;
+
+// 转储内容：文件头 | 事件 | (帧头 + JPEG)...
+struct DumpBuilder
+{
+    std::vector<FlightEvent> events;
+    std::vector<char> frames;
+    uint32_t frameCount;
+
+    DumpBuilder() : frameCount(0) {}
+
+    void detection(uint32_t frameId, int classId, float confidence)
+    {
+        FlightEvent ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.type = FlightDetection;
+        ev.frameId = frameId;
+        ev.classId = classId;
+        ev.confidence = confidence;
+        events.push_back(ev);
+    }
+
+    void command(uint32_t frameId, char cmd, int source)
+    {
+        FlightEvent ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.type = FlightCommand;
+        ev.frameId = frameId;
+        ev.cmd = cmd;
+        ev.source = static_cast<uint8_t>(source);
+        events.push_back(ev);
+    }
+
+    void frame(uint32_t frameId, int64_t captureNs, const std::vector<uchar> &jpeg)
+    {
+        FlightFrameHeader fh;
+        memset(&fh, 0, sizeof(fh));
+        fh.frameId = frameId;
+        fh.tCaptureNs = captureNs;
+        fh.length = static_cast<uint32_t>(jpeg.size());
+        const char *p = reinterpret_cast<const char *>(&fh);
+        frames.insert(frames.end(), p, p + sizeof(fh));
+        frames.insert(frames.end(), jpeg.begin(), jpeg.end());
+        frameCount++;
+    }
+
+    std::vector<char> bytes() const
+    {
+        FlightDumpHeader header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, "WCFLIGHT", 8);
+        header.version = 1;
+        header.reason = TriggerManual;
+        header.eventCount = static_cast<uint32_t>(events.size());
+        header.frameCount = frameCount;
+        header.eventSize = sizeof(FlightEvent);
+        std::vector<char> out(reinterpret_cast<const char *>(&header),
+                              reinterpret_cast<const char *>(&header) + sizeof(header));
+        if (!events.empty())
+            out.insert(out.end(), reinterpret_cast<const char *>(events.data()),
+                       reinterpret_cast<const char *>(events.data() + events.size()));
+        out.insert(out.end(), frames.begin(), frames.end());
+        return out;
+    }
+};
+
+static std::vector<uchar> encodeJpeg(int gray)
+{
+    std::vector<uchar> jpeg;
+    cv::imencode(".jpg", cv::Mat(8, 8, CV_8UC3, cv::Scalar(gray, gray, gray)), jpeg);
+    return jpeg;
+}
+
+static DetectionResult result(uint32_t frameId, int classId)
+{
+    DetectionResult r;
+    r.frame_id = frameId;
+    if (classId >= 0) {
+        r.count = 1;
+        r.detections[0].class_id = classId;
+        r.detections[0].confidence = 0.9f;
+    }
+    return r;
+}
+
+class TestReplaySource : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+    void rejectsInvalidDumps();
+    void indexesRecordedInference();
+    void framesReplayInRecordedOrder();
+    void truncatedFrameIsDropped();
+    void compareCountsMismatches();
+
+private:
+    std::string writeDump(const std::vector<char> &bytes);
+    DumpBuilder standardDump();
+
+    std::string dumpPath;
+};
+
+void TestReplaySource::init()
+{
+    char pattern[] = "/tmp/tst_replay_source_XXXXXX";
+    int fd = mkstemp(pattern);
+    QVERIFY(fd >= 0);
+    close(fd);
+    dumpPath = pattern;
+}
+
+void TestReplaySource::cleanup()
+{
+    unlink(dumpPath.c_str());
+}
+
+std::string TestReplaySource::writeDump(const std::vector<char> &bytes)
+{
+    FILE *fp = fopen(dumpPath.c_str(), "wb");
+    if (!fp)
+        return std::string();
+    fwrite(bytes.data(), 1, bytes.size(), fp);
+    fclose(fp);
+    return dumpPath;
+}
+
+// 帧10/20/30；推理了10和30，10的自动指令被录制，手动指令与无帧号的指令不参与比对
+DumpBuilder TestReplaySource::standardDump()
+{
+    DumpBuilder dump;
+    dump.detection(10, 2, 0.8f);
+    dump.command(10, 'F', SourceAuto);
+    dump.detection(30, 4, 0.6f);
+    dump.command(30, 'L', SourceInput);
+    dump.command(0, 'R', SourceAuto);
+    dump.frame(10, 1000 * kMs, encodeJpeg(40));
+    dump.frame(20, 1033 * kMs, encodeJpeg(120));
+    dump.frame(30, 1066 * kMs, encodeJpeg(200));
+    return dump;
+}
+
+void TestReplaySource::rejectsInvalidDumps()
+{
+    ReplaySource missing("/nonexistent/flight.bin", ReplayLockstep);
+    QVERIFY(!missing.open());
+    QVERIFY(!missing.errorString().empty());
+
+    std::vector<char> bytes = standardDump().bytes();
+    std::vector<char> badMagic = bytes;
+    badMagic[0] = 'X';
+    ReplaySource source(writeDump(badMagic), ReplayLockstep);
+    QVERIFY(!source.open());
+    QVERIFY(!source.isOpened());
+
+    // 事件区不完整
+    bytes.resize(sizeof(FlightDumpHeader) + sizeof(FlightEvent));
+    ReplaySource truncated(writeDump(bytes), ReplayLockstep);
+    QVERIFY(!truncated.open());
+
+    // 没有帧（录制时未开原始MJPEG）
+    DumpBuilder noFrames;
+    noFrames.detection(1, 0, 0.5f);
+    ReplaySource empty(writeDump(noFrames.bytes()), ReplayLockstep);
+    QVERIFY(!empty.open());
+}
+
+void TestReplaySource::indexesRecordedInference()
+{
+    ReplaySource source(writeDump(standardDump().bytes()), ReplayLockstep);
+    QVERIFY2(source.open(), source.errorString().c_str());
+    QCOMPARE(source.frameCount(), size_t(3));
+    QVERIFY(source.hasRecordedInference());
+    QVERIFY(source.wasInferred(10));
+    QVERIFY(!source.wasInferred(20));
+    QVERIFY(source.wasInferred(30));
+    QCOMPARE(source.nextFrameDelayMs(), 0);
+}
+
+void TestReplaySource::framesReplayInRecordedOrder()
+{
+    DumpBuilder dump = standardDump();
+    ReplaySource source(writeDump(dump.bytes()), ReplayLockstep);
+    QVERIFY(source.open());
+
+    const uint32_t ids[] = {10, 20, 30};
+    std::vector<uchar> first = encodeJpeg(40);
+    for (int i = 0; i < 3; ++i) {
+        QVERIFY(!source.atEnd());
+        CapturedFrame frame;
+        QVERIFY(source.read(frame));
+        QCOMPARE(frame.frameId, ids[i]);
+        QCOMPARE(frame.bgr.cols, 8);
+        QCOMPARE(frame.bgr.rows, 8);
+        QVERIFY(frame.captureNs > 0);
+        if (i == 0) {
+            // 原样交出录制的JPEG，且不引用回放的内部缓冲
+            QCOMPARE(frame.jpeg.total(), first.size());
+            QVERIFY(memcmp(frame.jpeg.data, first.data(), first.size()) == 0);
+        }
+    }
+    QCOMPARE(source.framePosition(), size_t(3));
+    QVERIFY(source.atEnd());
+    CapturedFrame frame;
+    QVERIFY(!source.read(frame));
+
+    // 重新打开从头回放
+    QVERIFY(source.open());
+    QVERIFY(!source.atEnd());
+    QVERIFY(source.read(frame));
+    QCOMPARE(frame.frameId, uint32_t(10));
+}
+
+void TestReplaySource::truncatedFrameIsDropped()
+{
+    std::vector<char> bytes = standardDump().bytes();
+    bytes.resize(bytes.size() - 5);   // 最后一帧的JPEG不完整
+    ReplaySource source(writeDump(bytes), ReplayFast);
+    QVERIFY(source.open());
+    QCOMPARE(source.frameCount(), size_t(2));
+}
+
+void TestReplaySource::compareCountsMismatches()
+{
+    ReplaySource source(writeDump(standardDump().bytes()), ReplayLockstep);
+    QVERIFY(source.open());
+
+    // 录制时没推理的帧不比对
+    source.compare(result(20, 1), 'R');
+    QCOMPARE(source.comparedFrames(), 0);
+
+    // 类别与指令都一致
+    source.compare(result(10, 2), 'F');
+    QCOMPARE(source.comparedFrames(), 1);
+    QCOMPARE(source.classMismatches(), 0);
+    QCOMPARE(source.commandMismatches(), 0);
+
+    // 类别一致、指令不同
+    source.compare(result(10, 2), 'B');
+    QCOMPARE(source.classMismatches(), 0);
+    QCOMPARE(source.commandMismatches(), 1);
+
+    // 帧30录制里只有手动指令：指令不判定，只计类别不同
+    source.compare(result(30, 3), 'R');
+    QCOMPARE(source.comparedFrames(), 3);
+    QCOMPARE(source.classMismatches(), 1);
+    QCOMPARE(source.commandMismatches(), 1);
+
+    std::string summary = source.summary();
+    QVERIFY(summary.find("compared 3 inferences: 1 class mismatches, 1 command mismatches") != std::string::npos);
+    QVERIFY(summary.find("frame 10: class 2 (recorded 2, 0.80) command B (recorded F)") != std::string::npos);
+    QVERIFY(summary.find("frame 30: class 3 (recorded 4, 0.60) command R (recorded -)") != std::string::npos);
+
+    // 本次没有检测到目标按类别-1比对
+    source.compare(result(10, -1), 'F');
+    QCOMPARE(source.classMismatches(), 2);
+    QVERIFY(source.summary().find("frame 10: class -1 (recorded 2, 0.80)") != std::string::npos);
+
+    // 重新打开时计数清零
+    QVERIFY(source.open());
+    QCOMPARE(source.comparedFrames(), 0);
+    QCOMPARE(source.classMismatches(), 0);
+}
+
+QTEST_APPLESS_MAIN(TestReplaySource)
+#include "tst_replay_source.moc"
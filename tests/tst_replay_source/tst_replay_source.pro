@@ -0,0 +1,4 @@
+TARGET = tst_replay_source
+include(../tests.pri)
+
+SOURCES += tst_replay_source.cpp
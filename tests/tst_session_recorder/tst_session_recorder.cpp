@@ -0,0 +1,326 @@
+#include <QtTest>
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "session_recorder.h"
+
+// 连续录制：真实跑写盘线程，录完后解析段文件，核对AVI块布局、idx1索引、侧车索引与分段
+static const int64_t kMs = 1000000;
+
+static uint32_t get32(const std::vector<char> &data, size_t offset)
+{
+    const unsigned char *p = reinterpret_cast<const unsigned char *>(data.data() + offset);
+    return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+static bool fourcc(const std::vector<char> &data, size_t offset, const char *cc)
+{
+    return offset + 4 <= data.size() && memcmp(data.data() + offset, cc, 4) == 0;
+}
+
+static std::vector<char> readFile(const std::string &file)
+{
+    std::vector<char> bytes;
+    FILE *fp = fopen(file.c_str(), "rb");
+    if (!fp)
+        return bytes;
+    char buffer[65536];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), fp)) > 0)
+        bytes.insert(bytes.end(), buffer, buffer + n);
+    fclose(fp);
+    return bytes;
+}
+
+static std::vector<std::string> readLines(const std::string &file)
+{
+    std::vector<char> bytes = readFile(file);
+    std::vector<std::string> lines;
+    std::string line;
+    for (size_t i = 0; i < bytes.size(); ++i) {
+        if (bytes[i] == '\n') {
+            lines.push_back(line);
+            line.clear();
+        } else {
+            line += bytes[i];
+        }
+    }
+    return lines;
+}
+
+// 每帧内容不同，便于按偏移回读核对
+static cv::Mat fakeJpeg(size_t length, int seed)
+{
+    cv::Mat jpeg(1, static_cast<int>(length), CV_8UC1);
+    for (size_t i = 0; i < length; ++i)
+        jpeg.data[i] = static_cast<uchar>(seed * 31 + i);
+    return jpeg;
+}
+
+class TestSessionRecorder : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+    void aviChunksAndIndex();
+    void sidecarIndexPointsAtFrames();
+    void mjpegStreamIsConcatenated();
+    void segmentsSplitBySize();
+    void fullQueueDropsWithoutBlocking();
+
+private:
+    SessionRecorder::Options options(bool avi, int segmentMb = 256);
+    // 目录下的文件名（排序）；suffix非空时只取该后缀
+    std::vector<std::string> files(const std::string &suffix = std::string());
+    // 录制frameCount帧（长度依次取lengths）并等写盘线程收尾
+    void record(SessionRecorder &recorder, const size_t *lengths, int frameCount);
+
+    std::string dir;
+};
+
+void TestSessionRecorder::init()
+{
+    char pattern[] = "/tmp/tst_session_recorder_XXXXXX";
+    QVERIFY(mkdtemp(pattern) != nullptr);
+    dir = pattern;
+}
+
+void TestSessionRecorder::cleanup()
+{
+    std::vector<std::string> names = files();
+    for (size_t i = 0; i < names.size(); ++i)
+        unlink((dir + "/" + names[i]).c_str());
+    rmdir(dir.c_str());
+}
+
+SessionRecorder::Options TestSessionRecorder::options(bool avi, int segmentMb)
+{
+    SessionRecorder::Options opts;
+    opts.dir = dir;
+    opts.avi = avi;
+    opts.segmentMb = segmentMb;
+    opts.minFreeMb = 0;
+    return opts;
+}
+
+std::vector<std::string> TestSessionRecorder::files(const std::string &suffix)
+{
+    std::vector<std::string> names;
+    DIR *d = opendir(dir.c_str());
+    if (!d)
+        return names;
+    while (struct dirent *entry = readdir(d)) {
+        std::string name = entry->d_name;
+        if (name == "." || name == "..")
+            continue;
+        if (suffix.empty() || (name.size() > suffix.size() &&
+                               name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0))
+            names.push_back(name);
+    }
+    closedir(d);
+    std::sort(names.begin(), names.end());
+    return names;
+}
+
+void TestSessionRecorder::record(SessionRecorder &recorder, const size_t *lengths, int frameCount)
+{
+    recorder.start();
+    recorder.beginRecording(cv::Size(320, 240), 10.0);
+    for (int i = 0; i < frameCount; ++i)
+        recorder.recordFrame(fakeJpeg(lengths[i], i + 1), static_cast<uint32_t>(i + 1), (1000 + 100 * i) * kMs);
+    DetectionResult result;
+    result.frame_id = 2;
+    result.count = 1;
+    result.detections[0].class_id = 3;
+    result.detections[0].confidence = 0.75f;
+    result.detections[0].box = cv::Rect(10, 20, 30, 40);
+    recorder.recordDetection(result);
+    result.frame_id = 3;
+    result.count = 0;
+    recorder.recordDetection(result);
+    // stop()先写完队列再关闭当前段
+    recorder.endRecording();
+    recorder.stop();
+}
+
+void TestSessionRecorder::aviChunksAndIndex()
+{
+    SessionRecorder recorder(options(true));
+    const size_t lengths[] = {11, 20, 7};   // 奇数长度需要补齐到偶数
+    record(recorder, lengths, 3);
+
+    std::vector<std::string> avi = files(".avi");
+    QCOMPARE(avi.size(), size_t(1));
+    QVERIFY(files(".part").empty());
+    std::vector<char> data = readFile(dir + "/" + avi[0]);
+
+    QVERIFY(fourcc(data, 0, "RIFF"));
+    QCOMPARE(get32(data, 4), uint32_t(data.size() - 8));
+    QVERIFY(fourcc(data, 8, "AVI "));
+    QVERIFY(fourcc(data, 24, "avih"));
+    QCOMPARE(get32(data, 32), uint32_t(100000));   // 10fps
+    QCOMPARE(get32(data, 48), uint32_t(3));        // dwTotalFrames
+    QCOMPARE(get32(data, 64), uint32_t(320));
+    QCOMPARE(get32(data, 68), uint32_t(240));
+    QVERIFY(fourcc(data, 112, "MJPG"));
+    QCOMPARE(get32(data, 140), uint32_t(3));       // strh.dwLength
+    QVERIFY(fourcc(data, 212, "LIST"));
+    QVERIFY(fourcc(data, 220, "movi"));
+
+    // movi：'00dc'块依次排列，奇数长度补一个字节
+    size_t offset = 224;
+    std::vector<uint32_t> chunkOffsets;
+    for (int i = 0; i < 3; ++i) {
+        QVERIFY(fourcc(data, offset, "00dc"));
+        QCOMPARE(get32(data, offset + 4), uint32_t(lengths[i]));
+        cv::Mat expected = fakeJpeg(lengths[i], i + 1);
+        QVERIFY(memcmp(data.data() + offset + 8, expected.data, lengths[i]) == 0);
+        chunkOffsets.push_back(static_cast<uint32_t>(offset - 220));
+        offset += 8 + lengths[i] + (lengths[i] & 1);
+    }
+    QCOMPARE(get32(data, 216), uint32_t(offset - 220));   // movi列表长度
+
+    // idx1：偏移相对'movi'类型字段
+    QVERIFY(fourcc(data, offset, "idx1"));
+    QCOMPARE(get32(data, offset + 4), uint32_t(3 * 16));
+    for (int i = 0; i < 3; ++i) {
+        size_t e = offset + 8 + i * 16;
+        QVERIFY(fourcc(data, e, "00dc"));
+        QCOMPARE(get32(data, e + 4), uint32_t(0x10));
+        QCOMPARE(get32(data, e + 8), chunkOffsets[i]);
+        QCOMPARE(get32(data, e + 12), uint32_t(lengths[i]));
+    }
+    QCOMPARE(offset + 8 + 3 * 16, data.size());
+
+    SessionRecorder::Stats stats = recorder.stats();
+    QCOMPARE(stats.frames, uint64_t(3));
+    QCOMPARE(stats.bytes, uint64_t(11 + 20 + 7));
+    QCOMPARE(stats.segments, uint64_t(1));
+    QCOMPARE(stats.dropped, uint64_t(0));
+}
+
+void TestSessionRecorder::sidecarIndexPointsAtFrames()
+{
+    SessionRecorder recorder(options(true));
+    const size_t lengths[] = {11, 20, 7};
+    record(recorder, lengths, 3);
+
+    std::vector<std::string> avi = files(".avi");
+    std::vector<std::string> idx = files(".idx");
+    QCOMPARE(avi.size(), size_t(1));
+    QCOMPARE(idx.size(), size_t(1));
+    QCOMPARE(idx[0].substr(0, idx[0].size() - 4), avi[0].substr(0, avi[0].size() - 4));
+    std::vector<char> data = readFile(dir + "/" + avi[0]);
+    std::vector<std::string> lines = readLines(dir + "/" + idx[0]);
+
+    int frameLines = 0;
+    std::vector<std::string> detections;
+    for (size_t i = 0; i < lines.size(); ++i) {
+        const std::string &line = lines[i];
+        if (line.empty() || line[0] == '#')
+            continue;
+        if (line[0] == 'D') {
+            detections.push_back(line);
+            continue;
+        }
+        QCOMPARE(line[0], 'F');
+        unsigned frameId = 0;
+        long long captureNs = 0;
+        unsigned long long offset = 0;
+        size_t length = 0;
+        QCOMPARE(sscanf(line.c_str(), "F %u %lld %llu %zu", &frameId, &captureNs, &offset, &length), 4);
+        QCOMPARE(frameId, unsigned(frameLines + 1));
+        QCOMPARE(captureNs, (1000 + 100 * frameLines) * kMs);
+        QCOMPARE(length, lengths[frameLines]);
+        // 偏移直接指向段文件中的JPEG数据
+        QVERIFY(offset + length <= data.size());
+        cv::Mat expected = fakeJpeg(length, frameLines + 1);
+        QVERIFY(memcmp(data.data() + offset, expected.data, length) == 0);
+        frameLines++;
+    }
+    QCOMPARE(frameLines, 3);
+    QCOMPARE(detections.size(), size_t(2));
+    QCOMPARE(detections[0], std::string("D 2 3 0.7500 10 20 30 40"));
+    QCOMPARE(detections[1], std::string("D 3 -1 0 0 0 0 0"));
+}
+
+void TestSessionRecorder::mjpegStreamIsConcatenated()
+{
+    SessionRecorder recorder(options(false));
+    const size_t lengths[] = {11, 20, 7};
+    record(recorder, lengths, 3);
+
+    std::vector<std::string> mjpeg = files(".mjpeg");
+    QCOMPARE(mjpeg.size(), size_t(1));
+    QVERIFY(files(".avi").empty());
+    std::vector<char> data = readFile(dir + "/" + mjpeg[0]);
+    QCOMPARE(data.size(), size_t(11 + 20 + 7));
+    size_t offset = 0;
+    for (int i = 0; i < 3; ++i) {
+        cv::Mat expected = fakeJpeg(lengths[i], i + 1);
+        QVERIFY(memcmp(data.data() + offset, expected.data, lengths[i]) == 0);
+        offset += lengths[i];
+    }
+}
+
+void TestSessionRecorder::segmentsSplitBySize()
+{
+    // 1MB一段：每段放两帧400KB，第三帧开新段
+    SessionRecorder recorder(options(true, 1));
+    const size_t lengths[] = {400000, 400000, 400000, 400000, 400000};
+    record(recorder, lengths, 5);
+
+    std::vector<std::string> avi = files(".avi");
+    QCOMPARE(avi.size(), size_t(3));
+    QCOMPARE(files(".idx").size(), size_t(3));
+    // 同一次录制的段文件共用时间戳，序号递增
+    QVERIFY(avi[0].find("_000.avi") != std::string::npos);
+    QVERIFY(avi[1].find("_001.avi") != std::string::npos);
+    QVERIFY(avi[2].find("_002.avi") != std::string::npos);
+    QCOMPARE(avi[0].substr(0, avi[0].size() - 8), avi[2].substr(0, avi[2].size() - 8));
+
+    const uint32_t expectedFrames[] = {2, 2, 1};
+    for (int i = 0; i < 3; ++i) {
+        std::vector<char> data = readFile(dir + "/" + avi[i]);
+        QVERIFY(data.size() <= size_t(1) << 20);
+        QCOMPARE(get32(data, 48), expectedFrames[i]);
+    }
+    QCOMPARE(recorder.stats().segments, uint64_t(3));
+    QCOMPARE(recorder.stats().frames, uint64_t(5));
+}
+
+void TestSessionRecorder::fullQueueDropsWithoutBlocking()
+{
+    // 写盘线程尚未启动：队列填满后的帧直接丢弃，recordFrame不阻塞
+    SessionRecorder recorder(options(true));
+    recorder.beginRecording(cv::Size(320, 240), 10.0);
+    cv::Mat jpeg = fakeJpeg(16, 1);
+    for (int i = 0; i < 70; ++i)
+        recorder.recordFrame(jpeg, static_cast<uint32_t>(i + 1), i * kMs);
+    QCOMPARE(recorder.queueDepth(), 64);
+    QCOMPARE(recorder.stats().dropped, uint64_t(6));
+
+    // 非原始采集（空帧）不入队
+    recorder.recordFrame(cv::Mat(), 100, 0);
+    QCOMPARE(recorder.queueDepth(), 64);
+    QCOMPARE(recorder.stats().dropped, uint64_t(6));
+
+    recorder.start();
+    for (int i = 0; i < 500 && recorder.stats().frames < 64; ++i)
+        usleep(10000);
+    QCOMPARE(recorder.stats().frames, uint64_t(64));
+    recorder.endRecording();
+    recorder.stop();
+    QCOMPARE(recorder.queueDepth(), 0);
+    QCOMPARE(files(".avi").size(), size_t(1));
+}
+
+QTEST_GUILESS_MAIN(TestSessionRecorder)
+#include "tst_session_recorder.moc"
@@ -0,0 +1,4 @@
+TARGET = tst_session_recorder
+include(../tests.pri)
+
+SOURCES += tst_session_recorder.cpp
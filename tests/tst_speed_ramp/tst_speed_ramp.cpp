@@ -0,0 +1,225 @@
+#include <QtTest>
+#include <math.h>
+#include "speed_ramp.h"
+
+// 速度斜坡：用模拟时钟按控制环周期驱动SpeedRamp::step，核对加速度/jerk上限、收敛与停止路径
+static const int64_t kPeriodNs = 20000000;   // 50Hz
+static const float kDt = 0.02f;
+static const float kEps = 1e-4f;
+
+static RampLimits limits(float accel, float jerk)
+{
+    RampLimits l;
+    l.maxAccel = accel;
+    l.maxJerk = jerk;
+    l.tau = 0.2f;
+    return l;
+}
+
+// 逐周期推进并记录线速度的最大加速度与最大jerk（包括到达目标的那几步）
+struct RampProbe
+{
+    SpeedRamp &ramp;
+    int64_t now;
+    float lastAccel;
+    float maxAccel;
+    float maxJerk;
+    float minVelocity;
+    float maxVelocity;
+
+    RampProbe(SpeedRamp &r, int64_t start)
+        : ramp(r), now(start), lastAccel(0.0f), maxAccel(0.0f), maxJerk(0.0f), minVelocity(0.0f), maxVelocity(0.0f)
+    {
+        ramp.step(now);
+    }
+
+    void run(float seconds)
+    {
+        minVelocity = maxVelocity = ramp.linear();
+        int steps = static_cast<int>(seconds / kDt + 0.5f);
+        for (int i = 0; i < steps; ++i) {
+            float before = ramp.linear();
+            now += kPeriodNs;
+            ramp.step(now);
+            float accel = (ramp.linear() - before) / kDt;
+            maxAccel = std::max(maxAccel, fabsf(accel));
+            maxJerk = std::max(maxJerk, fabsf(accel - lastAccel) / kDt);
+            lastAccel = accel;
+            minVelocity = std::min(minVelocity, ramp.linear());
+            maxVelocity = std::max(maxVelocity, ramp.linear());
+        }
+    }
+};
+
+class TestSpeedRamp : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void firstStepOnlyRecordsTime();
+    void accelAndJerkBounded();
+    void settlesToTarget();
+    void stiffArrivalBrakesWithinJerk();
+    void reversalStaysBounded();
+    void zeroTargetStopsWithoutReversing();
+    void resetStopsImmediately();
+    void longGapIsClamped();
+    void poseFilterForceStop();
+    void poseFilterSmoothsByConfidence();
+};
+
+void TestSpeedRamp::firstStepOnlyRecordsTime()
+{
+    SpeedRamp ramp(limits(0.5f, 1.5f), limits(1.5f, 4.0f));
+    ramp.setTarget(0.6f, 0.8f);
+    ramp.step(1000000000);
+    QCOMPARE(ramp.linear(), 0.0f);
+    QCOMPARE(ramp.angular(), 0.0f);
+    ramp.step(1000000000 + kPeriodNs);
+    QVERIFY(ramp.linear() > 0.0f);
+    QVERIFY(ramp.angular() > 0.0f);
+}
+
+void TestSpeedRamp::accelAndJerkBounded()
+{
+    SpeedRamp ramp(limits(0.5f, 1.5f), limits(1.5f, 4.0f));
+    RampProbe probe(ramp, 1000000000);
+    ramp.setTarget(0.6f, 0.0f);
+    probe.run(5.0f);
+    QVERIFY(probe.maxAccel <= 0.5f + kEps);
+    QVERIFY(probe.maxJerk <= 1.5f + kEps);
+    // 确实用到了加速度上限（否则上面的断言没有意义）
+    QVERIFY(probe.maxAccel > 0.45f);
+}
+
+void TestSpeedRamp::settlesToTarget()
+{
+    SpeedRamp ramp(limits(0.5f, 1.5f), limits(1.5f, 4.0f));
+    RampProbe probe(ramp, 1000000000);
+    ramp.setTarget(0.6f, -0.8f);
+    probe.run(4.0f);
+    QVERIFY(fabsf(ramp.linear() - 0.6f) < 1e-3f);
+    QVERIFY(fabsf(ramp.angular() + 0.8f) < 1e-3f);
+    // 不越过目标
+    QVERIFY(probe.maxVelocity <= 0.6f + kEps);
+}
+
+void TestSpeedRamp::stiffArrivalBrakesWithinJerk()
+{
+    // 时间常数很小：比例项一直要求最大加速度，到达前必须按jerk上限提前把加速度降到零
+    RampLimits stiff = limits(0.5f, 1.5f);
+    stiff.tau = 0.01f;
+    SpeedRamp ramp(stiff, limits(1.5f, 4.0f));
+    RampProbe probe(ramp, 1000000000);
+    ramp.setTarget(0.6f, 0.0f);
+    probe.run(3.0f);
+    QVERIFY(probe.maxAccel <= 0.5f + kEps);
+    QVERIFY(probe.maxJerk <= 1.5f + kEps);
+    QVERIFY(probe.maxVelocity <= 0.6f + kEps);
+    QCOMPARE(ramp.linear(), 0.6f);
+}
+
+void TestSpeedRamp::reversalStaysBounded()
+{
+    SpeedRamp ramp(limits(0.5f, 1.5f), limits(1.5f, 4.0f));
+    RampProbe probe(ramp, 1000000000);
+    ramp.setTarget(0.6f, 0.0f);
+    probe.run(4.0f);
+
+    // 前进中直接改为后退：速度连续穿过零，加速度与jerk仍受限
+    ramp.setTarget(-0.3f, 0.0f);
+    probe.lastAccel = 0.0f;
+    probe.maxAccel = 0.0f;
+    probe.maxJerk = 0.0f;
+    probe.run(6.0f);
+    QVERIFY(probe.maxAccel <= 0.5f + kEps);
+    QVERIFY(probe.maxJerk <= 1.5f + kEps);
+    QVERIFY(fabsf(ramp.linear() + 0.3f) < 1e-3f);
+    QVERIFY(probe.minVelocity >= -0.3f - kEps);
+}
+
+void TestSpeedRamp::zeroTargetStopsWithoutReversing()
+{
+    SpeedRamp ramp(limits(0.5f, 1.5f), limits(1.5f, 4.0f));
+    RampProbe probe(ramp, 1000000000);
+    ramp.setTarget(0.6f, 0.8f);
+    probe.run(4.0f);
+
+    ramp.setTarget(0.0f, 0.0f);
+    probe.lastAccel = 0.0f;
+    probe.maxAccel = 0.0f;
+    probe.maxJerk = 0.0f;
+    probe.run(4.0f);
+    QVERIFY(probe.maxAccel <= 0.5f + kEps);
+    QVERIFY(probe.maxJerk <= 1.5f + kEps);
+    QVERIFY(probe.minVelocity >= 0.0f);
+    QVERIFY(fabsf(ramp.linear()) < 1e-3f);
+    QVERIFY(fabsf(ramp.angular()) < 1e-3f);
+}
+
+void TestSpeedRamp::resetStopsImmediately()
+{
+    SpeedRamp ramp(limits(0.5f, 1.5f), limits(1.5f, 4.0f));
+    RampProbe probe(ramp, 1000000000);
+    ramp.setTarget(0.6f, 0.8f);
+    probe.run(2.0f);
+    QVERIFY(ramp.linear() > 0.3f);
+
+    ramp.reset(probe.now);
+    QCOMPARE(ramp.linear(), 0.0f);
+    QCOMPARE(ramp.angular(), 0.0f);
+    QCOMPARE(ramp.targetLinear(), 0.0f);
+    probe.run(1.0f);
+    QCOMPARE(ramp.linear(), 0.0f);
+}
+
+void TestSpeedRamp::longGapIsClamped()
+{
+    SpeedRamp ramp(limits(0.5f, 1.5f), limits(1.5f, 4.0f));
+    ramp.step(1000000000);
+    ramp.setTarget(0.6f, 0.0f);
+    // 线程被抢占5秒：单步按0.1秒计，速度不会一步跳到目标
+    ramp.step(6000000000LL);
+    QVERIFY(ramp.linear() <= 1.5f * 0.1f * 0.1f + kEps);
+    QVERIFY(ramp.linear() > 0.0f);
+}
+
+void TestSpeedRamp::poseFilterForceStop()
+{
+    PoseFilter filter(0.6f, 0.3f, 0.8f, 0.6f);
+    filter.update('F', 1.0f);
+    filter.update('L', 1.0f);
+    QVERIFY(filter.linear() > 0.0f);
+    QVERIFY(filter.angular() > 0.0f);
+
+    // 手动停止不做平滑，直接归零
+    filter.force('S');
+    QCOMPARE(filter.linear(), 0.0f);
+    QCOMPARE(filter.angular(), 0.0f);
+
+    filter.force('B');
+    QCOMPARE(filter.linear(), -0.3f);
+    QCOMPARE(filter.angular(), 0.0f);
+    filter.force('R');
+    QCOMPARE(filter.linear(), 0.0f);
+    QCOMPARE(filter.angular(), -0.8f);
+    // 未知指令按停止处理
+    filter.force('X');
+    QCOMPARE(filter.angular(), 0.0f);
+}
+
+void TestSpeedRamp::poseFilterSmoothsByConfidence()
+{
+    PoseFilter filter(0.6f, 0.3f, 0.8f, 0.5f);
+    filter.update('F', 1.0f);
+    QVERIFY(qFuzzyCompare(filter.linear(), 0.3f));
+    filter.update('F', 0.0f);
+    QVERIFY(qFuzzyCompare(filter.linear(), 0.3f));
+    filter.update('F', 0.5f);
+    QVERIFY(qFuzzyCompare(filter.linear(), 0.375f));
+    filter.update('S', 1.0f);
+    QVERIFY(qFuzzyCompare(filter.linear(), 0.1875f));
+}
+
+QTEST_APPLESS_MAIN(TestSpeedRamp)
+#include "tst_speed_ramp.moc"
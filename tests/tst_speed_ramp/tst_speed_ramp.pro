@@ -0,0 +1,4 @@
+TARGET = tst_speed_ramp
+include(../tests.pri)
+
+SOURCES += tst_speed_ramp.cpp
@@ -0,0 +1,80 @@
+#include <QtTest>
+#include <unistd.h>
+#include "uart_master.h"
+
+// 帧协议编码：头、类型、长度、负载、异或校验逐字节核对
+class TestUartFrame : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void encodesHeaderPayloadAndChecksum();
+    void emptyPayloadChecksumIsTypeOnly();
+    void rejectsOversizedPayload();
+    void setpointIsLittleEndian();
+};
+
+void TestUartFrame::encodesHeaderPayloadAndChecksum()
+{
+    const unsigned char payload[] = {0x01, 0x02, 0x03};
+    unsigned char frame[UART_FRAME_MAX_PAYLOAD + UART_FRAME_OVERHEAD];
+    int n = uart_encode_frame(frame, UART_FRAME_SETPOINT, payload, 3);
+
+    QCOMPARE(n, 3 + UART_FRAME_OVERHEAD);
+    QCOMPARE(int(frame[0]), UART_FRAME_HEAD0);
+    QCOMPARE(int(frame[1]), UART_FRAME_HEAD1);
+    QCOMPARE(int(frame[2]), UART_FRAME_SETPOINT);
+    QCOMPARE(int(frame[3]), 3);
+    QCOMPARE(int(frame[4]), 0x01);
+    QCOMPARE(int(frame[5]), 0x02);
+    QCOMPARE(int(frame[6]), 0x03);
+    // 0x01 ^ 0x03 ^ 0x01 ^ 0x02 ^ 0x03
+    QCOMPARE(int(frame[7]), 0x02);
+}
+
+void TestUartFrame::emptyPayloadChecksumIsTypeOnly()
+{
+    unsigned char frame[UART_FRAME_OVERHEAD];
+    QCOMPARE(uart_encode_frame(frame, UART_FRAME_ACK, NULL, 0), UART_FRAME_OVERHEAD);
+    QCOMPARE(int(frame[3]), 0);
+    QCOMPARE(int(frame[4]), UART_FRAME_ACK);
+}
+
+void TestUartFrame::rejectsOversizedPayload()
+{
+    unsigned char payload[UART_FRAME_MAX_PAYLOAD + 1] = {0};
+    unsigned char frame[UART_FRAME_MAX_PAYLOAD + 1 + UART_FRAME_OVERHEAD];
+    QCOMPARE(uart_encode_frame(frame, UART_FRAME_SETPOINT, payload, UART_FRAME_MAX_PAYLOAD + 1), -1);
+    QCOMPARE(uart_encode_frame(frame, UART_FRAME_SETPOINT, payload, -1), -1);
+    QCOMPARE(uart_encode_frame(frame, UART_FRAME_SETPOINT, payload, UART_FRAME_MAX_PAYLOAD),
+             UART_FRAME_MAX_PAYLOAD + UART_FRAME_OVERHEAD);
+}
+
+void TestUartFrame::setpointIsLittleEndian()
+{
+    // 经管道拿到实际写出的字节
+    int fds[2];
+    QVERIFY(pipe(fds) == 0);
+    int sent = uart_send_setpoint(fds[1], 300, -2, 7);
+    close(fds[1]);
+    unsigned char frame[16];
+    ssize_t n = read(fds[0], frame, sizeof(frame));
+    close(fds[0]);
+    QCOMPARE(sent, 0);
+
+    QCOMPARE(int(n), 5 + UART_FRAME_OVERHEAD);
+    QCOMPARE(int(frame[2]), UART_FRAME_SETPOINT);
+    QCOMPARE(int(frame[3]), 5);
+    QCOMPARE(int(frame[4]), 300 & 0xff);
+    QCOMPARE(int(frame[5]), 300 >> 8);
+    QCOMPARE(int(frame[6]), 0xfe);
+    QCOMPARE(int(frame[7]), 0xff);
+    QCOMPARE(int(frame[8]), 7);
+    unsigned char sum = 0;
+    for (int i = 2; i < 9; i++)
+        sum ^= frame[i];
+    QCOMPARE(int(frame[9]), int(sum));
+}
+
+QTEST_APPLESS_MAIN(TestUartFrame)
+#include "tst_uart_frame.moc"
@@ -0,0 +1,4 @@
+TARGET = tst_uart_frame
+include(../tests.pri)
+
+SOURCES += tst_uart_frame.cpp
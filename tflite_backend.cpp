@@ -0,0 +1,142 @@
+// TensorFlow Lite后端（qmake CONFIG+=tflite TFLITE_DIR=<tflite C库目录>），卷积交给XNNPACK委托
+#ifdef WHEELCHAIR_WITH_TFLITE
+
+#include "inference_backend.h"
+#include "async_logger.h"
+#include <tensorflow/lite/c/c_api.h>
+#include <tensorflow/lite/delegates/xnnpack/xnnpack_delegate.h>
+#include <string.h>
+#include <vector>
+
+// 模型为ONNX同名的.tflite（onnx2tf等工具转换，输入多为NHWC）。
+// 输入张量仍按NCHW写入inputTensor()，run()时按模型输入布局拷入解释器；输出直接引用解释器内存
+class TfliteBackend : public InferenceBackend
+{
+public:
+    TfliteBackend() : model(nullptr), options(nullptr), delegate(nullptr), interpreter(nullptr), nhwc(false) {}
+    ~TfliteBackend() { release(); }
+
+    const char *name() const override { return "tflite"; }
+
+    bool load(const std::string &modelPath, const cv::Size &inputShape,
+              const InferenceBackendOptions &backendOptions, std::string &error) override
+    {
+        std::string path = modelPath;
+        if (path.size() > 5 && path.compare(path.size() - 5, 5, ".onnx") == 0)
+            path = path.substr(0, path.size() - 5) + ".tflite";
+        model = TfLiteModelCreateFromFile(path.c_str());
+        if (!model) {
+            error = "无法读取TFLite模型: " + path;
+            return false;
+        }
+        options = TfLiteInterpreterOptionsCreate();
+        TfLiteInterpreterOptionsSetNumThreads(options, backendOptions.threads);
+        TfLiteXNNPackDelegateOptions xnnpack = TfLiteXNNPackDelegateOptionsDefault();
+        xnnpack.num_threads = backendOptions.threads;
+        delegate = TfLiteXNNPackDelegateCreate(&xnnpack);
+        if (delegate)
+            TfLiteInterpreterOptionsAddDelegate(options, delegate);
+        interpreter = TfLiteInterpreterCreate(model, options);
+        if (!interpreter || TfLiteInterpreterAllocateTensors(interpreter) != kTfLiteOk) {
+            error = "TFLite解释器创建失败: " + path;
+            release();
+            return false;
+        }
+
+        const TfLiteTensor *input = TfLiteInterpreterGetInputTensor(interpreter, 0);
+        if (TfLiteTensorType(input) != kTfLiteFloat32 || TfLiteTensorNumDims(input) != 4) {
+            error = "TFLite模型输入须为4维float32: " + path;
+            release();
+            return false;
+        }
+        // [1, H, W, 3]为NHWC，否则按[1, 3, H, W]
+        nhwc = TfLiteTensorDim(input, 3) == 3;
+        int h = TfLiteTensorDim(input, nhwc ? 1 : 2);
+        int w = TfLiteTensorDim(input, nhwc ? 2 : 3);
+        if (h != inputShape.height || w != inputShape.width) {
+            error = "TFLite模型输入尺寸与配置不一致: " + path;
+            release();
+            return false;
+        }
+        return true;
+    }
+
+    cv::Mat &inputTensor() override { return blob; }
+
+    bool run() override
+    {
+        if (!interpreter || blob.empty() || !blob.isContinuous())
+            return false;
+        TfLiteTensor *input = TfLiteInterpreterGetInputTensor(interpreter, 0);
+        float *dst = static_cast<float *>(TfLiteTensorData(input));
+        size_t bytes = TfLiteTensorByteSize(input);
+        if (bytes != blob.total() * sizeof(float))
+            return false;
+        const float *src = blob.ptr<float>();
+        if (nhwc) {
+            // NCHW → NHWC（3通道交织）
+            int plane = blob.size[2] * blob.size[3];
+            for (int i = 0; i < plane; ++i) {
+                dst[i * 3 + 0] = src[i];
+                dst[i * 3 + 1] = src[plane + i];
+                dst[i * 3 + 2] = src[plane * 2 + i];
+            }
+        } else {
+            memcpy(dst, src, bytes);
+        }
+
+        if (TfLiteInterpreterInvoke(interpreter) != kTfLiteOk) {
+            LOG_ERROR(LogInfer, "TFLite推理失败");
+            return false;
+        }
+
+        int count = TfLiteInterpreterGetOutputTensorCount(interpreter);
+        outputs.resize(count);
+        for (int i = 0; i < count; ++i) {
+            const TfLiteTensor *out = TfLiteInterpreterGetOutputTensor(interpreter, i);
+            int sizes[8];
+            int n = TfLiteTensorNumDims(out);
+            n = n < 8 ? n : 8;
+            for (int d = 0; d < n; ++d)
+                sizes[d] = TfLiteTensorDim(out, d);
+            outputs[i] = cv::Mat(n, sizes, CV_32F, TfLiteTensorData(out));
+        }
+        return count > 0;
+    }
+
+    int outputCount() const override { return static_cast<int>(outputs.size()); }
+    const cv::Mat &outputTensor(int index) const override { return outputs[index]; }
+
+    void release() override
+    {
+        outputs.clear();
+        if (interpreter)
+            TfLiteInterpreterDelete(interpreter);
+        if (delegate)
+            TfLiteXNNPackDelegateDelete(delegate);
+        if (options)
+            TfLiteInterpreterOptionsDelete(options);
+        if (model)
+            TfLiteModelDelete(model);
+        interpreter = nullptr;
+        delegate = nullptr;
+        options = nullptr;
+        model = nullptr;
+    }
+
+private:
+    TfLiteModel *model;
+    TfLiteInterpreterOptions *options;
+    TfLiteDelegate *delegate;
+    TfLiteInterpreter *interpreter;
+    bool nhwc;
+    cv::Mat blob;
+    std::vector<cv::Mat> outputs;
+};
+
+InferenceBackend *createTfliteBackend()
+{
+    return new TfliteBackend;
+}
+
+#endif // WHEELCHAIR_WITH_TFLITE
@@ -70,3 +70,46 @@ void uart_close(int fd) {
         close(fd);
     }
 }
+
+// 回放捕获：普通文件没有termios，tcdrain返回ENOTTY被忽略，其余发送路径与真实串口一致
+int uart_open_capture(const char *path) {
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        fprintf(stderr, "串口捕获文件打开失败 %s: %s\n", path, strerror(errno));
+    }
+    return fd;
+}
+
+// 帧编码：头 + 类型 + 长度 + 负载 + 异或校验
+int uart_encode_frame(unsigned char *out, unsigned char type, const unsigned char *payload, int len) {
+    if (out == NULL || len < 0 || len > UART_FRAME_MAX_PAYLOAD) return -1;
+    unsigned char sum = type ^ (unsigned char)len;
+    out[0] = UART_FRAME_HEAD0;
+    out[1] = UART_FRAME_HEAD1;
+    out[2] = type;
+    out[3] = (unsigned char)len;
+    for (int i = 0; i < len; i++) {
+        out[4 + i] = payload[i];
+        sum ^= payload[i];
+    }
+    out[4 + len] = sum;
+    return len + UART_FRAME_OVERHEAD;
+}
+
+// 整帧一次write发出，避免帧被其他写入打断
+int uart_send_frame(int fd, unsigned char type, const unsigned char *payload, int len) {
+    unsigned char frame[UART_FRAME_MAX_PAYLOAD + UART_FRAME_OVERHEAD];
+    int n = uart_encode_frame(frame, type, payload, len);
+    if (n < 0) return -1;
+    return uart_send_bytes(fd, frame, n);
+}
+
+int uart_send_setpoint(int fd, short linear_mm_s, short angular_mrad_s, unsigned char seq) {
+    unsigned char payload[5];
+    payload[0] = (unsigned char)(linear_mm_s & 0xff);
+    payload[1] = (unsigned char)((linear_mm_s >> 8) & 0xff);
+    payload[2] = (unsigned char)(angular_mrad_s & 0xff);
+    payload[3] = (unsigned char)((angular_mrad_s >> 8) & 0xff);
+    payload[4] = seq;
+    return uart_send_frame(fd, UART_FRAME_SETPOINT, payload, sizeof(payload));
+}
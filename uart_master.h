@@ -14,5 +14,20 @@ int uart_init(const char *uart_path);          // 仅传串口路径，无多余
 int uart_send_char(int fd, char c);            // 专门发送字符（适配你的F/B/L/R/S）
 int uart_send_bytes(int fd, const unsigned char *buf, int len); // 保留多字节接口
 void uart_close(int fd);                       // 关闭串口
+int uart_open_capture(const char *path);       // 回放用：把发往串口的字节写入普通文件（tty/pty请用uart_init）
+
+// 帧协议（速度设定值流，与单字符协议二选一）：
+//   0xAA 0x55 | type(1) | len(1) | payload(len) | checksum(1, type..payload逐字节异或)
+#define UART_FRAME_HEAD0        0xAA
+#define UART_FRAME_HEAD1        0x55
+#define UART_FRAME_OVERHEAD     5
+#define UART_FRAME_MAX_PAYLOAD  32
+#define UART_FRAME_SETPOINT     0x01   // int16 线速度(mm/s) + int16 角速度(mrad/s) + uint8 序号，小端
+#define UART_FRAME_ACK          0x81   // 下位机应答：uint8 序号
+#define UART_FRAME_TELEMETRY    0x82   // 下位机遥测：int16 左轮(mm/s) + int16 右轮(mm/s)
+
+int uart_encode_frame(unsigned char *out, unsigned char type, const unsigned char *payload, int len); // 返回帧长度
+int uart_send_frame(int fd, unsigned char type, const unsigned char *payload, int len);
+int uart_send_setpoint(int fd, short linear_mm_s, short angular_mrad_s, unsigned char seq);
 
 #endif // UART_MASTER_H
@@ -0,0 +1,161 @@
+#include "video_widget.h"
+#include "event_loop_monitor.h"
+#include <QPainter>
+#include <QPaintEvent>
+#include <QResizeEvent>
+#include <QElapsedTimer>
+#include <QRegion>
+#include <QFontMetrics>
+#include <QWindow>
+#include <opencv2/imgproc.hpp>
+
+// 各头部姿态类别的框颜色（front/left/up/right/down）
+static const QColor kClassColors[] = {
+    QColor(76, 175, 80), QColor(156, 39, 176), QColor(33, 150, 243), QColor(0, 150, 136), QColor(255, 152, 0)
+};
+
+VideoWidget::VideoWidget(QWidget *parent)
+    : QWidget(parent)
+    , detectionOverlay(nullptr)
+    , trackedOverlay(nullptr)
+    , overlaySinceMs(overlayClockMs())
+    , lastPaintUs(0)
+    , totalPaintUs(0)
+    , paintCount(0)
+    , skipCount(0)
+{
+    // 整个控件区域每次都完整绘制，跳过Qt的背景擦除
+    setAttribute(Qt::WA_OpaquePaintEvent);
+    setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
+}
+
+bool VideoWidget::isRenderable() const
+{
+    // 窗口被完全遮挡时会取消暴露的平台在这里就能跳过
+    const QWindow *handle = window()->windowHandle();
+    if (handle && !handle->isExposed())
+        return false;
+    return isVisible() && !window()->isMinimized() && !visibleRegion().isEmpty();
+}
+
+bool VideoWidget::setFrame(const cv::Mat &bgrFrame)
+{
+    if (bgrFrame.empty() || bgrFrame.type() != CV_8UC3)
+        return false;
+
+    if (!isRenderable()) {
+        skipCount++;
+        return false;
+    }
+
+    bool sizeChanged = bgrFrame.cols != frame.cols || bgrFrame.rows != frame.rows;
+    frame = bgrFrame;
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+    image = QImage(frame.data, frame.cols, frame.rows, static_cast<int>(frame.step), QImage::Format_BGR888);
+#else
+    cv::cvtColor(frame, rgbBuffer, cv::COLOR_BGR2RGB);
+    image = QImage(rgbBuffer.data, rgbBuffer.cols, rgbBuffer.rows, static_cast<int>(rgbBuffer.step), QImage::Format_RGB888);
+#endif
+    placeholder.clear();
+    if (sizeChanged)
+        updateTargetRect();
+    update(targetRect);
+    return true;
+}
+
+void VideoWidget::setPlaceholderText(const QString &text)
+{
+    placeholder = text;
+    image = QImage();
+    frame.release();
+    overlaySinceMs = overlayClockMs();
+    update();
+}
+
+void VideoWidget::setOverlaySources(const SeqLock<OverlayBox> *detection, const SeqLock<OverlayBox> *tracked)
+{
+    detectionOverlay = detection;
+    trackedOverlay = tracked;
+}
+
+void VideoWidget::resizeEvent(QResizeEvent *event)
+{
+    QWidget::resizeEvent(event);
+    updateTargetRect();
+}
+
+void VideoWidget::updateTargetRect()
+{
+    if (frame.empty()) {
+        targetRect = rect();
+        return;
+    }
+    QSize scaled = QSize(frame.cols, frame.rows).scaled(size(), Qt::KeepAspectRatio);
+    targetRect = QRect(QPoint((width() - scaled.width()) / 2, (height() - scaled.height()) / 2), scaled);
+}
+
+void VideoWidget::paintEvent(QPaintEvent *event)
+{
+    UI_SLOT_SCOPE();
+    QElapsedTimer paintTimer;
+    paintTimer.start();
+
+    QPainter painter(this);
+    if (image.isNull()) {
+        painter.fillRect(rect(), QColor("#f5f5f5"));
+        painter.setPen(QPen(QColor("#2196F3"), 2));
+        painter.drawRect(rect().adjusted(1, 1, -1, -1));
+        painter.setPen(Qt::black);
+        painter.drawText(rect(), Qt::AlignCenter, placeholder);
+        return;
+    }
+
+    // 只在需要时填充留白区域（帧更新时update()只标记了targetRect）
+    if (!targetRect.contains(event->rect())) {
+        QRegion border = QRegion(event->rect()) - QRegion(targetRect);
+        for (const QRect &r : border)
+            painter.fillRect(r, QColor("#f5f5f5"));
+    }
+
+    painter.drawImage(targetRect, image);
+
+    paintOverlay(painter);
+
+    lastPaintUs = paintTimer.nsecsElapsed() / 1000;
+    totalPaintUs += lastPaintUs;
+    paintCount++;
+}
+
+void VideoWidget::paintOverlay(QPainter &painter)
+{
+    OverlayBox det;
+    OverlayBox trk;
+    bool hasDet = detectionOverlay && detectionOverlay->load(det) &&
+                  det.stampMs >= overlaySinceMs && det.width > 0;
+    bool hasTrk = trackedOverlay && trackedOverlay->load(trk) &&
+                  trk.stampMs >= overlaySinceMs && trk.width > 0;
+    if (!hasDet && !hasTrk)
+        return;
+
+    // 跟踪框比检测框更新（逐帧传播），有则优先；类别与置信度来自最近一次检测
+    const OverlayBox &box = hasTrk ? trk : det;
+    qreal sx = qreal(targetRect.width()) / image.width();
+    qreal sy = qreal(targetRect.height()) / image.height();
+    QRectF r(targetRect.x() + box.x * sx, targetRect.y() + box.y * sy, box.width * sx, box.height * sy);
+
+    QColor color = hasDet && det.classId >= 0 ? kClassColors[det.classId % 5] : QColor(Qt::green);
+    painter.setPen(QPen(color, 2, hasTrk ? Qt::DashLine : Qt::SolidLine));
+    painter.setBrush(Qt::NoBrush);
+    painter.drawRect(r);
+
+    if (!hasDet)
+        return;
+    QString text = QString("%1 %2").arg(QLatin1String(det.label)).arg(det.confidence, 0, 'f', 2);
+    QFontMetrics fm = painter.fontMetrics();
+    QRectF textRect(r.left(), r.top() - fm.height() - 2, fm.boundingRect(text).width() + 6, fm.height() + 2);
+    if (textRect.top() < targetRect.top())
+        textRect.moveTop(r.top());
+    painter.fillRect(textRect, color);
+    painter.setPen(Qt::white);
+    painter.drawText(textRect, Qt::AlignCenter, text);
+}
@@ -0,0 +1,68 @@
+#ifndef VIDEO_WIDGET_H
+#define VIDEO_WIDGET_H
+
+#include <QWidget>
+#include <QImage>
+#include <QRect>
+#include <QString>
+#include <opencv2/core.hpp>
+#include "seqlock.h"
+#include "overlay_box.h"
+
+class QPainter;
+
+// 摄像头画面显示控件：替代 cvtColor + QImage + QPixmap::fromImage + scaled() 的逐帧拷贝链路
+// - 直接引用采集到的BGR帧（cv::Mat引用计数，不拷贝），Qt>=5.14用Format_BGR888免去通道交换
+// - 目标矩形只在resize时计算一次，paintEvent中由QPainter一次性缩放绘制
+// - 控件隐藏、窗口最小化或被完全遮挡时跳过渲染
+// - 检测框/类别/置信度作为矢量叠加层在paintEvent中绘制，不在帧数据上画（避免拷贝）
+class VideoWidget : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit VideoWidget(QWidget *parent = nullptr);
+
+    // 提交新帧（GUI线程调用）；返回false表示控件不可见，本帧未渲染
+    bool setFrame(const cv::Mat &bgrFrame);
+    // 清除画面并显示提示文字（摄像头未启动/已停止）
+    void setPlaceholderText(const QString &text);
+    // 叠加层来源：检测结果（推理线程写）与跟踪框（采集线程写），任一可为空
+    void setOverlaySources(const SeqLock<OverlayBox> *detection, const SeqLock<OverlayBox> *tracked);
+
+    // 是否值得渲染：控件可见、窗口未最小化且已被平台暴露、控件未被同一窗口内的其他控件完全遮住。
+    // 局限：visibleRegion()只反映本窗口内的遮挡，看不到其他顶层窗口的遮挡；isExposed()在xcb、linuxfb、eglfs等
+    // 平台上只在窗口未映射时为false，被其他窗口盖住仍算已暴露，这种情况下照常渲染（kiosk单窗口部署不受影响）
+    bool isRenderable() const;
+
+    // 渲染耗时统计（微秒）
+    qint64 lastPaintCostUs() const { return lastPaintUs; }
+    qint64 avgPaintCostUs() const { return paintCount ? totalPaintUs / paintCount : 0; }
+    quint64 paintedFrames() const { return paintCount; }
+    quint64 skippedFrames() const { return skipCount; }
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+
+private:
+    void updateTargetRect();
+    void paintOverlay(QPainter &painter);
+
+    cv::Mat frame;       // 当前显示帧（与采集端共享数据）
+#if QT_VERSION < QT_VERSION_CHECK(5, 14, 0)
+    cv::Mat rgbBuffer;   // 旧版Qt无BGR888格式，复用同一块RGB缓冲
+#endif
+    QImage image;        // 包装frame数据，不持有拷贝
+    QRect targetRect;    // 保持宽高比后的绘制区域（缓存）
+    QString placeholder;
+    const SeqLock<OverlayBox> *detectionOverlay;
+    const SeqLock<OverlayBox> *trackedOverlay;
+    qint64 overlaySinceMs;   // 早于该时刻发布的叠加层视为上一次会话的残留
+
+    qint64 lastPaintUs;
+    qint64 totalPaintUs;
+    quint64 paintCount;
+    quint64 skipCount;
+};
+
+#endif // VIDEO_WIDGET_H
@@ -0,0 +1,486 @@
+// 轮椅电机控制器模拟器
+//
+// 在伪终端(pty)上扮演下位机，使主程序可以在普通Linux主机上端到端运行：
+//   ./wheelchair_sim --link /tmp/ttyWheelchair &
+//   WHEELCHAIR_UART=/tmp/ttyWheelchair ./OpenCV_CameraMonitor
+//
+// - 同时解码单字符协议（F/B/L/R/S）与帧协议（0xAA 0x55 ...，见uart_master.h）
+// - 差速底盘运动学：每个轮子为一阶惯性环节，积分得到位姿
+// - 帧协议设定值回送ACK帧；按固定频率回送轮速遥测帧
+// - 每条收到的指令打印CLOCK_MONOTONIC时间戳（与主程序monotonicNowNs()同源），
+//   轮速到达新目标的90%时再打印一次"reach"，两者之差即模拟的指令→车轮延迟
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <signal.h>
+#include <poll.h>
+#include <math.h>
+#include <termios.h>
+#include <sys/timerfd.h>
+#include "uart_master.h"
+#include "pipeline_clock.h"
+
+struct SimOptions
+{
+    const char *linkPath;     // 把从设备路径软链接到固定位置，便于脚本使用
+    const char *logPath;      // 接收日志，默认stdout
+    int physicsHz;            // 运动学积分频率
+    int telemetryHz;          // 遥测频率，0表示不发送
+    int timeoutMs;            // 帧协议下超过该时长没有设定值则停车（模拟下位机看门狗），0表示不启用
+    float wheelBase;          // 轮距（m）
+    float motorTau;           // 电机一阶响应时间常数（s）
+    float legacyLinear;       // 单字符协议下前进/后退速度（m/s）
+    float legacyAngular;      // 单字符协议下转向角速度（rad/s）
+    bool quiet;               // 不打印逐条接收日志
+};
+
+struct SimStats
+{
+    unsigned long legacyCommands;
+    unsigned long frames;
+    unsigned long checksumErrors;
+    unsigned long unknownBytes;
+    unsigned long seqGaps;
+    unsigned long acksSent;
+    unsigned long telemetrySent;
+    unsigned long txDropped;
+    double reachTotalMs;
+    double reachMaxMs;
+    unsigned long reachCount;
+};
+
+// 差速底盘：目标线速度/角速度 → 左右轮目标速度 → 一阶惯性 → 位姿积分
+struct DiffDrive
+{
+    float targetLinear;
+    float targetAngular;
+    float left;
+    float right;
+    double x;
+    double y;
+    double theta;
+    int64_t commandNs;      // 最近一次改变目标的指令到达时刻
+    bool awaitingReach;
+    float startLeft;
+    float startRight;
+};
+
+enum DecodeState { WaitHead0, WaitHead1, WaitType, WaitLen, WaitPayload, WaitChecksum };
+
+struct FrameDecoder
+{
+    DecodeState state;
+    unsigned char type;
+    unsigned char len;
+    unsigned char payload[UART_FRAME_MAX_PAYLOAD];
+    int received;
+    unsigned char sum;
+};
+
+static volatile sig_atomic_t g_running = 1;
+
+static void onSignal(int)
+{
+    g_running = 0;
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+            "用法: %s [选项]\n"
+            "  --link PATH        把伪终端从设备软链接到PATH\n"
+            "  --log FILE         接收日志写入FILE（默认stdout）\n"
+            "  --physics-hz N     运动学积分频率（默认100）\n"
+            "  --telemetry-hz N   遥测帧频率，0关闭（默认10）\n"
+            "  --timeout-ms N     帧协议看门狗，0关闭（默认500）\n"
+            "  --wheel-base M     轮距，米（默认0.55）\n"
+            "  --motor-tau S      电机时间常数，秒（默认0.15）\n"
+            "  --quiet            只输出汇总\n",
+            prog);
+}
+
+static bool parseOptions(int argc, char **argv, SimOptions &opt)
+{
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *val = i + 1 < argc ? argv[i + 1] : NULL;
+        if (strcmp(arg, "--quiet") == 0) {
+            opt.quiet = true;
+            continue;
+        }
+        if (val == NULL) {
+            usage(argv[0]);
+            return false;
+        }
+        if (strcmp(arg, "--link") == 0) opt.linkPath = val;
+        else if (strcmp(arg, "--log") == 0) opt.logPath = val;
+        else if (strcmp(arg, "--physics-hz") == 0) opt.physicsHz = atoi(val);
+        else if (strcmp(arg, "--telemetry-hz") == 0) opt.telemetryHz = atoi(val);
+        else if (strcmp(arg, "--timeout-ms") == 0) opt.timeoutMs = atoi(val);
+        else if (strcmp(arg, "--wheel-base") == 0) opt.wheelBase = (float)atof(val);
+        else if (strcmp(arg, "--motor-tau") == 0) opt.motorTau = (float)atof(val);
+        else {
+            usage(argv[0]);
+            return false;
+        }
+        i++;
+    }
+    if (opt.physicsHz < 1 || opt.telemetryHz < 0 || opt.wheelBase <= 0.0f || opt.motorTau <= 0.0f) {
+        usage(argv[0]);
+        return false;
+    }
+    return true;
+}
+
+// 打开伪终端主设备；同时保持一个从设备句柄，主程序关闭/重开串口时主设备读不会返回EIO
+static int openPty(int &slaveFd, char *slaveName, size_t nameLen)
+{
+    int master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (master < 0) {
+        fprintf(stderr, "posix_openpt失败: %s\n", strerror(errno));
+        return -1;
+    }
+    if (grantpt(master) < 0 || unlockpt(master) < 0) {
+        fprintf(stderr, "伪终端初始化失败: %s\n", strerror(errno));
+        close(master);
+        return -1;
+    }
+    const char *name = ptsname(master);
+    if (name == NULL) {
+        close(master);
+        return -1;
+    }
+    snprintf(slaveName, nameLen, "%s", name);
+
+    slaveFd = open(slaveName, O_RDWR | O_NOCTTY);
+    if (slaveFd >= 0) {
+        // 原始模式：不做行缓冲/回显/字符转换，与真实串口一致
+        struct termios cfg;
+        if (tcgetattr(slaveFd, &cfg) == 0) {
+            cfmakeraw(&cfg);
+            tcsetattr(slaveFd, TCSANOW, &cfg);
+        }
+    }
+    fcntl(master, F_SETFL, fcntl(master, F_GETFL) | O_NONBLOCK);
+    return master;
+}
+
+static double nsToMs(int64_t ns)
+{
+    return ns / 1000000.0;
+}
+
+// 下行（模拟器→主程序）写入：主程序串口只写不读时缓冲区会满，此时丢弃而不是阻塞
+static void sendFrame(int fd, unsigned char type, const unsigned char *payload, int len, SimStats &stats)
+{
+    unsigned char frame[UART_FRAME_MAX_PAYLOAD + UART_FRAME_OVERHEAD];
+    int n = uart_encode_frame(frame, type, payload, len);
+    if (n < 0 || write(fd, frame, n) != n) {
+        stats.txDropped++;
+        return;
+    }
+    if (type == UART_FRAME_ACK)
+        stats.acksSent++;
+    else if (type == UART_FRAME_TELEMETRY)
+        stats.telemetrySent++;
+}
+
+static void setTarget(DiffDrive &drive, float linear, float angular, int64_t nowNs)
+{
+    if (linear == drive.targetLinear && angular == drive.targetAngular)
+        return;
+    drive.targetLinear = linear;
+    drive.targetAngular = angular;
+    drive.commandNs = nowNs;
+    drive.awaitingReach = true;
+    drive.startLeft = drive.left;
+    drive.startRight = drive.right;
+}
+
+static void onLegacyCommand(char c, int64_t nowNs, const SimOptions &opt, DiffDrive &drive, SimStats &stats, FILE *log)
+{
+    float linear = 0.0f;
+    float angular = 0.0f;
+    switch (c) {
+    case 'F': linear = opt.legacyLinear; break;
+    case 'B': linear = -opt.legacyLinear * 0.5f; break;
+    case 'L': angular = opt.legacyAngular; break;
+    case 'R': angular = -opt.legacyAngular; break;
+    default: break;
+    }
+    stats.legacyCommands++;
+    if (!opt.quiet)
+        fprintf(log, "%.3f rx legacy %c\n", nsToMs(nowNs), c);
+    setTarget(drive, linear, angular, nowNs);
+}
+
+static void onFrame(const FrameDecoder &dec, int64_t nowNs, int fd, const SimOptions &opt,
+                    DiffDrive &drive, SimStats &stats, FILE *log, int &lastSeq)
+{
+    stats.frames++;
+    if (dec.type != UART_FRAME_SETPOINT || dec.len != 5) {
+        if (!opt.quiet)
+            fprintf(log, "%.3f rx frame type=0x%02x len=%d (ignored)\n", nsToMs(nowNs), dec.type, dec.len);
+        return;
+    }
+
+    short linear = (short)(dec.payload[0] | (dec.payload[1] << 8));
+    short angular = (short)(dec.payload[2] | (dec.payload[3] << 8));
+    int seq = dec.payload[4];
+    if (lastSeq >= 0 && seq != ((lastSeq + 1) & 0xff))
+        stats.seqGaps++;
+    lastSeq = seq;
+
+    if (!opt.quiet)
+        fprintf(log, "%.3f rx setpoint seq=%d linear=%d angular=%d\n", nsToMs(nowNs), seq, linear, angular);
+    setTarget(drive, linear * 0.001f, angular * 0.001f, nowNs);
+
+    unsigned char ack = (unsigned char)seq;
+    sendFrame(fd, UART_FRAME_ACK, &ack, 1, stats);
+}
+
+static void decodeBytes(const unsigned char *buf, int n, int64_t nowNs, int fd, const SimOptions &opt,
+                        FrameDecoder &dec, DiffDrive &drive, SimStats &stats, FILE *log,
+                        int &lastSeq, int64_t &lastSetpointNs)
+{
+    for (int i = 0; i < n; i++) {
+        unsigned char b = buf[i];
+        switch (dec.state) {
+        case WaitHead0:
+            if (b == UART_FRAME_HEAD0)
+                dec.state = WaitHead1;
+            else if (b != 0 && strchr("FBLRS", b) != NULL)
+                onLegacyCommand((char)b, nowNs, opt, drive, stats, log);
+            else
+                stats.unknownBytes++;
+            break;
+        case WaitHead1:
+            if (b == UART_FRAME_HEAD1) {
+                dec.state = WaitType;
+            } else {
+                stats.unknownBytes++;
+                dec.state = b == UART_FRAME_HEAD0 ? WaitHead1 : WaitHead0;
+            }
+            break;
+        case WaitType:
+            dec.type = b;
+            dec.sum = b;
+            dec.state = WaitLen;
+            break;
+        case WaitLen:
+            if (b > UART_FRAME_MAX_PAYLOAD) {
+                stats.checksumErrors++;
+                dec.state = WaitHead0;
+                break;
+            }
+            dec.len = b;
+            dec.sum ^= b;
+            dec.received = 0;
+            dec.state = b ? WaitPayload : WaitChecksum;
+            break;
+        case WaitPayload:
+            dec.payload[dec.received++] = b;
+            dec.sum ^= b;
+            if (dec.received == dec.len)
+                dec.state = WaitChecksum;
+            break;
+        case WaitChecksum:
+            if (b == dec.sum) {
+                onFrame(dec, nowNs, fd, opt, drive, stats, log, lastSeq);
+                if (dec.type == UART_FRAME_SETPOINT)
+                    lastSetpointNs = nowNs;
+            } else {
+                stats.checksumErrors++;
+                if (!opt.quiet)
+                    fprintf(log, "%.3f rx checksum error type=0x%02x\n", nsToMs(nowNs), dec.type);
+            }
+            dec.state = WaitHead0;
+            break;
+        }
+    }
+}
+
+// 一阶惯性 + 位姿积分；轮速进入目标的90%后记录一次到达延迟
+static void stepPhysics(DiffDrive &drive, float dt, int64_t nowNs, const SimOptions &opt, SimStats &stats, FILE *log)
+{
+    float half = opt.wheelBase * 0.5f;
+    float targetLeft = drive.targetLinear - drive.targetAngular * half;
+    float targetRight = drive.targetLinear + drive.targetAngular * half;
+    float k = 1.0f - expf(-dt / opt.motorTau);
+    drive.left += (targetLeft - drive.left) * k;
+    drive.right += (targetRight - drive.right) * k;
+
+    double v = (drive.left + drive.right) * 0.5;
+    double w = (drive.right - drive.left) / opt.wheelBase;
+    drive.x += v * cos(drive.theta) * dt;
+    drive.y += v * sin(drive.theta) * dt;
+    drive.theta += w * dt;
+
+    if (drive.awaitingReach) {
+        float spanL = targetLeft - drive.startLeft;
+        float spanR = targetRight - drive.startRight;
+        bool leftDone = fabsf(spanL) < 1e-3f || fabsf(targetLeft - drive.left) <= fabsf(spanL) * 0.1f;
+        bool rightDone = fabsf(spanR) < 1e-3f || fabsf(targetRight - drive.right) <= fabsf(spanR) * 0.1f;
+        if (leftDone && rightDone) {
+            double ms = nsToMs(nowNs - drive.commandNs);
+            drive.awaitingReach = false;
+            stats.reachCount++;
+            stats.reachTotalMs += ms;
+            if (ms > stats.reachMaxMs)
+                stats.reachMaxMs = ms;
+            if (!opt.quiet)
+                fprintf(log, "%.3f reach %.1fms left=%.3f right=%.3f pose=(%.2f, %.2f, %.1fdeg)\n",
+                        nsToMs(nowNs), ms, drive.left, drive.right, drive.x, drive.y, drive.theta * 180.0 / M_PI);
+        }
+    }
+}
+
+static void sendTelemetry(int fd, const DiffDrive &drive, SimStats &stats)
+{
+    short left = (short)lrintf(drive.left * 1000.0f);
+    short right = (short)lrintf(drive.right * 1000.0f);
+    unsigned char payload[4];
+    payload[0] = (unsigned char)(left & 0xff);
+    payload[1] = (unsigned char)((left >> 8) & 0xff);
+    payload[2] = (unsigned char)(right & 0xff);
+    payload[3] = (unsigned char)((right >> 8) & 0xff);
+    sendFrame(fd, UART_FRAME_TELEMETRY, payload, sizeof(payload), stats);
+}
+
+int main(int argc, char **argv)
+{
+    SimOptions opt;
+    opt.linkPath = NULL;
+    opt.logPath = NULL;
+    opt.physicsHz = 100;
+    opt.telemetryHz = 10;
+    opt.timeoutMs = 500;
+    opt.wheelBase = 0.55f;
+    opt.motorTau = 0.15f;
+    opt.legacyLinear = 0.6f;
+    opt.legacyAngular = 0.8f;
+    opt.quiet = false;
+    if (!parseOptions(argc, argv, opt))
+        return 1;
+
+    FILE *log = stdout;
+    if (opt.logPath != NULL) {
+        log = fopen(opt.logPath, "w");
+        if (log == NULL) {
+            fprintf(stderr, "无法打开日志文件%s: %s\n", opt.logPath, strerror(errno));
+            return 1;
+        }
+    }
+    setvbuf(log, NULL, _IOLBF, 0);
+
+    int slaveFd = -1;
+    char slaveName[128];
+    int master = openPty(slaveFd, slaveName, sizeof(slaveName));
+    if (master < 0)
+        return 1;
+    if (opt.linkPath != NULL) {
+        unlink(opt.linkPath);
+        if (symlink(slaveName, opt.linkPath) < 0) {
+            fprintf(stderr, "创建软链接%s失败: %s\n", opt.linkPath, strerror(errno));
+            opt.linkPath = NULL;
+        }
+    }
+    fprintf(stderr, "模拟器就绪: %s%s%s\n", slaveName,
+            opt.linkPath ? " -> " : "", opt.linkPath ? opt.linkPath : "");
+
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = onSignal;
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+
+    int timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    struct itimerspec its;
+    its.it_interval.tv_sec = 0;
+    its.it_interval.tv_nsec = 1000000000L / opt.physicsHz;
+    if (opt.physicsHz == 1) {
+        its.it_interval.tv_sec = 1;
+        its.it_interval.tv_nsec = 0;
+    }
+    its.it_value = its.it_interval;
+    timerfd_settime(timerFd, 0, &its, NULL);
+
+    SimStats stats;
+    memset(&stats, 0, sizeof(stats));
+    DiffDrive drive;
+    memset(&drive, 0, sizeof(drive));
+    FrameDecoder dec;
+    memset(&dec, 0, sizeof(dec));
+    dec.state = WaitHead0;
+    int lastSeq = -1;
+    int64_t lastSetpointNs = 0;
+    int64_t lastPhysicsNs = monotonicNowNs();
+    int64_t lastTelemetryNs = lastPhysicsNs;
+    int64_t telemetryPeriodNs = opt.telemetryHz > 0 ? 1000000000LL / opt.telemetryHz : 0;
+
+    struct pollfd pfds[2];
+    pfds[0].fd = master;
+    pfds[0].events = POLLIN;
+    pfds[1].fd = timerFd;
+    pfds[1].events = POLLIN;
+    unsigned char buf[256];
+
+    while (g_running) {
+        if (poll(pfds, 2, -1) <= 0)
+            continue;
+
+        if (pfds[0].revents & POLLIN) {
+            ssize_t n;
+            while ((n = read(master, buf, sizeof(buf))) > 0) {
+                // 同一次read内的字节共用一个到达时间戳
+                int64_t now = monotonicNowNs();
+                decodeBytes(buf, (int)n, now, master, opt, dec, drive, stats, log, lastSeq, lastSetpointNs);
+            }
+        }
+
+        if (pfds[1].revents & POLLIN) {
+            uint64_t expirations;
+            while (read(timerFd, &expirations, sizeof(expirations)) == sizeof(expirations)) {
+            }
+            int64_t now = monotonicNowNs();
+            float dt = (float)((now - lastPhysicsNs) * 1e-9);
+            lastPhysicsNs = now;
+
+            // 下位机看门狗：设定值流中断时停车
+            if (opt.timeoutMs > 0 && lastSetpointNs > 0 &&
+                now - lastSetpointNs > (int64_t)opt.timeoutMs * 1000000) {
+                if (!opt.quiet)
+                    fprintf(log, "%.3f watchdog setpoint timeout, stopping\n", nsToMs(now));
+                setTarget(drive, 0.0f, 0.0f, now);
+                lastSetpointNs = 0;
+            }
+
+            stepPhysics(drive, dt, now, opt, stats, log);
+            if (telemetryPeriodNs > 0 && now - lastTelemetryNs >= telemetryPeriodNs) {
+                sendTelemetry(master, drive, stats);
+                lastTelemetryNs = now;
+            }
+        }
+    }
+
+    fprintf(log, "summary legacy=%lu frames=%lu checksum_errors=%lu unknown_bytes=%lu seq_gaps=%lu "
+                 "acks=%lu telemetry=%lu tx_dropped=%lu reach_avg=%.1fms reach_max=%.1fms "
+                 "pose=(%.2f, %.2f, %.1fdeg)\n",
+            stats.legacyCommands, stats.frames, stats.checksumErrors, stats.unknownBytes, stats.seqGaps,
+            stats.acksSent, stats.telemetrySent, stats.txDropped,
+            stats.reachCount ? stats.reachTotalMs / stats.reachCount : 0.0, stats.reachMaxMs,
+            drive.x, drive.y, drive.theta * 180.0 / M_PI);
+
+    if (opt.linkPath != NULL)
+        unlink(opt.linkPath);
+    close(timerFd);
+    if (slaveFd >= 0)
+        close(slaveFd);
+    close(master);
+    if (log != stdout)
+        fclose(log);
+    return 0;
+}
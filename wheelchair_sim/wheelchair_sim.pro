@@ -0,0 +1,16 @@
+# 轮椅下位机模拟器：在伪终端上解码单字符/帧协议，模拟差速底盘并回送应答与遥测
+QT       -= core gui
+
+CONFIG   += console c++11
+CONFIG   -= app_bundle
+
+TARGET = wheelchair_sim
+TEMPLATE = app
+
+INCLUDEPATH += ..
+
+SOURCES += wheelchair_sim.cpp \
+           ../uart_master.cpp
+
+HEADERS  += ../uart_master.h \
+            ../pipeline_clock.h